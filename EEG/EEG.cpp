@@ -18,6 +18,8 @@
 
 #include "EEG.h"
 #include "Sound_and_Spectrum.h"
+#include "NUM2.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "EEG_def.h"
@@ -94,12 +96,29 @@ long EEG_getChannelNumber (EEG me, const char32 *channelName) {
 	return 0;
 }
 
-autoEEG EEG_readFromBdfFile (MelderFile file) {
+Thing_implement (BdfFile, Thing, 0);
+
+void structBdfFile :: v_destroy () noexcept {
+	if (f) fclose (f);
+	if (channelNames) {
+		for (long ichan = 1; ichan <= numberOfChannels; ichan ++)
+			Melder_free (channelNames [ichan]);
+		NUMvector_free <char32 *> (channelNames, 1);
+	}
+	NUMvector_free <double> (factor, 1);
+	NUMvector_free <unsigned char> (buffer, 0);
+	BdfFile_Parent :: v_destroy ();
+}
+
+autoBdfFile BdfFile_open (MelderFile file) {
 	try {
-		autofile f = Melder_fopen (file, "rb");
+		autoBdfFile me = Thing_new (BdfFile);
+		MelderFile_copy (file, & my file);
+		my f = Melder_fopen (file, "rb");
+		FILE *f = my f;
 		char buffer [81];
 		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		bool is24bit = buffer [0] == (char) 255;
+		my is24bit = buffer [0] == (char) 255;
 		fread (buffer, 1, 80, f); buffer [80] = '\0';
 		trace (U"Local subject identification: \"", Melder_peek8to32 (buffer), U"\"");
 		fread (buffer, 1, 80, f); buffer [80] = '\0';
@@ -109,23 +128,24 @@ autoEEG EEG_readFromBdfFile (MelderFile file) {
 		fread (buffer, 1, 8, f); buffer [8] = '\0';
 		trace (U"Start time of recording: \"", Melder_peek8to32 (buffer), U"\"");
 		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		long numberOfBytesInHeaderRecord = atol (buffer);
-		trace (U"Number of bytes in header record: ", numberOfBytesInHeaderRecord);
+		my numberOfBytesInHeaderRecord = atol (buffer);
+		trace (U"Number of bytes in header record: ", my numberOfBytesInHeaderRecord);
 		fread (buffer, 1, 44, f); buffer [44] = '\0';
 		trace (U"Version of data format: \"", Melder_peek8to32 (buffer), U"\"");
 		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		long numberOfDataRecords = strtol (buffer, nullptr, 10);
-		trace (U"Number of data records: ", numberOfDataRecords);
+		my numberOfDataRecords = strtol (buffer, nullptr, 10);
+		trace (U"Number of data records: ", my numberOfDataRecords);
 		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		double durationOfDataRecord = atof (buffer);
-		trace (U"Duration of a data record: ", durationOfDataRecord);
+		my durationOfDataRecord = atof (buffer);
+		trace (U"Duration of a data record: ", my durationOfDataRecord);
 		fread (buffer, 1, 4, f); buffer [4] = '\0';
 		long numberOfChannels = atol (buffer);
 		trace (U"Number of channels in data record: ", numberOfChannels);
-		if (numberOfBytesInHeaderRecord != (numberOfChannels + 1) * 256)
-			Melder_throw (U"Number of bytes in header record (", numberOfBytesInHeaderRecord,
+		if (my numberOfBytesInHeaderRecord != (numberOfChannels + 1) * 256)
+			Melder_throw (U"Number of bytes in header record (", my numberOfBytesInHeaderRecord,
 				U") doesn't match number of channels (", numberOfChannels, U").");
-		autostring32vector channelNames (1, numberOfChannels);
+		my channelNames = NUMvector <char32 *> (1, numberOfChannels);
+		my numberOfChannels = numberOfChannels;
 		for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
 			fread (buffer, 1, 16, f); buffer [16] = '\0';   // labels of the channels
 			/*
@@ -138,11 +158,11 @@ autoEEG EEG_readFromBdfFile (MelderFile file) {
 					break;
 				}
 			}
-			channelNames [ichannel] = Melder_8to32 (buffer);
-			trace (U"Channel <<", channelNames [ichannel], U">>");
+			my channelNames [ichannel] = Melder_8to32 (buffer);
+			trace (U"Channel <<", my channelNames [ichannel], U">>");
 		}
-		bool hasLetters = str32equ (channelNames [numberOfChannels], U"EDF Annotations");
-		double samplingFrequency = NUMundefined;
+		my hasLetters = str32equ (my channelNames [numberOfChannels], U"EDF Annotations");
+		my samplingFrequency = NUMundefined;
 		for (long channel = 1; channel <= numberOfChannels; channel ++) {
 			fread (buffer, 1, 80, f); buffer [80] = '\0';   // transducer type
 		}
@@ -172,244 +192,369 @@ autoEEG EEG_readFromBdfFile (MelderFile file) {
 		for (long channel = 1; channel <= numberOfChannels; channel ++) {
 			fread (buffer, 1, 80, f); buffer [80] = '\0';   // prefiltering
 		}
-		long numberOfSamplesPerDataRecord = 0;
 		for (long channel = 1; channel <= numberOfChannels; channel ++) {
 			fread (buffer, 1, 8, f); buffer [8] = '\0';   // number of samples in each data record
 			long numberOfSamplesInThisDataRecord = atol (buffer);
-			if (samplingFrequency == NUMundefined) {
-				numberOfSamplesPerDataRecord = numberOfSamplesInThisDataRecord;
-				samplingFrequency = numberOfSamplesInThisDataRecord / durationOfDataRecord;
+			if (my samplingFrequency == NUMundefined) {
+				my numberOfSamplesPerDataRecord = numberOfSamplesInThisDataRecord;
+				my samplingFrequency = numberOfSamplesInThisDataRecord / my durationOfDataRecord;
 			}
-			if (numberOfSamplesInThisDataRecord / durationOfDataRecord != samplingFrequency)
+			if (numberOfSamplesInThisDataRecord / my durationOfDataRecord != my samplingFrequency)
 				Melder_throw (U"Number of samples per data record in channel ", channel,
 					U" (", numberOfSamplesInThisDataRecord,
-					U") doesn't match sampling frequency of channel 1 (", samplingFrequency, U").");
+					U") doesn't match sampling frequency of channel 1 (", my samplingFrequency, U").");
 		}
 		for (long channel = 1; channel <= numberOfChannels; channel ++) {
 			fread (buffer, 1, 32, f); buffer [32] = '\0';   // reserved
 		}
-		double duration = numberOfDataRecords * durationOfDataRecord;
-		autoEEG him = EEG_create (0, duration);
-		his numberOfChannels = numberOfChannels;
-		autoSound me = Sound_createSimple (numberOfChannels, duration, samplingFrequency);
-		Melder_assert (my nx == numberOfSamplesPerDataRecord * numberOfDataRecords);
-		autoNUMvector <unsigned char> dataBuffer (0L, 3 * numberOfSamplesPerDataRecord - 1);
-		for (long record = 1; record <= numberOfDataRecords; record ++) {
-			for (long channel = 1; channel <= numberOfChannels; channel ++) {
-				double factor = channel == numberOfChannels ? 1.0 : physicalMinimum [channel] / digitalMinimum [channel];
-				if (channel < numberOfChannels - EEG_getNumberOfExtraSensors (him.get())) factor /= 1000000.0;
-				if (is24bit) {
-					fread (& dataBuffer [0], 3, numberOfSamplesPerDataRecord, f);
-					unsigned char *p = & dataBuffer [0];
-					for (long i = 1; i <= numberOfSamplesPerDataRecord; i ++) {
-						long sample = i + (record - 1) * numberOfSamplesPerDataRecord;
-						Melder_assert (sample <= my nx);
-						uint8_t lowByte = *p ++, midByte = *p ++, highByte = *p ++;
-						uint32_t externalValue = ((uint32_t) highByte << 16) | ((uint32_t) midByte << 8) | (uint32_t) lowByte;
-						if ((highByte & 128) != 0)   // is the 24-bit sign bit on?
-							externalValue |= 0xFF000000;   // extend negative sign to 32 bits
-						my z [channel] [sample] = (int32_t) externalValue * factor;
-					}
-				} else {
-					fread (& dataBuffer [0], 2, numberOfSamplesPerDataRecord, f);
-					unsigned char *p = & dataBuffer [0];
-					for (long i = 1; i <= numberOfSamplesPerDataRecord; i ++) {
-						long sample = i + (record - 1) * numberOfSamplesPerDataRecord;
-						Melder_assert (sample <= my nx);
-						uint8 lowByte = *p ++, highByte = *p ++;
-						uint16 externalValue = (uint16) ((uint16) highByte << 8) | (uint16) lowByte;
-						my z [channel] [sample] = (int16) externalValue * factor;
-					}
+		if (my numberOfDataRecords < 1)
+			Melder_throw (U"The number of data records (", my numberOfDataRecords, U") should be positive.");
+		my factor = NUMvector <double> (1, numberOfChannels);
+		for (long channel = 1; channel <= numberOfChannels; channel ++) {
+			my factor [channel] = channel == numberOfChannels ? 1.0 : physicalMinimum [channel] / digitalMinimum [channel];
+			if (channel < numberOfChannels - EEG_getNumberOfExtraSensors (numberOfChannels)) my factor [channel] /= 1000000.0;
+		}
+		my numberOfBytesPerChannel = (my is24bit ? 3 : 2) * my numberOfSamplesPerDataRecord;
+		my numberOfBytesPerDataRecord = my numberOfBytesPerChannel * numberOfChannels;
+		my bufferSize = my numberOfBytesPerDataRecord > 1000000 ? my numberOfBytesPerDataRecord : 1000000;
+		my buffer = NUMvector <unsigned char> (0, my bufferSize - 1);
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"BDF file ", file, U" not opened.");
+	}
+}
+
+/*
+	Convert the samples of one channel in one data record to physical values.
+	Sign extension is done by shifting the three (or two) bytes into the top of a 32-bit (or 16-bit) integer
+	and shifting back, which the compiler turns into a short loop without branches.
+*/
+static void decode24 (const unsigned char *p, long numberOfSamples, double factor, double *to) {
+	for (long i = 1; i <= numberOfSamples; i ++, p += 3) {
+		uint32_t externalValue = (uint32_t) p [0] << 8 | (uint32_t) p [1] << 16 | (uint32_t) p [2] << 24;
+		to [i] = ((int32_t) externalValue >> 8) * factor;
+	}
+}
+
+static void decode16 (const unsigned char *p, long numberOfSamples, double factor, double *to) {
+	for (long i = 1; i <= numberOfSamples; i ++, p += 2) {
+		uint16 externalValue = (uint16) ((uint16) p [1] << 8) | (uint16) p [0];
+		to [i] = (int16) externalValue * factor;
+	}
+}
+
+void BdfFile_readChannels (BdfFile me, long fromRecord, long toRecord, long fromChannel, long toChannel, double **z) {
+	try {
+		Melder_assert (fromRecord >= 1 && toRecord <= my numberOfDataRecords && fromRecord <= toRecord);
+		Melder_assert (fromChannel >= 1 && toChannel <= my numberOfChannels && fromChannel <= toChannel);
+		/*
+			If all channels are wanted, the data records follow each other in the file,
+			so we read as many of them as fit in the buffer at a time;
+			otherwise, we read only the wanted channels of each data record and skip the rest.
+		*/
+		bool allChannels = ( fromChannel == 1 && toChannel == my numberOfChannels );
+		long numberOfRecordsPerRead = allChannels ? my bufferSize / my numberOfBytesPerDataRecord : 1;
+		long numberOfBytesToSkip = (fromChannel - 1) * my numberOfBytesPerChannel;
+		for (long firstRecord = fromRecord; firstRecord <= toRecord; firstRecord += numberOfRecordsPerRead) {
+			long numberOfRecords = toRecord - firstRecord + 1;
+			if (numberOfRecords > numberOfRecordsPerRead) numberOfRecords = numberOfRecordsPerRead;
+			size_t numberOfBytesToRead = allChannels ? numberOfRecords * my numberOfBytesPerDataRecord :
+				(toChannel - fromChannel + 1) * my numberOfBytesPerChannel;
+			fseeko (my f, (off_t) my numberOfBytesInHeaderRecord + (off_t) (firstRecord - 1) * my numberOfBytesPerDataRecord
+				+ numberOfBytesToSkip, SEEK_SET);
+			size_t numberOfBytesRead = fread (my buffer, 1, numberOfBytesToRead, my f);
+			if (numberOfBytesRead < numberOfBytesToRead)   // a truncated recording: pad with silence
+				memset (my buffer + numberOfBytesRead, 0, numberOfBytesToRead - numberOfBytesRead);
+			for (long irecord = 0; irecord < numberOfRecords; irecord ++) {
+				const unsigned char *p = my buffer + irecord * my numberOfBytesPerDataRecord;
+				long offset = (firstRecord + irecord - fromRecord) * my numberOfSamplesPerDataRecord;
+				for (long channel = fromChannel; channel <= toChannel; channel ++) {
+					double *to = z [channel - fromChannel + 1] + offset;
+					if (my is24bit)
+						decode24 (p, my numberOfSamplesPerDataRecord, my factor [channel], to);
+					else
+						decode16 (p, my numberOfSamplesPerDataRecord, my factor [channel], to);
+					p += my numberOfBytesPerChannel;
 				}
 			}
 		}
-		int numberOfStatusBits = 8;
-		for (long i = 1; i <= my nx; i ++) {
-			unsigned long value = (long) my z [numberOfChannels] [i];
-			if (value & 0x0000FF00) {
-				numberOfStatusBits = 16;
-			}
+	} catch (MelderError) {
+		Melder_throw (U"Data records ", fromRecord, U" to ", toRecord, U" of BDF file ", & my file, U" not read.");
+	}
+}
+
+static autoTextGrid BdfFile_statusToTextGrid (BdfFile me, double *status, long numberOfSamples,
+	double tmin, double tmax, double x1, double dx)
+{
+	int numberOfStatusBits = 8;
+	for (long i = 1; i <= numberOfSamples; i ++) {
+		unsigned long value = (long) status [i];
+		if (value & 0x0000FF00) {
+			numberOfStatusBits = 16;
 		}
-		autoTextGrid thee;
-		if (hasLetters) {
-			thee = TextGrid_create (0, duration, U"Mark Trigger", U"Mark Trigger");
-			autoMelderString letters;
-			double time = NUMundefined;
-			for (long i = 1; i <= my nx; i ++) {
-				unsigned long value = (long) my z [numberOfChannels] [i];
-				for (int byte = 1; byte <= numberOfStatusBits / 8; byte ++) {
-					unsigned long mask = byte == 1 ? 0x000000ff : 0x0000ff00;
-					char32 kar = byte == 1 ? (value & mask) : (value & mask) >> 8;
-					if (kar != U'\0' && kar != 20) {
-						MelderString_appendCharacter (& letters, kar);
-					} else if (letters. string [0] != U'\0') {
-						if (letters. string [0] == U'+') {
-							if (NUMdefined (time)) {
+	}
+	autoTextGrid thee;
+	if (my hasLetters) {
+		thee = TextGrid_create (tmin, tmax, U"Mark Trigger", U"Mark Trigger");
+		autoMelderString letters;
+		double time = NUMundefined;
+		for (long i = 1; i <= numberOfSamples; i ++) {
+			unsigned long value = (long) status [i];
+			for (int byte = 1; byte <= numberOfStatusBits / 8; byte ++) {
+				unsigned long mask = byte == 1 ? 0x000000ff : 0x0000ff00;
+				char32 kar = byte == 1 ? (value & mask) : (value & mask) >> 8;
+				if (kar != U'\0' && kar != 20) {
+					MelderString_appendCharacter (& letters, kar);
+				} else if (letters. string [0] != U'\0') {
+					if (letters. string [0] == U'+') {
+						if (NUMdefined (time)) {
+							try {
+								TextGrid_insertPoint (thee.get(), 1, time, U"");
+							} catch (MelderError) {
+								Melder_throw (U"Did not insert empty mark (", letters. string, U") on Mark tier.");
+							}
+							time = NUMundefined;   // defensive
+						}
+						time = Melder_atof (& letters. string [1]);
+						MelderString_empty (& letters);
+					} else {
+						if (! NUMdefined (time)) {
+							Melder_throw (U"Undefined time for label at sample ", i, U".");
+						}
+						try {
+							if (Melder_nequ (letters. string, U"Trigger-", 8)) {
 								try {
-									TextGrid_insertPoint (thee.get(), 1, time, U"");
+									TextGrid_insertPoint (thee.get(), 2, time, & letters. string [8]);
 								} catch (MelderError) {
-									Melder_throw (U"Did not insert empty mark (", letters. string, U") on Mark tier.");
+									Melder_clearError ();
+									trace (U"Duplicate trigger at ", time, U" seconds: ", & letters. string [8]);
 								}
-								time = NUMundefined;   // defensive
-							}
-							time = Melder_atof (& letters. string [1]);
-							MelderString_empty (& letters);
-						} else {
-							if (! NUMdefined (time)) {
-								Melder_throw (U"Undefined time for label at sample ", i, U".");
+							} else {
+								TextGrid_insertPoint (thee.get(), 1, time, & letters. string [0]);
 							}
-							try {
-								if (Melder_nequ (letters. string, U"Trigger-", 8)) {
-									try {
-										TextGrid_insertPoint (thee.get(), 2, time, & letters. string [8]);
-									} catch (MelderError) {
-										Melder_clearError ();
-										trace (U"Duplicate trigger at ", time, U" seconds: ", & letters. string [8]);
-									}
-								} else {
-									TextGrid_insertPoint (thee.get(), 1, time, & letters. string [0]);
-								}
-							} catch (MelderError) {
-								Melder_throw (U"Did not insert mark (", letters. string, U") on Trigger tier.");
-							}
-							time = NUMundefined;   // crucial
-							MelderString_empty (& letters);
+						} catch (MelderError) {
+							Melder_throw (U"Did not insert mark (", letters. string, U") on Trigger tier.");
 						}
+						time = NUMundefined;   // crucial
+						MelderString_empty (& letters);
 					}
 				}
 			}
-			if (NUMdefined (time)) {
-				TextGrid_insertPoint (thee.get(), 1, time, U"");
-				time = NUMundefined;   // defensive
-			}
-		} else {
-			thee = TextGrid_create (0, duration,
-				numberOfStatusBits == 8 ? U"S1 S2 S3 S4 S5 S6 S7 S8" : U"S1 S2 S3 S4 S5 S6 S7 S8 S9 S10 S11 S12 S13 S14 S15 S16", U"");
-			for (int bit = 1; bit <= numberOfStatusBits; bit ++) {
-				unsigned long bitValue = 1 << (bit - 1);
-				IntervalTier tier = (IntervalTier) thy tiers->at [bit];
-				for (long i = 1; i <= my nx; i ++) {
-					unsigned long previousValue = i == 1 ? 0 : (long) my z [numberOfChannels] [i - 1];
-					unsigned long thisValue = (long) my z [numberOfChannels] [i];
-					if ((thisValue & bitValue) != (previousValue & bitValue)) {
-						double time = i == 1 ? 0.0 : my x1 + (i - 1.5) * my dx;
-						if (time != 0.0)
-							TextGrid_insertBoundary (thee.get(), bit, time);
-						if ((thisValue & bitValue) != 0)
-							TextGrid_setIntervalText (thee.get(), bit, tier -> intervals.size, U"1");
-					}
+		}
+		if (NUMdefined (time)) {
+			TextGrid_insertPoint (thee.get(), 1, time, U"");
+			time = NUMundefined;   // defensive
+		}
+	} else {
+		thee = TextGrid_create (tmin, tmax,
+			numberOfStatusBits == 8 ? U"S1 S2 S3 S4 S5 S6 S7 S8" : U"S1 S2 S3 S4 S5 S6 S7 S8 S9 S10 S11 S12 S13 S14 S15 S16", U"");
+		for (int bit = 1; bit <= numberOfStatusBits; bit ++) {
+			unsigned long bitValue = 1 << (bit - 1);
+			IntervalTier tier = (IntervalTier) thy tiers->at [bit];
+			for (long i = 1; i <= numberOfSamples; i ++) {
+				unsigned long previousValue = i == 1 ? 0 : (long) status [i - 1];
+				unsigned long thisValue = (long) status [i];
+				if ((thisValue & bitValue) != (previousValue & bitValue)) {
+					double time = i == 1 ? 0.0 : x1 + (i - 1.5) * dx;
+					if (time != 0.0)
+						TextGrid_insertBoundary (thee.get(), bit, time);
+					if ((thisValue & bitValue) != 0)
+						TextGrid_setIntervalText (thee.get(), bit, tier -> intervals.size, U"1");
 				}
 			}
 		}
-		f.close (file);
-		his channelNames = channelNames.transfer();
-		his sound = me.move();
-		his textgrid = thee.move();
-		if (EEG_getNumberOfCapElectrodes (him.get()) == 32) {
-			EEG_setChannelName (him.get(), 1, U"Fp1");
-			EEG_setChannelName (him.get(), 2, U"AF3");
-			EEG_setChannelName (him.get(), 3, U"F7");
-			EEG_setChannelName (him.get(), 4, U"F3");
-			EEG_setChannelName (him.get(), 5, U"FC1");
-			EEG_setChannelName (him.get(), 6, U"FC5");
-			EEG_setChannelName (him.get(), 7, U"T7");
-			EEG_setChannelName (him.get(), 8, U"C3");
-			EEG_setChannelName (him.get(), 9, U"CP1");
-			EEG_setChannelName (him.get(), 10, U"CP5");
-			EEG_setChannelName (him.get(), 11, U"P7");
-			EEG_setChannelName (him.get(), 12, U"P3");
-			EEG_setChannelName (him.get(), 13, U"Pz");
-			EEG_setChannelName (him.get(), 14, U"PO3");
-			EEG_setChannelName (him.get(), 15, U"O1");
-			EEG_setChannelName (him.get(), 16, U"Oz");
-			EEG_setChannelName (him.get(), 17, U"O2");
-			EEG_setChannelName (him.get(), 18, U"PO4");
-			EEG_setChannelName (him.get(), 19, U"P4");
-			EEG_setChannelName (him.get(), 20, U"P8");
-			EEG_setChannelName (him.get(), 21, U"CP6");
-			EEG_setChannelName (him.get(), 22, U"CP2");
-			EEG_setChannelName (him.get(), 23, U"C4");
-			EEG_setChannelName (him.get(), 24, U"T8");
-			EEG_setChannelName (him.get(), 25, U"FC6");
-			EEG_setChannelName (him.get(), 26, U"FC2");
-			EEG_setChannelName (him.get(), 27, U"F4");
-			EEG_setChannelName (him.get(), 28, U"F8");
-			EEG_setChannelName (him.get(), 29, U"AF4");
-			EEG_setChannelName (him.get(), 30, U"Fp2");
-			EEG_setChannelName (him.get(), 31, U"Fz");
-			EEG_setChannelName (him.get(), 32, U"Cz");
-		} else if (EEG_getNumberOfCapElectrodes (him.get()) == 64) {
-			EEG_setChannelName (him.get(), 1, U"Fp1");
-			EEG_setChannelName (him.get(), 2, U"AF7");
-			EEG_setChannelName (him.get(), 3, U"AF3");
-			EEG_setChannelName (him.get(), 4, U"F1");
-			EEG_setChannelName (him.get(), 5, U"F3");
-			EEG_setChannelName (him.get(), 6, U"F5");
-			EEG_setChannelName (him.get(), 7, U"F7");
-			EEG_setChannelName (him.get(), 8, U"FT7");
-			EEG_setChannelName (him.get(), 9, U"FC5");
-			EEG_setChannelName (him.get(), 10, U"FC3");
-			EEG_setChannelName (him.get(), 11, U"FC1");
-			EEG_setChannelName (him.get(), 12, U"C1");
-			EEG_setChannelName (him.get(), 13, U"C3");
-			EEG_setChannelName (him.get(), 14, U"C5");
-			EEG_setChannelName (him.get(), 15, U"T7");
-			EEG_setChannelName (him.get(), 16, U"TP7");
-			EEG_setChannelName (him.get(), 17, U"CP5");
-			EEG_setChannelName (him.get(), 18, U"CP3");
-			EEG_setChannelName (him.get(), 19, U"CP1");
-			EEG_setChannelName (him.get(), 20, U"P1");
-			EEG_setChannelName (him.get(), 21, U"P3");
-			EEG_setChannelName (him.get(), 22, U"P5");
-			EEG_setChannelName (him.get(), 23, U"P7");
-			EEG_setChannelName (him.get(), 24, U"P9");
-			EEG_setChannelName (him.get(), 25, U"PO7");
-			EEG_setChannelName (him.get(), 26, U"PO3");
-			EEG_setChannelName (him.get(), 27, U"O1");
-			EEG_setChannelName (him.get(), 28, U"Iz");
-			EEG_setChannelName (him.get(), 29, U"Oz");
-			EEG_setChannelName (him.get(), 30, U"POz");
-			EEG_setChannelName (him.get(), 31, U"Pz");
-			EEG_setChannelName (him.get(), 32, U"CPz");
-			EEG_setChannelName (him.get(), 33, U"Fpz");
-			EEG_setChannelName (him.get(), 34, U"Fp2");
-			EEG_setChannelName (him.get(), 35, U"AF8");
-			EEG_setChannelName (him.get(), 36, U"AF4");
-			EEG_setChannelName (him.get(), 37, U"AFz");
-			EEG_setChannelName (him.get(), 38, U"Fz");
-			EEG_setChannelName (him.get(), 39, U"F2");
-			EEG_setChannelName (him.get(), 40, U"F4");
-			EEG_setChannelName (him.get(), 41, U"F6");
-			EEG_setChannelName (him.get(), 42, U"F8");
-			EEG_setChannelName (him.get(), 43, U"FT8");
-			EEG_setChannelName (him.get(), 44, U"FC6");
-			EEG_setChannelName (him.get(), 45, U"FC4");
-			EEG_setChannelName (him.get(), 46, U"FC2");
-			EEG_setChannelName (him.get(), 47, U"FCz");
-			EEG_setChannelName (him.get(), 48, U"Cz");
-			EEG_setChannelName (him.get(), 49, U"C2");
-			EEG_setChannelName (him.get(), 50, U"C4");
-			EEG_setChannelName (him.get(), 51, U"C6");
-			EEG_setChannelName (him.get(), 52, U"T8");
-			EEG_setChannelName (him.get(), 53, U"TP8");
-			EEG_setChannelName (him.get(), 54, U"CP6");
-			EEG_setChannelName (him.get(), 55, U"CP4");
-			EEG_setChannelName (him.get(), 56, U"CP2");
-			EEG_setChannelName (him.get(), 57, U"P2");
-			EEG_setChannelName (him.get(), 58, U"P4");
-			EEG_setChannelName (him.get(), 59, U"P6");
-			EEG_setChannelName (him.get(), 60, U"P8");
-			EEG_setChannelName (him.get(), 61, U"P10");
-			EEG_setChannelName (him.get(), 62, U"PO8");
-			EEG_setChannelName (him.get(), 63, U"PO4");
-			EEG_setChannelName (him.get(), 64, U"O2");
+	}
+	return thee;
+}
+
+static void EEG_setStandardChannelNames (EEG me) {
+	if (EEG_getNumberOfCapElectrodes (me) == 32) {
+		EEG_setChannelName (me, 1, U"Fp1");
+		EEG_setChannelName (me, 2, U"AF3");
+		EEG_setChannelName (me, 3, U"F7");
+		EEG_setChannelName (me, 4, U"F3");
+		EEG_setChannelName (me, 5, U"FC1");
+		EEG_setChannelName (me, 6, U"FC5");
+		EEG_setChannelName (me, 7, U"T7");
+		EEG_setChannelName (me, 8, U"C3");
+		EEG_setChannelName (me, 9, U"CP1");
+		EEG_setChannelName (me, 10, U"CP5");
+		EEG_setChannelName (me, 11, U"P7");
+		EEG_setChannelName (me, 12, U"P3");
+		EEG_setChannelName (me, 13, U"Pz");
+		EEG_setChannelName (me, 14, U"PO3");
+		EEG_setChannelName (me, 15, U"O1");
+		EEG_setChannelName (me, 16, U"Oz");
+		EEG_setChannelName (me, 17, U"O2");
+		EEG_setChannelName (me, 18, U"PO4");
+		EEG_setChannelName (me, 19, U"P4");
+		EEG_setChannelName (me, 20, U"P8");
+		EEG_setChannelName (me, 21, U"CP6");
+		EEG_setChannelName (me, 22, U"CP2");
+		EEG_setChannelName (me, 23, U"C4");
+		EEG_setChannelName (me, 24, U"T8");
+		EEG_setChannelName (me, 25, U"FC6");
+		EEG_setChannelName (me, 26, U"FC2");
+		EEG_setChannelName (me, 27, U"F4");
+		EEG_setChannelName (me, 28, U"F8");
+		EEG_setChannelName (me, 29, U"AF4");
+		EEG_setChannelName (me, 30, U"Fp2");
+		EEG_setChannelName (me, 31, U"Fz");
+		EEG_setChannelName (me, 32, U"Cz");
+	} else if (EEG_getNumberOfCapElectrodes (me) == 64) {
+		EEG_setChannelName (me, 1, U"Fp1");
+		EEG_setChannelName (me, 2, U"AF7");
+		EEG_setChannelName (me, 3, U"AF3");
+		EEG_setChannelName (me, 4, U"F1");
+		EEG_setChannelName (me, 5, U"F3");
+		EEG_setChannelName (me, 6, U"F5");
+		EEG_setChannelName (me, 7, U"F7");
+		EEG_setChannelName (me, 8, U"FT7");
+		EEG_setChannelName (me, 9, U"FC5");
+		EEG_setChannelName (me, 10, U"FC3");
+		EEG_setChannelName (me, 11, U"FC1");
+		EEG_setChannelName (me, 12, U"C1");
+		EEG_setChannelName (me, 13, U"C3");
+		EEG_setChannelName (me, 14, U"C5");
+		EEG_setChannelName (me, 15, U"T7");
+		EEG_setChannelName (me, 16, U"TP7");
+		EEG_setChannelName (me, 17, U"CP5");
+		EEG_setChannelName (me, 18, U"CP3");
+		EEG_setChannelName (me, 19, U"CP1");
+		EEG_setChannelName (me, 20, U"P1");
+		EEG_setChannelName (me, 21, U"P3");
+		EEG_setChannelName (me, 22, U"P5");
+		EEG_setChannelName (me, 23, U"P7");
+		EEG_setChannelName (me, 24, U"P9");
+		EEG_setChannelName (me, 25, U"PO7");
+		EEG_setChannelName (me, 26, U"PO3");
+		EEG_setChannelName (me, 27, U"O1");
+		EEG_setChannelName (me, 28, U"Iz");
+		EEG_setChannelName (me, 29, U"Oz");
+		EEG_setChannelName (me, 30, U"POz");
+		EEG_setChannelName (me, 31, U"Pz");
+		EEG_setChannelName (me, 32, U"CPz");
+		EEG_setChannelName (me, 33, U"Fpz");
+		EEG_setChannelName (me, 34, U"Fp2");
+		EEG_setChannelName (me, 35, U"AF8");
+		EEG_setChannelName (me, 36, U"AF4");
+		EEG_setChannelName (me, 37, U"AFz");
+		EEG_setChannelName (me, 38, U"Fz");
+		EEG_setChannelName (me, 39, U"F2");
+		EEG_setChannelName (me, 40, U"F4");
+		EEG_setChannelName (me, 41, U"F6");
+		EEG_setChannelName (me, 42, U"F8");
+		EEG_setChannelName (me, 43, U"FT8");
+		EEG_setChannelName (me, 44, U"FC6");
+		EEG_setChannelName (me, 45, U"FC4");
+		EEG_setChannelName (me, 46, U"FC2");
+		EEG_setChannelName (me, 47, U"FCz");
+		EEG_setChannelName (me, 48, U"Cz");
+		EEG_setChannelName (me, 49, U"C2");
+		EEG_setChannelName (me, 50, U"C4");
+		EEG_setChannelName (me, 51, U"C6");
+		EEG_setChannelName (me, 52, U"T8");
+		EEG_setChannelName (me, 53, U"TP8");
+		EEG_setChannelName (me, 54, U"CP6");
+		EEG_setChannelName (me, 55, U"CP4");
+		EEG_setChannelName (me, 56, U"CP2");
+		EEG_setChannelName (me, 57, U"P2");
+		EEG_setChannelName (me, 58, U"P4");
+		EEG_setChannelName (me, 59, U"P6");
+		EEG_setChannelName (me, 60, U"P8");
+		EEG_setChannelName (me, 61, U"P10");
+		EEG_setChannelName (me, 62, U"PO8");
+		EEG_setChannelName (me, 63, U"PO4");
+		EEG_setChannelName (me, 64, U"O2");
+	}
+}
+
+autoEEG BdfFile_to_EEG (BdfFile me, bool readSignal) {
+	try {
+		double duration = my numberOfDataRecords * my durationOfDataRecord;
+		long numberOfSamples = my numberOfDataRecords * my numberOfSamplesPerDataRecord;
+		double dx = 1.0 / my samplingFrequency, x1 = 0.5 * dx;
+		autoEEG him = EEG_create (0, duration);
+		his numberOfChannels = my numberOfChannels;
+		autoSound sound;
+		autoNUMvector <double> statusOnly;
+		double *status;
+		if (readSignal) {
+			sound = Sound_create (my numberOfChannels, 0.0, duration, numberOfSamples, dx, x1);
+			BdfFile_readChannels (me, 1, my numberOfDataRecords, 1, my numberOfChannels, sound -> z);
+			status = sound -> z [my numberOfChannels];
+		} else {
+			statusOnly.reset (1, numberOfSamples);
+			double *z [1+1] = { nullptr, statusOnly.peek() };
+			BdfFile_readChannels (me, 1, my numberOfDataRecords, my numberOfChannels, my numberOfChannels, z);
+			status = statusOnly.peek();
 		}
+		autoTextGrid textgrid = BdfFile_statusToTextGrid (me, status, numberOfSamples, 0.0, duration, x1, dx);
+		his channelNames = NUMvector <char32 *> (1, my numberOfChannels);
+		for (long ichan = 1; ichan <= my numberOfChannels; ichan ++)
+			his channelNames [ichan] = Melder_dup (my channelNames [ichan]);
+		his sound = sound.move();
+		his textgrid = textgrid.move();
+		EEG_setStandardChannelNames (him.get());
+		return him;
+	} catch (MelderError) {
+		Melder_throw (U"BDF file ", & my file, U" not converted to EEG.");
+	}
+}
+
+autoEEG EEG_readFromBdfFile (MelderFile file) {
+	try {
+		autoBdfFile bdf = BdfFile_open (file);
+		autoEEG him = BdfFile_to_EEG (bdf.get(), true);
 		return him;
 	} catch (MelderError) {
 		Melder_throw (U"BDF file not read.");
 	}
 }
 
+/*
+	The channels of an EEG are independent of each other,
+	so detrending and filtering can be done in parallel, a range of channels per thread;
+	subtracting a reference is done in parallel over ranges of samples.
+	Everything a thread needs is allocated beforehand, in the main thread.
+*/
+Thing_define (EEG_parallel_Args, Thing) { public:
+	Sound sound;
+	long first, last;   // channels or samples
+	/*
+		Filtering.
+	*/
+	autoNUMfft_Table fourierTable;   // one per thread, because the transforms use its trigcache as scratch
+	autoNUMvector <double> data;   // [1..fourierTable.n]
+	autoSpectrum spectrum;
+	double lowFrequency, lowWidth, highFrequency, highWidth;
+	bool doNotch50Hz;
+	/*
+		Subtracting the mean channel.
+	*/
+	long fromChannel, toChannel, numberOfElectrodeChannels;
+};
+
+Thing_implement (EEG_parallel_Args, Thing, 0);
+
+static int EEG_parallel_split (autoEEG_parallel_Args args [16], Sound sound, long first, long last) {
+	long numberOfJobs = last - first + 1;
+	int numberOfThreads = numberOfJobs < 16 ? (int) numberOfJobs : 16;
+	const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	long numberOfJobsPerThread = (numberOfJobs - 1) / numberOfThreads + 1;
+	numberOfThreads = (int) ((numberOfJobs - 1) / numberOfJobsPerThread + 1);
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoEEG_parallel_Args arg = Thing_new (EEG_parallel_Args);
+		arg -> sound = sound;
+		arg -> first = first + (ithread - 1) * numberOfJobsPerThread;
+		arg -> last = ithread == numberOfThreads ? last : arg -> first + numberOfJobsPerThread - 1;
+		args [ithread - 1] = arg.move();
+	}
+	return numberOfThreads;
+}
+
 static void detrend (double *a, long numberOfSamples) {
 	double firstValue = a [1], lastValue = a [numberOfSamples];
 	a [1] = a [numberOfSamples] = 0.0;
@@ -418,32 +563,94 @@ static void detrend (double *a, long numberOfSamples) {
 	}
 }
 
-void EEG_detrend (EEG me) {
-	for (long ichan = 1; ichan <= my numberOfChannels - EEG_getNumberOfExtraSensors (me); ichan ++) {
+static MelderThread_RETURN_TYPE detrend_thread (EEG_parallel_Args me) {
+	for (long ichan = my first; ichan <= my last; ichan ++) {
 		detrend (my sound -> z [ichan], my sound -> nx);
 	}
+	MelderThread_RETURN;
+}
+
+void EEG_detrend (EEG me) {
+	long numberOfElectrodeChannels = my numberOfChannels - EEG_getNumberOfExtraSensors (me);
+	if (numberOfElectrodeChannels < 1) return;
+	autoEEG_parallel_Args args [16];
+	int numberOfThreads = EEG_parallel_split (args, my sound.get(), 1, numberOfElectrodeChannels);
+	MelderThread_run (detrend_thread, args, numberOfThreads);
 }
 
-void EEG_filter (EEG me, double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz) {
-	try {
 /*
-	long nsampFFT = 1;
-	while (nsampFFT < my sound -> nx)
-		nsampFFT *= 2;
-	autoNUMfft_Table fftTable;
-	NUMfft_Table_init (& fftTable, nsampFFT);
+	The same computation as Sound_to_Spectrum (fast), Spectrum_passHannBand, Spectrum_stopHannBand and Spectrum_to_Sound,
+	with the same results to the last bit, but with one FFT table for all the channels of a thread and without allocating anything.
 */
-		for (long ichan = 1; ichan <= my numberOfChannels - EEG_getNumberOfExtraSensors (me); ichan ++) {
-			autoSound channel = Sound_extractChannel (my sound.get(), ichan);
-			autoSpectrum spec = Sound_to_Spectrum (channel.get(), true);
-			Spectrum_passHannBand (spec.get(), lowFrequency, 0.0, lowWidth);
-			Spectrum_passHannBand (spec.get(), 0.0, highFrequency, highWidth);
-			if (doNotch50Hz) {
-				Spectrum_stopHannBand (spec.get(), 48.0, 52.0, 1.0);
-			}
-			autoSound him = Spectrum_to_Sound (spec.get());
-			NUMvector_copyElements (his z [1], my sound -> z [ichan], 1, my sound -> nx);
+static MelderThread_RETURN_TYPE filter_thread (EEG_parallel_Args me) {
+	long numberOfSamples = my sound -> nx, numberOfFourierSamples = my fourierTable.n;
+	double *data = my data.peek();
+	Spectrum spectrum = my spectrum.get();
+	long numberOfFrequencies = spectrum -> nx;
+	double *re = spectrum -> z [1], *im = spectrum -> z [2];
+	for (long ichan = my first; ichan <= my last; ichan ++) {
+		double *channel = my sound -> z [ichan];
+		for (long i = 1; i <= numberOfSamples; i ++)
+			data [i] = channel [i];
+		for (long i = numberOfSamples + 1; i <= numberOfFourierSamples; i ++)
+			data [i] = 0.0;
+		NUMfft_forward (& my fourierTable, data);
+		double scaling = my sound -> dx;
+		re [1] = data [1] * scaling;
+		im [1] = 0.0;
+		for (long i = 2; i < numberOfFrequencies; i ++) {
+			re [i] = data [i + i - 2] * scaling;
+			im [i] = data [i + i - 1] * scaling;
+		}
+		re [numberOfFrequencies] = data [numberOfFourierSamples] * scaling;   // the number of Fourier samples is even
+		im [numberOfFrequencies] = 0.0;
+		Spectrum_passHannBand (spectrum, my lowFrequency, 0.0, my lowWidth);
+		Spectrum_passHannBand (spectrum, 0.0, my highFrequency, my highWidth);
+		if (my doNotch50Hz) {
+			Spectrum_stopHannBand (spectrum, 48.0, 52.0, 1.0);
 		}
+		scaling = spectrum -> dx;
+		data [1] = re [1] * scaling;
+		for (long i = 2; i < numberOfFrequencies; i ++) {
+			data [i + i - 2] = re [i] * scaling;
+			data [i + i - 1] = im [i] * scaling;
+		}
+		data [numberOfFourierSamples] = re [numberOfFrequencies] * scaling;
+		NUMfft_backward (& my fourierTable, data);
+		for (long i = 1; i <= numberOfSamples; i ++)
+			channel [i] = data [i];
+	}
+	MelderThread_RETURN;
+}
+
+void Sound_filterEEGChannels (Sound me, long fromChannel, long toChannel,
+	double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz)
+{
+	if (toChannel < fromChannel) return;
+	long numberOfFourierSamples = 2;
+	while (numberOfFourierSamples < my nx) numberOfFourierSamples *= 2;
+	long numberOfFrequencies = numberOfFourierSamples / 2 + 1;
+	autoEEG_parallel_Args args [16];
+	int numberOfThreads = EEG_parallel_split (args, me, fromChannel, toChannel);
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		EEG_parallel_Args arg = args [ithread - 1].get();
+		NUMfft_Table_init (& arg -> fourierTable, numberOfFourierSamples);
+		arg -> data.reset (1, numberOfFourierSamples);
+		arg -> spectrum = Spectrum_create (0.5 / my dx, numberOfFrequencies);
+		arg -> spectrum -> dx = 1.0 / (my dx * numberOfFourierSamples);   // as in Sound_to_Spectrum
+		arg -> lowFrequency = lowFrequency;
+		arg -> lowWidth = lowWidth;
+		arg -> highFrequency = highFrequency;
+		arg -> highWidth = highWidth;
+		arg -> doNotch50Hz = doNotch50Hz;
+	}
+	MelderThread_run (filter_thread, args, numberOfThreads);
+}
+
+void EEG_filter (EEG me, double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz) {
+	try {
+		Sound_filterEEGChannels (my sound.get(), 1, my numberOfChannels - EEG_getNumberOfExtraSensors (me),
+			lowFrequency, lowWidth, highFrequency, highWidth, doNotch50Hz);
 	} catch (MelderError) {
 		Melder_throw (me, U": not filtered.");
 	}
@@ -489,6 +696,21 @@ void EEG_subtractReference (EEG me, const char32 *channelNumber1_text, const cha
 	}
 }
 
+static MelderThread_RETURN_TYPE subtractMeanChannel_thread (EEG_parallel_Args me) {
+	double **z = my sound -> z;
+	for (long isamp = my first; isamp <= my last; isamp ++) {
+		double referenceValue = 0.0;
+		for (long ichan = my fromChannel; ichan <= my toChannel; ichan ++) {
+			referenceValue += z [ichan] [isamp];
+		}
+		referenceValue /= (my toChannel - my fromChannel + 1);
+		for (long ichan = 1; ichan <= my numberOfElectrodeChannels; ichan ++) {
+			z [ichan] [isamp] -= referenceValue;
+		}
+	}
+	MelderThread_RETURN;
+}
+
 void EEG_subtractMeanChannel (EEG me, long fromChannel, long toChannel) {
 	if (fromChannel < 1 || fromChannel > my numberOfChannels)
 		Melder_throw (U"No channel ", fromChannel, U".");
@@ -496,17 +718,14 @@ void EEG_subtractMeanChannel (EEG me, long fromChannel, long toChannel) {
 		Melder_throw (U"No channel ", toChannel, U".");
 	if (fromChannel > toChannel)
 		Melder_throw (U"Channel range cannot run from ", fromChannel, U" to ", toChannel, U". Please reverse.");
-	const long numberOfElectrodeChannels = my numberOfChannels - EEG_getNumberOfExtraSensors (me);
-	for (long isamp = 1; isamp <= my sound -> nx; isamp ++) {
-		double referenceValue = 0.0;
-		for (long ichan = fromChannel; ichan <= toChannel; ichan ++) {
-			referenceValue += my sound -> z [ichan] [isamp];
-		}
-		referenceValue /= (toChannel - fromChannel + 1);
-		for (long ichan = 1; ichan <= numberOfElectrodeChannels; ichan ++) {
-			my sound -> z [ichan] [isamp] -= referenceValue;
-		}
+	autoEEG_parallel_Args args [16];
+	int numberOfThreads = EEG_parallel_split (args, my sound.get(), 1, my sound -> nx);
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		args [ithread - 1] -> fromChannel = fromChannel;
+		args [ithread - 1] -> toChannel = toChannel;
+		args [ithread - 1] -> numberOfElectrodeChannels = my numberOfChannels - EEG_getNumberOfExtraSensors (me);
 	}
+	MelderThread_run (subtractMeanChannel_thread, args, numberOfThreads);
 }
 
 void EEG_setChannelToZero (EEG me, long channelNumber) {
@@ -26,6 +26,41 @@
 
 autoEEG EEG_create (double tmin, double tmax);
 
+/*
+	A BDF (24-bit) or EDF (16-bit) file, opened for reading piecemeal, in the way of a LongSound,
+	so that analyses can stream through the channels or data records of a recording that does not fit in memory.
+*/
+Thing_define (BdfFile, Thing) {
+	structMelderFile file;
+	FILE *f;
+	bool is24bit, hasLetters;
+	long numberOfBytesInHeaderRecord, numberOfDataRecords, numberOfChannels, numberOfSamplesPerDataRecord;
+	double durationOfDataRecord, samplingFrequency;
+	char32 **channelNames;   // [1..numberOfChannels]
+	double *factor;   // [1..numberOfChannels]: from digital values to volts
+	long numberOfBytesPerChannel, numberOfBytesPerDataRecord, bufferSize;
+	unsigned char *buffer;   // [0..bufferSize-1]
+
+	void v_destroy () noexcept
+		override;
+};
+
+autoBdfFile BdfFile_open (MelderFile file);
+
+void BdfFile_readChannels (BdfFile me, long fromRecord, long toRecord, long fromChannel, long toChannel, double **z);
+/*
+	Puts the physical values of channels fromChannel..toChannel of data records fromRecord..toRecord
+	into z [1..toChannel-fromChannel+1] [1..(toRecord-fromRecord+1)*numberOfSamplesPerDataRecord].
+*/
+
+autoEEG BdfFile_to_EEG (BdfFile me, bool readSignal);
+/*
+	If readSignal is false, only the status channel is read, to find the triggers;
+	the resulting EEG then has channel names and a TextGrid but no Sound,
+	so it is meant for analyses that stream the signal from the file themselves
+	and should never be shown to the user.
+*/
+
 autoEEG EEG_readFromBdfFile (MelderFile file);
 
 autoEEG EEGs_concatenate (OrderedOf<structEEG>* me);
@@ -36,8 +71,11 @@ void EEG_setChannelName (EEG me, long channelNumber, const char32 *a_name);
 static inline long EEG_getNumberOfCapElectrodes (EEG me) {
 	return (my numberOfChannels - 1) & ~ 15L;   // BUG
 }
+static inline long EEG_getNumberOfExtraSensors (long numberOfChannels) {
+	return numberOfChannels == 1 ? 0 : numberOfChannels & 1 ? 1 : 8;   // BUG
+}
 static inline long EEG_getNumberOfExtraSensors (EEG me) {
-	return my numberOfChannels == 1 ? 0 : my numberOfChannels & 1 ? 1 : 8;   // BUG
+	return EEG_getNumberOfExtraSensors (my numberOfChannels);
 }
 static inline long EEG_getNumberOfExternalElectrodes (EEG me) {
 	return my numberOfChannels - EEG_getNumberOfCapElectrodes (me) - EEG_getNumberOfExtraSensors (me);
@@ -46,6 +84,8 @@ void EEG_setExternalElectrodeNames (EEG me, const char32 *nameExg1, const char32
 	const char32 *nameExg5, const char32 *nameExg6, const char32 *nameExg7, const char32 *nameExg8);
 void EEG_detrend (EEG me);
 void EEG_filter (EEG me, double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz);
+void Sound_filterEEGChannels (Sound me, long fromChannel, long toChannel,
+	double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz);
 void EEG_subtractReference (EEG me, const char32 *channelNumber1, const char32 *channelNumber2);
 void EEG_subtractMeanChannel (EEG me, long fromChannel, long toChannel);
 void EEG_setChannelToZero (EEG me, long channelNumber);
@@ -17,6 +17,7 @@
  */
 
 #include "ERPTier.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "ERPTier_def.h"
@@ -65,42 +66,61 @@ double ERPTier_getMean (ERPTier me, long pointNumber, const char32 *channelName,
 	return ERPTier_getMean (me, pointNumber, ERPTier_getChannelNumber (me, channelName), tmin, tmax);
 }
 
-static autoERPTier EEG_PointProcess_to_ERPTier (EEG me, PointProcess events, double fromTime, double toTime) {
-	try {
-		autoERPTier thee = Thing_new (ERPTier);
-		Function_init (thee.get(), fromTime, toTime);
-		thy numberOfChannels = my numberOfChannels - EEG_getNumberOfExtraSensors (me);
-		Melder_assert (thy numberOfChannels > 0);
-		thy channelNames = NUMvector <char32 *> (1, thy numberOfChannels);
-		for (long ichan = 1; ichan <= thy numberOfChannels; ichan ++) {
-			thy channelNames [ichan] = Melder_dup (my channelNames [ichan]);
-		}
-		long numberOfEvents = events -> nt;
-		double soundDuration = toTime - fromTime;
-		double samplingPeriod = my sound -> dx;
-		long numberOfSamples = (long) floor (soundDuration / samplingPeriod) + 1;
-		if (numberOfSamples < 1)
-			Melder_throw (U"Time window too short.");
-		double midTime = 0.5 * (fromTime + toTime);
-		double soundPhysicalDuration = numberOfSamples * samplingPeriod;
-		double firstTime = midTime - 0.5 * soundPhysicalDuration + 0.5 * samplingPeriod;   // distribute the samples evenly over the time domain
-		for (long ievent = 1; ievent <= numberOfEvents; ievent ++) {
-			double eegEventTime = events -> t [ievent];
-			autoERPPoint event = Thing_new (ERPPoint);
-			event -> number = eegEventTime;
-			event -> erp = Sound_create (thy numberOfChannels, fromTime, toTime, numberOfSamples, samplingPeriod, firstTime);
-			double erpEventTime = 0.0;
-			double eegSample = 1 + (eegEventTime - my sound -> x1) / samplingPeriod;
-			double erpSample = 1 + (erpEventTime - firstTime) / samplingPeriod;
-			long sampleDifference = lround (eegSample - erpSample);
-			for (long ichannel = 1; ichannel <= thy numberOfChannels; ichannel ++) {
-				for (long isample = 1; isample <= numberOfSamples; isample ++) {
-					long jsample = isample + sampleDifference;
-					event -> erp -> z [ichannel] [isample] = jsample < 1 || jsample > my sound -> nx ? 0.0 : my sound -> z [ichannel] [jsample];
-				}
+static autoERPTier EEG_PointProcess_to_ERPTier_empty (EEG me, PointProcess events, double fromTime, double toTime, double samplingPeriod) {
+	autoERPTier thee = Thing_new (ERPTier);
+	Function_init (thee.get(), fromTime, toTime);
+	thy numberOfChannels = my numberOfChannels - EEG_getNumberOfExtraSensors (me);
+	Melder_assert (thy numberOfChannels > 0);
+	thy channelNames = NUMvector <char32 *> (1, thy numberOfChannels);
+	for (long ichan = 1; ichan <= thy numberOfChannels; ichan ++) {
+		thy channelNames [ichan] = Melder_dup (my channelNames [ichan]);
+	}
+	long numberOfEvents = events -> nt;
+	double soundDuration = toTime - fromTime;
+	long numberOfSamples = (long) floor (soundDuration / samplingPeriod) + 1;
+	if (numberOfSamples < 1)
+		Melder_throw (U"Time window too short.");
+	double midTime = 0.5 * (fromTime + toTime);
+	double soundPhysicalDuration = numberOfSamples * samplingPeriod;
+	double firstTime = midTime - 0.5 * soundPhysicalDuration + 0.5 * samplingPeriod;   // distribute the samples evenly over the time domain
+	for (long ievent = 1; ievent <= numberOfEvents; ievent ++) {
+		double eegEventTime = events -> t [ievent];
+		autoERPPoint event = Thing_new (ERPPoint);
+		event -> number = eegEventTime;
+		event -> erp = Sound_create (thy numberOfChannels, fromTime, toTime, numberOfSamples, samplingPeriod, firstTime);
+		thy points. addItem_move (event.move());
+	}
+	return thee;
+}
+
+/*
+	Copy the signal z [1..toChannel-fromChannel+1] [1..numberOfSamples],
+	which is sampled like the EEG, into channels fromChannel..toChannel of all events.
+*/
+static void ERPTier_copyChannelsFromSignal (ERPTier me, double **z, long fromChannel, long toChannel,
+	long numberOfSamples, double x1, double samplingPeriod)
+{
+	for (long ievent = 1; ievent <= my points.size; ievent ++) {
+		ERPPoint event = my points.at [ievent];
+		double eegEventTime = event -> number;
+		double erpEventTime = 0.0;
+		double eegSample = 1 + (eegEventTime - x1) / samplingPeriod;
+		double erpSample = 1 + (erpEventTime - event -> erp -> x1) / samplingPeriod;
+		long sampleDifference = lround (eegSample - erpSample);
+		for (long ichannel = fromChannel; ichannel <= toChannel; ichannel ++) {
+			double *from = z [ichannel - fromChannel + 1], *to = event -> erp -> z [ichannel];
+			for (long isample = 1; isample <= event -> erp -> nx; isample ++) {
+				long jsample = isample + sampleDifference;
+				to [isample] = jsample < 1 || jsample > numberOfSamples ? 0.0 : from [jsample];
 			}
-			thy points. addItem_move (event.move());
 		}
+	}
+}
+
+static autoERPTier EEG_PointProcess_to_ERPTier (EEG me, PointProcess events, double fromTime, double toTime) {
+	try {
+		autoERPTier thee = EEG_PointProcess_to_ERPTier_empty (me, events, fromTime, toTime, my sound -> dx);
+		ERPTier_copyChannelsFromSignal (thee.get(), my sound -> z, 1, thy numberOfChannels, my sound -> nx, my sound -> x1, my sound -> dx);
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": ERP analysis not performed.");
@@ -185,6 +205,46 @@ autoERPTier EEG_to_ERPTier_triggers_preceded (EEG me, double fromTime, double to
 	}
 }
 
+/*
+	The maximum number of samples of a BDF file that we hold in memory at a time
+	when we stream through its channels.
+*/
+#define BDF_MAXIMUM_NUMBER_OF_SAMPLES_IN_MEMORY  16000000
+
+autoERPTier BdfFile_to_ERPTier_triggers (BdfFile me, double fromTime, double toTime,
+	int which_Melder_STRING, const char32 *criterion,
+	bool filter, double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz)
+{
+	try {
+		autoEEG triggers = BdfFile_to_EEG (me, false);   // reads only the status channel
+		autoPointProcess events = TextGrid_getPoints (triggers -> textgrid.get(), 2, which_Melder_STRING, criterion);
+		double samplingPeriod = 1.0 / my samplingFrequency, x1 = 0.5 * samplingPeriod;
+		autoERPTier thee = EEG_PointProcess_to_ERPTier_empty (triggers.get(), events.get(), fromTime, toTime, samplingPeriod);
+		/*
+			Stream through the file a group of channels at a time,
+			filtering each channel over the whole recording, as EEG_filter would.
+		*/
+		long numberOfSamples = my numberOfDataRecords * my numberOfSamplesPerDataRecord;
+		long numberOfChannelsPerGroup = BDF_MAXIMUM_NUMBER_OF_SAMPLES_IN_MEMORY / numberOfSamples;
+		if (numberOfChannelsPerGroup < 1) numberOfChannelsPerGroup = 1;
+		if (numberOfChannelsPerGroup > thy numberOfChannels) numberOfChannelsPerGroup = thy numberOfChannels;
+		autoSound group = Sound_create (numberOfChannelsPerGroup, triggers -> xmin, triggers -> xmax,
+			numberOfSamples, samplingPeriod, x1);
+		for (long fromChannel = 1; fromChannel <= thy numberOfChannels; fromChannel += numberOfChannelsPerGroup) {
+			long toChannel = fromChannel + numberOfChannelsPerGroup - 1;
+			if (toChannel > thy numberOfChannels) toChannel = thy numberOfChannels;
+			BdfFile_readChannels (me, 1, my numberOfDataRecords, fromChannel, toChannel, group -> z);
+			if (filter)
+				Sound_filterEEGChannels (group.get(), 1, toChannel - fromChannel + 1,
+					lowFrequency, lowWidth, highFrequency, highWidth, doNotch50Hz);
+			ERPTier_copyChannelsFromSignal (thee.get(), group -> z, fromChannel, toChannel, numberOfSamples, x1, samplingPeriod);
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (U"BDF file ", & my file, U": ERPTier not created.");
+	}
+}
+
 void ERPTier_subtractBaseline (ERPTier me, double tmin, double tmax) {
 	long numberOfEvents = my points.size;
 	if (numberOfEvents < 1)
@@ -204,28 +264,156 @@ void ERPTier_subtractBaseline (ERPTier me, double tmin, double tmax) {
 	}
 }
 
-void ERPTier_rejectArtefacts (ERPTier me, double threshold) {
+/*
+	Artefact rejection and averaging go through the events in parallel, in a single pass over the data.
+	The events are divided into a fixed number of contiguous chunks, independently of the number of threads;
+	each chunk is summed separately, and the sums of the chunks are added in order,
+	so that the mean does not depend on the number of processors.
+*/
+#define ERPTier_MAXIMUM_NUMBER_OF_CHUNKS  16
+
+Thing_define (ERPTier_average_Args, Thing) { public:
+	ERPTier tier;
+	long firstChunk, lastChunk;
+	long *firstEventOfChunk;   // [1..numberOfChunks+1]
+	bool rejectArtefacts;
+	double threshold;
+	bool *rejected;   // [1..numberOfEvents]
+	Sound *sums;   // [1..numberOfChunks], or null if only rejecting
+	long *numberOfSummedEvents;   // [1..numberOfChunks]
+};
+
+Thing_implement (ERPTier_average_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE ERPTier_average_thread (ERPTier_average_Args me) {
+	for (long ichunk = my firstChunk; ichunk <= my lastChunk; ichunk ++) {
+		for (long ievent = my firstEventOfChunk [ichunk]; ievent < my firstEventOfChunk [ichunk + 1]; ievent ++) {
+			ERPPoint event = my tier -> points.at [ievent];
+			long numberOfChannels = event -> erp -> ny, numberOfSamples = event -> erp -> nx;
+			if (my rejectArtefacts) {
+				double minimum = event -> erp -> z [1] [1];
+				double maximum = minimum;
+				for (long ichannel = 1; ichannel <= (numberOfChannels & ~ 15); ichannel ++) {
+					double *channel = event -> erp -> z [ichannel];
+					for (long isample = 1; isample <= numberOfSamples; isample ++) {
+						double value = channel [isample];
+						if (value < minimum) minimum = value;
+						if (value > maximum) maximum = value;
+					}
+				}
+				my rejected [ievent] = minimum < - my threshold || maximum > my threshold;
+				if (my rejected [ievent]) continue;
+			}
+			if (my sums) {
+				Sound sum = my sums [ichunk];
+				for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
+					double *erpChannel = event -> erp -> z [ichannel];
+					double *sumChannel = sum -> z [ichannel];
+					for (long isample = 1; isample <= numberOfSamples; isample ++) {
+						sumChannel [isample] += erpChannel [isample];
+					}
+				}
+				my numberOfSummedEvents [ichunk] ++;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
+/*
+	Sets rejected [1..numberOfEvents] if rejectArtefacts is on,
+	and returns the mean of the events that were not rejected if wantMean is on.
+*/
+static autoERP ERPTier_average (ERPTier me, bool rejectArtefacts, double threshold, bool *rejected, bool wantMean) {
 	long numberOfEvents = my points.size;
-	if (numberOfEvents < 1)
-		return;   // nothing to do
 	ERPPoint firstEvent = my points.at [1];
 	long numberOfChannels = firstEvent -> erp -> ny;
 	long numberOfSamples = firstEvent -> erp -> nx;
-	if (numberOfSamples < 1)
-		return;   // nothing to do
-	for (long ievent = numberOfEvents; ievent >= 1; ievent --) {   // cycle down because of removal
+	for (long ievent = 2; ievent <= numberOfEvents; ievent ++) {
 		ERPPoint event = my points.at [ievent];
-		double minimum = event -> erp -> z [1] [1];
-		double maximum = minimum;
-		for (long ichannel = 1; ichannel <= (numberOfChannels & ~ 15); ichannel ++) {
-			double *channel = event -> erp -> z [ichannel];
+		if (event -> erp -> ny != numberOfChannels || event -> erp -> nx != numberOfSamples)
+			Melder_throw (U"Event ", ievent, U" has a different number of channels or samples than event 1.");
+	}
+	long numberOfChunks = numberOfEvents < ERPTier_MAXIMUM_NUMBER_OF_CHUNKS ? numberOfEvents : ERPTier_MAXIMUM_NUMBER_OF_CHUNKS;
+	long firstEventOfChunk [1 + ERPTier_MAXIMUM_NUMBER_OF_CHUNKS + 1];
+	for (long ichunk = 1; ichunk <= numberOfChunks + 1; ichunk ++)
+		firstEventOfChunk [ichunk] = 1 + (ichunk - 1) * numberOfEvents / numberOfChunks;
+	autoSound ownSums [1 + ERPTier_MAXIMUM_NUMBER_OF_CHUNKS];
+	Sound sums [1 + ERPTier_MAXIMUM_NUMBER_OF_CHUNKS] = { nullptr };
+	long numberOfSummedEvents [1 + ERPTier_MAXIMUM_NUMBER_OF_CHUNKS] = { 0 };
+	if (wantMean) {
+		for (long ichunk = 1; ichunk <= numberOfChunks; ichunk ++) {
+			ownSums [ichunk] = Sound_create (numberOfChannels, firstEvent -> erp -> xmin, firstEvent -> erp -> xmax,
+				numberOfSamples, firstEvent -> erp -> dx, firstEvent -> erp -> x1);
+			sums [ichunk] = ownSums [ichunk].get();
+		}
+	}
+
+	int numberOfThreads = (int) numberOfChunks;
+	const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	long numberOfChunksPerThread = (numberOfChunks - 1) / numberOfThreads + 1;
+	numberOfThreads = (int) ((numberOfChunks - 1) / numberOfChunksPerThread + 1);
+	autoERPTier_average_Args args [16];
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoERPTier_average_Args arg = Thing_new (ERPTier_average_Args);
+		arg -> tier = me;
+		arg -> firstChunk = 1 + (ithread - 1) * numberOfChunksPerThread;
+		arg -> lastChunk = ithread == numberOfThreads ? numberOfChunks : arg -> firstChunk + numberOfChunksPerThread - 1;
+		arg -> firstEventOfChunk = firstEventOfChunk;
+		arg -> rejectArtefacts = rejectArtefacts;
+		arg -> threshold = threshold;
+		arg -> rejected = rejected;
+		arg -> sums = wantMean ? sums : nullptr;
+		arg -> numberOfSummedEvents = numberOfSummedEvents;
+		args [ithread - 1] = arg.move();
+	}
+	MelderThread_run (ERPTier_average_thread, args, numberOfThreads);
+	if (! wantMean)
+		return autoERP ();
+
+	long totalNumberOfSummedEvents = 0;
+	for (long ichunk = 1; ichunk <= numberOfChunks; ichunk ++)
+		totalNumberOfSummedEvents += numberOfSummedEvents [ichunk];
+	if (totalNumberOfSummedEvents == 0)
+		Melder_throw (U"All events were rejected.");
+	autoERP mean = Thing_new (ERP);
+	sums [1] -> structSound :: v_copy (mean.get());
+	for (long ichunk = 2; ichunk <= numberOfChunks; ichunk ++) {
+		for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
+			double *sumChannel = sums [ichunk] -> z [ichannel];
+			double *meanChannel = mean -> z [ichannel];
 			for (long isample = 1; isample <= numberOfSamples; isample ++) {
-				double value = channel [isample];
-				if (value < minimum) minimum = value;
-				if (value > maximum) maximum = value;
+				meanChannel [isample] += sumChannel [isample];
 			}
 		}
-		if (minimum < - threshold || maximum > threshold) {
+	}
+	double factor = 1.0 / totalNumberOfSummedEvents;
+	for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
+		double *meanChannel = mean -> z [ichannel];
+		for (long isample = 1; isample <= numberOfSamples; isample ++) {
+			meanChannel [isample] *= factor;
+		}
+	}
+	mean -> channelNames = NUMvector <char32 *> (1, mean -> ny);
+	for (long ichan = 1; ichan <= mean -> ny; ichan ++) {
+		mean -> channelNames [ichan] = Melder_dup (my channelNames [ichan]);
+	}
+	return mean;
+}
+
+void ERPTier_rejectArtefacts (ERPTier me, double threshold) {
+	long numberOfEvents = my points.size;
+	if (numberOfEvents < 1)
+		return;   // nothing to do
+	ERPPoint firstEvent = my points.at [1];
+	if (firstEvent -> erp -> nx < 1)
+		return;   // nothing to do
+	autoNUMvector <bool> rejected (1, numberOfEvents);
+	ERPTier_average (me, true, threshold, rejected.peek(), false);
+	for (long ievent = numberOfEvents; ievent >= 1; ievent --) {   // cycle down because of removal
+		if (rejected [ievent]) {
 			my points. removeItem (ievent);
 		}
 	}
@@ -260,37 +448,22 @@ autoERP ERPTier_extractERP (ERPTier me, long eventNumber) {
 }
 
 autoERP ERPTier_to_ERP_mean (ERPTier me) {
+	try {
+		if (my points.size < 1)
+			Melder_throw (U"No events.");
+		return ERPTier_average (me, false, 0.0, nullptr, true);
+	} catch (MelderError) {
+		Melder_throw (me, U": mean not computed.");
+	}
+}
+
+autoERP ERPTier_to_ERP_mean_rejectArtefacts (ERPTier me, double threshold) {
 	try {
 		long numberOfEvents = my points.size;
 		if (numberOfEvents < 1)
 			Melder_throw (U"No events.");
-		ERPPoint firstEvent = my points.at [1];
-		long numberOfChannels = firstEvent -> erp -> ny;
-		long numberOfSamples = firstEvent -> erp -> nx;
-		autoERP mean = Thing_new (ERP);
-		firstEvent -> erp -> structSound :: v_copy (mean.get());
-		for (long ievent = 2; ievent <= numberOfEvents; ievent ++) {
-			ERPPoint event = my points.at [ievent];
-			for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
-				double *erpChannel = event -> erp -> z [ichannel];
-				double *meanChannel = mean -> z [ichannel];
-				for (long isample = 1; isample <= numberOfSamples; isample ++) {
-					meanChannel [isample] += erpChannel [isample];
-				}
-			}
-		}
-		double factor = 1.0 / numberOfEvents;
-		for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
-			double *meanChannel = mean -> z [ichannel];
-			for (long isample = 1; isample <= numberOfSamples; isample ++) {
-				meanChannel [isample] *= factor;
-			}
-		}
-		mean -> channelNames = NUMvector <char32 *> (1, mean -> ny);
-		for (long ichan = 1; ichan <= mean -> ny; ichan ++) {
-			mean -> channelNames [ichan] = Melder_dup (my channelNames [ichan]);
-		}
-		return mean;
+		autoNUMvector <bool> rejected (1, numberOfEvents);
+		return ERPTier_average (me, true, threshold, rejected.peek(), true);
 	} catch (MelderError) {
 		Melder_throw (me, U": mean not computed.");
 	}
@@ -36,6 +36,11 @@ void ERPTier_subtractBaseline (ERPTier me, double tmin, double tmax);
 void ERPTier_rejectArtefacts (ERPTier me, double threshold);
 autoERP ERPTier_extractERP (ERPTier me, long pointNumber);
 autoERP ERPTier_to_ERP_mean (ERPTier me);
+autoERP ERPTier_to_ERP_mean_rejectArtefacts (ERPTier me, double threshold);
+/*
+	The mean of the events that "Reject artefacts" would keep, computed in the same pass over the data;
+	the ERPTier itself is not changed.
+*/
 autoERPTier ERPTier_extractEventsWhereColumn_number (ERPTier me, Table table, long columnNumber, int which_Melder_NUMBER, double criterion);
 autoERPTier ERPTier_extractEventsWhereColumn_string (ERPTier me, Table table, long columnNumber, int which_Melder_STRING, const char32 *criterion);
 
@@ -47,5 +52,14 @@ autoERPTier EEG_to_ERPTier_triggers_preceded (EEG me, double fromTime, double to
 	int which_Melder_STRING, const char32 *criterion,
 	int which_Melder_STRING_precededBy, const char32 *criterion_precededBy);
 
+/*
+	Streams the signal of a BDF/EDF file a group of channels at a time,
+	so that the whole recording never has to be in memory;
+	with filtering, the result equals that of EEG_filter followed by EEG_to_ERPTier_triggers.
+*/
+autoERPTier BdfFile_to_ERPTier_triggers (BdfFile me, double fromTime, double toTime,
+	int which_Melder_STRING, const char32 *criterion,
+	bool filter, double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz);
+
 /* End of file ERPTier.h */
 #endif
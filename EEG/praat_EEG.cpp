@@ -267,6 +267,34 @@ DO
 	}
 END2 }
 
+FORM (ERPTier_readFromBdfFile_triggers, U"Read ERPTier from BDF file (triggers)", nullptr) {
+	SENTENCE (U"File name", U"recording.bdf")
+	REAL (U"From time (s)", U"-0.11")
+	REAL (U"To time (s)", U"0.39")
+	OPTIONMENU_ENUM (U"Get every event with a trigger that", kMelder_string, DEFAULT)
+	SENTENCE (U"...the text", U"1")
+	BOOLEAN (U"Filter", true)
+	REAL (U"Low frequency (Hz)", U"1.0")
+	REAL (U"Low width (Hz)", U"0.5")
+	REAL (U"High frequency (Hz)", U"25.0")
+	REAL (U"High width (Hz)", U"12.5")
+	BOOLEAN (U"Notch at 50 Hz", true)
+	OK2
+DO
+	structMelderFile file = { 0 };
+	Melder_relativePathToFile (GET_STRING (U"File name"), & file);
+	autoBdfFile bdf = BdfFile_open (& file);
+	autoERPTier thee = BdfFile_to_ERPTier_triggers (bdf.get(), GET_REAL (U"From time"), GET_REAL (U"To time"),
+		GET_ENUM (kMelder_string, U"Get every event with a trigger that"), GET_STRING (U"...the text"),
+		GET_INTEGER (U"Filter"), GET_REAL (U"Low frequency"), GET_REAL (U"Low width"),
+		GET_REAL (U"High frequency"), GET_REAL (U"High width"), GET_INTEGER (U"Notch at 50 Hz"));
+	autoMelderString name;
+	MelderString_copy (& name, MelderFile_name (& file));
+	char32 *dot = str32rchr (name.string, U'.');
+	if (dot) *dot = U'\0';
+	praat_new (thee.move(), name.string, U"_trigger", GET_STRING (U"...the text"));
+END2 }
+
 FORM (EEG_to_ERPTier_triggers_preceded, U"To ERPTier (triggers, preceded)", nullptr) {
 	REAL (U"From time (s)", U"-0.11")
 	REAL (U"To time (s)", U"0.39")
@@ -746,6 +774,17 @@ DIRECT2 (ERPTier_to_ERP_mean) {
 	}
 END2 }
 
+FORM (ERPTier_to_ERP_mean_rejectArtefacts, U"To ERP (mean, rejecting artefacts)", nullptr) {
+	POSITIVE (U"Threshold (V)", U"75e-6")
+	OK2
+DO
+	LOOP {
+		iam (ERPTier);
+		autoERP thee = ERPTier_to_ERP_mean_rejectArtefacts (me, GET_REAL (U"Threshold"));
+		praat_new (thee.move(), my name, U"_mean");
+	}
+END2 }
+
 /***** ERPTier & Table *****/
 
 FORM (ERPTier_Table_extractEventsWhereColumn_number, U"Extract events where column (number)", nullptr) {
@@ -807,6 +846,8 @@ void praat_EEG_init () {
 
 	Data_recognizeFileType (bdfFileRecognizer);
 
+	praat_addMenuCommand (U"Objects", U"Open", U"Read ERPTier from BDF file (triggers)...", nullptr, 0, DO_ERPTier_readFromBdfFile_triggers);
+
 	praat_addAction1 (classEEG, 0, U"EEG help", nullptr, 0, DO_EEG_help);
 	praat_addAction1 (classEEG, 1, U"View & Edit", nullptr, praat_ATTRACTIVE, DO_EEG_viewAndEdit);
 	praat_addAction1 (classEEG, 0, U"Query -", nullptr, 0, nullptr);
@@ -883,6 +924,7 @@ void praat_EEG_init () {
 	praat_addAction1 (classERPTier, 0, U"Analyse", nullptr, 0, nullptr);
 		praat_addAction1 (classERPTier, 0, U"Extract ERP...", nullptr, 0, DO_ERPTier_to_ERP);
 		praat_addAction1 (classERPTier, 0, U"To ERP (mean)", nullptr, 0, DO_ERPTier_to_ERP_mean);
+		praat_addAction1 (classERPTier, 0, U"To ERP (mean, rejecting artefacts)...", nullptr, 0, DO_ERPTier_to_ERP_mean_rejectArtefacts);
 
 	praat_addAction2 (classEEG, 1, classTextGrid, 1, U"Replace TextGrid", nullptr, 0, DO_EEG_TextGrid_replaceTextGrid);
 	praat_addAction2 (classERPTier, 1, classTable, 1, U"Extract -", nullptr, 0, nullptr);
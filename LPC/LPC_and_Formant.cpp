@@ -25,6 +25,7 @@
 #include "LPC_and_Formant.h"
 #include "LPC_and_Polynomial.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 void Formant_Frame_init (Formant_Frame me, long nFormants) {
 	my nFormants = nFormants;
@@ -40,14 +41,12 @@ void Formant_Frame_scale (Formant_Frame me, double scale) {
 	}
 }
 
-void Roots_into_Formant_Frame (Roots me, Formant_Frame thee, double samplingFrequency, double margin) {
-	long n = my max - my min + 1;
-	autoNUMvector<double> fc (1, n);
-	autoNUMvector<double> bc (1, n);
-
-	// Determine the formants and bandwidths
-
-	thy nFormants = 0;
+/*
+	Frequencies and bandwidths of the roots above the real axis that lie between margin and
+	Nyquist - margin, in frequencies [1..] and bandwidths [1..]; returns their number (at most the number of roots).
+*/
+static long Roots_into_formants (Roots me, double frequencies [], double bandwidths [], double samplingFrequency, double margin) {
+	long numberOfFormants = 0;
 	double fLow = margin, fHigh = samplingFrequency / 2 - margin;
 	for (long i = my min; i <= my max; i++) {
 		if (my v[i].im < 0) {
@@ -57,20 +56,33 @@ void Roots_into_Formant_Frame (Roots me, Formant_Frame thee, double samplingFreq
 		if (f >= fLow && f <= fHigh) {
 			/*b = - log (my v[i].re * my v[i].re + my v[i].im * my v[i].im) * samplingFrequency / 2 / NUMpi;*/
 			double b = - log (dcomplex_abs (my v[i])) * samplingFrequency / NUMpi;
-			thy nFormants++;
-			fc[thy nFormants] = f;
-			bc[thy nFormants] = b;
+			numberOfFormants++;
+			frequencies[numberOfFormants] = f;
+			bandwidths[numberOfFormants] = b;
 		}
 	}
+	return numberOfFormants;
+}
 
-	Formant_Frame_init (thee, thy nFormants);
-
-	for (long i = 1; i <= thy nFormants; i++) {
-		thy formant[i].frequency = fc[i];
-		thy formant[i].bandwidth = bc[i];
+static void Formant_Frame_setFormants (Formant_Frame me, long numberOfFormants, double frequencies [], double bandwidths []) {
+	Formant_Frame_init (me, numberOfFormants);
+	for (long i = 1; i <= numberOfFormants; i++) {
+		my formant[i].frequency = frequencies[i];
+		my formant[i].bandwidth = bandwidths[i];
 	}
 }
 
+void Roots_into_Formant_Frame (Roots me, Formant_Frame thee, double samplingFrequency, double margin) {
+	long n = my max - my min + 1;
+	autoNUMvector<double> fc (1, n);
+	autoNUMvector<double> bc (1, n);
+
+	// Determine the formants and bandwidths
+
+	long numberOfFormants = Roots_into_formants (me, fc.peek(), bc.peek(), samplingFrequency, margin);
+	Formant_Frame_setFormants (thee, numberOfFormants, fc.peek(), bc.peek());
+}
+
 void LPC_Frame_into_Formant_Frame (LPC_Frame me, Formant_Frame thee, double samplingPeriod, double margin) {
 	thy intensity = my gain;
 	if (my nCoefficients == 0) {
@@ -83,11 +95,54 @@ void LPC_Frame_into_Formant_Frame (LPC_Frame me, Formant_Frame thee, double samp
 	Roots_into_Formant_Frame (r.get(), thee, 1 / samplingPeriod, margin);
 }
 
+/*
+	The frames are converted block by block: the threads find the roots and put the formants of their frames
+	in the block's scratch arrays, after which the main thread (which does all the allocation) fills in the Formant frames.
+	Each thread keeps its own root finder, which starts from the roots of the thread's previous frame.
+*/
+#define LPC_to_Formant_BLOCK_SIZE  4096
+
+Thing_define (LPC_to_Formant_Args, Thing) { public:
+	LPC lpc;
+	long firstFrame, lastFrame, blockOffset;   // frame ifr goes to scratch row ifr - blockOffset
+	double margin;
+	autoPolynomialRootFinder finder;
+	double **frequencies, **bandwidths;   // shared scratch [1..LPC_to_Formant_BLOCK_SIZE][1..maxnCoefficients]
+	long *numberOfFormants;
+	bool *suspect;
+};
+
+Thing_implement (LPC_to_Formant_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE LPC_to_Formant_thread (LPC_to_Formant_Args me) {
+	LPC lpc = my lpc;
+	Polynomial p = my finder -> polynomial.get();
+	Roots roots = my finder -> roots.get();
+	for (long iframe = my firstFrame; iframe <= my lastFrame; iframe ++) {
+		LPC_Frame frame = & lpc -> d_frames [iframe];
+		long irow = iframe - my blockOffset, degree = frame -> nCoefficients;
+		my numberOfFormants [irow] = 0;
+		my suspect [irow] = false;
+		if (degree == 0) {
+			my finder -> numberOfPreviousRoots = 0;
+			continue;
+		}
+		p -> numberOfCoefficients = degree + 1;
+		for (long i = 1; i <= degree; i ++) {
+			p -> coefficients [i] = frame -> a [degree - i + 1];
+		}
+		p -> coefficients [degree + 1] = 1.0;
+		my suspect [irow] = ! PolynomialRootFinder_findRoots (my finder.get(), true);
+		Roots_fixIntoUnitCircle (roots);
+		my numberOfFormants [irow] = Roots_into_formants (roots, my frequencies [irow], my bandwidths [irow], 1.0 / lpc -> samplingPeriod, my margin);
+	}
+	MelderThread_RETURN;
+}
+
 autoFormant LPC_to_Formant (LPC me, double margin) {
 	try {
 		double samplingFrequency = 1.0 / my samplingPeriod;
 		long nmax = my maxnCoefficients, err = 0;
-		long interval = nmax > 20 ? 1 : 10;
 
 		if (nmax > 99) {
 			Melder_throw (U"We cannot find the roots of a polynomial of order > 99.");
@@ -97,26 +152,67 @@ autoFormant LPC_to_Formant (LPC me, double margin) {
 		}
 
 		autoFormant thee = Formant_create (my xmin, my xmax, my nx, my dx, my x1, (nmax + 1) / 2);
+		if (nmax < 1) {
+			return thee;
+		}
 
-		autoMelderProgress progress (U"LPC to Formant");
-
-		for (long i = 1; i <= my nx; i++) {
-			Formant_Frame formant = & thy d_frames[i];
-			LPC_Frame lpc = & my d_frames[i];
+		long blockSize = my nx < LPC_to_Formant_BLOCK_SIZE ? my nx : LPC_to_Formant_BLOCK_SIZE;
+		autoNUMmatrix<double> frequencies (1, blockSize, 1, nmax);
+		autoNUMmatrix<double> bandwidths (1, blockSize, 1, nmax);
+		autoNUMvector<long> numberOfFormants (1, blockSize);
+		autoNUMvector<bool> suspect (1, blockSize);
+
+		int numberOfThreads = blockSize < 16 ? (int) blockSize : 16;
+		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		autoLPC_to_Formant_Args args [16];
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoLPC_to_Formant_Args arg = Thing_new (LPC_to_Formant_Args);
+			arg -> lpc = me;
+			arg -> margin = margin;
+			arg -> finder = PolynomialRootFinder_create (nmax);
+			arg -> frequencies = frequencies.peek();
+			arg -> bandwidths = bandwidths.peek();
+			arg -> numberOfFormants = numberOfFormants.peek();
+			arg -> suspect = suspect.peek();
+			args [ithread - 1] = arg.move();
+		}
 
-			// Initialisation of Formant_Frame is taken care of in Roots_into_Formant_Frame!
+		autoMelderProgress progress (U"LPC to Formant");
 
-			try {
-				LPC_Frame_into_Formant_Frame (lpc, formant, my samplingPeriod, margin);
-			} catch (MelderError) {
-				Melder_clearError();
-				err++;
+		for (long firstFrame = 1; firstFrame <= my nx; firstFrame += blockSize) {
+			long lastFrame = firstFrame + blockSize - 1;
+			if (lastFrame > my nx) lastFrame = my nx;
+			long numberOfFrames = lastFrame - firstFrame + 1;
+			int numberOfThreadsInBlock = numberOfFrames < numberOfThreads ? (int) numberOfFrames : numberOfThreads;
+			long numberOfFramesPerThread = (numberOfFrames - 1) / numberOfThreadsInBlock + 1;
+			numberOfThreadsInBlock = (int) ((numberOfFrames - 1) / numberOfFramesPerThread + 1);
+			for (int ithread = 1; ithread <= numberOfThreadsInBlock; ithread ++) {
+				LPC_to_Formant_Args arg = args [ithread - 1].get();
+				arg -> blockOffset = firstFrame - 1;
+				arg -> firstFrame = firstFrame + (ithread - 1) * numberOfFramesPerThread;
+				arg -> lastFrame = ithread == numberOfThreadsInBlock ? lastFrame : arg -> firstFrame + numberOfFramesPerThread - 1;
 			}
-
-			if ( (interval == 1 || (i % interval) == 1)) {
-				Melder_progress ( (double) i / my nx, U"LPC to Formant: frame ", i,
-				                   U" out of ", my nx, U".");
+			MelderThread_run (LPC_to_Formant_thread, args, numberOfThreadsInBlock);
+
+			// Initialisation of the Formant_Frames happens here, in the main thread.
+
+			for (long i = firstFrame; i <= lastFrame; i++) {
+				Formant_Frame formant = & thy d_frames[i];
+				long irow = i - firstFrame + 1;
+				formant -> intensity = my d_frames[i].gain;
+				if (my d_frames[i].nCoefficients == 0) {
+					continue;
+				}
+				if (suspect[irow]) {
+					err++;
+				}
+				Formant_Frame_setFormants (formant, numberOfFormants[irow], frequencies[irow], bandwidths[irow]);
 			}
+
+			Melder_progress ( (double) lastFrame / my nx, U"LPC to Formant: frame ", lastFrame,
+			                   U" out of ", my nx, U".");
 		}
 
 		Formant_sort (thee.get());
@@ -30,6 +30,7 @@
 #include "Vector.h"
 #include "Spectrum.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 #define LPC_METHOD_AUTO 1
 #define LPC_METHOD_COVAR 2
@@ -57,9 +58,17 @@ static void LPC_Frame_and_Sound_filter (LPC_Frame me, Sound thee, int channel) {
 	}
 }
 
-void LPC_Frame_and_Sound_filterInverse (LPC_Frame me, Sound thee, int channel) {
-	double *x = thy z[channel];
-	autoNUMvector<double> y (0L, my nCoefficients);
+void LPC_Frame_and_Sound_filterInverse (LPC_Frame me, Sound thee, int channel, double *work) {
+	double *x = thy z[channel], *y = work;
+	autoNUMvector<double> ay;
+	if (! work) {
+		ay.reset (0L, my nCoefficients);
+		y = ay.peek();
+	} else {
+		for (long j = 0; j <= my nCoefficients; j++) {
+			y[j] = 0.0;
+		}
+	}
 	for (long i = 1; i <= thy nx; i++) {
 		y[0] = x[i];
 		for (long j = 1; j <= my nCoefficients; j++) {
@@ -71,18 +80,26 @@ void LPC_Frame_and_Sound_filterInverse (LPC_Frame me, Sound thee, int channel) {
 	}
 }
 
-static int Sound_into_LPC_Frame_auto (Sound me, LPC_Frame thee) {
+static int Sound_into_LPC_Frame_auto (Sound me, LPC_Frame thee, double work []) {
 	long i = 1; // For error condition at end
 	long m = thy nCoefficients;
 
-	autoNUMvector<double> r (1, m + 1);
-	autoNUMvector<double> a (1, m + 1);
-	autoNUMvector<double> rc (1, m);
+	for (long j = 1; j <= m + 1 + m + 1 + m; j++) {
+		work[j] = 0.0;
+	}
+	double *r = & work[0];   // r[1..m+1]
+	double *a = & work[m + 1];   // a[1..m+1]
+	double *rc = & work[m + 1 + m + 1];   // rc[1..m]
 
+	/*
+		All lags in one sweep over the samples; every r[i] is still summed in the order of j.
+	*/
 	double  *x = my z[1];
-	for (i = 1; i <= m + 1; i++) {
-		for (long j = 1; j <= my nx - i + 1; j++) {
-			r[i] += x[j] * x[j + i - 1];
+	for (long j = 1; j <= my nx; j++) {
+		long imax = my nx - j + 1 < m + 1 ? my nx - j + 1 : m + 1;
+		double xj = x[j];
+		for (i = 1; i <= imax; i++) {
+			r[i] += xj * x[j + i - 1];
 		}
 	}
 	if (r[1] == 0.0) {
@@ -130,15 +147,18 @@ end:
 	cc = & work[m+1)/2+m+m+1+m+1]
 	for (i=1; i<=m(m+1)/2+m+m+1+m+m+1;i++) work[i] = 0;
 */
-static int Sound_into_LPC_Frame_covar (Sound me, LPC_Frame thee) {
+static int Sound_into_LPC_Frame_covar (Sound me, LPC_Frame thee, double work []) {
 	long i = 1, n = my nx, m = thy nCoefficients;
 	double *x = my z[1];
 
-	autoNUMvector<double> b (1, m * (m + 1) / 2);
-	autoNUMvector<double> grc (1, m);
-	autoNUMvector<double> a (1, m + 1);
-	autoNUMvector<double> beta (1, m);
-	autoNUMvector<double> cc (1, m + 1);
+	for (long j = 1; j <= m * (m + 1) / 2 + m + m + 1 + m + m + 1; j++) {
+		work[j] = 0.0;
+	}
+	double *b = & work[0];   // b[1..m(m+1)/2]
+	double *grc = & work[m * (m + 1) / 2];   // grc[1..m]
+	double *a = & work[m * (m + 1) / 2 + m];   // a[1..m+1]
+	double *beta = & work[m * (m + 1) / 2 + m + m + 1];   // beta[1..m]
+	double *cc = & work[m * (m + 1) / 2 + m + m + 1 + m];   // cc[1..m+1]
 
 	thy gain = 0.0;
 	for (i = m + 1; i <= n; i++) {
@@ -223,8 +243,8 @@ end:
 	return 0; // Melder_warning ("Less coefficienst than asked for.");
 }
 
-static int Sound_into_LPC_Frame_burg (Sound me, LPC_Frame thee) {
-	int status = NUMburg (my z[1], my nx, thy a, thy nCoefficients, &thy gain);
+static int Sound_into_LPC_Frame_burg (Sound me, LPC_Frame thee, double work []) {
+	int status = NUMburg_preallocated (my z[1], my nx, thy a, thy nCoefficients, &thy gain, work);
 	thy gain *= my nx;
 	for (long i = 1; i <= thy nCoefficients; i++) {
 		thy a[i] = -thy a[i];
@@ -232,14 +252,17 @@ static int Sound_into_LPC_Frame_burg (Sound me, LPC_Frame thee) {
 	return status;
 }
 
-static int Sound_into_LPC_Frame_marple (Sound me, LPC_Frame thee, double tol1, double tol2) {
+static int Sound_into_LPC_Frame_marple (Sound me, LPC_Frame thee, double tol1, double tol2, double work []) {
 	long m = 1, n = my nx, mmax = thy nCoefficients;
 	int status = 1;
 	double *a = thy a, *x = my z[1];
 
-	autoNUMvector<double> c (1, mmax + 1);
-	autoNUMvector<double> d (1, mmax + 1);
-	autoNUMvector<double> r (1, mmax + 1);
+	for (long k = 1; k <= 3 * (mmax + 1); k++) {
+		work[k] = 0.0;
+	}
+	double *c = & work[0];   // c[1..mmax+1]
+	double *d = & work[mmax + 1];   // d[1..mmax+1]
+	double *r = & work[mmax + 1 + mmax + 1];   // r[1..mmax+1]
 	double e0 = 0.0;
 	for (long k = 1; k <= n; k++) {
 		e0 += x[k] * x[k];
@@ -368,6 +391,87 @@ end:
 	return status == 1 || status == 4 || status == 5;
 }
 
+Thing_define (Sound_into_LPC_Args, Thing) { public:
+	Sound sound, window;
+	LPC lpc;
+	long firstFrame, lastFrame;
+	int method;
+	double tol1, tol2, windowDuration;
+	long workSize;
+	long frameErrorCount;
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (Sound_into_LPC_Args, Thing, 0);
+
+static autoSound_into_LPC_Args Sound_into_LPC_Args_create (Sound sound, Sound window, LPC lpc,
+	long firstFrame, long lastFrame, int method, double tol1, double tol2, double windowDuration, long workSize,
+	bool isMainThread, volatile int *cancelled)
+{
+	autoSound_into_LPC_Args me = Thing_new (Sound_into_LPC_Args);
+	my sound = sound;
+	my window = window;
+	my lpc = lpc;
+	my firstFrame = firstFrame;
+	my lastFrame = lastFrame;
+	my method = method;
+	my tol1 = tol1;
+	my tol2 = tol2;
+	my windowDuration = windowDuration;
+	my workSize = workSize;
+	my isMainThread = isMainThread;
+	my cancelled = cancelled;
+	return me;
+}
+
+MelderThread_MUTEX (mutex);
+static bool mutex_inited;
+
+static MelderThread_RETURN_TYPE Sound_into_LPC (Sound_into_LPC_Args me) {
+	autoSound sframe;
+	autoNUMvector<double> work;
+	{// scope
+		MelderThread_LOCK (mutex);
+		sframe = Sound_createSimple (1, my windowDuration, 1.0 / my sound -> dx);
+		work.reset (1, my workSize);
+		MelderThread_UNLOCK (mutex);
+	}
+	for (long i = my firstFrame; i <= my lastFrame; i++) {
+		LPC_Frame lpcframe = (LPC_Frame) & my lpc -> d_frames[i];
+		double t = Sampled_indexToX (my lpc, i);
+		if (my isMainThread) {
+			try {
+				if ((i % 10) == 1) {
+					Melder_progress ( (double) (i - my firstFrame + 1) / (my lastFrame - my firstFrame + 1), U"LPC analysis of frame ", i, U" out of ", my lastFrame, U".");
+				}
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		} else if (*my cancelled) {
+			MelderThread_RETURN;
+		}
+		Sound_into_Sound (my sound, sframe.get(), t - my windowDuration / 2);
+		Vector_subtractMean (sframe.get());
+		Sounds_multiply (sframe.get(), my window);
+		int status = 0;
+		if (my method == LPC_METHOD_AUTO) {
+			status = Sound_into_LPC_Frame_auto (sframe.get(), lpcframe, work.peek());
+		} else if (my method == LPC_METHOD_COVAR) {
+			status = Sound_into_LPC_Frame_covar (sframe.get(), lpcframe, work.peek());
+		} else if (my method == LPC_METHOD_BURG) {
+			status = Sound_into_LPC_Frame_burg (sframe.get(), lpcframe, work.peek());
+		} else if (my method == LPC_METHOD_MARPLE) {
+			status = Sound_into_LPC_Frame_marple (sframe.get(), lpcframe, my tol1, my tol2, work.peek());
+		}
+		if (! status) {
+			my frameErrorCount++;
+		}
+	}
+	MelderThread_RETURN;
+}
+
 static autoLPC _Sound_to_LPC (Sound me, int predictionOrder, double analysisWidth, double dt, double preEmphasisFrequency, int method, double tol1, double tol2) {
 	double t1, samplingFrequency = 1.0 / my dx;
 	double windowDuration = 2 * analysisWidth; /* gaussian window */
@@ -383,7 +487,6 @@ static autoLPC _Sound_to_LPC (Sound me, int predictionOrder, double analysisWidt
 	}
 	Sampled_shortTermAnalysis (me, windowDuration, dt, & nFrames, & t1);
 	autoSound sound = Data_copy (me);
-	autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
 	autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
 	autoLPC thee = LPC_create (my xmin, my xmax, nFrames, dt, t1, predictionOrder, my dx);
 
@@ -394,32 +497,40 @@ static autoLPC _Sound_to_LPC (Sound me, int predictionOrder, double analysisWidt
 	}
 
 	for (long i = 1; i <= nFrames; i++) {
-		LPC_Frame lpcframe = (LPC_Frame) & thy d_frames[i];
-		double t = Sampled_indexToX (thee.get(), i);
-		LPC_Frame_init (lpcframe, predictionOrder);
-		Sound_into_Sound (sound.get(), sframe.get(), t - windowDuration / 2);
-		Vector_subtractMean (sframe.get());
-		Sounds_multiply (sframe.get(), window.get());
-		if (method == LPC_METHOD_AUTO) {
-			if (! Sound_into_LPC_Frame_auto (sframe.get(), lpcframe)) {
-				frameErrorCount++;
-			}
-		} else if (method == LPC_METHOD_COVAR) {
-			if (! Sound_into_LPC_Frame_covar (sframe.get(), lpcframe)) {
-				frameErrorCount++;
-			}
-		} else if (method == LPC_METHOD_BURG) {
-			if (! Sound_into_LPC_Frame_burg (sframe.get(), lpcframe)) {
-				frameErrorCount++;
-			}
-		} else if (method == LPC_METHOD_MARPLE) {
-			if (! Sound_into_LPC_Frame_marple (sframe.get(), lpcframe, tol1, tol2)) {
-				frameErrorCount++;
-			}
-		}
-		if ((i % 10) == 1) {
-			Melder_progress ( (double) i / nFrames, U"LPC analysis of frame ", i, U" out of ", nFrames, U".");
-		}
+		LPC_Frame_init (& thy d_frames[i], predictionOrder);
+	}
+
+	/*
+		The work space of each thread is large enough for the selected method only.
+	*/
+	long m = predictionOrder, n = window -> nx;
+	long workSize = method == LPC_METHOD_AUTO ? m + 1 + m + 1 + m :
+		method == LPC_METHOD_COVAR ? m * (m + 1) / 2 + m + m + 1 + m + m + 1 :
+		method == LPC_METHOD_BURG ? n + n + m : 3 * (m + 1);
+
+	long numberOfFramesPerThread = 20;
+	int numberOfThreads = (nFrames - 1) / numberOfFramesPerThread + 1;
+	const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	numberOfFramesPerThread = (nFrames - 1) / numberOfThreads + 1;
+
+	if (! mutex_inited) { MelderThread_MUTEX_INIT (mutex); mutex_inited = true; }
+	autoSound_into_LPC_Args args [16];
+	long firstFrame = 1, lastFrame = numberOfFramesPerThread;
+	volatile int cancelled = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		if (ithread == numberOfThreads) lastFrame = nFrames;
+		args [ithread - 1] = Sound_into_LPC_Args_create (sound.get(), window.get(), thee.get(),
+			firstFrame, lastFrame, method, tol1, tol2, windowDuration, workSize,
+			ithread == numberOfThreads, & cancelled);
+		firstFrame = lastFrame + 1;
+		lastFrame += numberOfFramesPerThread;
+	}
+	MelderThread_run (Sound_into_LPC, args, numberOfThreads);
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		frameErrorCount += args [ithread - 1] -> frameErrorCount;
 	}
 	return thee;
 }
@@ -608,10 +719,10 @@ void LPC_and_Sound_filterInverseWithFilterAtTime_inline (LPC me, Sound thee, int
 			channel = 1;
 		}
 		if (channel > 0) {
-			LPC_Frame_and_Sound_filterInverse (& (my d_frames[frameIndex]), thee, channel);
+			LPC_Frame_and_Sound_filterInverse (& (my d_frames[frameIndex]), thee, channel, nullptr);
 		} else {
 			for (long ichan = 1; ichan <= thy ny; ichan++) {
-				LPC_Frame_and_Sound_filterInverse (& (my d_frames[frameIndex]), thee, ichan);
+				LPC_Frame_and_Sound_filterInverse (& (my d_frames[frameIndex]), thee, ichan, nullptr);
 			}
 		}
 	} catch (MelderError) {
@@ -65,7 +65,11 @@ autoLPC Sound_to_LPC_marple (Sound me, int predictionOrder, double analysisWidth
  *	tol2 : stop iteration when (E(m)-E(m-1)) / E(m-1) < tol2,
  */
 
-void LPC_Frame_and_Sound_filterInverse (LPC_Frame me, Sound thee, int channel);
+void LPC_Frame_and_Sound_filterInverse (LPC_Frame me, Sound thee, int channel, double *work);
+/*
+	work is a working array (0..my nCoefficients) that can be used for efficiency reasons.
+	If work == nullptr, the routine allocates (and destroys) its own memory.
+*/
 
 autoSound LPC_and_Sound_filter (LPC me, Sound thee, int useGain);
 /*
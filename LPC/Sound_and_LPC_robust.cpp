@@ -33,6 +33,8 @@
 #include "SVD.h"
 #include "Vector.h"
 #include "NUM2.h"
+#include "NUMclapack.h"
+#include "MelderThread.h"
 
 struct huber_struct {
 	autoSound e;
@@ -42,13 +44,13 @@ struct huber_struct {
 	double location, scale;
 	long n, p;
 	double *w, *work;
-	double *a;
+	double *a, *y;
 	double **covar, *c;
 	autoSVD svd;
 };
 
 static void huber_struct_init (struct huber_struct *hs, double windowDuration, long p, double samplingFrequency, double location, int wantlocation) {
-	hs -> w = hs -> work = hs -> a = hs -> c = nullptr;
+	hs -> w = hs -> work = hs -> a = hs -> y = hs -> c = nullptr;
 	hs -> covar = nullptr;
 	hs -> svd = autoSVD();
 	hs -> e = Sound_createSimple (1, windowDuration, samplingFrequency);
@@ -58,6 +60,7 @@ static void huber_struct_init (struct huber_struct *hs, double windowDuration, l
 	hs -> w = NUMvector<double> (1, n);
 	hs -> work = NUMvector<double> (1, n);
 	hs -> a = NUMvector<double> (1, p);
+	hs -> y = NUMvector<double> (0, p);
 	hs -> covar = NUMmatrix<double> (1, p, 1, p);
 	hs -> c = NUMvector<double> (1, p);
 	hs -> svd = SVD_create (p, p);
@@ -74,6 +77,7 @@ static void huber_struct_destroy (struct huber_struct *hs) {
 	NUMvector_free<double> (hs -> w, 1);
 	NUMvector_free<double> (hs -> work, 1);
 	NUMvector_free<double> (hs -> a, 1);
+	NUMvector_free<double> (hs -> y, 0);
 	NUMmatrix_free<double> (hs -> covar, 1, 1);
 	NUMvector_free<double> (hs -> c, 1);
 }
@@ -127,7 +131,7 @@ static void huber_struct_solvelpc (struct huber_struct *hs) {
 	SVD_solve (me, hs -> c, hs -> a);
 }
 
-void LPC_Frames_and_Sound_huber (LPC_Frame me, Sound thee, LPC_Frame him, struct huber_struct *hs) {
+bool LPC_Frames_and_Sound_huber (LPC_Frame me, Sound thee, LPC_Frame him, struct huber_struct *hs) {
 	long p = my nCoefficients > his nCoefficients ? his nCoefficients : my nCoefficients;
 	long n = hs -> e -> nx > thy nx ? thy nx : hs -> e -> nx;
 	double *e = hs -> e -> z[1], *s = thy z[1];
@@ -142,24 +146,40 @@ void LPC_Frames_and_Sound_huber (LPC_Frame me, Sound thee, LPC_Frame him, struct
 		for (long i = 1; i <= thy nx; i++) {
 			hse -> z[1][i] = thy z[1][i];
 		}
-		LPC_Frame_and_Sound_filterInverse (him, hse, 1);
+		LPC_Frame_and_Sound_filterInverse (him, hse, 1, hs -> y);
 
 		s0 = hs -> scale;
 
-		NUMstatistics_huber (e, n, & (hs -> location), hs -> wantlocation, & (hs -> scale), hs -> wantscale, hs -> k, hs -> tol, hs -> work);
+		if (! NUMstatistics_huber (e, n, & (hs -> location), hs -> wantlocation, & (hs -> scale), hs -> wantscale, hs -> k, hs -> tol, hs -> work)) {
+			return false;   // scale is zero
+		}
 
 		huber_struct_getWeights (hs, e);
 		huber_struct_getWeightedCovars (hs, s);
 
 		// Solve C a = [-] c */
-		try {
-			huber_struct_solvelpc (hs);
-		} catch (MelderError) {
+		bool solved;
+		{
+			/*
+				SVD_compute calls the f2c-translated LAPACK, which is not reentrant,
+				so the frames that are analysed in different threads take turns in solving.
+			*/
+			NUMlapack_lock ();
+			try {
+				huber_struct_solvelpc (hs);
+				solved = true;
+			} catch (MelderError) {
+				Melder_clearError ();
+				solved = false;
+			}
+			NUMlapack_unlock ();
+		}
+		if (! solved) {
 			// Copy the starting lpc coeffs */
 			for (long i = 1; i <= p; i++) {
 				his a[i] = my a[i];
 			}
-			throw MelderError();
+			return false;
 		}
 		for (long i = 1; i <= p; i++) {
 			his a[i] = hs -> a[i];
@@ -167,24 +187,64 @@ void LPC_Frames_and_Sound_huber (LPC_Frame me, Sound thee, LPC_Frame him, struct
 
 		(hs -> iter) ++;
 	} while ( (hs -> iter < hs -> itermax) && (fabs (s0 - hs -> scale) > hs -> tol * s0));
+	return true;
+}
+
+Thing_define (LPC_and_Sound_to_LPC_robust_Args, Thing) { public:
+	LPC lpc, result;
+	Sound sound, window;
+	double windowDuration;
+	long firstFrame, lastFrame;
+	struct huber_struct hs;
+	autoSound sframe;
+	long frameErrorCount, numberOfIterations;
+	bool isMainThread;
+	volatile int *cancelled;
+
+	void v_destroy () noexcept
+		override;
+};
+
+Thing_implement (LPC_and_Sound_to_LPC_robust_Args, Thing, 0);
+
+void structLPC_and_Sound_to_LPC_robust_Args :: v_destroy () noexcept {
+	huber_struct_destroy (& hs);
+	LPC_and_Sound_to_LPC_robust_Args_Parent :: v_destroy ();
+}
+
+static MelderThread_RETURN_TYPE LPC_and_Sound_to_LPC_robust_thread (LPC_and_Sound_to_LPC_robust_Args me) {
+	for (long i = my firstFrame; i <= my lastFrame; i++) {
+		LPC_Frame lpc = (LPC_Frame) & my lpc -> d_frames[i];
+		LPC_Frame lpcto = (LPC_Frame) & my result -> d_frames[i];
+		double t = Sampled_indexToX (my lpc, i);
+		if (my isMainThread) {
+			try {
+				if ( (i % 10) == 1) {
+					Melder_progress ( (double) (i - my firstFrame + 1) / (my lastFrame - my firstFrame + 1), U"LPC analysis of frame ", i, U" out of ", my lastFrame, U".");
+				}
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		} else if (*my cancelled) {
+			MelderThread_RETURN;
+		}
+
+		Sound_into_Sound (my sound, my sframe.get(), t - my windowDuration / 2);
+		Vector_subtractMean (my sframe.get());
+		Sounds_multiply (my sframe.get(), my window);
+
+		if (! LPC_Frames_and_Sound_huber (lpc, my sframe.get(), lpcto, & my hs)) {
+			my frameErrorCount++;
+		}
+
+		my numberOfIterations += my hs.iter;
+	}
+	MelderThread_RETURN;
 }
 
-#if 0
-	autoSound e;
-	double k, tol, tol_svd;
-	long iter, itermax;
-	int wantlocation, wantscale;
-	double location, scale;
-	long n, p;
-	double *w, *work;
-	double *a;
-	double **covar, *c;
-	autoSVD svd;
-#endif
-	
 autoLPC LPC_and_Sound_to_LPC_robust (LPC thee, Sound me, double analysisWidth, double preEmphasisFrequency, double k,
 	int itermax, double tol, int wantlocation) {
-	struct huber_struct struct_huber { autoSound(), 0.0, 0.0, 0.0, 0, 0, 0, 0, 0.0, 0.0, 0, 0, nullptr, nullptr, nullptr, nullptr, nullptr, autoSVD() };
 	try {
 		double t1, samplingFrequency = 1.0 / my dx, tol_svd = 0.000001;
 		double location = 0, windowDuration = 2 * analysisWidth; /* Gaussian window */
@@ -206,50 +266,59 @@ autoLPC LPC_and_Sound_to_LPC_robust (LPC thee, Sound me, double analysisWidth, d
 		}
 
 		autoSound sound = Data_copy (me);
-		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
 		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
 		autoLPC him = Data_copy (thee);
-		huber_struct_init (&struct_huber, windowDuration, p, samplingFrequency, location, wantlocation);
-
-		struct_huber.k = k;
-		struct_huber.tol = tol;
-		struct_huber.tol_svd = tol_svd;
-		struct_huber.itermax = itermax;
 
 		autoMelderProgress progess (U"LPC analysis");
 
 		Sound_preEmphasis (sound.get(), preEmphasisFrequency);
 
-		for (long i = 1; i <= nFrames; i++) {
-			LPC_Frame lpc = (LPC_Frame) & thy d_frames[i];
-			LPC_Frame lpcto = (LPC_Frame) & his d_frames[i];
-			double t = Sampled_indexToX (thee, i);
-
-			Sound_into_Sound (sound.get(), sframe.get(), t - windowDuration / 2);
-			Vector_subtractMean (sframe.get());
-			Sounds_multiply (sframe.get(), window.get());
-
-			try {
-				LPC_Frames_and_Sound_huber (lpc, sframe.get(), lpcto, & struct_huber);
-			} catch (MelderError) {
-				frameErrorCount++;
-			}
-
-			iter += struct_huber.iter;
-
-			if ( (i % 10) == 1) {
-				Melder_progress ( (double) i / nFrames, U"LPC analysis of frame ", i, U" out of ", nFrames, U".");
-			}
+		long numberOfFramesPerThread = 20;
+		int numberOfThreads = (nFrames - 1) / numberOfFramesPerThread + 1;
+		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		numberOfFramesPerThread = (nFrames - 1) / numberOfThreads + 1;
+
+		NUMlapack_initLock ();
+		autoLPC_and_Sound_to_LPC_robust_Args args [16];
+		long firstFrame = 1, lastFrame = numberOfFramesPerThread;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			if (ithread == numberOfThreads) lastFrame = nFrames;
+			autoLPC_and_Sound_to_LPC_robust_Args arg = Thing_new (LPC_and_Sound_to_LPC_robust_Args);
+			arg -> lpc = thee;
+			arg -> result = him.get();
+			arg -> sound = sound.get();
+			arg -> window = window.get();
+			arg -> windowDuration = windowDuration;
+			arg -> firstFrame = firstFrame;
+			arg -> lastFrame = lastFrame;
+			huber_struct_init (& arg -> hs, windowDuration, p, samplingFrequency, location, wantlocation);
+			arg -> hs.k = k;
+			arg -> hs.tol = tol;
+			arg -> hs.tol_svd = tol_svd;
+			arg -> hs.itermax = itermax;
+			arg -> sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
+			arg -> isMainThread = ithread == numberOfThreads;
+			arg -> cancelled = & cancelled;
+			args [ithread - 1] = arg.move();
+			firstFrame = lastFrame + 1;
+			lastFrame += numberOfFramesPerThread;
+		}
+		MelderThread_run (LPC_and_Sound_to_LPC_robust_thread, args, numberOfThreads);
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			frameErrorCount += args [ithread - 1] -> frameErrorCount;
+			iter += args [ithread - 1] -> numberOfIterations;
 		}
 
 		if (frameErrorCount) Melder_warning (U"Results of ", frameErrorCount,
 			U" frame(s) out of ", nFrames, U" could not be optimised.");
 		MelderInfo_writeLine (U"Number of iterations: ", iter,
 			U"\n   Average per frame: ", ((double) iter) / nFrames);
-		huber_struct_destroy (&struct_huber);
 		return him;
 	} catch (MelderError) {
-		huber_struct_destroy (&struct_huber);
 		Melder_throw (me, U": no robust LPC created.");
 	}
 }
@@ -27,7 +27,8 @@
 #include "Formant.h"
 #include "Sound.h"
 
-void LPC_Frames_and_Sound_huber (LPC_Frame me, Sound thee, LPC_Frame him, struct huber_struct *hs);
+bool LPC_Frames_and_Sound_huber (LPC_Frame me, Sound thee, LPC_Frame him, struct huber_struct *hs);
+/* Returns false if the frame could not be optimised. */
 /*int LPC_Frames_and_Sound_huber (LPC_Frame me, Sound thee, LPC_Frame him, void *huber);
 	The gnu c compiler (version 3.3.1) complaints about having two LPC_Frame types
 	in the argument list:
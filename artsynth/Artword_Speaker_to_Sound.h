@@ -26,4 +26,13 @@ autoSound Artword_Speaker_to_Sound (Artword artword, Speaker speaker,
    autoSound *p1, int ip1, autoSound *p2, int ip2, autoSound *p3, int ip3,
    autoSound *v1, int iv1, autoSound *v2, int iv2, autoSound *v3, int iv3);
 
+void Artwords_Speaker_to_Sounds (OrderedOf<structArtword>& artwords, Speaker speaker,
+	double samplingFrequency, int oversampling, OrderedOf<structSound>& sounds);
+/*
+	Synthesizes every Artword with the same Speaker, on as many threads as there are processors,
+	and adds the resulting Sounds to 'sounds', in the order of the Artwords.
+	The turbulence noise of each Sound comes from its own random stream,
+	so that the result does not depend on the number of threads.
+*/
+
 /* End of file Artword_Speaker_to_Sound.h */
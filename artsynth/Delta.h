@@ -50,6 +50,10 @@ struct structDelta_Tube
 	double p, phalf, pleft, pleftnew, pright, prightnew;
 	double Kleft, Kleftnew, Kright, Krightnew, Pturbright, Pturbrightnew;
 	double B, r, R, DeltaP, v;
+
+	/* Derived from the quasistatic quantities once per sample, by the synthesizer. */
+
+	double DtBymass, Rclosed, Ropen;
 };
 
 Thing_define (Delta, Thing) {
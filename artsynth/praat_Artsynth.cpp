@@ -224,6 +224,24 @@ DO
 	if (iv3) praat_new (v3.move(), U"velocity", iv3);
 END2 }
 
+FORM (Artwords_Speaker_to_Sounds, U"Articulatory synthesizer (many Artwords)", U"Artword & Speaker: To Sound...") {
+	POSITIVE (U"Sampling frequency (Hz)", U"22050.0")
+	NATURAL (U"Oversampling factor", U"25")
+	OK2
+DO
+	OrderedOf<structArtword> artwords;
+	Speaker speaker = nullptr;
+	LOOP {
+		if (CLASS == classArtword) artwords. addItem_ref ((Artword) OBJECT);
+		if (CLASS == classSpeaker) speaker = (Speaker) OBJECT;
+	}
+	OrderedOf<structSound> sounds;
+	Artwords_Speaker_to_Sounds (artwords, speaker,
+		GET_REAL (U"Sampling frequency"), GET_INTEGER (U"Oversampling factor"), sounds);
+	for (long iartword = 1; iartword <= artwords.size; iartword ++)
+		praat_new (sounds. subtractItem_move (1), artwords.at [iartword] -> name, U"_", speaker -> name);
+END2 }
+
 DIRECT2 (Artword_Speaker_movie) {
 	Graphics graphics = Movie_create (U"Artword & Speaker movie", 300, 300);
 	iam_ONLY (Artword);
@@ -397,6 +415,7 @@ void praat_uvafon_Artsynth_init () {
 	praat_addAction2 (classArtword, 1, classSpeaker, 1, U"Draw...", nullptr, 0, DO_Artword_Speaker_draw);
 	praat_addAction2 (classArtword, 1, classSpeaker, 1, U"Synthesize", nullptr, 0, nullptr);
 	praat_addAction2 (classArtword, 1, classSpeaker, 1, U"To Sound...", nullptr, 0, DO_Artword_Speaker_to_Sound);
+	praat_addAction2 (classArtword, 0, classSpeaker, 1, U"To Sounds...", nullptr, 0, DO_Artwords_Speaker_to_Sounds);
 
 	praat_addAction3 (classArtword, 1, classSpeaker, 1, classSound, 1, U"Movie", nullptr, 0, DO_Artword_Speaker_Sound_movie);
 
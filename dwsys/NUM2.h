@@ -299,12 +299,13 @@ void NUMmad (double *x, long n, double *location, int wantlocation, double *mad,
 	If work == NULL, the routine allocates (and destroys) its own memory.
  */
 
-void NUMstatistics_huber (double *x, long n, double *location, int wantlocation,
+bool NUMstatistics_huber (double *x, long n, double *location, int wantlocation,
 	double *scale, int wantscale, double k, double tol, double *work);
 /*
 	Finds the Huber M-estimator for location with scale specified,
 	scale with location specified, or both if neither is specified.
 	k Winsorizes at `k' standard deviations.
+	Returns false (without throwing, so that it can be used in threads) if the scale is zero.
 
 	work is a working array (1..n) that can be used for efficiency reasons.
 	If work == NULL, the routine allocates (and destroys) its own memory.
@@ -1008,6 +1009,11 @@ int NUMburg (double x[], long n, double a[], int m, double *xms);
 	Spectrum Analysis, IEEE Press, 1978, 252-255.
 */
 
+int NUMburg_preallocated (double x[], long n, double a[], int m, double *xms, double work[]);
+/*
+	As NUMburg, with workspace work[1..n+n+m] supplied by the caller, so that it allocates nothing.
+*/
+
 void NUMdmatrix_to_dBs (double **m, long rb, long re, long cb, long ce,
 	double ref, double factor, double floor);
 /*
@@ -20,6 +20,7 @@
 #include "NUMcblas.h"
 #include "NUMf2c.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 #define MAX(m,n) ((m) > (n) ? (m) : (n))
 #define MIN(m,n) ((m) < (n) ? (m) : (n))
@@ -225,17 +226,188 @@ L60:
 	return ret_val;
 }								/* NUMblas_ddot */
 
+/*
+	Blocked matrix multiplication, after Goto & van de Geijn (2008), "Anatomy of high-performance matrix multiplication".
+	Panels of op(A) (MC x KC) and op(B) (KC x NC) are copied into contiguous buffers in exactly the order
+	in which the micro kernel reads them, so that the kernel streams through memory that stays in the caches
+	whatever the transposition and leading dimensions of the arguments.
+	The micro kernel computes a DGEMM_MR x DGEMM_NR tile of C with loops of constant length,
+	which lets the compiler keep the accumulators in (vector) registers.
+	Large products are distributed over threads by columns of C.
+*/
+#define DGEMM_MR  4
+#define DGEMM_NR  4
+#define DGEMM_MC  128
+#define DGEMM_KC  256
+#define DGEMM_NC  2048
+
+static void dgemm_packA (bool transposed, const double *a, long lda, long i0, long l0, long mc, long kc, double *packed) {
+	for (long ip = 0; ip < mc; ip += DGEMM_MR) {
+		long mr = MIN (DGEMM_MR, mc - ip);
+		for (long l = 0; l < kc; l ++) {
+			for (long r = 0; r < mr; r ++) {
+				long i = i0 + ip + r, ll = l0 + l;
+				*packed ++ = transposed ? a [ll + i * lda] : a [i + ll * lda];
+			}
+			for (long r = mr; r < DGEMM_MR; r ++) {
+				*packed ++ = 0.0;
+			}
+		}
+	}
+}
+
+static void dgemm_packB (bool transposed, const double *b, long ldb, long l0, long j0, long kc, long nc, double *packed) {
+	for (long jp = 0; jp < nc; jp += DGEMM_NR) {
+		long nr = MIN (DGEMM_NR, nc - jp);
+		for (long l = 0; l < kc; l ++) {
+			for (long r = 0; r < nr; r ++) {
+				long j = j0 + jp + r, ll = l0 + l;
+				*packed ++ = transposed ? b [j + ll * ldb] : b [ll + j * ldb];
+			}
+			for (long r = nr; r < DGEMM_NR; r ++) {
+				*packed ++ = 0.0;
+			}
+		}
+	}
+}
+
+static void dgemm_microKernel (long kc, const double *pa, const double *pb, double alpha, double *c, long ldc, long mr, long nr) {
+	/*
+		The 4 x 4 block of C is accumulated in sixteen scalars, so that the compiler can keep them in registers.
+	*/
+	double c00 = 0.0, c10 = 0.0, c20 = 0.0, c30 = 0.0, c01 = 0.0, c11 = 0.0, c21 = 0.0, c31 = 0.0;
+	double c02 = 0.0, c12 = 0.0, c22 = 0.0, c32 = 0.0, c03 = 0.0, c13 = 0.0, c23 = 0.0, c33 = 0.0;
+	for (long l = 0; l < kc; l ++) {
+		double a0 = pa [0], a1 = pa [1], a2 = pa [2], a3 = pa [3];
+		double b0 = pb [0], b1 = pb [1], b2 = pb [2], b3 = pb [3];
+		c00 += a0 * b0; c10 += a1 * b0; c20 += a2 * b0; c30 += a3 * b0;
+		c01 += a0 * b1; c11 += a1 * b1; c21 += a2 * b1; c31 += a3 * b1;
+		c02 += a0 * b2; c12 += a1 * b2; c22 += a2 * b2; c32 += a3 * b2;
+		c03 += a0 * b3; c13 += a1 * b3; c23 += a2 * b3; c33 += a3 * b3;
+		pa += DGEMM_MR;
+		pb += DGEMM_NR;
+	}
+	double ab [DGEMM_MR * DGEMM_NR] = {
+		c00, c10, c20, c30, c01, c11, c21, c31, c02, c12, c22, c32, c03, c13, c23, c33 };
+	if (mr == DGEMM_MR && nr == DGEMM_NR) {
+		for (int j = 0; j < DGEMM_NR; j ++) {
+			double *cj = c + j * ldc;
+			cj [0] += alpha * ab [j * DGEMM_MR];
+			cj [1] += alpha * ab [1 + j * DGEMM_MR];
+			cj [2] += alpha * ab [2 + j * DGEMM_MR];
+			cj [3] += alpha * ab [3 + j * DGEMM_MR];
+		}
+		return;
+	}
+	for (long j = 0; j < nr; j ++) {
+		for (long i = 0; i < mr; i ++) {
+			c [i + j * ldc] += alpha * ab [i + j * DGEMM_MR];
+		}
+	}
+}
+
+/*
+	C [0..m-1, j0..j0+n-1] += alpha * op(A) * op(B) [.., j0..j0+n-1], with 0-based column-major storage.
+	packedA must hold dgemm_packedASize (m, k), packedB dgemm_packedBSize (k, n) numbers.
+*/
+static long dgemm_packedASize (long m, long k) {
+	return (MIN (DGEMM_MC, m) + DGEMM_MR - 1) / DGEMM_MR * DGEMM_MR * MIN (DGEMM_KC, k);   // panels are padded to whole micro tiles
+}
+
+static long dgemm_packedBSize (long k, long n) {
+	return MIN (DGEMM_KC, k) * ((MIN (DGEMM_NC, n) + DGEMM_NR - 1) / DGEMM_NR * DGEMM_NR);
+}
+
+static void dgemm_blocked (bool transa, bool transb, long m, long j0, long n, long k, double alpha,
+	const double *a, long lda, const double *b, long ldb, double *c, long ldc, double *packedA, double *packedB)
+{
+	for (long jc = j0; jc < j0 + n; jc += DGEMM_NC) {
+		long nc = MIN (DGEMM_NC, j0 + n - jc);
+		for (long pc = 0; pc < k; pc += DGEMM_KC) {
+			long kc = MIN (DGEMM_KC, k - pc);
+			dgemm_packB (transb, b, ldb, pc, jc, kc, nc, packedB);
+			for (long ic = 0; ic < m; ic += DGEMM_MC) {
+				long mc = MIN (DGEMM_MC, m - ic);
+				dgemm_packA (transa, a, lda, ic, pc, mc, kc, packedA);
+				for (long jr = 0; jr < nc; jr += DGEMM_NR) {
+					long nr = MIN (DGEMM_NR, nc - jr);
+					for (long ir = 0; ir < mc; ir += DGEMM_MR) {
+						long mr = MIN (DGEMM_MR, mc - ir);
+						dgemm_microKernel (kc, packedA + ir * kc, packedB + jr * kc, alpha,
+							c + (ic + ir) + (jc + jr) * ldc, ldc, mr, nr);
+					}
+				}
+			}
+		}
+	}
+}
+
+Thing_define (NUMblas_dgemm_Args, Thing) { public:
+	bool transa, transb;
+	long m, j0, n, k;
+	double alpha;
+	const double *a, *b;
+	double *c;
+	long lda, ldb, ldc;
+	autoNUMvector <double> packedA, packedB;
+};
+
+Thing_implement (NUMblas_dgemm_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE NUMblas_dgemm_thread (NUMblas_dgemm_Args me) {
+	dgemm_blocked (my transa, my transb, my m, my j0, my n, my k, my alpha, my a, my lda, my b, my ldb, my c, my ldc,
+		my packedA.peek(), my packedB.peek());
+	MelderThread_RETURN;
+}
+
+static void dgemm_run (bool transa, bool transb, long m, long n, long k, double alpha,
+	const double *a, long lda, const double *b, long ldb, double *c, long ldc)
+{
+	/*
+		Use about 2^26 multiplications per thread at least, otherwise starting threads costs more than it saves.
+	*/
+	double numberOfMultiplications = (double) m * (double) n * (double) k;
+	int numberOfThreads = (int) MIN ((double) MelderThread_getNumberOfProcessors (), numberOfMultiplications / 67108864.0);
+	numberOfThreads = MIN (numberOfThreads, (int) ((n + DGEMM_NR - 1) / DGEMM_NR));
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	long numberOfColumnsPerThread = ((n + numberOfThreads - 1) / numberOfThreads + DGEMM_NR - 1) / DGEMM_NR * DGEMM_NR;
+	numberOfThreads = (int) ((n + numberOfColumnsPerThread - 1) / numberOfColumnsPerThread);
+
+	autoNUMblas_dgemm_Args args [16];
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoNUMblas_dgemm_Args arg = Thing_new (NUMblas_dgemm_Args);
+		arg -> transa = transa;
+		arg -> transb = transb;
+		arg -> m = m;
+		arg -> j0 = (ithread - 1) * numberOfColumnsPerThread;
+		arg -> n = MIN (numberOfColumnsPerThread, n - arg -> j0);
+		arg -> k = k;
+		arg -> alpha = alpha;
+		arg -> a = a;
+		arg -> lda = lda;
+		arg -> b = b;
+		arg -> ldb = ldb;
+		arg -> c = c;
+		arg -> ldc = ldc;
+		arg -> packedA.reset (0, dgemm_packedASize (m, k) - 1);
+		arg -> packedB.reset (0, dgemm_packedBSize (k, arg -> n) - 1);
+		args [ithread - 1] = arg.move();
+	}
+	MelderThread_run (NUMblas_dgemm_thread, args, numberOfThreads);
+}
+
 int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, long *k, double *alpha, double *a, long *lda,
                    double *b, long *ldb, double *beta, double *c__, long *ldc) {
 	/* System generated locals */
 	long a_dim1, a_offset, b_dim1, b_offset, c_dim1, c_offset, i__1, i__2, i__3;
 
-	/* Local variables */
-	static long info;
-	static long nota, notb;
-	static double temp;
-	static long i__, j, l, ncola;
-	static long nrowa, nrowb;
+	/* Local variables (not static: this routine has to be reentrant) */
+	long info;
+	long nota, notb;
+	double temp;
+	long i__, j, l;
+	long nrowa, nrowb;
 
 #define a_ref(a_1,a_2) a[(a_2)*a_dim1 + a_1]
 #define b_ref(a_1,a_2) b[(a_2)*b_dim1 + a_1]
@@ -258,10 +430,8 @@ int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, lon
 	notb = lsame_ (transb, "N");
 	if (nota) {
 		nrowa = *m;
-		ncola = *k;
 	} else {
 		nrowa = *k;
-		ncola = *m;
 	}
 	if (notb) {
 		nrowb = *k;
@@ -295,50 +465,40 @@ int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, lon
 	if (*m == 0 || *n == 0 || ((*alpha == 0. || *k == 0) && *beta == 1.)) {
 		return 0;
 	}
-	/* And if alpha.eq.zero. */
-	if (*alpha == 0.) {
-		if (*beta == 0.) {
-			i__1 = *n;
-			for (j = 1; j <= i__1; ++j) {
-				i__2 = *m;
+	/* Form C := beta*C. */
+	if (*beta != 1.) {
+		i__1 = *n;
+		for (j = 1; j <= i__1; ++j) {
+			i__2 = *m;
+			if (*beta == 0.) {
 				for (i__ = 1; i__ <= i__2; ++i__) {
 					c___ref (i__, j) = 0.;
-					/* L10: */
 				}
-				/* L20: */
-			}
-		} else {
-			i__1 = *n;
-			for (j = 1; j <= i__1; ++j) {
-				i__2 = *m;
+			} else {
 				for (i__ = 1; i__ <= i__2; ++i__) {
 					c___ref (i__, j) = *beta * c___ref (i__, j);
-					/* L30: */
 				}
-				/* L40: */
 			}
 		}
+	}
+	if (*alpha == 0. || *k == 0) {
+		return 0;
+	}
+	/*
+		Large products go through the blocked kernel;
+		for small ones, packing would cost more than it saves.
+		This is also true if C has only a few rows or columns, because then every packed number is used only a few times.
+	*/
+	if ((double) *m * (double) *n * (double) *k >= 65536.0 && *m >= 2 * DGEMM_MR && *n >= 2 * DGEMM_NR) {
+		dgemm_run (! nota, ! notb, *m, *n, *k, *alpha, & a_ref (1, 1), *lda, & b_ref (1, 1), *ldb, & c___ref (1, 1), *ldc);
 		return 0;
 	}
 	/* Start the operations. */
 	if (notb) {
 		if (nota) {
-			/* Form C := alpha*A*B + beta*C. */
+			/* Form C := alpha*A*B + C. */
 			i__1 = *n;
 			for (j = 1; j <= i__1; ++j) {
-				if (*beta == 0.) {
-					i__2 = *m;
-					for (i__ = 1; i__ <= i__2; ++i__) {
-						c___ref (i__, j) = 0.;
-						/* L50: */
-					}
-				} else if (*beta != 1.) {
-					i__2 = *m;
-					for (i__ = 1; i__ <= i__2; ++i__) {
-						c___ref (i__, j) = *beta * c___ref (i__, j);
-						/* L60: */
-					}
-				}
 				i__2 = *k;
 				for (l = 1; l <= i__2; ++l) {
 					if (b_ref (l, j) != 0.) {
@@ -346,15 +506,12 @@ int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, lon
 						i__3 = *m;
 						for (i__ = 1; i__ <= i__3; ++i__) {
 							c___ref (i__, j) = c___ref (i__, j) + temp * a_ref (i__, l);
-							/* L70: */
 						}
 					}
-					/* L80: */
 				}
-				/* L90: */
 			}
 		} else {
-			/* Form C := alpha*A'*B + beta*C */
+			/* Form C := alpha*A'*B + C */
 			i__1 = *n;
 			for (j = 1; j <= i__1; ++j) {
 				i__2 = *m;
@@ -363,36 +520,16 @@ int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, lon
 					i__3 = *k;
 					for (l = 1; l <= i__3; ++l) {
 						temp += a_ref (l, i__) * b_ref (l, j);
-						/* L100: */
 					}
-					if (*beta == 0.) {
-						c___ref (i__, j) = *alpha * temp;
-					} else {
-						c___ref (i__, j) = *alpha * temp + *beta * c___ref (i__, j);
-					}
-					/* L110: */
+					c___ref (i__, j) += *alpha * temp;
 				}
-				/* L120: */
 			}
 		}
 	} else {
 		if (nota) {
-			/* Form C := alpha*A*B' + beta*C */
+			/* Form C := alpha*A*B' + C */
 			i__1 = *n;
 			for (j = 1; j <= i__1; ++j) {
-				if (*beta == 0.) {
-					i__2 = *m;
-					for (i__ = 1; i__ <= i__2; ++i__) {
-						c___ref (i__, j) = 0.;
-						/* L130: */
-					}
-				} else if (*beta != 1.) {
-					i__2 = *m;
-					for (i__ = 1; i__ <= i__2; ++i__) {
-						c___ref (i__, j) = *beta * c___ref (i__, j);
-						/* L140: */
-					}
-				}
 				i__2 = *k;
 				for (l = 1; l <= i__2; ++l) {
 					if (b_ref (j, l) != 0.) {
@@ -400,15 +537,12 @@ int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, lon
 						i__3 = *m;
 						for (i__ = 1; i__ <= i__3; ++i__) {
 							c___ref (i__, j) = c___ref (i__, j) + temp * a_ref (i__, l);
-							/* L150: */
 						}
 					}
-					/* L160: */
 				}
-				/* L170: */
 			}
 		} else {
-			/* Form C := alpha*A'*B' + beta*C */
+			/* Form C := alpha*A'*B' + C */
 			i__1 = *n;
 			for (j = 1; j <= i__1; ++j) {
 				i__2 = *m;
@@ -417,16 +551,9 @@ int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, lon
 					i__3 = *k;
 					for (l = 1; l <= i__3; ++l) {
 						temp += a_ref (l, i__) * b_ref (j, l);
-						/* L180: */
 					}
-					if (*beta == 0.) {
-						c___ref (i__, j) = *alpha * temp;
-					} else {
-						c___ref (i__, j) = *alpha * temp + *beta * c___ref (i__, j);
-					}
-					/* L190: */
+					c___ref (i__, j) += *alpha * temp;
 				}
-				/* L200: */
 			}
 		}
 	}
@@ -529,11 +656,11 @@ int NUMblas_dgemv (const char *trans, long *m, long *n, double *alpha, double *a
 	/* System generated locals */
 	long a_dim1, a_offset, i__1, i__2;
 
-	/* Local variables */
-	static long info;
-	static double temp;
-	static long lenx, leny, i__, j;
-	static long ix, iy, jx, jy, kx, ky;
+	/* Local variables (not static: this routine has to be reentrant) */
+	long info;
+	double temp;
+	long lenx, leny, i__, j;
+	long ix, iy, jx, jy, kx, ky;
 
 #define a_ref(a_1,a_2) a[(a_2)*a_dim1 + a_1]
 
@@ -628,8 +755,22 @@ int NUMblas_dgemv (const char *trans, long *m, long *n, double *alpha, double *a
 		/* Form y := alpha*A*x + y. */
 		jx = kx;
 		if (*incy == 1) {
+			/*
+				Four columns at a time: y is read and written once for every four columns of A.
+			*/
+			i__1 = *n - 3;
+			for (j = 1; j <= i__1; j += 4) {
+				double temp0 = *alpha * x[jx], temp1 = *alpha * x[jx + *incx];
+				double temp2 = *alpha * x[jx + 2 * *incx], temp3 = *alpha * x[jx + 3 * *incx];
+				const double *a0 = & a_ref (1, j), *a1 = & a_ref (1, j + 1), *a2 = & a_ref (1, j + 2), *a3 = & a_ref (1, j + 3);
+				i__2 = *m;
+				for (i__ = 0; i__ < i__2; ++i__) {
+					y[i__ + 1] += temp0 * a0[i__] + temp1 * a1[i__] + temp2 * a2[i__] + temp3 * a3[i__];
+				}
+				jx += 4 * *incx;
+			}
 			i__1 = *n;
-			for (j = 1; j <= i__1; ++j) {
+			for (; j <= i__1; ++j) {
 				if (x[jx] != 0.) {
 					temp = *alpha * x[jx];
 					i__2 = *m;
@@ -662,8 +803,29 @@ int NUMblas_dgemv (const char *trans, long *m, long *n, double *alpha, double *a
 		/* Form y := alpha*A'*x + y. */
 		jy = ky;
 		if (*incx == 1) {
+			/*
+				Four columns at a time: x is read once for every four dot products.
+			*/
+			i__1 = *n - 3;
+			for (j = 1; j <= i__1; j += 4) {
+				double temp0 = 0., temp1 = 0., temp2 = 0., temp3 = 0.;
+				const double *a0 = & a_ref (1, j), *a1 = & a_ref (1, j + 1), *a2 = & a_ref (1, j + 2), *a3 = & a_ref (1, j + 3);
+				i__2 = *m;
+				for (i__ = 0; i__ < i__2; ++i__) {
+					double xi = x[i__ + 1];
+					temp0 += a0[i__] * xi;
+					temp1 += a1[i__] * xi;
+					temp2 += a2[i__] * xi;
+					temp3 += a3[i__] * xi;
+				}
+				y[jy] += *alpha * temp0;
+				y[jy + *incy] += *alpha * temp1;
+				y[jy + 2 * *incy] += *alpha * temp2;
+				y[jy + 3 * *incy] += *alpha * temp3;
+				jy += 4 * *incy;
+			}
 			i__1 = *n;
-			for (j = 1; j <= i__1; ++j) {
+			for (; j <= i__1; ++j) {
 				temp = 0.;
 				i__2 = *m;
 				for (i__ = 1; i__ <= i__2; ++i__) {
@@ -2156,6 +2318,92 @@ int NUMblas_dsyr2k (const char *uplo, const char *trans, long *n, long *k, doubl
 #undef b_ref
 #undef a_ref
 
+int NUMblas_dsyrk (const char *uplo, const char *trans, long *n, long *k, double *alpha, double *a, long *lda,
+	double *beta, double *c__, long *ldc)
+{
+	long a_dim1 = *lda, c_dim1 = *ldc;
+#define a_ref(a_1,a_2) a[((a_2) - 1)*a_dim1 + (a_1) - 1]
+#define c___ref(a_1,a_2) c__[((a_2) - 1)*c_dim1 + (a_1) - 1]
+	long upper = lsame_ (uplo, "U");
+	long notrans = lsame_ (trans, "N");
+	long nrowa = notrans ? *n : *k;
+	long info = 0;
+	if (! upper && ! lsame_ (uplo, "L")) {
+		info = 1;
+	} else if (! notrans && ! lsame_ (trans, "T") && ! lsame_ (trans, "C")) {
+		info = 2;
+	} else if (*n < 0) {
+		info = 3;
+	} else if (*k < 0) {
+		info = 4;
+	} else if (*lda < MAX (1, nrowa)) {
+		info = 7;
+	} else if (*ldc < MAX (1, *n)) {
+		info = 10;
+	}
+	if (info != 0) {
+		xerbla_ ("DSYRK ", &info);
+		return 0;
+	}
+	if (*n == 0 || ((*alpha == 0. || *k == 0) && *beta == 1.)) {
+		return 0;
+	}
+	/* Form C := beta*C on the referenced triangle. */
+	if (*beta != 1.) {
+		for (long j = 1; j <= *n; j ++) {
+			long ifirst = upper ? 1 : j, ilast = upper ? j : *n;
+			for (long i = ifirst; i <= ilast; i ++) {
+				c___ref (i, j) = *beta == 0. ? 0. : *beta * c___ref (i, j);
+			}
+		}
+	}
+	if (*alpha == 0. || *k == 0) {
+		return 0;
+	}
+	/*
+		Go through C in column blocks. The triangle inside each diagonal block is computed directly,
+		the rectangle outside it (above the block for 'U', below it for 'L') by the blocked NUMblas_dgemm.
+	*/
+	const long blockSize = 64;
+	double one = 1.0;
+	for (long jb = 1; jb <= *n; jb += blockSize) {
+		long nb = MIN (blockSize, *n - jb + 1);
+		for (long j = jb; j < jb + nb; j ++) {
+			long ifirst = upper ? jb : j, ilast = upper ? j : jb + nb - 1;
+			if (notrans) {
+				for (long l = 1; l <= *k; l ++) {
+					double temp = *alpha * a_ref (j, l);
+					if (temp != 0.) {
+						for (long i = ifirst; i <= ilast; i ++) {
+							c___ref (i, j) += temp * a_ref (i, l);
+						}
+					}
+				}
+			} else {
+				for (long i = ifirst; i <= ilast; i ++) {
+					double temp = 0.;
+					for (long l = 1; l <= *k; l ++) {
+						temp += a_ref (l, i) * a_ref (l, j);
+					}
+					c___ref (i, j) += *alpha * temp;
+				}
+			}
+		}
+		long mrest = upper ? jb - 1 : *n - (jb + nb) + 1;
+		if (mrest > 0) {
+			long irest = upper ? 1 : jb + nb;
+			if (notrans) {
+				NUMblas_dgemm ("N", "T", & mrest, & nb, k, alpha, & a_ref (irest, 1), lda, & a_ref (jb, 1), lda, & one, & c___ref (irest, jb), ldc);
+			} else {
+				NUMblas_dgemm ("T", "N", & mrest, & nb, k, alpha, & a_ref (1, irest), lda, & a_ref (1, jb), lda, & one, & c___ref (irest, jb), ldc);
+			}
+		}
+	}
+	return 0;
+#undef c___ref
+#undef a_ref
+}								/* NUMblas_dsyrk */
+
 int NUMblas_dtrmm (const char *side, const char *uplo, const char *transa, const char *diag, long *m, long *n, double *alpha, double *a,
                    long *lda, double *b, long *ldb) {
 	/* System generated locals */
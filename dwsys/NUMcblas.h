@@ -543,6 +543,37 @@ int NUMblas_dsyr2k (const char *uplo, const char *trans, long *n, long *k, doubl
     Level 3 Blas routine.
 */
 
+int NUMblas_dsyrk (const char *uplo, const char *trans, long *n, long *k, double *alpha, double *a,
+	long *lda, double *beta, double *c, long *ldc);
+/*  Purpose
+    =======
+    NUMblas_dsyrk  performs one of the symmetric rank k operations
+       C := alpha*A*A' + beta*C,
+    or
+       C := alpha*A'*A + beta*C,
+    where  alpha and beta  are scalars, C is an  n by n  symmetric matrix
+    and  A  is an  n by k  matrix in the first case and a  k by n  matrix
+    in the second case.
+    The off-diagonal blocks of C are computed with NUMblas_dgemm.
+    Parameters
+    ==========
+    UPLO   - char*.
+             'U': only the upper triangular part of C is referenced and updated;
+             'L': only the lower triangular part of C is referenced and updated.
+    TRANS  - char*.
+             'N': C := alpha*A*A' + beta*C;
+             'T' or 'C': C := alpha*A'*A + beta*C.
+    N      - long. The order of the matrix C. N >= 0.
+    K      - long. The number of columns of A if TRANS = 'N', its number of rows otherwise. K >= 0.
+    ALPHA  - double.
+    A      - double array of DIMENSION ( LDA, ka ), where ka is k when TRANS = 'N', and n otherwise.
+    LDA    - long. At least max( 1, n ) when TRANS = 'N', at least max( 1, k ) otherwise.
+    BETA   - double.
+    C      - double array of DIMENSION ( LDC, n ).
+    LDC    - long. At least max( 1, n ).
+    Level 3 Blas routine.
+*/
+
 int NUMblas_dtrmm (const char *side, const char *uplo, const char *transa, const char *diag,
 	long *m, long *n, double *alpha, double *a, long *lda,
 	double *b, long *ldb);
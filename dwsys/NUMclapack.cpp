@@ -15,6 +15,7 @@
 #include "NUMcblas.h"
 #include "NUM2.h"
 #include "melder.h"
+#include "MelderThread.h"
 
 /* Table of constant values */
 
@@ -20346,4 +20347,19 @@ L1100:
 #undef MAX
 #undef MIN
 
+MelderThread_MUTEX (NUMlapack_mutex);
+static bool NUMlapack_mutex_inited;
+
+void NUMlapack_initLock () {
+	if (! NUMlapack_mutex_inited) { MelderThread_MUTEX_INIT (NUMlapack_mutex); NUMlapack_mutex_inited = true; }
+}
+
+void NUMlapack_lock () {
+	MelderThread_LOCK (NUMlapack_mutex);
+}
+
+void NUMlapack_unlock () {
+	MelderThread_UNLOCK (NUMlapack_mutex);
+}
+
 /* End of file NUMclapack.c */
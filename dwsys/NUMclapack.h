@@ -6608,4 +6608,13 @@ long NUMlapack_ilaenv (long *ispec, const char *name, const char *opts, long *n1
     =====================================================================
 */
 
+/*
+	The translated routines keep their local variables in static storage, so they are not reentrant.
+	Threads that call them take turns by holding the LAPACK lock.
+	NUMlapack_initLock has to be called in the main thread before such threads start.
+*/
+void NUMlapack_initLock ();
+void NUMlapack_lock ();
+void NUMlapack_unlock ();
+
 #endif /* _NUMclapack_h_ */
@@ -61,7 +61,7 @@ static double NUMgauss (double x) {
 	return NUM1_sqrt2pi * exp (- 0.5 * x * x);
 }
 
-void NUMstatistics_huber (double *x, long n, double *location, int wantlocation,
+bool NUMstatistics_huber (double *x, long n, double *location, int wantlocation,
                           double *scale, int wantscale, double k, double tol, double *work) {
 	double *tmp = work;
 	double theta = 2.0 * NUMgaussP (k) - 1.0;
@@ -79,7 +79,7 @@ void NUMstatistics_huber (double *x, long n, double *location, int wantlocation,
 		*scale = mad;
 	}
 	if (*scale == 0) {
-		Melder_throw (U"Scale is zero.");
+		return false;   // scale is zero
 	}
 
 	double mu0, mu1 = *location;
@@ -128,4 +128,5 @@ void NUMstatistics_huber (double *x, long n, double *location, int wantlocation,
 	if (wantscale) {
 		*scale = s1;
 	}
+	return true;
 }
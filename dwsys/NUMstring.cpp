@@ -130,13 +130,16 @@ void NUMstring_add (unsigned char *a, unsigned char *b, unsigned char *c, long n
 
 char32 *strstr_regexp (const char32 *string, const char32 *search_regexp) {
 	char32 *charp = 0;
-	regexp *compiled_regexp = CompileRE_throwable (search_regexp, 0);
+	const char32 *compileMessage;
+	regexp *compiled_regexp = CompileRE_cached (search_regexp, & compileMessage, 0);   // owned by the cache
+	if (compiled_regexp == NULL) {
+		Melder_throw (U"Regular expression: ", compileMessage, U".");
+	}
 
 	if (ExecRE (compiled_regexp, NULL, string, NULL, 0, '\0', '\0', NULL, NULL, NULL)) {
 		charp = compiled_regexp -> startp[0];
 	}
 
-	free (compiled_regexp);
 	return charp;
 }
 
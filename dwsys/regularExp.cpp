@@ -521,6 +521,7 @@ static void tail (char32 *search_from, char32 *point_t);
 static char32 *shortcut_escape (char32 c, int *flag_param, int emit);
 
 static int             init_ansi_classes ();
+static long            nfa_program_size (regexp *prog, unsigned long size);
 
 /*----------------------------------------------------------------------*
  * CompileRE
@@ -675,9 +676,71 @@ regexp *CompileRE (const char32 *exp, const char32 **errorText, int defaultFlags
 		}
 	}
 
+	comp_regex->nfa_size = nfa_program_size (comp_regex, Reg_Size + 1);
+
 	return (comp_regex);
 }
 
+/*----------------------------------------------------------------------*
+ * CompileRE_cached
+ *
+ * Callers that test many strings against the same few expressions (e.g.
+ * one per interval of a tier or per row of a table) would otherwise
+ * compile the same expression over and over again. We keep the most
+ * recently used compiled expressions and throw out the least recently
+ * used one when the cache is full.
+ *----------------------------------------------------------------------*/
+
+#define COMPILED_CACHE_SIZE  32
+
+static struct {
+	char32 *exp;
+	int defaultFlags, countingQuantifier;
+	regexp *compiled;
+	unsigned long lastUse;
+} Compiled_Cache [COMPILED_CACHE_SIZE];
+static unsigned long Compiled_Cache_Clock;
+
+regexp *CompileRE_cached (const char32 *exp, const char32 **errorText, int defaultFlags) {
+	int i, oldest = 0;
+	regexp *compiled;
+
+	if (exp == NULL) {
+		return CompileRE (exp, errorText, defaultFlags);
+	}
+
+	for (i = 0; i < COMPILED_CACHE_SIZE; i++) {
+		if (Compiled_Cache [i].compiled != NULL &&
+		        Compiled_Cache [i].defaultFlags == defaultFlags &&
+		        Compiled_Cache [i].countingQuantifier == Enable_Counting_Quantifier &&
+		        str32equ (Compiled_Cache [i].exp, exp)) {
+			Compiled_Cache [i].lastUse = ++Compiled_Cache_Clock;
+			*errorText = U"";
+			return Compiled_Cache [i].compiled;
+		}
+
+		if (Compiled_Cache [i].lastUse < Compiled_Cache [oldest].lastUse) {
+			oldest = i;
+		}
+	}
+
+	compiled = CompileRE (exp, errorText, defaultFlags);
+
+	if (compiled == NULL) {
+		return NULL;
+	}
+
+	free (Compiled_Cache [oldest].compiled);
+	Melder_free (Compiled_Cache [oldest].exp);
+	Compiled_Cache [oldest].exp = Melder_dup_f (exp);
+	Compiled_Cache [oldest].defaultFlags = defaultFlags;
+	Compiled_Cache [oldest].countingQuantifier = Enable_Counting_Quantifier;
+	Compiled_Cache [oldest].compiled = compiled;
+	Compiled_Cache [oldest].lastUse = ++Compiled_Cache_Clock;
+
+	return compiled;
+}
+
 /*----------------------------------------------------------------------*
  * chunk                                                                *
  *                                                                      *
@@ -4025,6 +4088,459 @@ static unsigned long greedy (char32 *p, long max) {
 	return (count);
 }
 
+/*----------------------------------------------------------------------*
+ * nfa_program_size
+ *
+ * Returns the number of positions in the compiled program if every node
+ * that can be reached from its start can be simulated by `MatchesRE',
+ * i.e. if there are no back references, no look-ahead or look-behind and
+ * no {m,n} counting; returns 0 otherwise.
+ *----------------------------------------------------------------------*/
+
+static int is_simple_node (char32 *p) {
+	switch (GET_OP_CODE (p)) {
+		case ANY: case EVERY: case EXACTLY: case SIMILAR: case ANY_OF: case ANY_BUT:
+		case IS_DELIM: case NOT_DELIM: case WORD_CHAR: case NOT_WORD_CHAR:
+		case DIGIT: case NOT_DIGIT: case SPACE: case SPACE_NL: case NOT_SPACE:
+		case NOT_SPACE_NL: case LETTER: case NOT_LETTER:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+static long nfa_program_size (regexp *prog, unsigned long size) {
+	char *visited = (char *) calloc (size, 1);
+	char32 **stack = (char32 **) malloc (size * sizeof (char32 *));
+	long result = (long) size;
+	unsigned long depth = 0;
+
+	if (visited == NULL || stack == NULL) {
+		result = 0;
+	} else {
+		stack [depth++] = prog->program + REGEX_START_OFFSET;
+		visited [REGEX_START_OFFSET] = 1;
+
+		while (depth > 0 && result > 0) {
+			char32 *scan = stack [--depth];
+			char32 *next = next_ptr (scan);
+			int op = GET_OP_CODE (scan);
+
+			switch (op) {
+				case END: case BOL: case EOL: case BOWORD: case EOWORD: case NOT_BOUNDARY:
+				case NOTHING: case BACK:
+					break;
+
+				case BRANCH: {
+					char32 *operand = OPERAND (scan);
+
+					if (!visited [operand - prog->program]) {
+						visited [operand - prog->program] = 1;
+						stack [depth++] = operand;
+					}
+				}
+				break;
+
+				case STAR: case LAZY_STAR: case PLUS: case LAZY_PLUS: case QUESTION: case LAZY_QUESTION:
+					if (!is_simple_node (OPERAND (scan))) {
+						result = 0;
+					}
+
+					break;
+
+				default:
+					if (is_simple_node (scan)) {
+						break;
+					}
+
+					if ( (op > OPEN && op < OPEN + NSUBEXP) || (op > CLOSE && op < CLOSE + NSUBEXP)) {
+						break;
+					}
+
+					result = 0;   /* Back references, look-around, counting. */
+			}
+
+			if (next != NULL && !visited [next - prog->program]) {
+				visited [next - prog->program] = 1;
+				stack [depth++] = next;
+			}
+		}
+	}
+
+	free (visited);
+	free (stack);
+	return result;
+}
+
+/*----------------------------------------------------------------------*
+ * MatchesRE
+ *
+ * Instead of trying every starting point in turn and backtracking into
+ * every alternative, as `match' does, we run all of them at once: the
+ * program is a nondeterministic automaton, and we keep the set of nodes
+ * it can be in after each character (Thompson's simulation). A new
+ * attempt starts at every position, as in `ExecRE'. Every node enters the
+ * set at most once per character, so the time is linear in the length of
+ * the string.
+ *
+ * A state is a node plus, for EXACTLY and SIMILAR, the number of operand
+ * characters already matched, or, for PLUS, whether the operand has been
+ * matched at least once. Its index `node + sub' is unique, because it
+ * points into the node itself.
+ *----------------------------------------------------------------------*/
+
+typedef struct nfa_state {
+	char32 *node;
+	int     sub;
+} nfa_state;
+
+static nfa_state     *Nfa_List [2];           /* Current and next state sets. */
+static long           Nfa_Length [2];
+static nfa_state     *Nfa_Stack;              /* Work stack for the epsilon closure. */
+static unsigned long *Nfa_Mark;               /* Generation in which a state was added. */
+static unsigned long  Nfa_Generation;
+static long           Nfa_Capacity;
+static char32        *Nfa_Program;
+static int            Nfa_Matched;
+
+#define IS_DELIMITER(c)  ((c) < UCHAR_MAX && Current_Delimiters [(c)])
+
+static int nfa_reserve (long size) {
+	if (size <= Nfa_Capacity) {
+		return 1;
+	}
+
+	free (Nfa_List [0]);
+	free (Nfa_List [1]);
+	free (Nfa_Stack);
+	free (Nfa_Mark);
+	Nfa_List [0] = (nfa_state *) malloc (size * sizeof (nfa_state));
+	Nfa_List [1] = (nfa_state *) malloc (size * sizeof (nfa_state));
+	Nfa_Stack    = (nfa_state *) malloc (size * sizeof (nfa_state));
+	Nfa_Mark     = (unsigned long *) calloc (size, sizeof (unsigned long));
+	Nfa_Generation = 0;
+
+	if (Nfa_List [0] == NULL || Nfa_List [1] == NULL || Nfa_Stack == NULL || Nfa_Mark == NULL) {
+		Nfa_Capacity = 0;
+		return 0;
+	}
+
+	Nfa_Capacity = size;
+	return 1;
+}
+
+/* Does the single-character node `scan' accept `c'? The same tests as in `match'. */
+
+static int nfa_node_accepts (char32 *scan, char32 c) {
+	switch (GET_OP_CODE (scan)) {
+		case IS_DELIM:      return IS_DELIMITER (c);
+		case NOT_DELIM:     return !IS_DELIMITER (c);
+		case WORD_CHAR:     return isalnum ( (int) c) || c == '_';
+		case NOT_WORD_CHAR: return !isalnum ( (int) c) && c != '_' && c != '\n';
+		case ANY:           return c != '\n';
+		case EVERY:         return 1;
+		case DIGIT:         return isdigit ( (int) c);
+		case NOT_DIGIT:     return !isdigit ( (int) c) && c != '\n';
+		case LETTER:        return isalpha ( (int) c);
+		case NOT_LETTER:    return !isalpha ( (int) c) && c != '\n';
+		case SPACE:         return isspace ( (int) c) && c != '\n';
+		case SPACE_NL:      return isspace ( (int) c);
+		case NOT_SPACE:     return !isspace ( (int) c);
+		case NOT_SPACE_NL:  return !isspace ( (int) c) || c == '\n';
+		case ANY_OF:        return str32chr (OPERAND (scan), c) != NULL;
+		case ANY_BUT:       return str32chr (OPERAND (scan), c) == NULL;
+		default:            return 0;
+	}
+}
+
+/* Does the operand `p' of a STAR, PLUS or QUESTION accept `c'? The same tests as in `greedy'. */
+
+static int nfa_operand_accepts (char32 *p, char32 c) {
+	char32 *operand = OPERAND (p);
+
+	switch (GET_OP_CODE (p)) {
+		case ANY:           return c != '\n';
+		case EVERY:         return 1;
+		case EXACTLY:       return *operand == c;
+		case SIMILAR:       return *operand == (char32) towlower ( (int) c);
+		case ANY_OF:        return str32chr (operand, c) != NULL;
+		case ANY_BUT:       return str32chr (operand, c) == NULL;
+		case IS_DELIM:      return IS_DELIMITER (c);
+		case NOT_DELIM:     return !IS_DELIMITER (c);
+		case WORD_CHAR:     return iswalnum ( (int) c) || c == U'_';
+		case NOT_WORD_CHAR: return !iswalnum ( (int) c) && c != U'_' && c != U'\n';
+		case DIGIT:         return isdigit ( (int) c);
+		case NOT_DIGIT:     return !iswdigit ( (int) c) && c != U'\n';
+		case SPACE:         return iswspace ( (int) c) && c != U'\n';
+		case SPACE_NL:      return iswspace ( (int) c);
+		case NOT_SPACE:     return !iswspace ( (int) c);
+		case NOT_SPACE_NL:  return !iswspace ( (int) c) || c == '\n';
+		case LETTER:        return iswalpha ( (int) c);
+		case NOT_LETTER:    return !iswalpha ( (int) c) && c != '\n';
+		default:            return 0;
+	}
+}
+
+/* Is the position `here' at a word delimiter, looking backward resp. forward? */
+
+static int nfa_prev_is_delim (const char32 *here) {
+	return here == Start_Of_String ? Prev_Is_Delim : IS_DELIMITER (* (here - 1));
+}
+
+static int nfa_current_is_delim (const char32 *here) {
+	return *here == '\0' ? Succ_Is_Delim : IS_DELIMITER (*here);
+}
+
+/* Add state (node, sub) to list `which', following all transitions that consume no input at `here'. */
+
+static void nfa_add (int which, char32 *node, int sub, const char32 *here) {
+	long depth = 0;
+	long key = (node - Nfa_Program) + sub;
+
+	if (Nfa_Mark [key] == Nfa_Generation) {
+		return;
+	}
+
+	Nfa_Mark [key] = Nfa_Generation;
+	Nfa_Stack [depth].node = node;
+	Nfa_Stack [depth++].sub = sub;
+
+	while (depth > 0) {
+		char32 *scan = Nfa_Stack [--depth].node;
+		int current_sub = Nfa_Stack [depth].sub;
+		char32 *next = next_ptr (scan);
+		int op = GET_OP_CODE (scan), consumes = 0;
+
+		switch (op) {
+			case END:
+				Nfa_Matched = 1;
+				next = NULL;
+				break;
+
+			case BRANCH:
+				if (GET_OP_CODE (next) != BRANCH) {
+					next = OPERAND (scan);
+				} else {
+					/* Every alternative of the chain; the chain itself leads nowhere else. */
+					for (; scan != NULL && GET_OP_CODE (scan) == BRANCH; scan = next_ptr (scan)) {
+						char32 *operand = OPERAND (scan);
+						long operand_key = operand - Nfa_Program;
+
+						if (Nfa_Mark [operand_key] != Nfa_Generation) {
+							Nfa_Mark [operand_key] = Nfa_Generation;
+							Nfa_Stack [depth].node = operand;
+							Nfa_Stack [depth++].sub = 0;
+						}
+					}
+
+					next = NULL;
+				}
+
+				break;
+
+			case BOL:
+				if (! (here == Start_Of_String ? Prev_Is_BOL : * (here - 1) == '\n')) {
+					next = NULL;
+				}
+
+				break;
+
+			case EOL:
+				if (! (*here == '\n' || (*here == '\0' && Succ_Is_EOL))) {
+					next = NULL;
+				}
+
+				break;
+
+			case BOWORD:
+				if (! (nfa_prev_is_delim (here) && !nfa_current_is_delim (here))) {
+					next = NULL;
+				}
+
+				break;
+
+			case EOWORD:
+				if (! (!nfa_prev_is_delim (here) && nfa_current_is_delim (here))) {
+					next = NULL;
+				}
+
+				break;
+
+			case NOT_BOUNDARY:
+				if (nfa_prev_is_delim (here) ^ nfa_current_is_delim (here)) {
+					next = NULL;
+				}
+
+				break;
+
+			case NOTHING:
+			case BACK:
+				break;
+
+			case STAR:
+			case LAZY_STAR:
+			case QUESTION:
+			case LAZY_QUESTION:
+				consumes = 1;   /* ...or skips. */
+				break;
+
+			case PLUS:
+			case LAZY_PLUS:
+				consumes = 1;
+
+				if (current_sub == 0) {
+					next = NULL;   /* At least one first. */
+				}
+
+				break;
+
+			default:
+				if ( (op > OPEN && op < OPEN + NSUBEXP) || (op > CLOSE && op < CLOSE + NSUBEXP)) {
+					break;
+				}
+
+				consumes = 1;   /* A single-character node, or EXACTLY or SIMILAR part-way. */
+				next = NULL;
+		}
+
+		if (consumes) {
+			nfa_state *state = & Nfa_List [which] [Nfa_Length [which]++];
+			state->node = scan;
+			state->sub = current_sub;
+		}
+
+		if (next != NULL) {
+			long next_key = next - Nfa_Program;
+
+			if (Nfa_Mark [next_key] != Nfa_Generation) {
+				Nfa_Mark [next_key] = Nfa_Generation;
+				Nfa_Stack [depth].node = next;
+				Nfa_Stack [depth++].sub = 0;
+			}
+		}
+	}
+}
+
+/* Move every state of list `from' over the character at `here' into list `to'. */
+
+static void nfa_step (int from, int to, const char32 *here) {
+	char32 c = *here;
+	const char32 *there = here + 1;
+
+	for (long i = 0; i < Nfa_Length [from]; i++) {
+		char32 *scan = Nfa_List [from] [i].node;
+		int sub = Nfa_List [from] [i].sub;
+
+		switch (GET_OP_CODE (scan)) {
+			case EXACTLY:
+			case SIMILAR: {
+				char32 *operand = OPERAND (scan);
+				char32 test = GET_OP_CODE (scan) == EXACTLY ? c : (char32) towlower ( (int) c);
+
+				if (operand [sub] == test) {
+					if (operand [sub + 1] == '\0') {
+						nfa_add (to, next_ptr (scan), 0, there);
+					} else {
+						nfa_add (to, scan, sub + 1, there);
+					}
+				}
+			}
+			break;
+
+			case STAR:
+			case LAZY_STAR:
+				if (nfa_operand_accepts (OPERAND (scan), c)) {
+					nfa_add (to, scan, 0, there);
+				}
+
+				break;
+
+			case PLUS:
+			case LAZY_PLUS:
+				if (nfa_operand_accepts (OPERAND (scan), c)) {
+					nfa_add (to, scan, 1, there);
+				}
+
+				break;
+
+			case QUESTION:
+			case LAZY_QUESTION:
+				if (nfa_operand_accepts (OPERAND (scan), c)) {
+					nfa_add (to, next_ptr (scan), 0, there);
+				}
+
+				break;
+
+			default:
+				if (nfa_node_accepts (scan, c)) {
+					nfa_add (to, next_ptr (scan), 0, there);
+				}
+		}
+	}
+}
+
+int MatchesRE (regexp *prog, const char32 *string) {
+	int current = 0;
+
+	if (prog == NULL || string == NULL || prog->nfa_size == 0 || !nfa_reserve (prog->nfa_size)) {
+		return ExecRE (prog, NULL, string, NULL, 0, '\0', '\0', NULL, NULL, NULL);
+	}
+
+	/* The same circumstances as ExecRE has for a whole string without context. */
+
+	Current_Delimiters = Default_Delimiters;
+	End_Of_String      = NULL;
+	Start_Of_String    = string;
+	Prev_Is_BOL        = 1;
+	Succ_Is_EOL        = 1;
+	Prev_Is_Delim      = IS_DELIMITER ('\0');
+	Succ_Is_Delim      = IS_DELIMITER ('\n');
+
+	Nfa_Program = prog->program;
+	Nfa_Matched = 0;
+	Nfa_Length [current] = 0;
+	Nfa_Generation++;
+
+	for (const char32 *here = string; ; here++) {
+		if (Nfa_Length [current] == 0) {
+			/* Nothing in progress: skip to where a match can start. */
+			if (prog->anchor && here != string) {
+				while (*here != '\0' && * (here - 1) != '\n') {
+					here++;
+				}
+
+				if (* (here - 1) != '\n') {
+					return 0;
+				}
+			} else if (prog->match_start != '\0') {
+				while (*here != '\0' && *here != prog->match_start) {
+					here++;
+				}
+			}
+		}
+
+		nfa_add (current, Nfa_Program + REGEX_START_OFFSET, 0, here);   /* A new attempt. */
+
+		if (Nfa_Matched) {
+			return 1;
+		}
+
+		if (*here == '\0') {
+			return 0;
+		}
+
+		Nfa_Generation++;
+		Nfa_Length [1 - current] = 0;
+		nfa_step (current, 1 - current, here);
+
+		if (Nfa_Matched) {
+			return 1;
+		}
+
+		current = 1 - current;
+	}
+}
+
 /*----------------------------------------------------------------------*
  * next_ptr - compute the address of a node's "NEXT" pointer.
  * Note: a simplified inline version is available via the NEXT_PTR() macro,
@@ -52,6 +52,7 @@ typedef struct regexp {
                                Used by syntax highlighting only. */
    char32  match_start;       /* Internal use only. */
    char32  anchor;            /* Internal use only. */
+   long    nfa_size;          /* Internal use only. */
    char32  program [1];       /* Unwarranted chumminess with compiler. */
 } regexp;
 
@@ -72,6 +73,15 @@ regexp * CompileRE (
 
 regexp *CompileRE_throwable (const char32 *exp, int defaultFlags);
 
+/* Same as `CompileRE', but remembers the most recently used expressions.
+   The result is owned by the cache and must not be freed; it stays valid
+   until the next call to `CompileRE_cached'. */
+
+regexp * CompileRE_cached (
+   const char32  *exp,
+   const char32 **errorText,
+   int  defaultFlags);
+
 /* Match a `regexp' structure against a string. */
 
 int ExecRE (
@@ -97,6 +107,13 @@ int ExecRE (
                                    set. Lookahead can cross the boundary. */
 
 
+/* Does `prog' match anywhere in `string'? The answer is the same as that of
+   ExecRE (prog, NULL, string, NULL, 0, '\0', '\0', NULL, NULL, NULL), but for
+   expressions without back references, look-around or counting constructs
+   the time taken is linear in the length of `string'. Sets no `startp'. */
+
+int MatchesRE (regexp *prog, const char32 *string);
+
 /* Perform substitutions after a `regexp' match. */
 
 int SubstituteRE (
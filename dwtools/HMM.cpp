@@ -24,6 +24,7 @@
 #include "Index.h"
 #include "NUM2.h"
 #include "Strings_extensions.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "HMM_def.h"
@@ -50,7 +51,7 @@ Thing_implement (HMMStateList, Ordered, 0);
 Thing_implement (HMMObservation, Daata, 0);
 Thing_implement (HMMObservationList, Ordered, 0);
 Thing_implement (HMMBaumWelch, Daata, 0);
-Thing_implement (HMMViterbi, Daata, 0);
+Thing_implement (HMMViterbi, Daata, 1);
 Thing_implement (HMMObservationSequence, Table, 0);
 Thing_implement (HMMObservationSequenceBag, Collection, 0);
 Thing_implement (HMMStateSequence, Strings, 0);
@@ -227,10 +228,9 @@ void HMMState_setLabel (HMMState me, char32 *label) {
 /**************** HMMBaumWelch ******************************/
 
 void structHMMBaumWelch :: v_destroy () noexcept {
-	for (long it = 1; it <= capacity; it ++) {
-		NUMmatrix_free (xi[it], 1, 1);
-	}
-	NUMvector_free (xi, 1);
+	NUMmatrix_free (xi, 1, 1);
+	NUMmatrix_free (xisum, 1, 1);
+	NUMvector_free (work, 1);
 	NUMvector_free (scale, 1);
 	NUMmatrix_free (beta, 1, 1);
 	NUMmatrix_free (alpha, 1, 1);
@@ -247,17 +247,18 @@ autoHMMBaumWelch HMMBaumWelch_create (long nstates, long nsymbols, long capacity
 		my numberOfTimes = my capacity = capacity;
 		my numberOfStates = nstates;
 		my numberOfSymbols = nsymbols;
-		my alpha = NUMmatrix<double> (1, nstates, 1, capacity);
-		my beta = NUMmatrix<double> (1, nstates, 1, capacity);
-		my scale = NUMvector<double> (1, capacity);
-		my xi = NUMvector<double **> (1, capacity);
 		my aij_num = NUMmatrix<double> (0, nstates, 1, nstates + 1);
 		my aij_denom = NUMmatrix<double> (0, nstates, 1, nstates + 1);
 		my bik_num = NUMmatrix<double> (1, nstates, 1, nsymbols);
 		my bik_denom = NUMmatrix<double> (1, nstates, 1, nsymbols);
-		my gamma = NUMmatrix<double> (1, nstates, 1, capacity);
-		for (long it = 1; it <= capacity; it++) {
-			my xi[it] = NUMmatrix<double> (1, nstates, 1, nstates);
+		if (capacity > 0) {   // with zero capacity, only the accumulators of the estimates are created
+			my alpha = NUMmatrix<double> (1, nstates, 1, capacity);
+			my beta = NUMmatrix<double> (1, nstates, 1, capacity);
+			my scale = NUMvector<double> (1, capacity);
+			my xi = NUMmatrix<double> (1, nstates, 1, nstates);
+			my xisum = NUMmatrix<double> (1, nstates, 1, nstates);
+			my work = NUMvector<double> (1, nstates);
+			my gamma = NUMmatrix<double> (1, nstates, 1, capacity);
 		}
 		return me;
 	} catch (MelderError) {
@@ -855,7 +856,7 @@ void HMMBaumWelch_reInit (HMMBaumWelch me) {
 	/*
 		The _num and _denum matrices are asigned as += in the iteration loop and therefore need to be zeroed
 		at the start of each new iteration.
-		The elements of alpha, beta, scale, gamma & xi are always calculated directly and need not be
+		The elements of alpha, beta, scale, gamma, xi & xisum are always calculated directly and need not be
 		initialised.
 	*/
 	for (long is = 0; is <= my numberOfStates; is++) {
@@ -872,52 +873,169 @@ void HMMBaumWelch_reInit (HMMBaumWelch me) {
 	}
 }
 
+static void HMMBaumWelch_addAccumulators (HMMBaumWelch me, HMMBaumWelch thee) {
+	my totalNumberOfSequences += thy totalNumberOfSequences;
+	my lnProb += thy lnProb;
+	for (long is = 0; is <= my numberOfStates; is++) {
+		for (long js = 1; js <= my numberOfStates + 1; js++) {
+			my aij_num[is][js] += thy aij_num[is][js];
+			my aij_denom[is][js] += thy aij_denom[is][js];
+		}
+	}
+	for (long is = 1; is <= my numberOfStates; is++) {
+		for (long js = 1; js <= my numberOfSymbols; js++) {
+			my bik_num[is][js] += thy bik_num[is][js];
+			my bik_denom[is][js] += thy bik_denom[is][js];
+		}
+	}
+}
+
+/*
+	The segments are divided into a fixed number of contiguous chunks, independently of the number of threads;
+	every chunk accumulates its own estimates, and these are added in chunk order before reestimation,
+	so that the learned probabilities do not depend on the number of processors.
+	A chunk needs only the accumulators; the forward and backward variables, which grow with the longest sequence,
+	are kept once per thread.
+*/
+#define HMM_LEARN_MAXIMUM_NUMBER_OF_CHUNKS  16
+
+Thing_define (HMM_and_HMMBaumWelch_learn_Args, Thing) { public:
+	HMM hmm;
+	autoHMMBaumWelch bw;   // the work space of this thread
+	HMMBaumWelch *accumulators;   // [1..numberOfChunks]
+	long **obs, *numberOfObservations;   // [1..numberOfSegments]
+	long *firstSegmentOfChunk;   // [1..numberOfChunks+1]
+	long firstChunk, lastChunk;
+};
+
+Thing_implement (HMM_and_HMMBaumWelch_learn_Args, Thing, 0);
+
+static autoHMM_and_HMMBaumWelch_learn_Args HMM_and_HMMBaumWelch_learn_Args_create (HMM hmm, long capacity, HMMBaumWelch *accumulators,
+	long **obs, long *numberOfObservations, long *firstSegmentOfChunk, long firstChunk, long lastChunk)
+{
+	autoHMM_and_HMMBaumWelch_learn_Args me = Thing_new (HMM_and_HMMBaumWelch_learn_Args);
+	my hmm = hmm;
+	my bw = HMMBaumWelch_create (hmm -> numberOfStates, hmm -> numberOfObservationSymbols, capacity);
+	my accumulators = accumulators;
+	my obs = obs;
+	my numberOfObservations = numberOfObservations;
+	my firstSegmentOfChunk = firstSegmentOfChunk;
+	my firstChunk = firstChunk;
+	my lastChunk = lastChunk;
+	return me;
+}
+
+static MelderThread_RETURN_TYPE HMM_and_HMMBaumWelch_learn (HMM_and_HMMBaumWelch_learn_Args me) {
+	HMM hmm = my hmm;
+	HMMBaumWelch bw = my bw.get();
+	for (long ichunk = my firstChunk; ichunk <= my lastChunk; ichunk ++) {
+		HMMBaumWelch_reInit (bw);
+		for (long iseg = my firstSegmentOfChunk [ichunk]; iseg < my firstSegmentOfChunk [ichunk + 1]; iseg ++) {
+			long *obs = my obs [iseg];
+			bw -> numberOfTimes = my numberOfObservations [iseg];
+			(bw -> totalNumberOfSequences) ++;
+			HMM_and_HMMBaumWelch_forward (hmm, bw, obs); // get new alphas
+			HMM_and_HMMBaumWelch_backward (hmm, bw, obs); // get new betas
+			HMMBaumWelch_getGamma (bw);
+			HMM_and_HMMBaumWelch_getXi (hmm, bw, obs);
+			HMM_and_HMMBaumWelch_addEstimate (hmm, bw, obs);
+		}
+		HMMBaumWelch_addAccumulators (my accumulators [ichunk], bw);   // the chunk's accumulators were zero
+	}
+	MelderThread_RETURN;
+}
+
 void HMM_and_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee, double delta_lnp, double minProb, int info) {
 	try {
 		// act as if all observation sequences are in memory
 		long capacity = HMMObservationSequenceBag_getLongestSequence (thee);
-		autoHMMBaumWelch bw = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, capacity);
-		bw -> minProb = minProb;
+
+		/*
+			The symbol indices of the observation sequences do not change during learning.
+			Interpretation of unknowns: end of sequence.
+		*/
+		OrderedOf<structStringsIndex> indices;
+		long numberOfSegments = 0;
+		for (long ios = 1; ios <= thy size; ios ++) {
+			HMMObservationSequence hmm_os = thy at [ios];
+			autoStringsIndex si = HMM_and_HMMObservationSequence_to_StringsIndex (me, hmm_os);
+			long *obs = si -> classIndex, nobs = si -> numberOfElements; // convenience
+			for (long it = 1; it <= nobs; it ++) {
+				if (obs [it] != 0 && (it == 1 || obs [it - 1] == 0)) {
+					numberOfSegments ++;
+				}
+			}
+			indices. addItem_move (si.move());
+		}
+		autoNUMvector<long *> segmentObservations (1, numberOfSegments);
+		autoNUMvector<long> segmentLength (1, numberOfSegments);
+		long iseg = 0;
+		for (long ios = 1; ios <= indices.size; ios ++) {
+			long *obs = indices.at [ios] -> classIndex, nobs = indices.at [ios] -> numberOfElements;
+			long istart = 1, iend = nobs;
+			while (istart <= nobs) {
+				while (istart <= nobs && obs[istart] == 0) {
+					istart++;
+				};
+				if (istart > nobs) {
+					break;
+				}
+				iend = istart + 1;
+				while (iend <= nobs && obs[iend] != 0) {
+					iend++;
+				}
+				iend --;
+				iseg ++;
+				segmentObservations [iseg] = obs + istart - 1;
+				segmentLength [iseg] = iend - istart + 1;
+				istart = iend + 1;
+			}
+		}
+		Melder_assert (iseg == numberOfSegments);
+
+		long numberOfChunks = numberOfSegments < HMM_LEARN_MAXIMUM_NUMBER_OF_CHUNKS ? numberOfSegments : HMM_LEARN_MAXIMUM_NUMBER_OF_CHUNKS;
+		if (numberOfChunks < 1) numberOfChunks = 1;
+		long firstSegmentOfChunk [1 + HMM_LEARN_MAXIMUM_NUMBER_OF_CHUNKS + 1];
+		for (long ichunk = 1; ichunk <= numberOfChunks + 1; ichunk ++)
+			firstSegmentOfChunk [ichunk] = 1 + (ichunk - 1) * numberOfSegments / numberOfChunks;
+		autoHMMBaumWelch ownAccumulators [1 + HMM_LEARN_MAXIMUM_NUMBER_OF_CHUNKS];
+		HMMBaumWelch accumulators [1 + HMM_LEARN_MAXIMUM_NUMBER_OF_CHUNKS] = { nullptr };
+		for (long ichunk = 1; ichunk <= numberOfChunks; ichunk ++) {
+			ownAccumulators [ichunk] = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, 0);
+			ownAccumulators [ichunk] -> minProb = minProb;
+			accumulators [ichunk] = ownAccumulators [ichunk].get();
+		}
+
+		int numberOfThreads = (int) numberOfChunks;
+		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		long numberOfChunksPerThread = (numberOfChunks - 1) / numberOfThreads + 1;
+		numberOfThreads = (int) ((numberOfChunks - 1) / numberOfChunksPerThread + 1);
+		autoHMM_and_HMMBaumWelch_learn_Args args [HMM_LEARN_MAXIMUM_NUMBER_OF_CHUNKS];
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			long firstChunk = 1 + (ithread - 1) * numberOfChunksPerThread;
+			long lastChunk = ithread == numberOfThreads ? numberOfChunks : firstChunk + numberOfChunksPerThread - 1;
+			args [ithread - 1] = HMM_and_HMMBaumWelch_learn_Args_create (me, capacity, accumulators,
+				segmentObservations.peek(), segmentLength.peek(), firstSegmentOfChunk, firstChunk, lastChunk);
+		}
+		HMMBaumWelch bw = accumulators [1];
 		if (info) {
 			MelderInfo_open (); 
 		}
 		long iter = 0; double lnp;
 		do {
 			lnp = bw -> lnProb;
-			HMMBaumWelch_reInit (bw.get());
-			for (long ios = 1; ios <= thy size; ios ++) {
-				HMMObservationSequence hmm_os = thy at [ios];
-				autoStringsIndex si = HMM_and_HMMObservationSequence_to_StringsIndex (me, hmm_os); // TODO outside the loop or more efficiently
-				long *obs = si -> classIndex, nobs = si -> numberOfElements; // convenience
-
-				// Interpretation of unknowns: end of sequence
-
-				long istart = 1, iend = nobs;
-				while (istart <= nobs) {
-					while (istart <= nobs && obs[istart] == 0) {
-						istart++;
-					};
-					if (istart > nobs) {
-						break;
-					}
-					iend = istart + 1;
-					while (iend <= nobs && obs[iend] != 0) {
-						iend++;
-					}
-					iend --;
-					bw -> numberOfTimes = iend - istart + 1;
-					(bw -> totalNumberOfSequences) ++;
-					HMM_and_HMMBaumWelch_forward (me, bw.get(), obs + istart - 1); // get new alphas
-					HMM_and_HMMBaumWelch_backward (me, bw.get(), obs + istart - 1); // get new betas
-					HMMBaumWelch_getGamma (bw.get());
-					HMM_and_HMMBaumWelch_getXi (me, bw.get(), obs + istart - 1);
-					HMM_and_HMMBaumWelch_addEstimate (me, bw.get(), obs + istart - 1);
-					istart = iend + 1;
-				}
+			for (long ichunk = 1; ichunk <= numberOfChunks; ichunk ++) {
+				HMMBaumWelch_reInit (accumulators [ichunk]);
+			}
+			MelderThread_run (HMM_and_HMMBaumWelch_learn, args, numberOfThreads);
+			for (long ichunk = 2; ichunk <= numberOfChunks; ichunk ++) {
+				HMMBaumWelch_addAccumulators (bw, accumulators [ichunk]);
 			}
 			// we have processed all observation sequences, now it is time to estimate new probabilities.
 			iter++;
-			HMM_and_HMMBaumWelch_reestimate (me, bw.get());
+			HMM_and_HMMBaumWelch_reestimate (me, bw);
 			if (info) { 
 				MelderInfo_writeLine (U"Iteration: ", iter, U" ln(prob): ", bw -> lnProb); 
 			}
@@ -934,7 +1052,6 @@ void HMM_and_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag
 	}
 }
 
-
 // xc1 < xc2
 void HMM_and_HMMStateSequence_drawTrellis (HMM me, HMMStateSequence thee, Graphics g, int connect, int garnish) {
 	long numberOfTimes = thy numberOfStrings;
@@ -1136,20 +1253,29 @@ void HMM_drawForwardAndBackwardProbabilitiesIllustration (Graphics g, bool garni
 	}
 }
 
+/*
+	Only the sums of the xi's over time are needed for the reestimation,
+	so we keep the xi's of one time step at a time and add them to thy xisum.
+*/
 void HMM_and_HMMBaumWelch_getXi (HMM me, HMMBaumWelch thee, long *obs) {
-
+	for (long is = 1; is <= thy numberOfStates; is++) {
+		for (long js = 1; js <= thy numberOfStates; js++) {
+			thy xisum[is][js] = 0.0;
+		}
+	}
 	for (long it = 1; it <= thy numberOfTimes - 1; it++) {
 		double sum = 0.0;
 		for (long is = 1; is <= thy numberOfStates; is++) {
 			for (long js = 1; js <= thy numberOfStates; js++) {
-				thy xi[it][is][js] = thy alpha[is][it] * thy beta[js][it + 1] *
+				thy xi[is][js] = thy alpha[is][it] * thy beta[js][it + 1] *
 					my transitionProbs[is][js] * my emissionProbs[js][ obs[it + 1] ];
-				sum += thy xi[it][is][js];
+				sum += thy xi[is][js];
 			}
 		}
 		for (long is = 1; is <= my numberOfStates; is++) {
 			for (long js = 1; js <= my numberOfStates; js++) {
-				thy xi[it][is][js] /= sum;
+				thy xi[is][js] /= sum;
+				thy xisum[is][js] += thy xi[is][js];
 			}
 		}
 	}
@@ -1171,13 +1297,9 @@ void HMM_and_HMMBaumWelch_addEstimate (HMM me, HMMBaumWelch thee, long *obs) {
 		}
 
 		for (long js = 1; js <= my numberOfStates; js ++) {
-			double xisum = 0.0;
-			for (long it = 1; it <= thy numberOfTimes - 1; it ++) {
-				xisum += thy xi [it] [is] [js];
-			}
 			// zero probs signal invalid connections, don't reestimate
 			if (my transitionProbs [is] [js] > 0.0) {
-				thy aij_num [is] [js] += xisum;
+				thy aij_num [is] [js] += thy xisum [is] [js];
 				thy aij_denom [is] [js] += gammasum;
 			}
 		}
@@ -1261,16 +1383,26 @@ void HMM_and_HMMBaumWelch_forward (HMM me, HMMBaumWelch thee, long *obs) {
 	for (long js = 1; js <= my numberOfStates; js ++) {
 		thy alpha [js] [1] /= thy scale [1];
 	}
-	// recursion
+	/*
+		Recursion.
+		The sums over the previous states are accumulated for all current states at once,
+		so that the transition matrix is traversed row by row;
+		every sum still adds its terms in the order of the previous states.
+	*/
+	double *sum = thy work;
 	for (long it = 2; it <= thy numberOfTimes; it ++) {
 		thy scale [it] = 0.0;
 		for (long js = 1; js <= my numberOfStates; js ++) {
-			double sum = 0.0;
-			for (long is = 1; is <= my numberOfStates; is ++) {
-				sum += thy alpha [is] [it - 1] * my transitionProbs [is] [js];
+			sum [js] = 0.0;
+		}
+		for (long is = 1; is <= my numberOfStates; is ++) {
+			double alpha_is = thy alpha [is] [it - 1], *transitionProbs_is = my transitionProbs [is];
+			for (long js = 1; js <= my numberOfStates; js ++) {
+				sum [js] += alpha_is * transitionProbs_is [js];
 			}
-
-			thy alpha [js] [it] = sum * my emissionProbs [js] [obs [it]];
+		}
+		for (long js = 1; js <= my numberOfStates; js ++) {
+			thy alpha [js] [it] = sum [js] * my emissionProbs [js] [obs [it]];
 			thy scale [it] += thy alpha [js] [it];
 		}
 
@@ -1302,36 +1434,54 @@ void HMM_and_HMMBaumWelch_backward (HMM me, HMMBaumWelch thee, long *obs) {
 /*************************** HMM decoding ***********************************/
 
 // precondition: valid symbols, i.e. 1 <= o[i] <= my numberOfSymbols for i=1..nt
+/*
+	The scores are kept as logarithms of probabilities:
+	the products of many probabilities would underflow for long observation sequences.
+*/
 void HMM_and_HMMViterbi_decode (HMM me, HMMViterbi thee, long *obs) {
 	long ntimes = thy numberOfTimes;
+	autoNUMmatrix<double> lnTransitionProbs (0, my numberOfStates, 1, my numberOfStates);
+	autoNUMmatrix<double> lnEmissionProbs (1, my numberOfStates, 1, my numberOfObservationSymbols);
+	for (long is = 0; is <= my numberOfStates; is++) {
+		for (long js = 1; js <= my numberOfStates; js++) {
+			lnTransitionProbs[is][js] = my transitionProbs[is][js] > 0.0 ? log (my transitionProbs[is][js]) : - INFINITY;
+		}
+	}
+	for (long is = 1; is <= my numberOfStates; is++) {
+		for (long k = 1; k <= my numberOfObservationSymbols; k++) {
+			lnEmissionProbs[is][k] = my emissionProbs[is][k] > 0.0 ? log (my emissionProbs[is][k]) : - INFINITY;
+		}
+	}
 	// initialisation
 	for (long is = 1; is <= my numberOfStates; is++) {
-		thy viterbi[is][1] = my transitionProbs[0][is] * my emissionProbs[is][ obs[1] ];
+		thy viterbi[is][1] = lnTransitionProbs[0][is] + lnEmissionProbs[is][ obs[1] ];
 		thy bp[is][1] = 0;
 	}
 	// recursion
 	for (long it = 2; it <= ntimes; it++) {
 		for (long is = 1; is <= my numberOfStates; is++) {
 			// all transitions isp -> is from previous time to current
-			double max_score = -1; // any negative number is ok
-			for (long isp = 1; isp <= my numberOfStates; isp++) {
-				double score = thy viterbi[isp][it - 1] * my transitionProbs[isp][is]; // * my emissionProbs[is][ obs[it] ]
+			double max_score = thy viterbi[1][it - 1] + lnTransitionProbs[1][is];
+			thy bp[is][it] = 1;
+			for (long isp = 2; isp <= my numberOfStates; isp++) {
+				double score = thy viterbi[isp][it - 1] + lnTransitionProbs[isp][is]; // + lnEmissionProbs[is][ obs[it] ]
 				if (score > max_score) {
 					max_score = score;
 					thy bp[is][it] = isp;
 				}
 			}
-			thy viterbi[is][it] = max_score * my emissionProbs[is][ obs[it] ];
+			thy viterbi[is][it] = max_score + lnEmissionProbs[is][ obs[it] ];
 		}
 	}
 	// path starts at state with best end probability
 	thy path[ntimes] = 1;
-	thy prob = thy viterbi[1][ntimes];
+	double lnProb = thy viterbi[1][ntimes];
 	for (long is = 2; is <= my numberOfStates; is++) {
-		if (thy viterbi[is][ntimes] > thy prob) {
-			thy prob = thy viterbi[ thy path[ntimes] = is ][ntimes];
+		if (thy viterbi[is][ntimes] > lnProb) {
+			lnProb = thy viterbi[ thy path[ntimes] = is ][ntimes];
 		}
 	}
+	thy prob = exp (lnProb);
 	// trace back and get path
 	for (long it = ntimes; it > 1; it--) {
 		thy path[it - 1] = thy bp[ thy path[it] ][it];
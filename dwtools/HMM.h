@@ -54,7 +54,9 @@ Thing_define (HMMBaumWelch, Daata) {
 	double **beta;
 	double *scale;
 	double **gamma;
-	double ***xi;
+	double **xi;   // [1..numberOfStates][1..numberOfStates]: of one time step only
+	double **xisum;   // xi summed over the time steps of the current sequence
+	double *work;   // [1..numberOfStates]
 	double **aij_num, **aij_denom;
 	double **bik_num, **bik_denom;
 
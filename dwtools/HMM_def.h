@@ -66,7 +66,7 @@ oo_DEFINE_CLASS (HMMViterbi, Daata)
 	oo_LONG (numberOfTimes)
 	oo_LONG (numberOfStates)
 	oo_DOUBLE (prob)
-	oo_DOUBLE_MATRIX (viterbi, numberOfStates, numberOfTimes)
+	oo_DOUBLE_MATRIX (viterbi, numberOfStates, numberOfTimes)   // natural logarithms of the path probabilities (since version 1; linear before)
 	oo_LONG_MATRIX (bp, numberOfStates, numberOfTimes)
 	oo_LONG_VECTOR (path, numberOfTimes)
 
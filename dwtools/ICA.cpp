@@ -26,22 +26,29 @@
 #include "NUM2.h"
 #include "Sound_and_PCA.h"
 #include "SVD.h"
+#include "NUMcblas.h"
+#include "MelderThread.h"
 
-// matrix multiply R = V*C*V', V is nrv x ncv, C is ncv x ncv, R is nrv x nrv
-static void NUMdmatrices_multiply_VCVp (double **r, double **v, long nrv, long ncv, double **c, int csym) {
-	for (long i = 1; i <= nrv; i++) {
-		long jstart = csym ? i : 1;
-		for (long j = jstart; j <= nrv; j++) {
-			// V_ik C_kl V'_lj = V_ik C_kl V_jl
-			double vcv = 0;
-			for (long k = 1; k <= ncv; k++) {
-				for (long l = 1; l <= ncv; l++) {
-					vcv += v[i][k] * c[k][l] * v[j][l];
-				}
-			}
-			r[i][j] = vcv;
-			if (csym) {
-				r[j][i] = vcv;
+/*
+	The matrix products below are done by BLAS.
+	All matrices are NUMmatrix blocks, i.e. stored row after row,
+	so that BLAS sees a row-major m x n matrix X as the column-major n x m matrix X'.
+	The result matrix may not be the same as any of the argument matrices.
+*/
+
+// matrix multiply R = V*C*V', V is nrv x ncv, C is ncv x ncv, R is nrv x nrv; work is nrv x ncv
+static void NUMdmatrices_multiply_VCVp (double **r, double **v, long nrv, long ncv, double **c, int csym, double **work) {
+	/*
+		Column-major, R' = V C' V' = (V')' (C' V'), with V' and C' what BLAS sees of v and c.
+	*/
+	double alpha = 1.0, beta = 0.0;
+	long ldv = ncv, ldc = ncv, ldw = ncv, ldr = nrv;
+	NUMblas_dgemm ("N", "N", & ncv, & nrv, & ncv, & alpha, & c [1] [1], & ldc, & v [1] [1], & ldv, & beta, & work [1] [1], & ldw);
+	NUMblas_dgemm ("T", "N", & nrv, & nrv, & ncv, & alpha, & v [1] [1], & ldv, & work [1] [1], & ldw, & beta, & r [1] [1], & ldr);
+	if (csym) {
+		for (long i = 1; i <= nrv; i++) {
+			for (long j = i + 1; j <= nrv; j++) {
+				r[j][i] = r[i][j];
 			}
 		}
 	}
@@ -71,44 +78,79 @@ static void NUMdmatrices_multiply_VpCV (double **r, double **v, long nrv, long n
 
 // matrix multiply V*C, V is nrv x ncv, C is ncv x ncc, R is nrv x ncc;
 static void NUMdmatrices_multiply_VC (double **r, double **v, long nrv, long ncv, double **c, long ncc) {
-	for (long i = 1; i <= nrv; i++) {
-		for (long j = 1; j <= ncc; j++) {
-			// V_ik C_kj
-			double vc = 0;
-			for (long k = 1; k <= ncv; k++) {
-				vc += v[i][k] * c[k][j];
-			}
-			r[i][j] = vc;
-		}
-	}
+	// column-major: R' = C' V'
+	double alpha = 1.0, beta = 0.0;
+	long ldc = ncc, ldv = ncv, ldr = ncc;
+	NUMblas_dgemm ("N", "N", & ncc, & nrv, & ncv, & alpha, & c [1] [1], & ldc, & v [1] [1], & ldv, & beta, & r [1] [1], & ldr);
 }
 
 // matrix multiply V'*C, V is nrv x ncv, C is nrv x ncc, R is ncv x ncc;
 static void NUMdmatrices_multiply_VpC (double **r, double **v, long nrv, long ncv, double **c, long ncc) {
-	for (long i = 1; i <= ncv; i++) {
-		for (long j = 1; j <= ncc; j++) {
-			// V'_ik C_kj
-			double vc = 0;
-			for (long k = 1; k <= nrv; k++) {
-				vc += v[k][i] * c[k][j];
-			}
-			r[i][j] = vc;
-		}
-	}
+	// column-major: R' = C' (V')'
+	double alpha = 1.0, beta = 0.0;
+	long ldc = ncc, ldv = ncv, ldr = ncc;
+	NUMblas_dgemm ("N", "T", & ncc, & ncv, & nrv, & alpha, & c [1] [1], & ldc, & v [1] [1], & ldv, & beta, & r [1] [1], & ldr);
 }
 
 // D += scalef * M * M', M = nrm x ncm, D is nrm x nrm
 static void NUMdmatrices_multiplyScaleAdd (double **r, double **m, long nrm, long ncm, double scalef) {
-	for (long i = 1; i <= nrm; i++) {
-		for (long j = 1; j <= nrm; j++) {
-			// M_ik M'_kj = M_ik M_jk
-			double mm = 0;
-			for (long k = 1; k <= ncm; k++) {
-				mm += m[i][k] * m[j][k];
-			}
-			r[i][j] += scalef * mm;
+	// column-major: D' += scalef * (M')' M', which is symmetric
+	double beta = 1.0;
+	long ldm = ncm, ldr = nrm;
+	NUMblas_dgemm ("T", "N", & nrm, & nrm, & ncm, & scalef, & m [1] [1], & ldm, & m [1] [1], & ldm, & beta, & r [1] [1], & ldr);
+}
+
+/*
+	For all k: to [k] := V * from [k] * V', where from and to may be the same list.
+	The tables are independent, so they are divided over threads;
+	each thread gets its own work space, allocated here in the main thread.
+*/
+Thing_define (CrossCorrelationTableList_transform_Args, Thing) { public:
+	CrossCorrelationTableList from, to;
+	double **v;
+	long dimension, firstTable, lastTable;
+	autoNUMmatrix <double> copy, work;
+};
+
+Thing_implement (CrossCorrelationTableList_transform_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE CrossCorrelationTableList_transform_thread (CrossCorrelationTableList_transform_Args me) {
+	for (long itable = my firstTable; itable <= my lastTable; itable ++) {
+		double **c = my from -> at [itable] -> data;
+		if (my from == my to) {
+			NUMmatrix_copyElements (c, my copy.peek(), 1, my dimension, 1, my dimension);
+			c = my copy.peek();
 		}
+		NUMdmatrices_multiply_VCVp (my to -> at [itable] -> data, my v, my dimension, my dimension, c, 1, my work.peek());
 	}
+	MelderThread_RETURN;
+}
+
+static void CrossCorrelationTableList_transform (CrossCorrelationTableList from, CrossCorrelationTableList to, double **v, long dimension) {
+	long numberOfTables = from -> size;
+	Melder_assert (to -> size == numberOfTables);
+	if (numberOfTables < 1) return;
+	int numberOfThreads = numberOfTables < 16 ? (int) numberOfTables : 16;
+	const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	long numberOfTablesPerThread = (numberOfTables - 1) / numberOfThreads + 1;
+	numberOfThreads = (int) ((numberOfTables - 1) / numberOfTablesPerThread + 1);
+	autoCrossCorrelationTableList_transform_Args args [16];
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoCrossCorrelationTableList_transform_Args arg = Thing_new (CrossCorrelationTableList_transform_Args);
+		arg -> from = from;
+		arg -> to = to;
+		arg -> v = v;
+		arg -> dimension = dimension;
+		arg -> firstTable = 1 + (ithread - 1) * numberOfTablesPerThread;
+		arg -> lastTable = ithread == numberOfThreads ? numberOfTables : arg -> firstTable + numberOfTablesPerThread - 1;
+		if (from == to)
+			arg -> copy.reset (1, dimension, 1, dimension);
+		arg -> work.reset (1, dimension, 1, dimension);
+		args [ithread - 1] = arg.move();
+	}
+	MelderThread_run (CrossCorrelationTableList_transform_thread, args, numberOfThreads);
 }
 
 /*
@@ -190,7 +232,6 @@ static void Diagonalizer_and_CrossCorrelationTableList_ffdiag (Diagonalizer me,
 		autoCrossCorrelationTableList ccts = CrossCorrelationTableList_and_Diagonalizer_diagonalize (thee, me);
 		autoNUMmatrix<double> w (1, dimension, 1, dimension);
 		autoNUMmatrix<double> vnew (1, dimension, 1, dimension);
-		autoNUMmatrix<double> cc (1, dimension, 1, dimension);
 
 		for (long i = 1; i <= dimension; i++) {
 			w[i][i] = 1;
@@ -252,11 +293,7 @@ static void Diagonalizer_and_CrossCorrelationTableList_ffdiag (Diagonalizer me,
 				// update V
 				NUMmatrix_copyElements (v, vnew.peek(), 1, dimension, 1, dimension);
 				NUMdmatrices_multiply_VC (v, w.peek(), dimension, dimension, vnew.peek(), dimension);
-				for (long k = 1; k <= ccts->size; k ++) {
-					CrossCorrelationTable ct = ccts->at [k];
-					NUMmatrix_copyElements (ct -> data, cc.peek(), 1, dimension, 1, dimension);
-					NUMdmatrices_multiply_VCVp (ct -> data, w.peek(), dimension, dimension, cc.peek(), 1);
-				}
+				CrossCorrelationTableList_transform (ccts.get(), ccts.get(), w.peek(), dimension);
 				dm_new = CrossCorrelationTableList_getDiagonalityMeasure (ccts.get(), nullptr, 0, 0);
 				iter++;
 				Melder_progress ((double) iter / (double) maxNumberOfIterations, U"Iteration: ", iter, U", measure: ", dm_new, U"\n fractional measure: ", dm_new / dm_start);
@@ -276,24 +313,17 @@ static void Diagonalizer_and_CrossCorrelationTableList_ffdiag (Diagonalizer me,
 */
 static void update_one_column (CrossCorrelationTableList me, double **d, double *wp, double *wvec, double scalef, double *work) {
 	long dimension = my at [1] -> numberOfColumns;
+	long inc = 1, lda = dimension;
+	double one = 1.0, zero = 0.0;
 
 	for (long ic = 2; ic <= my size; ic ++) { // exclude C0
 		SSCP cov = my at [ic];
 		double **c = cov -> data;
-		// m1 = C * wvec
-		for (long i = 1; i <= dimension; i++) {
-			double r = 0;
-			for (long j = 1; j <= dimension; j++) {
-				r += c[i][j] * wvec[j];
-			}
-			work[i] = r;
-		}
+		// m1 = C * wvec (BLAS sees C')
+		NUMblas_dgemv ("T", & dimension, & dimension, & one, & c [1] [1], & lda, & wvec [1], & inc, & zero, & work [1], & inc);
 		// D = D +/- 2*p(t)*(m1*m1');
-		for (long i = 1; i <= dimension; i++) {
-			for (long j = 1; j <= dimension; j++) {
-				d[i][j] += 2 * scalef * wp[ic] * work[i] * work[j];
-			}
-		}
+		double alpha = 2 * scalef * wp[ic];
+		NUMblas_dger (& dimension, & dimension, & alpha, & work [1], & inc, & work [1], & inc, & d [1] [1], & lda);
 	}
 }
 
@@ -341,11 +371,7 @@ static void Diagonalizer_and_CrossCorrelationTable_qdiag (Diagonalizer me, Cross
 
 		// P*C[i]*P'
 
-		for (long ic = 1; ic <= thy size; ic ++) {
-			CrossCorrelationTable cov1 = thy at [ic];
-			CrossCorrelationTable cov2 = ccts -> at [ic];
-			NUMdmatrices_multiply_VCVp (cov2 -> data, p.peek(), dimension, dimension, cov1 -> data, 1);
-		}
+		CrossCorrelationTableList_transform (thee, ccts.get(), p.peek(), dimension);
 
 		// W = P'\W == inv(P') * W
 
@@ -435,31 +461,106 @@ void MixingMatrix_and_CrossCorrelationTableList_improveUnmixing (MixingMatrix me
 }
 
 
-/* Preconditions:
- * 	x[1..nrows][1..ncols], cc[1..nrows][1..nrows], centroid[1..nrows]
- * 	if (lag>0) {i2 + lag <= ncols} else {i1-lag >= 1}
- * 	no array boundary checks!
- * 	lag >= 0
- */
-static void NUMcrossCorrelate_rows (double **x, long nrows, long icol1, long icol2, long lag, double **cc, double *centroid, double scale) {
-	lag = labs (lag);
-	long nsamples = icol2 - icol1 + 1 + lag;
+/*
+	Cross-correlations for several lags in one pass over the data.
+	Preconditions:
+		x [1..nrows] [icol1..icol2], lags [1..numberOfLags] >= 0, icol2 - lags [k] >= icol1,
+		cc [1..numberOfLags] [1..nrows] [1..nrows], centroid [1..nrows]
+	The centroid is taken over columns icol1..icol2, and for lag k the products run over columns icol1..icol2 - lags [k].
+	Only the upper triangle is computed (and copied to the lower one).
+
+	The channel pairs are divided over threads. For each pair the samples are visited in blocks:
+	a block of both (centred) channels is copied into the thread's buffers once and then serves all lags,
+	so that every lag adds its products in the original order.
+*/
+#define NUMcrossCorrelate_BLOCK_SIZE  4096
+
+Thing_define (NUMcrossCorrelate_Args, Thing) { public:
+	double **x, *centroid;
+	long nrows, icol1, icol2, *lags, numberOfLags, maximumLag;
+	double ***cc, scale;
+	long firstPair, lastPair;
+	autoNUMvector <double> bufferi, bufferj, sums;
+};
+
+Thing_implement (NUMcrossCorrelate_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE NUMcrossCorrelate_thread (NUMcrossCorrelate_Args me) {
+	double *bufferi = my bufferi.peek(), *bufferj = my bufferj.peek(), *sums = my sums.peek();
+	long ipair = 0;
+	for (long i = 1; i <= my nrows; i ++) {
+		for (long j = i; j <= my nrows; j ++) {
+			if (++ ipair < my firstPair) continue;
+			if (ipair > my lastPair) MelderThread_RETURN;
+			double *xi = my x [i], *xj = my x [j], centroidi = my centroid [i], centroidj = my centroid [j];
+			for (long ilag = 1; ilag <= my numberOfLags; ilag ++)
+				sums [ilag] = 0.0;
+			for (long blockStart = my icol1; blockStart <= my icol2; blockStart += NUMcrossCorrelate_BLOCK_SIZE) {
+				long blockEnd = blockStart + NUMcrossCorrelate_BLOCK_SIZE - 1;
+				if (blockEnd > my icol2) blockEnd = my icol2;
+				long bufferEnd = blockEnd + my maximumLag;
+				if (bufferEnd > my icol2) bufferEnd = my icol2;
+				for (long k = blockStart; k <= blockEnd; k ++)
+					bufferi [k - blockStart + 1] = xi [k] - centroidi;
+				for (long k = blockStart; k <= bufferEnd; k ++)
+					bufferj [k - blockStart + 1] = xj [k] - centroidj;
+				for (long ilag = 1; ilag <= my numberOfLags; ilag ++) {
+					long lag = my lags [ilag];
+					long last = my icol2 - lag < blockEnd ? my icol2 - lag : blockEnd;
+					double sum = sums [ilag];
+					for (long k = 1; k <= last - blockStart + 1; k ++)
+						sum += bufferi [k] * bufferj [k + lag];
+					sums [ilag] = sum;
+				}
+			}
+			for (long ilag = 1; ilag <= my numberOfLags; ilag ++)
+				my cc [ilag] [j] [i] = my cc [ilag] [i] [j] = sums [ilag] * my scale;
+		}
+	}
+	MelderThread_RETURN;
+}
+
+static void NUMcrossCorrelate_rows (double **x, long nrows, long icol1, long icol2, long *lags, long numberOfLags, double ***cc, double *centroid, double scale) {
+	long nsamples = icol2 - icol1 + 1, maximumLag = 0;
 	for (long i = 1; i <= nrows; i++) {
 		double sum = 0;
-		for (long k = icol1; k <= icol2 + lag; k++) {
+		for (long k = icol1; k <= icol2; k++) {
 			sum += x[i][k];
 		}
 		centroid[i] = sum / nsamples;
 	}
-	for (long i = 1; i <= nrows; i++) {
-		for (long j = i; j <= nrows; j++) {
-			double ccor = 0;
-			for (long k = icol1; k <= icol2; k++) {
-				ccor += (x[i][k] - centroid[i]) * (x[j][k + lag] - centroid[j]);
-			}
-			cc[j][i] = cc[i][j] = ccor * scale;
-		}
+	for (long ilag = 1; ilag <= numberOfLags; ilag ++) {
+		Melder_assert (lags [ilag] >= 0 && icol2 - lags [ilag] >= icol1);
+		if (lags [ilag] > maximumLag) maximumLag = lags [ilag];
+	}
+	long numberOfPairs = nrows * (nrows + 1) / 2;
+	int numberOfThreads = numberOfPairs < 16 ? (int) numberOfPairs : 16;
+	const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	long numberOfPairsPerThread = (numberOfPairs - 1) / numberOfThreads + 1;
+	numberOfThreads = (int) ((numberOfPairs - 1) / numberOfPairsPerThread + 1);
+	autoNUMcrossCorrelate_Args args [16];
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoNUMcrossCorrelate_Args arg = Thing_new (NUMcrossCorrelate_Args);
+		arg -> x = x;
+		arg -> centroid = centroid;
+		arg -> nrows = nrows;
+		arg -> icol1 = icol1;
+		arg -> icol2 = icol2;
+		arg -> lags = lags;
+		arg -> numberOfLags = numberOfLags;
+		arg -> maximumLag = maximumLag;
+		arg -> cc = cc;
+		arg -> scale = scale;
+		arg -> firstPair = 1 + (ithread - 1) * numberOfPairsPerThread;
+		arg -> lastPair = ithread == numberOfThreads ? numberOfPairs : arg -> firstPair + numberOfPairsPerThread - 1;
+		arg -> bufferi.reset (1, NUMcrossCorrelate_BLOCK_SIZE);
+		arg -> bufferj.reset (1, NUMcrossCorrelate_BLOCK_SIZE + maximumLag);
+		arg -> sums.reset (1, numberOfLags);
+		args [ithread - 1] = arg.move();
 	}
+	MelderThread_run (NUMcrossCorrelate_thread, args, numberOfThreads);
 }
 
 /*
@@ -467,6 +568,52 @@ static void NUMcrossCorrelate_rows (double **x, long nrows, long icol1, long ico
 	The cross-correlation between channel i and channel j is defined as
 		sum(k=1..nsamples, (z[i][k] - mean[i])(z[j][k + tau] - mean[j]))*samplingTime
 */
+autoCrossCorrelationTableList Sound_to_CrossCorrelationTableList (Sound me, double startTime, double endTime, double lagStep, long ncovars) {
+	try {
+		if (lagStep < my dx) {
+			lagStep = my dx;
+		}
+		if (endTime <= startTime) {
+			startTime = my xmin;
+			endTime = my xmax;
+		}
+		if (startTime + ncovars * lagStep >= endTime) {
+			Melder_throw (U"Lag time too large.");
+		}
+		long i1 = Sampled_xToNearestIndex (me, startTime);
+		if (i1 < 1) {
+			i1 = 1;
+		}
+		long i2 = Sampled_xToNearestIndex (me, endTime);
+		if (i2 > my nx) {
+			i2 = my nx;
+		}
+		autoNUMvector <long> lags (1, ncovars);
+		autoNUMvector <double **> cc (1, ncovars);
+		autoCrossCorrelationTableList thee = CrossCorrelationTableList_create ();
+		for (long i = 1; i <= ncovars; i ++) {
+			lags [i] = (long) floor ((i - 1) * lagStep / my dx);
+			long nsamples = i2 - lags [i] - i1 + 1;
+			if (nsamples <= my ny) {
+				Melder_throw (U"Not enough samples, choose a longer interval.");
+			}
+			autoCrossCorrelationTable ct = CrossCorrelationTable_create (my ny);
+			ct -> numberOfObservations = nsamples;
+			cc [i] = ct -> data;
+			thy addItem_move (ct.move());
+		}
+		CrossCorrelationTable first = thy at [1];
+		NUMcrossCorrelate_rows (my z, my ny, i1, i2, lags.peek(), ncovars, cc.peek(), first -> centroid, my dx);
+		for (long i = 2; i <= ncovars; i ++) {
+			CrossCorrelationTable ct = thy at [i];
+			NUMvector_copyElements (first -> centroid, ct -> centroid, 1, my ny);
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": no CrossCorrelationTableList created.");
+	}
+}
+
 autoCrossCorrelationTable Sound_to_CrossCorrelationTable (Sound me, double startTime, double endTime, double lagStep) {
 	try {
 		if (endTime <= startTime) {
@@ -482,14 +629,14 @@ autoCrossCorrelationTable Sound_to_CrossCorrelationTable (Sound me, double start
 		if (i2 > my nx) {
 			i2 = my nx;
 		}
-		i2 -= lag;
-		long nsamples = i2 - i1 + 1;
+		long nsamples = i2 - lag - i1 + 1;
 		if (nsamples <= my ny) {
 			Melder_throw (U"Not enough samples, choose a longer interval.");
 		}
 		autoCrossCorrelationTable thee = CrossCorrelationTable_create (my ny);
-
-		NUMcrossCorrelate_rows (my z, my ny, i1, i2, lag, thy data, thy centroid, my dx);
+		double **cc [1+1] = { nullptr, thy data };
+		long lags [1+1] = { 0, lag };
+		NUMcrossCorrelate_rows (my z, my ny, i1, i2, lags, 1, cc, thy centroid, my dx);
 
 		thy numberOfObservations = nsamples;
 
@@ -521,8 +668,7 @@ autoCrossCorrelationTable Sounds_to_CrossCorrelationTable_combined (Sound me, So
 		if (i2 > my nx) {
 			i2 = my nx;
 		}
-		i2 -= ndelta;
-		long nsamples = i2 - i1 + 1;
+		long nsamples = i2 - ndelta - i1 + 1;
 		if (nsamples <= nchannels) {
 			Melder_throw (U"Not enough samples");
 		}
@@ -535,7 +681,9 @@ autoCrossCorrelationTable Sounds_to_CrossCorrelationTable_combined (Sound me, So
 			data[i + my ny] = thy z[i];
 		}
 
-		NUMcrossCorrelate_rows (data.peek(), nchannels, i1, i2, ndelta, his data, his centroid, my dx);
+		double **cc [1+1] = { nullptr, his data };
+		long lags [1+1] = { 0, ndelta };
+		NUMcrossCorrelate_rows (data.peek(), nchannels, i1, i2, lags, 1, cc, his centroid, my dx);
 
 		his numberOfObservations = nsamples;
 
@@ -557,30 +705,6 @@ autoCovariance Sound_to_Covariance_channels (Sound me, double startTime, double
     }
 }
 
-autoCrossCorrelationTableList Sound_to_CrossCorrelationTableList (Sound me, double startTime, double endTime, double lagStep, long ncovars) {
-	try {
-		if (lagStep < my dx) {
-			lagStep = my dx;
-		}
-		if (endTime <= startTime) {
-			startTime = my xmin;
-			endTime = my xmax;
-		}
-		if (startTime + ncovars * lagStep >= endTime) {
-			Melder_throw (U"Lag time too large.");
-		}
-		autoCrossCorrelationTableList thee = CrossCorrelationTableList_create ();
-		for (long i = 1; i <= ncovars; i ++) {
-			double lag = (i - 1) * lagStep;
-			autoCrossCorrelationTable ct = Sound_to_CrossCorrelationTable (me, startTime, endTime, lag);
-			thy addItem_move (ct.move());
-		}
-		return thee;
-	} catch (MelderError) {
-		Melder_throw (me, U": no CrossCorrelationTableList created.");
-	}
-}
-
 autoSound Sound_to_Sound_BSS (Sound me, double startTime, double endTime, long ncovars, double lagStep, long maxNumberOfIterations, double tol, int method) {
 	try {
 		autoMixingMatrix him = Sound_to_MixingMatrix (me, startTime, endTime, ncovars, lagStep, maxNumberOfIterations, tol, method);
@@ -748,6 +872,18 @@ autoMixingMatrix Sound_to_MixingMatrix (Sound me, double startTime, double endTi
 	}
 }
 
+void Sound_and_MixingMatrix_improveUnmixing (Sound me, MixingMatrix thee, double startTime, double endTime, long ncovars, double lagStep, long maxNumberOfIterations, double tol, int method) {
+	try {
+		if (my ny != thy numberOfRows) {
+			Melder_throw (U"The MixingMatrix and the Sound must have the same number of channels.");
+		}
+		autoCrossCorrelationTableList ccs = Sound_to_CrossCorrelationTableList (me, startTime, endTime, lagStep, ncovars);
+		MixingMatrix_and_CrossCorrelationTableList_improveUnmixing (thee, ccs.get(), maxNumberOfIterations, tol, method);
+	} catch (MelderError) {
+		Melder_throw (me, U" & ", thee, U": unmixing not improved.");
+	}
+}
+
 autoMixingMatrix TableOfReal_to_MixingMatrix (TableOfReal me) {
 	try {
 		if (my numberOfColumns != my numberOfRows) {
@@ -875,7 +1011,8 @@ autoCrossCorrelationTable CrossCorrelationTable_and_Diagonalizer_diagonalize (Cr
 			Melder_throw (U"The CrossCorrelationTable and the Diagonalizer matrix dimensions must be equal.");
 		}
 		autoCrossCorrelationTable him = CrossCorrelationTable_create (my numberOfColumns);
-		NUMdmatrices_multiply_VCVp (his data, thy data, my numberOfColumns, my numberOfColumns, my data, 1);
+		autoNUMmatrix<double> work (1, my numberOfColumns, 1, my numberOfColumns);
+		NUMdmatrices_multiply_VCVp (his data, thy data, my numberOfColumns, my numberOfColumns, my data, 1, work.peek());
 		return him;
 	} catch (MelderError) {
 		Melder_throw (U"CrossCorrelationTable not diagonalized.");
@@ -887,9 +1024,11 @@ autoCrossCorrelationTableList CrossCorrelationTableList_and_Diagonalizer_diagona
 		autoCrossCorrelationTableList him = CrossCorrelationTableList_create ();
 		for (long i = 1; i <= my size; i ++) {
 			CrossCorrelationTable item = my at [i];
-			autoCrossCorrelationTable ct = CrossCorrelationTable_and_Diagonalizer_diagonalize (item, thee);
-			his addItem_move (ct.move());
+			if (item -> numberOfRows != thy numberOfRows)
+				Melder_throw (U"The CrossCorrelationTable and the Diagonalizer matrix dimensions must be equal.");
+			his addItem_move (CrossCorrelationTable_create (item -> numberOfColumns));
 		}
+		CrossCorrelationTableList_transform (me, him.get(), thy data, thy numberOfRows);
 		return him;
 	} catch (MelderError) {
 		Melder_throw (U"CrossCorrelationTableList not diagonalized.");
@@ -956,6 +1095,7 @@ autoCrossCorrelationTableList CrossCorrelationTableList_createTestSet (long dime
 			}
 		}
 		autoNUMmatrix<double> v (1, dimension, 1, dimension);
+		autoNUMmatrix<double> work (1, dimension, 1, dimension);
 		autoSVD svd = SVD_create_d (d.peek(), dimension, dimension);
 		autoCrossCorrelationTableList me = CrossCorrelationTableList_create ();
 
@@ -979,7 +1119,7 @@ autoCrossCorrelationTableList CrossCorrelationTableList_createTestSet (long dime
 				}
 			}
 			// we need V'DV, however our V has eigenvectors row-wise -> VDV'
-			NUMdmatrices_multiply_VCVp (ct -> data, v.peek(), dimension, dimension, d.peek(), 1);
+			NUMdmatrices_multiply_VCVp (ct -> data, v.peek(), dimension, dimension, d.peek(), 1, work.peek());
             my addItem_move (ct.move());
 		}
 		return me;
@@ -83,6 +83,12 @@ autoSound Sound_and_MixingMatrix_unmix (Sound me, MixingMatrix thee);
 
 autoMixingMatrix Sound_to_MixingMatrix (Sound me, double startTime, double endTime, long ncovars, double lagStep, long maxNumberOfIterations, double delta_w, int method);
 
+/*
+	Start from an existing MixingMatrix instead of a random one,
+	e.g. the one found for the previous window in a sliding-window separation.
+*/
+void Sound_and_MixingMatrix_improveUnmixing (Sound me, MixingMatrix thee, double startTime, double endTime, long ncovars, double lagStep, long maxNumberOfIterations, double delta_w, int method);
+
 autoSound Sound_to_Sound_BSS (Sound me, double startTime, double endTime, long ncovars, double lagStep, long maxNumberOfIterations, double delta_w, int method);
 
 autoSound Sound_whitenChannels (Sound me, double varianceFraction);
@@ -36,6 +36,7 @@
 #include "MDS.h"
 #include "SSCP.h"
 #include "PCA.h"
+#include "MelderThread.h"
 
 #define TINY 1e-30
 
@@ -1194,36 +1195,40 @@ autoScalarProduct Distance_to_ScalarProduct (Distance me, bool normalize) {
 /**********  Configuration & ..... ***********************************/
 
 
-autoDistance Configuration_to_Distance (Configuration me) {
-	try {
-		autoDistance thee = Distance_create (my numberOfRows);
-		TableOfReal_copyLabels (me, thee.get(), 1, -1);
-		for (long i = 1; i <= thy numberOfRows - 1; i++) {
-			for (long j = i + 1; j <= thy numberOfColumns; j++) {
-				double dmax = 0.0, d = 0.0;
+static void Configuration_into_Distance (Configuration me, Distance thee) {
+	for (long i = 1; i <= thy numberOfRows - 1; i++) {
+		for (long j = i + 1; j <= thy numberOfColumns; j++) {
+			double dmax = 0.0, d = 0.0;
 
-				/*
-					first divide distance by maximum to prevent overflow when metric is a large number.
-					d = (x^n)^(1/n) may overflow if x>1 & n >>1 even if d would not overflow!
-					metric changed 24/11/97
-					my w[k] * pow (|i-j|) instead of pow (my w[k] * |i-j|)
-				*/
+			/*
+				first divide distance by maximum to prevent overflow when metric is a large number.
+				d = (x^n)^(1/n) may overflow if x>1 & n >>1 even if d would not overflow!
+				metric changed 24/11/97
+				my w[k] * pow (|i-j|) instead of pow (my w[k] * |i-j|)
+			*/
 
-				for (long k = 1; k <= my numberOfColumns; k++) {
-					double dtmp  = fabs (my data[i][k] - my data[j][k]);
-					if (dtmp > dmax) {
-						dmax = dtmp;
-					}
+			for (long k = 1; k <= my numberOfColumns; k++) {
+				double dtmp  = fabs (my data[i][k] - my data[j][k]);
+				if (dtmp > dmax) {
+					dmax = dtmp;
 				}
-				if (dmax > 0.0) {
-					for (long k = 1; k <= my numberOfColumns; k++) {
-						double arg = fabs (my data[i][k] - my data[j][k]) / dmax;
-						d += my w[k] * pow (arg, my metric);
-					}
+			}
+			if (dmax > 0.0) {
+				for (long k = 1; k <= my numberOfColumns; k++) {
+					double arg = fabs (my data[i][k] - my data[j][k]) / dmax;
+					d += my w[k] * pow (arg, my metric);
 				}
-				thy data[i][j] = thy data[j][i] = dmax * pow (d, 1.0 / my metric);
 			}
+			thy data[i][j] = thy data[j][i] = dmax * pow (d, 1.0 / my metric);
 		}
+	}
+}
+
+autoDistance Configuration_to_Distance (Configuration me) {
+	try {
+		autoDistance thee = Distance_create (my numberOfRows);
+		TableOfReal_copyLabels (me, thee.get(), 1, -1);
+		Configuration_into_Distance (me, thee.get());
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": no Distance created.");
@@ -1587,39 +1592,50 @@ autoDistanceList DissimilarityList_to_DistanceList (DissimilarityList me, int me
 
 /*****************  Kruskal *****************************************/
 
-static void smacof_guttmanTransform (Configuration cx, Configuration cz, Distance disp, Weight weight, double **vplus) {
+static void smacof_guttmanTransform (Configuration cx, Configuration cz, Distance disp, Distance distZ, Weight weight, double **vplus, double **bz) {
 	long nPoints = cx -> numberOfRows, nDimensions = cx -> numberOfColumns;
-	double **z = cz -> data;
+	double **z = cz -> data, **x = cx -> data;
 
-	autoNUMmatrix<double> b (1, nPoints, 1, nPoints);
-	autoDistance distZ = Configuration_to_Distance (cz);
-
-	// compute B(Z) (eq. 8.25)
+	/*
+		Compute B(Z)Z (eq. 8.25) without storing B(Z): B is symmetric with rows that sum to zero,
+		so row i of B(Z)Z equals sum (j != i) b[i][j] (z[j] - z[i]). Only the upper triangle is visited.
+	*/
 
 	for (long i = 1; i <= nPoints; i++) {
-		double sum = 0.0;
-		for (long j = 1; j <= nPoints; j++) {
-			double dzij = distZ -> data[i][j];
-			if (i == j || dzij == 0.0) {
+		for (long k = 1; k <= nDimensions; k++) {
+			bz[i][k] = 0.0;
+		}
+	}
+	for (long i = 1; i <= nPoints - 1; i++) {
+		double *wi = weight -> data[i], *dispi = disp -> data[i], *dzi = distZ -> data[i];
+		double *zi = z[i], *bzi = bz[i];
+		for (long j = i + 1; j <= nPoints; j++) {
+			double dzij = dzi[j];
+			if (dzij == 0.0) {
 				continue;
 			}
-			b[i][j] = - weight -> data[i][j] * disp -> data[i][j] / dzij;
-			sum += b[i][j];
+			double bij = - wi[j] * dispi[j] / dzij;
+			double *zj = z[j], *bzj = bz[j];
+			for (long k = 1; k <= nDimensions; k++) {
+				double dz = bij * (zj[k] - zi[k]);
+				bzi[k] += dz;
+				bzj[k] -= dz;
+			}
 		}
-		b[i][i] = - sum;
 	}
 
-	// Guttman transform: Xu = (V+)B(Z)Z (eq. 8.29)
+	// Guttman transform: Xu = (V+)B(Z)Z (eq. 8.29), row by row so that the inner loop streams through memory.
 
 	for (long i = 1; i <= nPoints; i++) {
-		for (long j = 1; j <= nDimensions; j++) {
-			double xij = 0.0;
-			for (long k = 1;  k <= nPoints; k++) {
-				for (long l = 1; l <= nPoints; l++) {
-					xij += vplus[i][k] * b[k][l] * z[l][j];
-				}
+		double *xi = x[i], *vplusi = vplus[i];
+		for (long k = 1; k <= nDimensions; k++) {
+			xi[k] = 0.0;
+		}
+		for (long l = 1; l <= nPoints; l++) {
+			double vil = vplusi[l], *bzl = bz[l];
+			for (long k = 1; k <= nDimensions; k++) {
+				xi[k] += vil * bzl[k];
 			}
-			cx -> data[i][j] = xij;
 		}
 	}
 }
@@ -1795,88 +1811,108 @@ double Distance_Weight_congruenceCoefficient (Distance x, Distance y, Weight w)
 	return xy / (sqrt (x2) * sqrt (y2));
 }
 
-autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimilarity me, Configuration conf, Weight weight, Transformator t, double tolerance, long numberOfIterations, bool showProgress, double *stress) {
-	try {
-		long nPoints = conf -> numberOfRows;
-		long nDimensions = conf -> numberOfColumns;
-		double tol = 1e-6, stressp = 1e308, stres;
-		bool no_weight = ! weight;
+static void smacof_getVplus (Weight weight, double **vplus) {
+	long nPoints = weight -> numberOfRows;
+	double tol = 1e-6, **w = weight -> data;
+	autoNUMmatrix<double> v (1, nPoints, 1, nPoints);
 
-		if (my numberOfRows != nPoints || (!no_weight && weight -> numberOfRows != nPoints) || t -> numberOfPoints != nPoints) {
-			Melder_throw (U"Dimensions not in concordance.");
-		}
-		autoWeight aw;
-		if (no_weight) {
-			aw = Weight_create (nPoints);
-			weight = aw.get();
+	// Get V (eq. 8.19).
+
+	for (long i = 1; i <= nPoints; i++) {
+		double wsum = 0;
+		for (long j = 1; j <= nPoints; j++) {
+			if (i == j) {
+				continue;
+			}
+			v[i][j] = - w[i][j];
+			wsum += w[i][j];
 		}
-		autoNUMmatrix<double> v (1, nPoints, 1, nPoints);
-		autoNUMmatrix<double> vplus (1, nPoints, 1, nPoints);
-		autoConfiguration z = Data_copy (conf);
-		autoMDSVec vec = Dissimilarity_to_MDSVec (me);
+		v[i][i] = wsum;
+	}
 
-		double **w = weight -> data;
+	// V is row and column centered and therefore: rank(V) <= nPoints-1.
+	// V^-1 does not exist -> get Moore-Penrose inverse.
 
-		if (showProgress) {
-			Melder_progress (0.0, U"MDS analysis");
-		}
+	NUMpseudoInverse (v.peek(), nPoints, nPoints, vplus, tol);
+}
 
-		// Get V (eq. 8.19).
+/*
+	One smacof fit, starting from conf (which is overwritten).
+	V+ and the MDSVec only depend on the weights and the dissimilarities, respectively,
+	and are shared between repeated fits.
+*/
+static autoConfiguration smacof (Configuration conf, MDSVec vec, Weight weight, Transformator t, double **vplus, double tolerance, long numberOfIterations, bool showProgress, double *stress) {
+	long nPoints = conf -> numberOfRows;
+	long nDimensions = conf -> numberOfColumns;
+	double stressp = 1e308, stres = NUMundefined;
 
-		for (long i = 1; i <= nPoints; i++) {
-			double wsum = 0;
-			for (long j = 1; j <= nPoints; j++) {
-				if (i == j) {
-					continue;
-				}
-				v[i][j] = - w[i][j];
-				wsum += w[i][j];
-			}
-			v[i][i] = wsum;
-		}
+	autoConfiguration z = Data_copy (conf);
+	autoNUMmatrix<double> bz (1, nPoints, 1, nDimensions);
 
-		// V is row and column centered and therefore: rank(V) <= nPoints-1.
-		// V^-1 does not exist -> get Moore-Penrose inverse.
+	// The distances of conf are those of z at the start of every iteration: compute them only once per iteration.
 
-		NUMpseudoInverse (v.peek(), nPoints, nPoints, vplus.peek(), tol);
-		for (long iter = 1; iter <= numberOfIterations; iter++) {
-			autoDistance dist = Configuration_to_Distance (conf);
+	autoDistance dist = Configuration_to_Distance (conf);
+	for (long iter = 1; iter <= numberOfIterations; iter++) {
 
-			// transform & normalization
+		// transform & normalization
 
-			autoDistance fit = Transformator_transform (t, vec.get(), dist.get(), weight);
+		autoDistance fit = Transformator_transform (t, vec, dist.get(), weight);
 
-			// Make conf the Guttman transform of z
+		// Make conf the Guttman transform of z
 
-			smacof_guttmanTransform (conf, z.get(), fit.get(), weight, vplus.peek());
+		smacof_guttmanTransform (conf, z.get(), fit.get(), dist.get(), weight, vplus, bz.peek());
 
-			// Compute stress
+		// Compute stress
 
-			autoDistance cdist = Configuration_to_Distance (conf);
+		Configuration_into_Distance (conf, dist.get());
 
-			stres = Distance_Weight_stress (fit.get(), cdist.get(), weight, MDS_NORMALIZED_STRESS);
+		stres = Distance_Weight_stress (fit.get(), dist.get(), weight, MDS_NORMALIZED_STRESS);
 
-			// Check stop criterium
+		// Check stop criterium
 
-			if (fabs (stres - stressp) / stressp < tolerance) {
-				break;
-			}
+		if (fabs (stres - stressp) / stressp < tolerance) {
+			break;
+		}
 
-			// Make Z = X
+		// Make Z = X
 
-			NUMmatrix_copyElements (conf -> data, z -> data, 1, nPoints, 1, nDimensions);
+		NUMmatrix_copyElements (conf -> data, z -> data, 1, nPoints, 1, nDimensions);
 
-			stressp = stres;
-			if (showProgress) {
-				Melder_progress ((double) iter / (numberOfIterations + 1), U"kruskal: stress ", stres);
-			}
+		stressp = stres;
+		if (showProgress) {
+			Melder_progress ((double) iter / (numberOfIterations + 1), U"kruskal: stress ", stres);
+		}
+	}
+	if (stress) {
+		*stress = stres;
+	}
+	return z;
+}
+
+autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimilarity me, Configuration conf, Weight weight, Transformator t, double tolerance, long numberOfIterations, bool showProgress, double *stress) {
+	try {
+		long nPoints = conf -> numberOfRows;
+		bool no_weight = ! weight;
+
+		if (my numberOfRows != nPoints || (!no_weight && weight -> numberOfRows != nPoints) || t -> numberOfPoints != nPoints) {
+			Melder_throw (U"Dimensions not in concordance.");
+		}
+		autoWeight aw;
+		if (no_weight) {
+			aw = Weight_create (nPoints);
+			weight = aw.get();
+		}
+		autoNUMmatrix<double> vplus (1, nPoints, 1, nPoints);
+		autoMDSVec vec = Dissimilarity_to_MDSVec (me);
+
+		if (showProgress) {
+			Melder_progress (0.0, U"MDS analysis");
 		}
+		smacof_getVplus (weight, vplus.peek());
+		autoConfiguration z = smacof (conf, vec.get(), weight, t, vplus.peek(), tolerance, numberOfIterations, showProgress, stress);
 		if (showProgress) {
 			Melder_progress (1.0);
 		}
-		if (stress) {
-			*stress = stres;
-		}
 		return z;
 	} catch (MelderError) {
 		if (showProgress) {
@@ -1886,41 +1922,200 @@ autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissi
 	}
 }
 
+/*
+	Transformators keep data (ratio, I-spline design matrix and coefficients) that is changed by every transform,
+	therefore each thread needs its own one with the same settings.
+*/
+static autoTransformator Transformator_createCopyWithSameSettings (Transformator me) {
+	autoTransformator thee;
+	if (my classInfo == classISplineTransformator) {
+		ISplineTransformator him = static_cast<ISplineTransformator> (me);
+		thee = ISplineTransformator_create (my numberOfPoints, his numberOfInteriorKnots, his order);
+	} else if (my classInfo == classMonotoneTransformator) {
+		autoMonotoneTransformator monotone = MonotoneTransformator_create (my numberOfPoints);
+		MonotoneTransformator_setTiesProcessing (monotone.get(), static_cast<MonotoneTransformator> (me) -> tiesProcessing);
+		thee = monotone.move();
+	} else if (my classInfo == classRatioTransformator) {
+		thee = RatioTransformator_create (my numberOfPoints);
+	} else {
+		Melder_assert (my classInfo == classTransformator);
+		thee = Transformator_create (my numberOfPoints);
+	}
+	thy normalization = my normalization;
+	return thee;
+}
+
+Thing_define (MDS_multiSmacof_Args, Thing) { public:
+	MDSVec vec;
+	Weight weight;
+	Transformator transformator;
+	autoTransformator ownTransformator;
+	double **vplus;
+	ConfigurationList starts;
+	long firstRepetition, lastRepetition, numberOfRepetitions;
+	double tolerance;
+	long numberOfIterations;
+	autoConfiguration best;
+	double bestStress;
+	bool isMainThread, showMulti, showSingle, failed;
+	volatile int *cancelled;
+};
+
+Thing_implement (MDS_multiSmacof_Args, Thing, 0);
+
+static autoMDS_multiSmacof_Args MDS_multiSmacof_Args_create (MDSVec vec, Weight weight, Transformator t, double **vplus,
+	ConfigurationList starts, long firstRepetition, long lastRepetition, long numberOfRepetitions,
+	double tolerance, long numberOfIterations, bool isMainThread, bool showMulti, bool showSingle, volatile int *cancelled)
+{
+	autoMDS_multiSmacof_Args me = Thing_new (MDS_multiSmacof_Args);
+	my vec = vec;
+	my weight = weight;
+	if (isMainThread) {
+		my transformator = t;
+	} else {
+		my ownTransformator = Transformator_createCopyWithSameSettings (t);
+		my transformator = my ownTransformator.get();
+	}
+	my vplus = vplus;
+	my starts = starts;
+	my firstRepetition = firstRepetition;
+	my lastRepetition = lastRepetition;
+	my numberOfRepetitions = numberOfRepetitions;
+	my tolerance = tolerance;
+	my numberOfIterations = numberOfIterations;
+	my bestStress = 1e308;
+	my isMainThread = isMainThread;
+	my showMulti = showMulti;
+	my showSingle = showSingle;
+	my cancelled = cancelled;
+	return me;
+}
+
+static MelderThread_RETURN_TYPE MDS_multiSmacof (MDS_multiSmacof_Args me) {
+	for (long i = my firstRepetition; i <= my lastRepetition; i ++) {
+		if (my isMainThread) {
+			if (my showMulti) {
+				try {
+					Melder_progress ((double) (i - my firstRepetition) / (my lastRepetition - my firstRepetition + 1),
+						i - my firstRepetition + 1, U" from ", my lastRepetition - my firstRepetition + 1);
+				} catch (MelderError) {
+					*my cancelled = 1;
+					throw;
+				}
+			}
+		} else if (*my cancelled) {
+			MelderThread_RETURN;
+		}
+		try {
+			double stress;
+			autoConfiguration cresult = smacof (my starts -> at [i], my vec, my weight, my transformator, my vplus,
+				my tolerance, my numberOfIterations, my showSingle, & stress);
+			/*
+				Strictly smaller: on ties the earliest repetition wins, just as in a serial run.
+			*/
+			if (stress < my bestStress) {
+				my bestStress = stress;
+				my best = cresult.move();
+			}
+		} catch (MelderError) {
+			if (my isMainThread) {
+				*my cancelled = 1;
+				throw;
+			}
+			my failed = true;
+			*my cancelled = 1;
+			MelderThread_RETURN;
+		}
+	}
+	MelderThread_RETURN;
+}
+
 autoConfiguration Dissimilarity_Configuration_Weight_Transformator_multiSmacof (Dissimilarity me, Configuration conf,  Weight w, Transformator t, double tolerance, long numberOfIterations, long numberOfRepetitions, bool showProgress) {
 	int showMulti = showProgress && numberOfRepetitions > 1;
 	try {
+		long nPoints = conf -> numberOfRows;
 		bool showSingle = ( showProgress && numberOfRepetitions == 1 );
-		double stress, stressmax = 1e308;
 
-		autoConfiguration cstart = Data_copy (conf);
-		autoConfiguration  cbest = Data_copy (conf);
+		if (my numberOfRows != nPoints || (w && w -> numberOfRows != nPoints) || t -> numberOfPoints != nPoints) {
+			Melder_throw (U"Dimensions not in concordance.");
+		}
+		autoWeight aw;
+		if (! w) {
+			aw = Weight_create (nPoints);
+			w = aw.get();
+		}
+
+		/*
+			The start configurations are drawn here, in the order of a serial run,
+			so that the outcome does not depend on the number of threads.
+		*/
+
+		autoConfigurationList starts = ConfigurationList_create ();
+		starts -> addItem_move (Data_copy (conf));
+		for (long i = 2; i <= numberOfRepetitions; i++) {
+			autoConfiguration cstart = Data_copy (conf);
+			Configuration_randomize (cstart.get());
+			TableOfReal_centreColumns (cstart.get());
+			starts -> addItem_move (cstart.move());
+		}
+
+		autoMDSVec vec = Dissimilarity_to_MDSVec (me);
+		autoNUMmatrix<double> vplus (1, nPoints, 1, nPoints);
+		smacof_getVplus (w, vplus.peek());
 
 		if (showMulti) {
 			Melder_progress (0.0, U"MDS many times");
+		} else if (showSingle) {
+			Melder_progress (0.0, U"MDS analysis");
 		}
 
-		for (long i = 1; i <= numberOfRepetitions; i++) {
-			autoConfiguration cresult = Dissimilarity_Configuration_Weight_Transformator_smacof (me, cstart.get(), w, t, tolerance, numberOfIterations, showSingle, &stress);
-			if (stress < stressmax) {
-				stressmax = stress;
-				cbest = cresult.move();
-			}
-			Configuration_randomize (cstart.get());
-			TableOfReal_centreColumns (cstart.get());
+		int numberOfThreads = numberOfRepetitions;
+		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		long numberOfRepetitionsPerThread = (numberOfRepetitions - 1) / numberOfThreads + 1;
+		numberOfThreads = (numberOfRepetitions - 1) / numberOfRepetitionsPerThread + 1;
 
-			if (showMulti) {
-				Melder_progress ( (double) i / (numberOfRepetitions + 1), i, U" from ", numberOfRepetitions);
+		autoMDS_multiSmacof_Args args [16];
+		long firstRepetition = 1, lastRepetition = numberOfRepetitionsPerThread;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			if (ithread == numberOfThreads) lastRepetition = numberOfRepetitions;
+			args [ithread - 1] = MDS_multiSmacof_Args_create (vec.get(), w, t, vplus.peek(),
+				starts.get(), firstRepetition, lastRepetition, numberOfRepetitions, tolerance, numberOfIterations,
+				ithread == numberOfThreads, showMulti, showSingle, & cancelled);
+			firstRepetition = lastRepetition + 1;
+			lastRepetition += numberOfRepetitionsPerThread;
+		}
+		MelderThread_run (MDS_multiSmacof, args, numberOfThreads);
+
+		/*
+			Reduce in repetition order.
+		*/
+		autoConfiguration cbest;
+		double stressmax = 1e308;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			if (args [ithread - 1] -> failed) {
+				Melder_throw (U"Repetitions ", args [ithread - 1] -> firstRepetition, U" to ", args [ithread - 1] -> lastRepetition, U" failed.");
+			}
+			if (args [ithread - 1] -> best && args [ithread - 1] -> bestStress < stressmax) {
+				stressmax = args [ithread - 1] -> bestStress;
+				cbest = args [ithread - 1] -> best.move();
 			}
 		}
-		if (showMulti) {
+		if (! cbest) {
+			cbest = Data_copy (conf);
+		}
+		if (showProgress) {
 			Melder_progress (1.0);
 		}
 		return cbest;
 	} catch (MelderError) {
-		if (showMulti) {
+		if (showProgress) {
 			Melder_progress (1.0);
 		}
-		Melder_throw (me, U": no improved Configuration created (smacodf method).");
+		Melder_throw (me, U": no improved Configuration created (smacof method).");
 	}
 }
 
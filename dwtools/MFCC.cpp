@@ -82,6 +82,35 @@ autoTableOfReal MFCC_to_TableOfReal (MFCC me, bool includeC0) {
 	}
 }
 
+void MFCC_addFramesToSSCP (MFCC me, SSCP thee, bool includeC0) {
+	try {
+		long numberOfColumns = my maximumNumberOfCoefficients + (includeC0 ? 1 : 0);
+		if (thy numberOfColumns != numberOfColumns) {
+			Melder_throw (U"The dimension of the SSCP should be ", numberOfColumns, U".");
+		}
+		long offset = includeC0 ? 1 : 0, blockSize = 512;
+		autoNUMmatrix<double> block (1, blockSize, 1, numberOfColumns);
+		for (long ifirst = 1; ifirst <= my nx; ifirst += blockSize) {
+			long numberOfFrames = my nx - ifirst + 1 < blockSize ? my nx - ifirst + 1 : blockSize;
+			for (long i = 1; i <= numberOfFrames; i++) {
+				CC_Frame cf = (CC_Frame) & my frame[ifirst + i - 1];
+				for (long j = 1; j <= numberOfColumns; j++) {
+					block[i][j] = 0.0;
+				}
+				for (long j = 1; j <= cf -> numberOfCoefficients; j++) {
+					block[i][j + offset] = cf -> c[j];
+				}
+				if (includeC0) {
+					block[i][1] = cf -> c0;
+				}
+			}
+			SSCP_addVectors (thee, block.peek(), numberOfFrames);
+		}
+	} catch (MelderError) {
+		Melder_throw (me, U": frames not accumulated.");
+	}
+}
+
 // as_Sound not to_Sound
 autoSound MFCC_to_Sound (MFCC me) {
 	try {
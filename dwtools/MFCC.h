@@ -29,6 +29,7 @@
 #include "CC.h"
 #include "Sound.h"
 #include "TableOfReal.h"
+#include "SSCP.h"
 
 Thing_define (MFCC, CC) {
 };
@@ -63,6 +64,13 @@ void MFCC_lifter (MFCC me, long lifter);
 
 autoTableOfReal MFCC_to_TableOfReal (MFCC me, bool includeC0);
 
+void MFCC_addFramesToSSCP (MFCC me, SSCP thee, bool includeC0);
+/*
+	Accumulate the frames as observations in the SSCP, whose dimension must be
+	my maximumNumberOfCoefficients (+ 1 if includeC0). Missing coefficients count as zero,
+	as in MFCC_to_TableOfReal.
+*/
+
 autoSound MFCC_to_Sound (MFCC me);
 
 autoSound MFCCs_crossCorrelate (MFCC me, MFCC thee, enum kSounds_convolve_scaling scaling, enum kSounds_convolve_signalOutsideTimeDomain signalOutsideTimeDomain);
@@ -33,6 +33,7 @@
 #include "NUMclapack.h"
 #include "TableOfReal_extensions.h"
 #include "NUMmachar.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "Polynomial_def.h"
@@ -1170,9 +1171,44 @@ void Roots_draw (Roots me, Graphics g, double rmin, double rmax, double imin, do
 	}
 }
 
+/*
+	Find the roots of a polynomial as the eigenvalues of its companion matrix.
+	The caller supplies the storage: hes [1..n*n] for the Hessenberg matrix, wr [1..n] and wi [1..n]
+	for the eigenvalues, and work [1..lwork] (lwork = -1 only queries the optimal size into work [1]).
+	Returns the number of roots found; these are in wr [offset + 1 .. offset + numberOfRoots].
+*/
+static long Polynomial_companionMatrixEigenvalues (Polynomial me, double hes [], double wr [], double wi [], double work [], long lwork, long *p_offset) {
+	long np1 = my numberOfCoefficients, n = np1 - 1;
+
+	// Fill the upper Hessenberg matrix (storage is Fortran)
+	// C: [i][j] -> Fortran: (j-1)*n + i
+
+	for (long i = 1; i <= n * n; i++) {
+		hes[i] = 0.0;
+	}
+	for (long i = 1; i <= n; i++) {
+		hes[ (i - 1) *n + 1] = - (my coefficients[np1 - i] / my coefficients[np1]);
+		if (i < n) {
+			hes[ (i - 1) *n + 1 + i] = 1;
+		}
+	}
+
+	char job = 'E', compz = 'N';
+	long ilo = 1, ihi = n, ldh = n, ldz = n, info;
+	double *z = 0;
+	NUMlapack_dhseqr (&job, &compz, &n, &ilo, &ihi, &hes[1], &ldh, &wr[1], &wi[1], z, &ldz, &work[1], &lwork, &info);
+	if (info < 0) {
+		Melder_throw (U"Programming error. Argument ", info, U" in NUMlapack_dhseqr has illegal value.");
+	}
+	// if INFO = i, NUMlapack_dhseqr failed to compute all of the eigenvalues. Elements i+1:n of
+	// WR and WI contain those eigenvalues which have been successfully computed
+	*p_offset = info;
+	return n - info;
+}
+
 autoRoots Polynomial_to_Roots (Polynomial me) {
 	try {
-		long np1 = my numberOfCoefficients, n = np1 - 1, n2 = n * n;
+		long n = my numberOfCoefficients - 1, n2 = n * n;
 
 		if (n < 1) {
 			Melder_throw (U"Cannot find roots of a constant function.");
@@ -1185,46 +1221,22 @@ autoRoots Polynomial_to_Roots (Polynomial me) {
 		double *wr = &hes[n2];
 		double *wi = &hes[n2 + n];
 
-		// Fill the upper Hessenberg matrix (storage is Fortran)
-		// C: [i][j] -> Fortran: (j-1)*n + i
-
-		for (long i = 1; i <= n; i++) {
-			hes[ (i - 1) *n + 1] = - (my coefficients[np1 - i] / my coefficients[np1]);
-			if (i < n) {
-				hes[ (i - 1) *n + 1 + i] = 1;
-			}
-		}
-
 		// Find out the working storage needed
 
-		char job = 'E', compz = 'N';
-		long ilo = 1, ihi = n, ldh = n, ldz = n, lwork = -1, info;
-		double *z = 0, wt[1];
-		NUMlapack_dhseqr (&job, &compz, &n, &ilo, &ihi, &hes[1], &ldh, &wr[1], &wi[1], z, &ldz, wt, &lwork, &info);
-		if (info != 0) {
-			if (info < 0) {
-				Melder_throw (U"Programming error. Argument ", info, U" in NUMlapack_dhseqr has illegal value.");
-			}
-		}
-		lwork = (long) floor (wt[0]);
+		double wt[1];
+		long ioffset;
+		Polynomial_companionMatrixEigenvalues (me, hes.peek(), wr, wi, wt - 1, -1, &ioffset);
+		long lwork = (long) floor (wt[0]);
 		autoNUMvector<double> work (1, lwork);
 
 		// Find eigenvalues.
 
-		NUMlapack_dhseqr (&job, &compz, &n, &ilo, &ihi, &hes[1], &ldh, &wr[1], &wi[1], z, &ldz, &work[1], &lwork, &info);
-		long nrootsfound = n;
-		long ioffset = 0;
-		if (info > 0) {
-			// if INFO = i, NUMlapack_dhseqr failed to compute all of the eigenvalues. Elements i+1:n of
-			// WR and WI contain those eigenvalues which have been successfully computed
-			nrootsfound -= info;
-			if (nrootsfound < 1) {
-				Melder_throw (U"No roots found.");
-			}
+		long nrootsfound = Polynomial_companionMatrixEigenvalues (me, hes.peek(), wr, wi, work.peek(), lwork, &ioffset);
+		if (nrootsfound < 1) {
+			Melder_throw (U"No roots found.");
+		}
+		if (nrootsfound < n) {
 			Melder_warning (U"Calculated only ", nrootsfound, U" roots.");
-			ioffset = info;
-		} else if (info < 0) {
-			Melder_throw (U"Programming error. Argument ", info, U" in NUMlapack_dhseqr has illegal value.");
 		}
 
 		autoRoots thee = Roots_create (nrootsfound);
@@ -1261,6 +1273,192 @@ void Roots_and_Polynomial_polish (Roots me, Polynomial thee) {
 	}
 }
 
+/********** PolynomialRootFinder **********/
+
+Thing_implement (PolynomialRootFinder, Thing, 0);
+
+autoPolynomialRootFinder PolynomialRootFinder_create (long maximumDegree) {
+	try {
+		Melder_assert (maximumDegree > 0);
+		NUMlapack_initLock ();   // root finders are created in the main thread, and may be used in others
+		autoPolynomialRootFinder me = Thing_new (PolynomialRootFinder);
+		my maximumDegree = maximumDegree;
+		my polynomial = Polynomial_create (-1.0, 1.0, maximumDegree);
+		my roots = Roots_create (maximumDegree);
+		my previousRoots.reset (1, maximumDegree);
+		my hessenberg.reset (1, maximumDegree * maximumDegree);
+		my wr.reset (1, maximumDegree);
+		my wi.reset (1, maximumDegree);
+		double wt [1];
+		long offset;
+		Polynomial_companionMatrixEigenvalues (my polynomial.get(), my hessenberg.peek(), my wr.peek(), my wi.peek(), wt - 1, -1, & offset);
+		my lwork = MAX (maximumDegree, (long) floor (wt [0]));
+		my work.reset (1, my lwork);
+		if (! NUMfpp) {
+			NUMmachar ();
+		}
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"PolynomialRootFinder not created.");
+	}
+}
+
+/*
+	All roots have to be simple and polished up to a backward error of a few ulps,
+	and complex roots have to come in adjacent conjugate pairs.
+*/
+static bool Roots_and_Polynomial_areAllRoots (Roots me, Polynomial thee) {
+	long degree = thy numberOfCoefficients - 1;
+	if (my max - my min + 1 != degree) {
+		return false;
+	}
+	double tolerance = 64.0 * degree * NUMfpp -> eps;
+	for (long i = my min; i <= my max; i++) {
+		dcomplex z = my v[i], p, dp;
+		Polynomial_evaluateWithDerivative_z (thee, & z, & p, & dp);
+		double zabs = dcomplex_abs (z), bound = 0.0;
+		for (long k = thy numberOfCoefficients; k > 0; k--) {
+			bound = bound * zabs + fabs (thy coefficients[k]);
+		}
+		if (! (dcomplex_abs (p) <= tolerance * bound)) {
+			return false;
+		}
+		if (z.im != 0.0 && ! ( (i > my min && my v[i - 1].re == z.re && my v[i - 1].im == -z.im) ||
+			(i < my max && my v[i + 1].re == z.re && my v[i + 1].im == -z.im))) {
+			return false;
+		}
+		for (long j = my min; j < i; j++) {
+			if (dcomplex_abs (dcomplex_sub (z, my v[j])) <= 1e-8 * (zabs + dcomplex_abs (my v[j]))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/*
+	Ehrlich-Aberth iteration: Newton's method for all roots at once, in which every approximation
+	is repelled by the others, so that no two of them can converge to the same root.
+	Returns true if all corrections have become negligible within maxit iterations.
+*/
+static bool Polynomial_improveRoots_aberth (Polynomial me, dcomplex z [], long n, long maxit) {
+	dcomplex one = dcomplex_create (1.0, 0.0);
+	for (long iter = 1; iter <= maxit; iter++) {
+		bool converged = true;
+		for (long k = 1; k <= n; k++) {
+			dcomplex p, dp;
+			Polynomial_evaluateWithDerivative_z (me, & z[k], & p, & dp);
+			if (p.re == 0.0 && p.im == 0.0) {
+				continue;
+			}
+			if (dp.re == 0.0 && dp.im == 0.0) {
+				return false;
+			}
+			dcomplex ratio = dcomplex_div (p, dp), sum = dcomplex_create (0.0, 0.0);
+			for (long j = 1; j <= n; j++) {
+				if (j != k) {
+					sum = dcomplex_add (sum, dcomplex_div (one, dcomplex_sub (z[k], z[j])));
+				}
+			}
+			dcomplex w = dcomplex_div (ratio, dcomplex_sub (one, dcomplex_mul (ratio, sum)));
+			z[k] = dcomplex_sub (z[k], w);
+			if (! (dcomplex_abs (w) <= 1e-12 * dcomplex_abs (z[k]))) {   // also if NaN
+				converged = false;
+			}
+		}
+		if (converged) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+	Make the roots of a real polynomial real or exactly conjugate in adjacent pairs (a+bi, a-bi) with b > 0,
+	as Roots_and_Polynomial_polish expects. Returns false if some complex root has no conjugate partner.
+*/
+static bool Roots_pairConjugates (Roots me) {
+	long i = my min;
+	while (i <= my max) {
+		dcomplex z = my v[i];
+		double zabs = dcomplex_abs (z);
+		if (fabs (z.im) <= 1e-10 * zabs) {
+			my v[i].im = 0.0;
+			i++;
+			continue;
+		}
+		long jbest = 0;
+		double dbest = 1e-8 * zabs;
+		for (long j = i + 1; j <= my max; j++) {
+			double d = dcomplex_abs (dcomplex_sub (my v[j], dcomplex_conjugate (z)));
+			if (d <= dbest) {
+				jbest = j;
+				dbest = d;
+			}
+		}
+		if (jbest == 0) {
+			return false;
+		}
+		dcomplex partner = my v[jbest];
+		my v[jbest] = my v[i + 1];
+		double re = 0.5 * (z.re + partner.re), im = 0.5 * (fabs (z.im) + fabs (partner.im));
+		my v[i] = dcomplex_create (re, im);
+		my v[i + 1] = dcomplex_create (re, -im);
+		i += 2;
+	}
+	return true;
+}
+
+bool PolynomialRootFinder_findRoots (PolynomialRootFinder me, bool warmStart) {
+	Polynomial p = my polynomial.get();
+	Roots roots = my roots.get();
+	long degree = p -> numberOfCoefficients - 1;
+	Melder_assert (degree > 0 && degree <= my maximumDegree);
+
+	if (warmStart && my numberOfPreviousRoots == degree) {
+		roots -> max = degree;
+		for (long i = 1; i <= degree; i++) {
+			roots -> v[i] = my previousRoots[i];
+		}
+		if (Polynomial_improveRoots_aberth (p, roots -> v, degree, 20) && Roots_pairConjugates (roots)) {
+			Roots_and_Polynomial_polish (roots, p);
+		}
+		if (Roots_and_Polynomial_areAllRoots (roots, p)) {
+			for (long i = 1; i <= degree; i++) {
+				my previousRoots[i] = roots -> v[i];
+			}
+			return true;
+		}
+	}
+
+	long offset, numberOfRoots;
+	{
+		/*
+			NUMlapack_dhseqr is not reentrant, so root finders in different threads take turns;
+			the lock must not stay held if the eigenvalue method throws.
+		*/
+		NUMlapack_lock ();
+		try {
+			numberOfRoots = Polynomial_companionMatrixEigenvalues (p, my hessenberg.peek(), my wr.peek(), my wi.peek(), my work.peek(), my lwork, & offset);
+		} catch (MelderError) {
+			NUMlapack_unlock ();
+			throw;
+		}
+		NUMlapack_unlock ();
+	}
+	roots -> max = numberOfRoots;
+	for (long i = 1; i <= numberOfRoots; i++) {
+		roots -> v[i].re = my wr[offset + i];
+		roots -> v[i].im = my wi[offset + i];
+	}
+	Roots_and_Polynomial_polish (roots, p);
+	my numberOfPreviousRoots = numberOfRoots == degree ? degree : 0;
+	for (long i = 1; i <= my numberOfPreviousRoots; i++) {
+		my previousRoots[i] = roots -> v[i];
+	}
+	return numberOfRoots == degree;
+}
+
 autoPolynomial Roots_to_Polynomial (Roots me, bool rootsAreReal) {
 	try {
 		(void) me;
@@ -205,6 +205,26 @@ autoSpectrum Roots_to_Spectrum (Roots me, double nyquistFrequency, long numberOf
 autoRoots Polynomial_to_Roots (Polynomial me);
 /* Find roots of polynomial and polish them */
 
+Thing_define (PolynomialRootFinder, Thing) {
+	long maximumDegree;
+	autoPolynomial polynomial;   // the caller fills in numberOfCoefficients (at most maximumDegree + 1) and coefficients
+	autoRoots roots;   // roots [1..max] of the polynomial after PolynomialRootFinder_findRoots
+	autoNUMvector <dcomplex> previousRoots;
+	long numberOfPreviousRoots;
+	autoNUMvector <double> hessenberg, wr, wi, work;
+	long lwork;
+};
+
+autoPolynomialRootFinder PolynomialRootFinder_create (long maximumDegree);
+/* Workspace for finding the roots of many polynomials of degree <= maximumDegree, e.g. one per analysis frame. */
+
+bool PolynomialRootFinder_findRoots (PolynomialRootFinder me, bool warmStart);
+/* Finds and polishes the roots of my polynomial without allocating memory.
+ * With warmStart, the roots of the previous polynomial are polished first and accepted if they are all simple roots
+ * of the current polynomial; otherwise the eigenvalues of the companion matrix are used.
+ * Returns false if not all roots could be found. Can be used from several threads, one finder per thread.
+ */
+
 double Polynomial_findOneSimpleRealRoot_nr (Polynomial me, double xmin, double xmax);
 double Polynomial_findOneSimpleRealRoot_ridders (Polynomial me, double xmin, double xmax);
 /* Preconditions: there must be exactly one root in the [xmin, xmax] interval;
@@ -63,6 +63,7 @@
 #include "NUMlapack.h"
 #include "NUM2.h"
 #include "SVD.h"
+#include "NUMcblas.h"
 
 #include "oo_DESTROY.h"
 #include "SSCP_def.h"
@@ -513,9 +514,138 @@ autoTableOfReal Covariance_to_TableOfReal_randomSampling (Covariance me, long nu
 	}
 }
 
+/*
+	The streaming functions below keep the SSCP itself as the accumulator: numberOfObservations, centroid and
+	the sums of squares and cross products around the centroid are exactly what has to be updated.
+	A block of vectors is first reduced to its own centroid and sscp (two passes over data that are in the cache),
+	after which it is combined with the accumulated statistics by the pairwise update of Chan, Golub & LeVeque (1979):
+		n = na + nb, delta = mb - ma, m = ma + delta * nb / n, S = Sa + Sb + delta delta' * na * nb / n.
+	This is numerically much more stable than accumulating raw sums of squares, and merging two partial
+	accumulators gives the same result as accumulating all data in one of them.
+*/
+
+#define SSCP_BLOCKSIZE  512
+
+static void SSCP_checkFullStorage (SSCP me) {
+	if (my numberOfRows != my numberOfColumns) {
+		Melder_throw (me, U": cannot accumulate into an SSCP with reduced storage.");
+	}
+}
+
+static void SSCP_addBlockStatistics (SSCP me, double nb, double *mb, double **sb) {
+	long p = my numberOfColumns;
+	double na = my numberOfObservations, n = na + nb;
+	if (nb <= 0.0) {
+		return;
+	}
+	double factor = na * nb / n;
+	for (long i = 1; i <= p; i ++) {
+		double deltai = mb [i] - my centroid [i];
+		for (long j = i; j <= p; j ++) {
+			double deltaj = mb [j] - my centroid [j];
+			my data [j] [i] = my data [i] [j] += sb [i] [j] + factor * deltai * deltaj;
+		}
+	}
+	for (long i = 1; i <= p; i ++) {
+		my centroid [i] += (mb [i] - my centroid [i]) * (nb / n);
+	}
+	my numberOfObservations = n;
+}
+
+void SSCP_addVectors (SSCP me, double **vectors, long numberOfVectors) {
+	try {
+		SSCP_checkFullStorage (me);
+		if (numberOfVectors < 1) {
+			return;
+		}
+		long p = my numberOfColumns;
+		if (! NUMdmatrix_hasFiniteElements (vectors, 1, numberOfVectors, 1, p)) {
+			Melder_throw (U"At least one of the elements is not finite or undefined.");
+		}
+		autoNUMvector<double> mean (1, p);
+		autoNUMmatrix<double> sscp (1, p, 1, p);
+		NUMcentreColumns (vectors, 1, numberOfVectors, 1, p, mean.peek());
+		/*
+			vectors [1..numberOfVectors] [1..p] is, read in column-major order, the p x numberOfVectors matrix A;
+			sscp = A A' then has the upper triangle of the row-major sscp [i] [j] (i <= j) in its lower triangle.
+		*/
+		double alpha = 1.0, beta = 0.0;
+		long lda = p, ldc = p;
+		NUMblas_dsyrk ("L", "N", & p, & numberOfVectors, & alpha, & vectors [1] [1], & lda, & beta, & sscp [1] [1], & ldc);
+		SSCP_addBlockStatistics (me, numberOfVectors, mean.peek(), sscp.peek());
+	} catch (MelderError) {
+		Melder_throw (me, U": vectors not accumulated.");
+	}
+}
+
+void SSCP_addTableOfRealRows (SSCP me, TableOfReal thee, long rowb, long rowe, long colb) {
+	try {
+		long p = my numberOfColumns;
+		if (rowb == 0 && rowe == 0) {
+			rowb = 1;
+			rowe = thy numberOfRows;
+		} else if (rowe < rowb || rowb < 1 || rowe > thy numberOfRows) {
+			Melder_throw (U"Invalid row number.");
+		}
+		if (colb < 1 || colb + p - 1 > thy numberOfColumns) {
+			Melder_throw (U"The table should have at least ", p, U" columns from column ", colb, U" on.");
+		}
+		autoNUMmatrix<double> block (1, SSCP_BLOCKSIZE, 1, p);
+		for (long ifirst = rowb; ifirst <= rowe; ifirst += SSCP_BLOCKSIZE) {
+			long numberOfVectors = MIN (SSCP_BLOCKSIZE, rowe - ifirst + 1);
+			for (long i = 1; i <= numberOfVectors; i ++) {
+				NUMvector_copyElements (& thy data [ifirst + i - 1] [colb - 1], block [i], 1, p);
+			}
+			SSCP_addVectors (me, block.peek(), numberOfVectors);
+		}
+	} catch (MelderError) {
+		Melder_throw (me, U": rows from ", thee, U" not accumulated.");
+	}
+}
+
+void SSCP_addMatrixColumns (SSCP me, Matrix thee, long colb, long cole, long rowb) {
+	try {
+		long p = my numberOfColumns;
+		if (colb == 0 && cole == 0) {
+			colb = 1;
+			cole = thy nx;
+		} else if (cole < colb || colb < 1 || cole > thy nx) {
+			Melder_throw (U"Invalid column number.");
+		}
+		if (rowb < 1 || rowb + p - 1 > thy ny) {
+			Melder_throw (U"The matrix should have at least ", p, U" rows from row ", rowb, U" on.");
+		}
+		autoNUMmatrix<double> block (1, SSCP_BLOCKSIZE, 1, p);
+		for (long ifirst = colb; ifirst <= cole; ifirst += SSCP_BLOCKSIZE) {
+			long numberOfVectors = MIN (SSCP_BLOCKSIZE, cole - ifirst + 1);
+			for (long j = 1; j <= p; j ++) {
+				const double *row = thy z [rowb + j - 1];
+				for (long i = 1; i <= numberOfVectors; i ++) {
+					block [i] [j] = row [ifirst + i - 1];
+				}
+			}
+			SSCP_addVectors (me, block.peek(), numberOfVectors);
+		}
+	} catch (MelderError) {
+		Melder_throw (me, U": columns from ", thee, U" not accumulated.");
+	}
+}
+
+void SSCP_addSSCP (SSCP me, SSCP thee) {
+	try {
+		SSCP_checkFullStorage (me);
+		SSCP_checkFullStorage (thee);
+		if (thy numberOfColumns != my numberOfColumns) {
+			Melder_throw (U"The dimensions should be equal.");
+		}
+		SSCP_addBlockStatistics (me, thy numberOfObservations, thy centroid, thy data);
+	} catch (MelderError) {
+		Melder_throw (me, U": ", thee, U" not added.");
+	}
+}
+
 autoSSCP TableOfReal_to_SSCP (TableOfReal me, long rowb, long rowe, long colb, long cole) {
 	try {
-		
 		if (! NUMdmatrix_hasFiniteElements(my data, 1, my numberOfRows, 1, my numberOfColumns)) {
 			Melder_throw (U"At least one of the table's elements is not finite or undefined.");
 		}
@@ -543,31 +673,8 @@ autoSSCP TableOfReal_to_SSCP (TableOfReal me, long rowb, long rowe, long colb, l
 				"(The number of data points was less than the number of variables.)");
 		}
 		autoSSCP thee = SSCP_create (numberOfColumns);
-		autoNUMmatrix<double> v (1, numberOfRows, 1, numberOfColumns);
+		SSCP_addTableOfRealRows (thee.get(), me, rowb, rowe, colb);
 
-		long nvalidrows = 0;
-		for (long i = 1; i <= numberOfRows; i++) {
-			nvalidrows++;
-			for (long j = 1; j <= numberOfColumns; j++) {
-				v[i][j] = my data[rowb + i - 1][colb + j - 1];
-			}
-		}
-
-		NUMcentreColumns (v.peek(), 1, numberOfRows, 1, numberOfColumns, thy centroid);
-
-		SSCP_setNumberOfObservations (thee.get(), numberOfRows);
-
-		// sum of squares and cross products = T'T
-
-		for (long i = 1; i <= numberOfColumns; i++) {
-			for (long j = i; j <= numberOfColumns; j++) {
-				double t = 0.0;
-				for (long k = 1; k <= numberOfRows; k++) {
-					t += v[k][i] * v[k][j];
-				}
-				thy data[i][j] = thy data[j][i] = t;
-			}
-		}
 		for (long j = 1; j <= numberOfColumns; j++) {
 			char32 *label = my columnLabels[colb + j - 1];
 			TableOfReal_setColumnLabel (thee.get(), j, label);
@@ -963,6 +1070,18 @@ autoCCA SSCP_to_CCA (SSCP me, long ny) {
 
 /************ SSCPList ***********************************************/
 
+autoSSCP SSCPList_to_SSCP_sum (SSCPList me) {
+	try {
+		autoSSCP thee = Data_copy (my at [1]);
+		for (long k = 2; k <= my size; k ++) {
+			SSCP_addSSCP (thee.get(), my at [k]);
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": not summed.");
+	}
+}
+
 autoSSCP SSCPList_to_SSCP_pool (SSCPList me) {
 	try {
 		autoSSCP thee = Data_copy (my at [1]);
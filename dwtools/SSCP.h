@@ -76,6 +76,27 @@ double SSCP_getFractionVariation (SSCP me, long from, long to);
 
 autoSSCP TableOfReal_to_SSCP (TableOfReal me, long rowb, long rowe, long colb, long cole);
 
+void SSCP_addVectors (SSCP me, double **vectors, long numberOfVectors);
+/*
+	Accumulate the observations vectors [1..numberOfVectors] [1..my numberOfColumns] into the SSCP,
+	updating numberOfObservations, centroid and the sums of squares and cross products.
+	The vectors must be stored contiguously (as in a NUMmatrix with my numberOfColumns columns);
+	they are used as workspace and will be centred on return.
+	Start with an SSCP_create (dimension), which has no observations.
+*/
+
+void SSCP_addTableOfRealRows (SSCP me, TableOfReal thee, long rowb, long rowe, long colb);
+/* Accumulate the rows [rowb..rowe] (0, 0: all), columns [colb..colb+my numberOfColumns-1]. */
+
+void SSCP_addMatrixColumns (SSCP me, Matrix thee, long colb, long cole, long rowb);
+/* Accumulate the frames in columns [colb..cole] (0, 0: all), rows [rowb..rowb+my numberOfColumns-1]. */
+
+void SSCP_addSSCP (SSCP me, SSCP thee);
+/*
+	Merge the observations of thee into me, e.g. partial results of parallel workers.
+	The result equals the SSCP of all observations together.
+*/
+
 autoTableOfReal SSCP_and_TableOfReal_extractDistanceQuantileRange (SSCP me, TableOfReal thee, double qlow, double qhigh);
 
 autoTableOfReal Covariance_and_TableOfReal_extractDistanceQuantileRange (Covariance me, TableOfReal thee, double qlow, double qhigh);
@@ -212,7 +233,10 @@ autoCovariance CovarianceList_to_Covariance_pool (CovarianceList me);
 autoSSCPList TableOfReal_to_SSCPList_byLabel (TableOfReal me);
 
 autoSSCP SSCPList_to_SSCP_sum (SSCPList me);
-/* Sum the sscp's and weigh each means with it's numberOfObservations. */
+/*
+	The SSCP of all observations of the SSCP's together (the 'total' sscp):
+	the between-groups scatter of the centroids is included.
+*/
 
 autoSSCP SSCPList_to_SSCP_pool (SSCPList me);
 
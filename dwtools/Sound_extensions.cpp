@@ -657,11 +657,11 @@ autoSound Sound_createGammaTone (double minimumTime, double maximumTime, double
 	}
 }
 
-static void NUMgammatoneFilter4 (double *x, double *y, long n, double centre_frequency, double bandwidth, double samplingFrequency) {
-	double a[5], b[9], dt = 1.0 / samplingFrequency, wt = NUMpi * centre_frequency * dt;
+static void NUMgammatoneFilter4_getCoefficients (double centre_frequency, double bandwidth, double samplingFrequency, double a [5], double b [9]) {
+	double dt = 1.0 / samplingFrequency, wt = NUMpi * centre_frequency * dt;
 	double bt = 2 * NUMpi * bandwidth * dt, dt2 = dt * dt, dt4 = dt2 * dt2;
 
-	Melder_assert (n > 0 && centre_frequency > 0 && bandwidth >= 0 && samplingFrequency > 0);
+	Melder_assert (centre_frequency > 0 && bandwidth >= 0 && samplingFrequency > 0);
 
 	/*
 		The filter function is:
@@ -731,7 +731,15 @@ static void NUMgammatoneFilter4 (double *x, double *y, long n, double centre_fre
 			Melder_casual (U"b[", i, U"] = ", b[i]);
 		}
 	}
+}
 
+/*
+	The coefficients depend only on the filter and the sampling frequency,
+	so they are computed once and then applied to every channel.
+	x and y are base-1 and must not overlap, because y [i] is computed from x [i - 4..i]
+	after y [i - 4..i - 1] have been written; so this does not filter in place.
+*/
+static void NUMgammatoneFilter4_apply (const double a [5], const double b [9], const double *x, double *y, long n) {
 	/* Perform the filtering. For the first 8 samples we must do some extra work.
 	y[1] = a[0] * x[1];
 	if (n > 1) {
@@ -803,20 +811,10 @@ autoSound Sound_filterByGammaToneFilter4 (Sound me, double centre_frequency, dou
 		}
 
 		autoSound thee = Sound_create (my ny, my xmin, my xmax, my nx, my dx, my x1);
-		autoNUMvector<double> y (1, my nx);
-		autoNUMvector<double> x (1, my nx);
-
-		double fs = 1 / my dx;
+		double a[5], b[9];
+		NUMgammatoneFilter4_getCoefficients (centre_frequency, bandwidth, 1.0 / my dx, a, b);
 		for (long channel = 1; channel <= my ny; channel++) {
-			for (long i = 1; i <= my nx; i++) {
-				x[i] = my z[channel][i];
-			}
-
-			NUMgammatoneFilter4 (x.peek(), y.peek(), my nx, centre_frequency, bandwidth, fs);
-
-			for (long i = 1; i <= my nx; i++) {
-				thy z[channel][i] = y[i];
-			}
+			NUMgammatoneFilter4_apply (a, b, my z[channel], thy z[channel], my nx);   // from the original channel straight into the new one
 		}
 		return thee;
 	} catch (MelderError) {
@@ -29,12 +29,12 @@
 #include "Sound_to_SPINET.h"
 #include "SPINET_to_Pitch.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
-static int spec_enhance_SHS (double a[], long n) {
+static int spec_enhance_SHS (double a[], long n, long posmax[]) {   // posmax [1.. (n + 1) / 2]
 	if (n < 2) {
 		return 0;
 	}
-	autoNUMvector<long> posmax (1, (n + 1) / 2);
 	long nmax = 0;
 	if (a[1] > a[2]) {
 		posmax[++nmax] = 1;
@@ -69,13 +69,349 @@ static void spec_smoooth_SHS (double a[], long n) {
 	}
 }
 
+/*
+	The log2 frequencies of the spectrum and of the octave scale are the same for every frame,
+	so the parts of the cubic spline (NUMspline, NUMsplint) that depend only on them are computed once.
+	The arithmetic per frame is the same as that of NUMspline and NUMsplint.
+*/
+Thing_define (SHS_Tables, Thing) { public:
+	long nfft, nfft2, nFrequencyPoints, nSubharmonicShifts;
+	double *fl2, *splineSig, *splineP, *splineY2;   // [1..nfft2]
+	long *interpolationLow;   // [1..nFrequencyPoints]
+	double *interpolationA, *interpolationB, *interpolationH2, *arctg;   // [1..nFrequencyPoints]
+	long *subharmonicShift;   // [1..nSubharmonicShifts]
+	double *subharmonicWeight;   // [1..nSubharmonicShifts]
+
+	void v_destroy () noexcept
+		override;
+};
+
+Thing_implement (SHS_Tables, Thing, 0);
+
+void structSHS_Tables :: v_destroy () noexcept {
+	NUMvector_free (fl2, 1);
+	NUMvector_free (splineSig, 1);
+	NUMvector_free (splineP, 1);
+	NUMvector_free (splineY2, 1);
+	NUMvector_free (interpolationLow, 1);
+	NUMvector_free (interpolationA, 1);
+	NUMvector_free (interpolationB, 1);
+	NUMvector_free (interpolationH2, 1);
+	NUMvector_free (arctg, 1);
+	NUMvector_free (subharmonicShift, 1);
+	NUMvector_free (subharmonicWeight, 1);
+	SHS_Tables_Parent :: v_destroy ();
+}
+
+static autoSHS_Tables SHS_Tables_create (long nfft, double df, double fminl2, double dfl2, long nFrequencyPoints,
+	long nPointsPerOctave, long maxnSubharmonics, double compressionFactor)
+{
+	autoSHS_Tables me = Thing_new (SHS_Tables);
+	long nfft2 = nfft / 2 + 1;
+	my nfft = nfft;
+	my nfft2 = nfft2;
+	my nFrequencyPoints = nFrequencyPoints;
+	my fl2 = NUMvector<double> (1, nfft2);
+	my splineSig = NUMvector<double> (1, nfft2);
+	my splineP = NUMvector<double> (1, nfft2);
+	my splineY2 = NUMvector<double> (1, nfft2);
+	my interpolationLow = NUMvector<long> (1, nFrequencyPoints);
+	my interpolationA = NUMvector<double> (1, nFrequencyPoints);
+	my interpolationB = NUMvector<double> (1, nFrequencyPoints);
+	my interpolationH2 = NUMvector<double> (1, nFrequencyPoints);
+	my arctg = NUMvector<double> (1, nFrequencyPoints);
+
+	/*
+		For the cubic spline interpolation we need the frequencies on an octave
+		scale, i.e., a log2 scale. All frequencies must be DIFFERENT, otherwise
+		the cubic spline interpolation will give corrupt results.
+		Because log2(f==0) is not defined, we use the heuristic: f[2]-f[1] == f[3]-f[2].
+	*/
+
+	double *x = my fl2;
+	for (long i = 2; i <= nfft2; i++) {
+		x[i] = NUMlog2 ((i - 1) * df);
+	}
+	x[1] = 2 * x[2] - x[3];
+
+	// The data-independent part of the tridiagonal system of NUMspline (natural spline).
+
+	my splineY2[1] = 0.0;
+	for (long i = 2; i <= nfft2 - 1; i++) {
+		double sig = (x[i] - x[i - 1]) / (x[i + 1] - x[i - 1]);
+		double p = sig * my splineY2[i - 1] + 2.0;
+		my splineSig[i] = sig;
+		my splineP[i] = p;
+		my splineY2[i] = (sig - 1.0) / p;
+	}
+
+	// The interval and weights of NUMsplint for every point on the octave scale.
+
+	for (long j = 1; j <= nFrequencyPoints; j++) {
+		double f = fminl2 + (j - 1) * dfl2;
+		long klo = 1, khi = nfft2;
+		while (khi - klo > 1) {
+			long k = (khi + klo) >> 1;
+			if (x[k] > f) {
+				khi = k;
+			} else {
+				klo = k;
+			}
+		}
+		double h = x[khi] - x[klo];
+		if (h == 0.0) {
+			Melder_throw (U"NUMsplint: bad input value.");
+		}
+		my interpolationLow[j] = klo;
+		my interpolationA[j] = (x[khi] - f) / h;
+		my interpolationB[j] = (f - x[klo]) / h;
+		my interpolationH2[j] = h * h;
+	}
+
+	// Frequencies regularly spaced on a log2-scale and the frequency weighting function.
+
+	double atans = nPointsPerOctave * NUMlog2 (65.0 / 50.0) - 1;
+	for (long i = 1; i <= nFrequencyPoints; i++) {
+		my arctg[i] = 0.5 + atan (3.0 * (i - atans) / nPointsPerOctave) / NUMpi;
+	}
+
+	// The subharmonic summation as shifts in octaves with compressed weights.
+
+	my nSubharmonicShifts = maxnSubharmonics + 1;
+	my subharmonicShift = NUMvector<long> (1, my nSubharmonicShifts);
+	my subharmonicWeight = NUMvector<double> (1, my nSubharmonicShifts);
+	double hm = 1;
+	for (long m = 1; m <= my nSubharmonicShifts; m++) {
+		my subharmonicShift[m] = 1 + (long) floor (nPointsPerOctave * NUMlog2 (m));
+		my subharmonicWeight[m] = hm;
+		hm *= compressionFactor;
+	}
+	return me;
+}
+
+/*
+	From amplitude spectrum y [1..nfft2] to the interpolated values on the octave scale al2 [1..nFrequencyPoints].
+	y2 and u are work vectors [1..nfft2].
+*/
+static void SHS_Tables_interpolate (SHS_Tables me, const double y[], double y2[], double u[], double al2[]) {
+	const double *x = my fl2;
+	long n = my nfft2;
+	y2[1] = u[1] = 0.0;
+	for (long i = 2; i <= n - 1; i++) {
+		y2[i] = my splineY2[i];
+		u[i] = (y[i + 1] - y[i]) / (x[i + 1] - x[i]) - (y[i] - y[i - 1]) / (x[i] - x[i - 1]);
+		u[i] = (6.0 * u[i] / (x[i + 1] - x[i - 1]) - my splineSig[i] * u[i - 1]) / my splineP[i];
+	}
+	double qn = 0.0, un = 0.0;
+	y2[n] = (un - qn * u[n - 1]) / (qn * y2[n - 1] + 1.0);
+	for (long k = n - 1; k >= 1; k--) {
+		y2[k] = y2[k] * y2[k + 1] + u[k];
+	}
+	for (long j = 1; j <= my nFrequencyPoints; j++) {
+		long klo = my interpolationLow[j], khi = klo + 1;
+		double a = my interpolationA[j], b = my interpolationB[j];
+		al2[j] = a * y[klo] + b * y[khi] + ( (a * a * a - a) * y2[klo] +
+			(b * b * b - b) * y2[khi]) * my interpolationH2[j] / 6.0;
+	}
+}
+
+Thing_define (Sound_into_Pitch_shs_Args, Thing) { public:
+	Sound sound, hamming;
+	Pitch pitch;
+	SHS_Tables tables;
+	double *cc;
+	long firstFrame, lastFrame, nx, maxnCandidates;
+	double halfWindow, frameDuration, globalPeak, fminl2, dfl2;
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (Sound_into_Pitch_shs_Args, Thing, 0);
+
+static autoSound_into_Pitch_shs_Args Sound_into_Pitch_shs_Args_create (Sound sound, Sound hamming, Pitch pitch, SHS_Tables tables,
+	double *cc, long firstFrame, long lastFrame, long nx, long maxnCandidates, double halfWindow, double frameDuration,
+	double globalPeak, double fminl2, double dfl2, bool isMainThread, volatile int *cancelled)
+{
+	autoSound_into_Pitch_shs_Args me = Thing_new (Sound_into_Pitch_shs_Args);
+	my sound = sound;
+	my hamming = hamming;
+	my pitch = pitch;
+	my tables = tables;
+	my cc = cc;
+	my firstFrame = firstFrame;
+	my lastFrame = lastFrame;
+	my nx = nx;
+	my maxnCandidates = maxnCandidates;
+	my halfWindow = halfWindow;
+	my frameDuration = frameDuration;
+	my globalPeak = globalPeak;
+	my fminl2 = fminl2;
+	my dfl2 = dfl2;
+	my isMainThread = isMainThread;
+	my cancelled = cancelled;
+	return me;
+}
+
+MelderThread_MUTEX (mutex);
+static bool mutex_inited;
+
+static MelderThread_RETURN_TYPE Sound_into_Pitch_shs (Sound_into_Pitch_shs_Args me) {
+	Sound sound = my sound;
+	Pitch thee = my pitch;
+	SHS_Tables tables = my tables;
+	long nx = my nx, nfft = tables -> nfft, nfft2 = tables -> nfft2, nFrequencyPoints = tables -> nFrequencyPoints;
+	double halfWindow = my halfWindow;
+	autoSound frame;
+	autoNUMfft_Table fourierTable;
+	autoNUMvector<double> data, specAmp, yv2, u, al2, sumspec;
+	autoNUMvector<long> posmax;
+	{// scope
+		MelderThread_LOCK (mutex);
+		frame = Sound_createSimple (1, my frameDuration, 1.0 / sound -> dx);
+		NUMfft_Table_init (& fourierTable, nfft);
+		data.reset (1, nfft);
+		specAmp.reset (1, nfft2);
+		yv2.reset (1, nfft2);
+		u.reset (1, nfft2);
+		posmax.reset (1, (nfft2 + 1) / 2);
+		al2.reset (1, nFrequencyPoints);
+		sumspec.reset (1, nFrequencyPoints);
+		MelderThread_UNLOCK (mutex);
+	}
+
+	for (long i = my firstFrame; i <= my lastFrame; i++) {
+		if (my isMainThread) {
+			try {
+				if ((i % 20) == 1) {
+					Melder_progress ((double) (i - my firstFrame + 1) / (my lastFrame - my firstFrame + 1),
+						U"Pitch analysis of frame ", i, U" out of ", my lastFrame, U".");
+				}
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		} else if (*my cancelled) {
+			MelderThread_RETURN;
+		}
+		Pitch_Frame pitchFrame = &thy frame[i];
+		double f0, pitch_strength, localMean, localPeak;
+		double tmid = Sampled_indexToX (thee, i); /* The center of this frame */
+		long nx_tmp = frame -> nx;
+
+		// Copy a frame from the sound, apply a hamming window. Get local 'intensity'
+
+		frame -> nx = nx; /*begin vies */
+		Sound_into_Sound (sound, frame.get(), tmid - halfWindow);
+		Sounds_multiply (frame.get(), my hamming);
+		Sound_localMean (sound, tmid - 3 * halfWindow, tmid + 3 * halfWindow, &localMean);
+		Sound_localPeak (sound, tmid - halfWindow, tmid + halfWindow, localMean, &localPeak);
+		pitchFrame -> intensity = localPeak > my globalPeak ? 1 : localPeak / my globalPeak;
+		frame -> nx = nx_tmp; /* einde vies */
+
+		// Get the Fourier spectrum (as Sound_to_Spectrum would, but into the reused buffer) and its amplitude.
+
+		for (long j = 1; j <= frame -> nx; j++) {
+			data[j] = frame -> z[1][j];
+		}
+		for (long j = frame -> nx + 1; j <= nfft; j++) {
+			data[j] = 0.0;
+		}
+		NUMfft_forward (& fourierTable, data.peek());
+		double scaling = frame -> dx;
+		double rs = data[1] * scaling;
+		specAmp[1] = sqrt (rs * rs);
+		for (long j = 2; j < nfft2; j++) {
+			double re = data[j + j - 2] * scaling, im = data[j + j - 1] * scaling;
+			specAmp[j] = sqrt (re * re + im * im);
+		}
+		rs = data[nfft] * scaling;
+		specAmp[nfft2] = sqrt (rs * rs);
+
+		// Enhance the peaks in the spectrum.
+
+		spec_enhance_SHS (specAmp.peek(), nfft2, posmax.peek());
+
+		// Smooth the enhanced spectrum.
+
+		spec_smoooth_SHS (specAmp.peek(), nfft2);
+
+		// Go to a logarithmic scale and perform cubic spline interpolation to get
+		// spectral values for the increased number of frequency points.
+
+		SHS_Tables_interpolate (tables, specAmp.peek(), yv2.peek(), u.peek(), al2.peek());
+
+		// Multiply by frequency selectivity of the auditory system.
+
+		for (long j = 1; j <= nFrequencyPoints; j++) al2[j] = al2[j] > 0 ?
+			        al2[j] * tables -> arctg[j] : 0;
+
+		// The subharmonic summation. Shift spectra in octaves and sum.
+
+		for (long k = 1; k <= nFrequencyPoints; k++) {
+			sumspec[k] = 0.0;
+		}
+		pitchFrame -> nCandidates = 0; /* !!!!! */
+
+		for (long m = 1; m <= tables -> nSubharmonicShifts; m++) {
+			long kb = tables -> subharmonicShift[m];
+			double hm = tables -> subharmonicWeight[m];
+			for (long k = kb; k <= nFrequencyPoints; k++) {
+				sumspec[k - kb + 1] += al2[k] * hm;
+			}
+		}
+
+		// First register the voiceless candidate (always present).
+
+		Pitch_Frame_addPitch (pitchFrame, 0, 0, my maxnCandidates);
+
+		/*
+			Get the best local estimates for the pitch as the maxima of the
+			subharmonic sum spectrum by parabolic interpolation on three points:
+			The formula for a parabole with a maximum is:
+				y(x) = a - b (x - c)^2 with a, b, c >= 0
+			The three points are (-x, y1), (0, y2) and (x, y3).
+			The solution for a (the maximum) and c (the position) is:
+			a = (2 y1 (4 y2 + y3) - y1^2 - (y3 - 4 y2)^2)/( 8 (y1 - 2 y2 + y3)
+			c = dx (y1 - y3) / (2 (y1 - 2 y2 + y3))
+			(b = (2 y2 - y1 - y3) / (2 dx^2) )
+		*/
+
+		for (long k = 2; k <= nFrequencyPoints - 1; k++) {
+			double y1 = sumspec[k - 1], y2 = sumspec[k], y3 = sumspec[k + 1];
+			if (y2 > y1 && y2 >= y3) {
+				double denum = y1 - 2 * y2 + y3, tmp = y3 - 4 * y2;
+				double x =  my dfl2 * (y1 - y3) / (2 * denum);
+				double f = pow (2, my fminl2 + (k - 1) * my dfl2 + x);
+				double strength = (2 * y1 * (4 * y2 + y3) - y1 * y1 - tmp * tmp) / (8 * denum);
+				Pitch_Frame_addPitch (pitchFrame, f, strength, my maxnCandidates);
+			}
+		}
+
+		/*
+			Check whether f0 corresponds to an actual periodicity T = 1 / f0:
+			correlate two signal periods of duration T, one starting at the
+			middle of the interval and one starting T seconds before.
+			If there is periodicity the correlation coefficient should be high.
+
+			However, some sounds do not show any regularity, or very low
+			frequency and regularity, and nevertheless have a definite
+			pitch, e.g. Shepard sounds.
+		*/
+
+		Pitch_Frame_getPitch (pitchFrame, &f0, &pitch_strength);
+		if (f0 > 0) {
+			my cc[i] = Sound_correlateParts (sound, tmid - 1.0 / f0, tmid, 1.0 / f0);
+		}
+	}
+	MelderThread_RETURN;
+}
+
 autoPitch Sound_to_Pitch_shs (Sound me, double timeStep, double minimumPitch,
                           double maximumFrequency, double ceiling, long maxnSubharmonics, long maxnCandidates,
                           double compressionFactor, long nPointsPerOctave) {
 	try {
 		double firstTime, newSamplingFrequency = 2 * maximumFrequency;
 		double windowDuration = 2 / minimumPitch, halfWindow = windowDuration / 2;
-		double atans = nPointsPerOctave * NUMlog2 (65.0 / 50.0) - 1;
 		// Number of speech samples in the downsampled signal in each frame:
 		// 100 for windowDuration == 0.04 and newSamplingFrequency == 2500
 		long nx = lround (windowDuration * newSamplingFrequency);
@@ -85,7 +421,6 @@ autoPitch Sound_to_Pitch_shs (Sound me, double timeStep, double minimumPitch,
 		while ( (nfft *= 2) < nx || nfft <= 128) {
 			;
 		}
-		long nfft2 = nfft / 2 + 1;
 		double frameDuration = nfft / newSamplingFrequency;
 		double df = newSamplingFrequency / nfft;
 
@@ -98,18 +433,14 @@ autoPitch Sound_to_Pitch_shs (Sound me, double timeStep, double minimumPitch,
 		autoSound sound = Sound_resample (me, newSamplingFrequency, 50);
 		long numberOfFrames;
 		Sampled_shortTermAnalysis (sound.get(), windowDuration, timeStep, &numberOfFrames, &firstTime);
-		autoSound frame = Sound_createSimple (1, frameDuration, newSamplingFrequency);
 		autoSound hamming = Sound_createHamming (nx / newSamplingFrequency, newSamplingFrequency);
 		autoPitch thee = Pitch_create (my xmin, my xmax, numberOfFrames, timeStep, firstTime, ceiling, maxnCandidates);
 		autoNUMvector<double> cc (1, numberOfFrames);
-		autoNUMvector<double> specAmp (1, nfft2);
-		autoNUMvector<double> fl2 (1, nfft2);
-		autoNUMvector<double> yv2 (1, nfft2);
-		autoNUMvector<double> arctg (1, nFrequencyPoints);
-		autoNUMvector<double> al2 (1, nFrequencyPoints);
+		autoSHS_Tables tables = SHS_Tables_create (nfft, df, fminl2, dfl2, nFrequencyPoints,
+			nPointsPerOctave, maxnSubharmonics, compressionFactor);
 
-		Melder_assert (frame->nx >= nx);
 		Melder_assert (hamming->nx == nx);
+		Melder_assert ((long) round (frameDuration * newSamplingFrequency) >= nx);   // every thread's frame (see Sound_createSimple) can hold the window
 
 		// Compute the absolute value of the globally largest amplitude w.r.t. the global mean.
 
@@ -117,134 +448,34 @@ autoPitch Sound_to_Pitch_shs (Sound me, double timeStep, double minimumPitch,
 		Sound_localMean (sound.get(), sound -> xmin, sound -> xmax, &globalMean);
 		Sound_localPeak (sound.get(), sound -> xmin, sound -> xmax, globalMean, &globalPeak);
 
-		/*
-			For the cubic spline interpolation we need the frequencies on an octave
-			scale, i.e., a log2 scale. All frequencies must be DIFFERENT, otherwise
-			the cubic spline interpolation will give corrupt results.
-			Because log2(f==0) is not defined, we use the heuristic: f[2]-f[1] == f[3]-f[2].
-		*/
-
-		for (long i = 2; i <= nfft2; i++) {
-			fl2[i] = NUMlog2 ((i - 1) * df);
-		}
-		fl2[1] = 2 * fl2[2] - fl2[3];
-
-		// Calculate frequencies regularly spaced on a log2-scale and
-		// the frequency weighting function.
-
-		for (long i = 1; i <= nFrequencyPoints; i++) {
-			arctg[i] = 0.5 + atan (3.0 * (i - atans) / nPointsPerOctave) / NUMpi;
-		}
-
-		// Perform the analysis on all frames.
-
 		for (long i = 1; i <= numberOfFrames; i++) {
-			Pitch_Frame pitchFrame = &thy frame[i];
-			double hm = 1, f0, pitch_strength, localMean, localPeak;
-			double tmid = Sampled_indexToX (thee.get(), i); /* The center of this frame */
-			long nx_tmp = frame -> nx;
-
-			// Copy a frame from the sound, apply a hamming window. Get local 'intensity'
-
-			frame -> nx = nx; /*begin vies */
-			Sound_into_Sound (sound.get(), frame.get(), tmid - halfWindow);
-			Sounds_multiply (frame.get(), hamming.get());
-			Sound_localMean (sound.get(), tmid - 3 * halfWindow, tmid + 3 * halfWindow, &localMean);
-			Sound_localPeak (sound.get(), tmid - halfWindow, tmid + halfWindow, localMean, &localPeak);
-			pitchFrame -> intensity = localPeak > globalPeak ? 1 : localPeak / globalPeak;
-			frame -> nx = nx_tmp; /* einde vies */
-
-			// Get the Fourier spectrum.
-
-			autoSpectrum spec = Sound_to_Spectrum (frame.get(), 1);
-			Melder_assert (spec->nx == nfft2);
-
-			// From complex spectrum to amplitude spectrum.
-
-			for (long j = 1; j <= nfft2; j++) {
-				double rs = spec -> z[1][j], is = spec -> z[2][j];
-				specAmp[j] = sqrt (rs * rs + is * is);
-			}
-
-			// Enhance the peaks in the spectrum.
-
-			spec_enhance_SHS (specAmp.peek(), nfft2);
-
-			// Smooth the enhanced spectrum.
-
-			spec_smoooth_SHS (specAmp.peek(), nfft2);
-
-			// Go to a logarithmic scale and perform cubic spline interpolation to get
-			// spectral values for the increased number of frequency points.
-
-			NUMspline (fl2.peek(), specAmp.peek(), nfft2, 1e30, 1e30, yv2.peek());
-			for (long j = 1; j <= nFrequencyPoints; j++) {
-				double f = fminl2 + (j - 1) * dfl2;
-				NUMsplint (fl2.peek(), specAmp.peek(), yv2.peek(), nfft2, f, &al2[j]);
-			}
-
-			// Multiply by frequency selectivity of the auditory system.
-
-			for (long j = 1; j <= nFrequencyPoints; j++) al2[j] = al2[j] > 0 ?
-				        al2[j] * arctg[j] : 0;
-
-			// The subharmonic summation. Shift spectra in octaves and sum.
-
-			Pitch_Frame_init (pitchFrame, maxnCandidates);
-			autoNUMvector<double> sumspec (1, nFrequencyPoints);
-			pitchFrame -> nCandidates = 0; /* !!!!! */
-
-			for (long m = 1; m <= maxnSubharmonics + 1; m++) {
-				long kb = 1 + (long) floor (nPointsPerOctave * NUMlog2 (m));
-				for (long k = kb; k <= nFrequencyPoints; k++) {
-					sumspec[k - kb + 1] += al2[k] * hm;
-				}
-				hm *= compressionFactor;
-			}
-
-			// First register the voiceless candidate (always present).
-
-			Pitch_Frame_addPitch (pitchFrame, 0, 0, maxnCandidates);
-
-			/*
-				Get the best local estimates for the pitch as the maxima of the
-				subharmonic sum spectrum by parabolic interpolation on three points:
-				The formula for a parabole with a maximum is:
-					y(x) = a - b (x - c)^2 with a, b, c >= 0
-				The three points are (-x, y1), (0, y2) and (x, y3).
-				The solution for a (the maximum) and c (the position) is:
-				a = (2 y1 (4 y2 + y3) - y1^2 - (y3 - 4 y2)^2)/( 8 (y1 - 2 y2 + y3)
-				c = dx (y1 - y3) / (2 (y1 - 2 y2 + y3))
-				(b = (2 y2 - y1 - y3) / (2 dx^2) )
-			*/
-
-			for (long k = 2; k <= nFrequencyPoints - 1; k++) {
-				double y1 = sumspec[k - 1], y2 = sumspec[k], y3 = sumspec[k + 1];
-				if (y2 > y1 && y2 >= y3) {
-					double denum = y1 - 2 * y2 + y3, tmp = y3 - 4 * y2;
-					double x =  dfl2 * (y1 - y3) / (2 * denum);
-					double f = pow (2, fminl2 + (k - 1) * dfl2 + x);
-					double strength = (2 * y1 * (4 * y2 + y3) - y1 * y1 - tmp * tmp) / (8 * denum);
-					Pitch_Frame_addPitch (pitchFrame, f, strength, maxnCandidates);
-				}
-			}
-
-			/*
-				Check whether f0 corresponds to an actual periodicity T = 1 / f0:
-				correlate two signal periods of duration T, one starting at the
-				middle of the interval and one starting T seconds before.
-				If there is periodicity the correlation coefficient should be high.
-
-				However, some sounds do not show any regularity, or very low
-				frequency and regularity, and nevertheless have a definite
-				pitch, e.g. Shepard sounds.
-			*/
+			Pitch_Frame_init (& thy frame[i], maxnCandidates);
+		}
 
-			Pitch_Frame_getPitch (pitchFrame, &f0, &pitch_strength);
-			if (f0 > 0) {
-				cc[i] = Sound_correlateParts (sound.get(), tmid - 1.0 / f0, tmid, 1.0 / f0);
-			}
+		// Perform the analysis on all frames, divided over the threads.
+
+		autoMelderProgress progress (U"Pitch analysis (shs)");
+		long numberOfFramesPerThread = 20;
+		int numberOfThreads = (numberOfFrames - 1) / numberOfFramesPerThread + 1;
+		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		numberOfFramesPerThread = (numberOfFrames - 1) / numberOfThreads + 1;
+
+		if (! mutex_inited) { MelderThread_MUTEX_INIT (mutex); mutex_inited = true; }
+		autoSound_into_Pitch_shs_Args args [16];
+		long firstFrame = 1, lastFrame = numberOfFramesPerThread;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			if (ithread == numberOfThreads) lastFrame = numberOfFrames;
+			args [ithread - 1] = Sound_into_Pitch_shs_Args_create (sound.get(), hamming.get(), thee.get(), tables.get(),
+				cc.peek(), firstFrame, lastFrame, nx, maxnCandidates, halfWindow, frameDuration, globalPeak, fminl2, dfl2,
+				ithread == numberOfThreads, & cancelled);
+			firstFrame = lastFrame + 1;
+			lastFrame += numberOfFramesPerThread;
 		}
+		MelderThread_run (Sound_into_Pitch_shs, args, numberOfThreads);
 
 		// Base V/UV decision on correlation coefficients.
 		// Resize the pitch strengths w.r.t. the cc.
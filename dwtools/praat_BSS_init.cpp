@@ -507,6 +507,27 @@ DIRECT (Sound_and_MixingMatrix_mix)
 	praat_new (thee.move(), Thing_getName (s), U"_mixed");
 END
 
+FORM (Sound_and_MixingMatrix_improveUnmixing, U"Sound & MixingMatrix: Improve unmixing", nullptr)
+	REAL (U"left Time range (s)", U"0.0")
+	REAL (U"right Time range (s)", U"10.0")
+	NATURAL (U"Number of cross-correlations", U"40")
+	POSITIVE (U"Lag step (s)", U"0.002")
+	LABEL (U"", U"Iteration parameters")
+	NATURAL (U"Maximum number of iterations", U"100")
+	POSITIVE (U"Tolerance", U"0.001")
+	OPTIONMENU (U"Diagonalization method", 2)
+		OPTION (U"qdiag")
+		OPTION (U"ffdiag")
+	OK
+DO
+	Sound s = FIRST (Sound);
+	MixingMatrix mm = FIRST (MixingMatrix);
+	Sound_and_MixingMatrix_improveUnmixing (s, mm, GET_REAL (U"left Time range"), GET_REAL (U"right Time range"),
+		GET_INTEGER (U"Number of cross-correlations"), GET_REAL (U"Lag step"), GET_INTEGER (U"Maximum number of iterations"),
+		GET_REAL (U"Tolerance"), GET_INTEGER (U"Diagonalization method"));
+	praat_dataChanged (mm);
+END
+
 DIRECT (Sound_and_MixingMatrix_unmix)
 	Sound s = FIRST (Sound);
 	MixingMatrix mm = FIRST (MixingMatrix);
@@ -600,6 +621,7 @@ void praat_BSS_init () {
 
 	praat_addAction2 (classSound, 1, classMixingMatrix, 1, U"Mix", 0, 0, DO_Sound_and_MixingMatrix_mix);
 	praat_addAction2 (classSound, 1, classMixingMatrix, 1, U"Unmix", 0, 0, DO_Sound_and_MixingMatrix_unmix);
+	praat_addAction2 (classSound, 1, classMixingMatrix, 1, U"Improve unmixing...", 0, 0, DO_Sound_and_MixingMatrix_improveUnmixing);
 
 	praat_addAction2 (classSound, 1, classPCA, 1, U"To Sound (white channels)...", 0 , 0, DO_Sound_and_PCA_whitenChannels);
 	praat_addAction2 (classSound, 1, classPCA, 1, U"To Sound (principal components)...", 0 , 0, DO_Sound_and_PCA_principalComponents);
@@ -72,6 +72,7 @@
 #include "Categories.h"
 #include "CategoriesEditor.h"
 #include "ClassificationTable.h"
+#include "Cochleagram.h"
 #include "Collection_extensions.h"
 #include "ComplexSpectrogram.h"
 #include "Confusion.h"
@@ -7326,6 +7327,59 @@ DIRECT (SSCP_to_PCA)
 	}
 END
 
+FORM (SSCP_create, U"Create empty SSCP", U"Create empty SSCP...")
+	WORD (U"Name", U"sscp")
+	NATURAL (U"Dimension", U"13")
+	OK
+DO
+	autoSSCP me = SSCP_create (GET_INTEGER (U"Dimension"));
+	praat_new (me.move(), GET_STRING (U"Name"));
+END
+
+DIRECT (SSCPs_to_SSCP_sum)
+	autoSSCPList sscps = SSCPList_create ();
+	LOOP {
+		iam (SSCP);
+		sscps -> addItem_ref (me);
+	}
+	autoSSCP thee = SSCPList_to_SSCP_sum (sscps.get());
+	praat_new (thee.move(), U"sum");
+END
+
+FORM (SSCP_and_TableOfReal_accumulateRows, U"SSCP & TableOfReal: Accumulate rows", U"SSCP & TableOfReal: Accumulate rows...")
+	INTEGER (U"Begin row", U"0")
+	INTEGER (U"End row", U"0")
+	NATURAL (U"Begin column", U"1")
+	OK
+DO
+	SSCP me = FIRST (SSCP);
+	TableOfReal thee = FIRST (TableOfReal);
+	SSCP_addTableOfRealRows (me, thee, GET_INTEGER (U"Begin row"), GET_INTEGER (U"End row"), GET_INTEGER (U"Begin column"));
+	praat_dataChanged (me);
+END
+
+FORM (SSCP_and_Matrix_accumulateColumns, U"SSCP & Matrix: Accumulate columns", U"SSCP & Matrix: Accumulate columns...")
+	INTEGER (U"Begin column", U"0")
+	INTEGER (U"End column", U"0")
+	NATURAL (U"Begin row", U"1")
+	OK
+DO
+	SSCP me = FIRST (SSCP);
+	Matrix thee = FIRST_GENERIC (Matrix);
+	SSCP_addMatrixColumns (me, thee, GET_INTEGER (U"Begin column"), GET_INTEGER (U"End column"), GET_INTEGER (U"Begin row"));
+	praat_dataChanged (me);
+END
+
+FORM (SSCP_and_MFCC_accumulateFrames, U"SSCP & MFCC: Accumulate frames", U"SSCP & MFCC: Accumulate frames...")
+	BOOLEAN (U"Include energy", false)
+	OK
+DO
+	SSCP me = FIRST (SSCP);
+	MFCC thee = FIRST (MFCC);
+	MFCC_addFramesToSSCP (thee, me, GET_INTEGER (U"Include energy"));
+	praat_dataChanged (me);
+END
+
 /******************* Strings ****************************/
 DIRECT (Strings_createFromEspeakVoices)
 	//praat_new (nullptr, U"voices"); // TODO ??
@@ -8984,6 +9038,7 @@ void praat_uvafon_David_init () {
 	praat_addMenuCommand (U"Objects", U"New", U"Create simple Confusion...", U"Create TableOfReal (Weenink 1985)...", 1, DO_Confusion_createSimple);
 	praat_addMenuCommand (U"Objects", U"New", U"Create simple Covariance...", U"Create simple Confusion...", 1, DO_Covariance_createSimple);
 	praat_addMenuCommand (U"Objects", U"New", U"Create simple Correlation...", U"Create simple Covariance...", 1, DO_Correlation_createSimple);
+	praat_addMenuCommand (U"Objects", U"New", U"Create empty SSCP...", U"Create simple Correlation...", 1, DO_SSCP_create);
 	praat_addMenuCommand (U"Objects", U"New", U"Create empty EditCostsTable...", U"Create simple Covariance...", 1, DO_EditCostsTable_createEmpty);
 
 	praat_addMenuCommand (U"Objects", U"New", U"Create KlattTable example", U"Create TableOfReal (Weenink 1985)...", praat_DEPTH_1 + praat_HIDDEN, DO_KlattTable_createExample);
@@ -9648,6 +9703,12 @@ void praat_uvafon_David_init () {
 	praat_addAction1 (classSSCP, 0, U"To PCA", nullptr, 0, DO_SSCP_to_PCA);
 	praat_addAction1 (classSSCP, 0, U"To Correlation", nullptr, 0, DO_SSCP_to_Correlation);
 	praat_addAction1 (classSSCP, 0, U"To Covariance...", nullptr, 0, DO_SSCP_to_Covariance);
+	praat_addAction1 (classSSCP, 0, U"To SSCP (sum)", nullptr, 0, DO_SSCPs_to_SSCP_sum);
+	praat_addAction2 (classSSCP, 1, classTableOfReal, 1, U"Accumulate rows...", nullptr, 0, DO_SSCP_and_TableOfReal_accumulateRows);
+	praat_addAction2 (classSSCP, 1, classMatrix, 1, U"Accumulate columns...", nullptr, 0, DO_SSCP_and_Matrix_accumulateColumns);
+	praat_addAction2 (classSSCP, 1, classSpectrogram, 1, U"Accumulate columns...", nullptr, 0, DO_SSCP_and_Matrix_accumulateColumns);
+	praat_addAction2 (classSSCP, 1, classCochleagram, 1, U"Accumulate columns...", nullptr, 0, DO_SSCP_and_Matrix_accumulateColumns);
+	praat_addAction2 (classSSCP, 1, classMFCC, 1, U"Accumulate frames...", nullptr, 0, DO_SSCP_and_MFCC_accumulateFrames);
 
 	praat_addAction1 (classStrings, 0, U"To Categories", nullptr, 0, DO_Strings_to_Categories);
 	praat_addAction1 (classStrings, 0, U"Append", nullptr, 0, DO_Strings_append);
@@ -149,37 +149,62 @@ static double Sound_getHannWindowedRms (Sound me, double tmid, double widthLeft,
 	}
 	return sqrt (sumOfSquares / windowSumOfSquares);
 }
+long PointProcess_Sound_getPeriodPeaks (PointProcess me, Sound thee, double tmin, double tmax,
+	double pmin, double pmax, double maximumPeriodFactor, double times [], double peaks [])
+{
+	if (tmax <= tmin) tmin = my xmin, tmax = my xmax;
+	long imin, imax;
+	if (PointProcess_getWindowPoints (me, tmin, tmax, & imin, & imax) < 3) return -1;
+	long numberOfPeaks = 0;
+	for (long i = imin + 1; i < imax; i ++) {
+		double p1 = my t [i] - my t [i - 1], p2 = my t [i + 1] - my t [i];
+		double intervalFactor = p1 > p2 ? p1 / p2 : p2 / p1;
+		if (pmin == pmax || (p1 >= pmin && p1 <= pmax && p2 >= pmin && p2 <= pmax && intervalFactor <= maximumPeriodFactor)) {
+			double peak = Sound_getHannWindowedRms (thee, my t [i], 0.2 * p1, 0.2 * p2);
+			if (NUMdefined (peak) && peak > 0.0) {
+				numberOfPeaks ++;
+				times [numberOfPeaks] = my t [i];
+				peaks [numberOfPeaks] = peak;
+			}
+		}
+	}
+	return numberOfPeaks;
+}
 autoAmplitudeTier PointProcess_Sound_to_AmplitudeTier_period (PointProcess me, Sound thee, double tmin, double tmax,
 	double pmin, double pmax, double maximumPeriodFactor)
 {
 	try {
 		if (tmax <= tmin) tmin = my xmin, tmax = my xmax;
-		long imin, imax;
-		long numberOfPeaks = PointProcess_getWindowPoints (me, tmin, tmax, & imin, & imax);
-		if (numberOfPeaks < 3) Melder_throw (U"Too few pulses between ", tmin, U" and ", tmax, U" seconds.");
+		long numberOfPulses = PointProcess_getWindowPoints (me, tmin, tmax, nullptr, nullptr);
+		if (numberOfPulses < 3) Melder_throw (U"Too few pulses between ", tmin, U" and ", tmax, U" seconds.");
+		autoNUMvector <double> times (1, numberOfPulses), peaks (1, numberOfPulses);
+		long numberOfPeaks = PointProcess_Sound_getPeriodPeaks (me, thee, tmin, tmax, pmin, pmax, maximumPeriodFactor, times.peek(), peaks.peek());
 		autoAmplitudeTier him = AmplitudeTier_create (tmin, tmax);
-		for (long i = imin + 1; i < imax; i ++) {
-			double p1 = my t [i] - my t [i - 1], p2 = my t [i + 1] - my t [i];
-			double intervalFactor = p1 > p2 ? p1 / p2 : p2 / p1;
-			if (pmin == pmax || (p1 >= pmin && p1 <= pmax && p2 >= pmin && p2 <= pmax && intervalFactor <= maximumPeriodFactor)) {
-				double peak = Sound_getHannWindowedRms (thee, my t [i], 0.2 * p1, 0.2 * p2);
-				if (NUMdefined (peak) && peak > 0.0)
-					RealTier_addPoint (him.get(), my t [i], peak);
-			}
-		}
+		for (long i = 1; i <= numberOfPeaks; i ++)
+			RealTier_addPoint (him.get(), times [i], peaks [i]);
 		return him;
 	} catch (MelderError) {
 		Melder_throw (me, U" & ", thee, U": not converted to AmplitudeTier.");
 	}
 }
-double AmplitudeTier_getShimmer_local (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+static void AmplitudeTier_getPeaks (AmplitudeTier me, autoNUMvector <double> *times, autoNUMvector <double> *peaks) {
+	times -> reset (1, my points.size);
+	peaks -> reset (1, my points.size);
+	for (long i = 1; i <= my points.size; i ++) {
+		RealPoint point = my points.at [i];
+		(*times) [i] = point -> number;
+		(*peaks) [i] = point -> value;
+	}
+}
+double NUMshimmer_local (long numberOfPoints, const double times [], const double peaks [],
+	double pmin, double pmax, double maximumAmplitudeFactor)
+{
 	long numberOfPeaks = 0;
 	double numerator = 0.0, denominator = 0.0;
-	RealPoint *points = & my points.at [0];
-	for (long i = 2; i <= my points.size; i ++) {
-		double p = points [i] -> number - points [i - 1] -> number;
+	for (long i = 2; i <= numberOfPoints; i ++) {
+		double p = times [i] - times [i - 1];
 		if (pmin == pmax || (p >= pmin && p <= pmax)) {
-			double a1 = points [i - 1] -> value, a2 = points [i] -> value;
+			double a1 = peaks [i - 1], a2 = peaks [i];
 			double amplitudeFactor = a1 > a2 ? a1 / a2 : a2 / a1;
 			if (amplitudeFactor <= maximumAmplitudeFactor) {
 				numerator += fabs (a1 - a2);
@@ -190,22 +215,28 @@ double AmplitudeTier_getShimmer_local (AmplitudeTier me, double pmin, double pma
 	if (numberOfPeaks < 1) return NUMundefined;
 	numerator /= numberOfPeaks;
 	numberOfPeaks = 0;
-	for (long i = 1; i < my points.size; i ++) {
-		denominator += points [i] -> value;
+	for (long i = 1; i < numberOfPoints; i ++) {
+		denominator += peaks [i];
 		numberOfPeaks ++;
 	}
 	denominator /= numberOfPeaks;
 	if (denominator == 0.0) return NUMundefined;
 	return numerator / denominator;
 }
-double AmplitudeTier_getShimmer_local_dB (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+double AmplitudeTier_getShimmer_local (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+	autoNUMvector <double> times, peaks;
+	AmplitudeTier_getPeaks (me, & times, & peaks);
+	return NUMshimmer_local (my points.size, times.peek(), peaks.peek(), pmin, pmax, maximumAmplitudeFactor);
+}
+double NUMshimmer_local_dB (long numberOfPoints, const double times [], const double peaks [],
+	double pmin, double pmax, double maximumAmplitudeFactor)
+{
 	long numberOfPeaks = 0;
 	double result = 0.0;
-	RealPoint *points = & my points.at [0];
-	for (long i = 2; i <= my points.size; i ++) {
-		double p = points [i] -> number - points [i - 1] -> number;
+	for (long i = 2; i <= numberOfPoints; i ++) {
+		double p = times [i] - times [i - 1];
 		if (pmin == pmax || (p >= pmin && p <= pmax)) {
-			double a1 = points [i - 1] -> value, a2 = points [i] -> value;
+			double a1 = peaks [i - 1], a2 = peaks [i];
 			double amplitudeFactor = a1 > a2 ? a1 / a2 : a2 / a1;
 			if (amplitudeFactor <= maximumAmplitudeFactor) {
 				result += fabs (log10 (a1 / a2));
@@ -217,16 +248,22 @@ double AmplitudeTier_getShimmer_local_dB (AmplitudeTier me, double pmin, double
 	result /= numberOfPeaks;
 	return 20.0 * result;
 }
-double AmplitudeTier_getShimmer_apq3 (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+double AmplitudeTier_getShimmer_local_dB (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+	autoNUMvector <double> times, peaks;
+	AmplitudeTier_getPeaks (me, & times, & peaks);
+	return NUMshimmer_local_dB (my points.size, times.peek(), peaks.peek(), pmin, pmax, maximumAmplitudeFactor);
+}
+double NUMshimmer_apq3 (long numberOfPoints, const double times [], const double peaks [],
+	double pmin, double pmax, double maximumAmplitudeFactor)
+{
 	long numberOfPeaks = 0;
 	double numerator = 0.0, denominator = 0.0;
-	RealPoint *points = & my points.at [0];
-	for (long i = 2; i <= my points.size - 1; i ++) {
+	for (long i = 2; i <= numberOfPoints - 1; i ++) {
 		double
-			p1 = points [i] -> number - points [i - 1] -> number,
-			p2 = points [i + 1] -> number - points [i] -> number;
+			p1 = times [i] - times [i - 1],
+			p2 = times [i + 1] - times [i];
 		if (pmin == pmax || (p1 >= pmin && p1 <= pmax && p2 >= pmin && p2 <= pmax)) {
-			double a1 = points [i - 1] -> value, a2 = points [i] -> value, a3 = points [i + 1] -> value;
+			double a1 = peaks [i - 1], a2 = peaks [i], a3 = peaks [i + 1];
 			double f1 = a1 > a2 ? a1 / a2 : a2 / a1, f2 = a2 > a3 ? a2 / a3 : a3 / a2;
 			if (f1 <= maximumAmplitudeFactor && f2 <= maximumAmplitudeFactor) {
 				double threePointAverage = (a1 + a2 + a3) / 3.0;
@@ -238,29 +275,35 @@ double AmplitudeTier_getShimmer_apq3 (AmplitudeTier me, double pmin, double pmax
 	if (numberOfPeaks < 1) return NUMundefined;
 	numerator /= numberOfPeaks;
 	numberOfPeaks = 0;
-	for (long i = 1; i < my points.size; i ++) {
-		denominator += points [i] -> value;
+	for (long i = 1; i < numberOfPoints; i ++) {
+		denominator += peaks [i];
 		numberOfPeaks ++;
 	}
 	denominator /= numberOfPeaks;
 	if (denominator == 0.0) return NUMundefined;
 	return numerator / denominator;
 }
-double AmplitudeTier_getShimmer_apq5 (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+double AmplitudeTier_getShimmer_apq3 (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+	autoNUMvector <double> times, peaks;
+	AmplitudeTier_getPeaks (me, & times, & peaks);
+	return NUMshimmer_apq3 (my points.size, times.peek(), peaks.peek(), pmin, pmax, maximumAmplitudeFactor);
+}
+double NUMshimmer_apq5 (long numberOfPoints, const double times [], const double peaks [],
+	double pmin, double pmax, double maximumAmplitudeFactor)
+{
 	long numberOfPeaks = 0;
 	double numerator = 0.0, denominator = 0.0;
-	RealPoint *points = & my points.at [0];
-	for (long i = 3; i <= my points.size - 2; i ++) {
+	for (long i = 3; i <= numberOfPoints - 2; i ++) {
 		double
-			p1 = points [i - 1] -> number - points [i - 2] -> number,
-			p2 = points [i] -> number - points [i - 1] -> number,
-			p3 = points [i + 1] -> number - points [i] -> number,
-			p4 = points [i + 2] -> number - points [i + 1] -> number;
+			p1 = times [i - 1] - times [i - 2],
+			p2 = times [i] - times [i - 1],
+			p3 = times [i + 1] - times [i],
+			p4 = times [i + 2] - times [i + 1];
 		if (pmin == pmax || (p1 >= pmin && p1 <= pmax && p2 >= pmin && p2 <= pmax
 			&& p3 >= pmin && p3 <= pmax && p4 >= pmin && p4 <= pmax))
 		{
-			double a1 = points [i - 2] -> value, a2 = points [i - 1] -> value, a3 = points [i] -> value,
-				a4 = points [i + 1] -> value, a5 = points [i + 2] -> value;
+			double a1 = peaks [i - 2], a2 = peaks [i - 1], a3 = peaks [i],
+				a4 = peaks [i + 1], a5 = peaks [i + 2];
 			double f1 = a1 > a2 ? a1 / a2 : a2 / a1, f2 = a2 > a3 ? a2 / a3 : a3 / a2,
 				f3 = a3 > a4 ? a3 / a4 : a4 / a3, f4 = a4 > a5 ? a4 / a5 : a5 / a4;
 			if (f1 <= maximumAmplitudeFactor && f2 <= maximumAmplitudeFactor &&
@@ -275,39 +318,45 @@ double AmplitudeTier_getShimmer_apq5 (AmplitudeTier me, double pmin, double pmax
 	if (numberOfPeaks < 1) return NUMundefined;
 	numerator /= numberOfPeaks;
 	numberOfPeaks = 0;
-	for (long i = 1; i < my points.size; i ++) {
-		denominator += points [i] -> value;
+	for (long i = 1; i < numberOfPoints; i ++) {
+		denominator += peaks [i];
 		numberOfPeaks ++;
 	}
 	denominator /= numberOfPeaks;
 	if (denominator == 0.0) return NUMundefined;
 	return numerator / denominator;
 }
-double AmplitudeTier_getShimmer_apq11 (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+double AmplitudeTier_getShimmer_apq5 (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+	autoNUMvector <double> times, peaks;
+	AmplitudeTier_getPeaks (me, & times, & peaks);
+	return NUMshimmer_apq5 (my points.size, times.peek(), peaks.peek(), pmin, pmax, maximumAmplitudeFactor);
+}
+double NUMshimmer_apq11 (long numberOfPoints, const double times [], const double peaks [],
+	double pmin, double pmax, double maximumAmplitudeFactor)
+{
 	long numberOfPeaks = 0;
 	double numerator = 0.0, denominator = 0.0;
-	RealPoint *points = & my points.at [0];
-	for (long i = 6; i <= my points.size - 5; i ++) {
+	for (long i = 6; i <= numberOfPoints - 5; i ++) {
 		double
-			p1 = points [i - 4] -> number - points [i - 5] -> number,
-			p2 = points [i - 3] -> number - points [i - 4] -> number,
-			p3 = points [i - 2] -> number - points [i - 3] -> number,
-			p4 = points [i - 1] -> number - points [i - 2] -> number,
-			p5 = points [i] -> number - points [i - 1] -> number,
-			p6 = points [i + 1] -> number - points [i] -> number,
-			p7 = points [i + 2] -> number - points [i + 1] -> number,
-			p8 = points [i + 3] -> number - points [i + 2] -> number,
-			p9 = points [i + 4] -> number - points [i + 3] -> number,
-			p10 = points [i + 5] -> number - points [i + 4] -> number;
+			p1 = times [i - 4] - times [i - 5],
+			p2 = times [i - 3] - times [i - 4],
+			p3 = times [i - 2] - times [i - 3],
+			p4 = times [i - 1] - times [i - 2],
+			p5 = times [i] - times [i - 1],
+			p6 = times [i + 1] - times [i],
+			p7 = times [i + 2] - times [i + 1],
+			p8 = times [i + 3] - times [i + 2],
+			p9 = times [i + 4] - times [i + 3],
+			p10 = times [i + 5] - times [i + 4];
 		if (pmin == pmax || (p1 >= pmin && p1 <= pmax && p2 >= pmin && p2 <= pmax
 			&& p3 >= pmin && p3 <= pmax && p4 >= pmin && p4 <= pmax && p5 >= pmin && p5 <= pmax
 			&& p6 >= pmin && p6 <= pmax && p7 >= pmin && p7 <= pmax && p8 >= pmin && p8 <= pmax
 			&& p9 >= pmin && p9 <= pmax && p10 >= pmin && p10 <= pmax))
 		{
-			double a1 = points [i - 5] -> value, a2 = points [i - 4] -> value, a3 = points [i - 3] -> value,
-				a4 = points [i - 2] -> value, a5 = points [i - 1] -> value, a6 = points [i] -> value,
-				a7 = points [i + 1] -> value, a8 = points [i + 2] -> value, a9 = points [i + 3] -> value,
-				a10 = points [i + 4] -> value, a11 = points [i + 5] -> value;
+			double a1 = peaks [i - 5], a2 = peaks [i - 4], a3 = peaks [i - 3],
+				a4 = peaks [i - 2], a5 = peaks [i - 1], a6 = peaks [i],
+				a7 = peaks [i + 1], a8 = peaks [i + 2], a9 = peaks [i + 3],
+				a10 = peaks [i + 4], a11 = peaks [i + 5];
 			double f1 = a1 > a2 ? a1 / a2 : a2 / a1, f2 = a2 > a3 ? a2 / a3 : a3 / a2,
 				f3 = a3 > a4 ? a3 / a4 : a4 / a3, f4 = a4 > a5 ? a4 / a5 : a5 / a4,
 				f5 = a5 > a6 ? a5 / a6 : a6 / a5, f6 = a6 > a7 ? a6 / a7 : a7 / a6,
@@ -328,14 +377,19 @@ double AmplitudeTier_getShimmer_apq11 (AmplitudeTier me, double pmin, double pma
 	if (numberOfPeaks < 1) return NUMundefined;
 	numerator /= numberOfPeaks;
 	numberOfPeaks = 0;
-	for (long i = 1; i < my points.size; i ++) {
-		denominator += points [i] -> value;
+	for (long i = 1; i < numberOfPoints; i ++) {
+		denominator += peaks [i];
 		numberOfPeaks ++;
 	}
 	denominator /= numberOfPeaks;
 	if (denominator == 0.0) return NUMundefined;
 	return numerator / denominator;
 }
+double AmplitudeTier_getShimmer_apq11 (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
+	autoNUMvector <double> times, peaks;
+	AmplitudeTier_getPeaks (me, & times, & peaks);
+	return NUMshimmer_apq11 (my points.size, times.peek(), peaks.peek(), pmin, pmax, maximumAmplitudeFactor);
+}
 double AmplitudeTier_getShimmer_dda (AmplitudeTier me, double pmin, double pmax, double maximumAmplitudeFactor) {
 	double apq3 = AmplitudeTier_getShimmer_apq3 (me, pmin, pmax, maximumAmplitudeFactor);
 	return NUMdefined (apq3) ? 3.0 * apq3 : NUMundefined;
@@ -44,6 +44,23 @@ autoSound Sound_AmplitudeTier_multiply (Sound me, AmplitudeTier intensity);
 autoAmplitudeTier PointProcess_Sound_to_AmplitudeTier_point (PointProcess me, Sound thee);
 autoAmplitudeTier PointProcess_Sound_to_AmplitudeTier_period (PointProcess me, Sound thee,
 	double tmin, double tmax, double shortestPeriod, double longestPeriod, double maximumPeriodFactor);
+long PointProcess_Sound_getPeriodPeaks (PointProcess me, Sound thee, double tmin, double tmax,
+	double shortestPeriod, double longestPeriod, double maximumPeriodFactor, double times [], double peaks []);
+/*
+	Puts the peaks that PointProcess_Sound_to_AmplitudeTier_period would put into an AmplitudeTier
+	into times [1..numberOfPeaks] and peaks [1..numberOfPeaks], which should have room for all the pulses between tmin and tmax.
+	Returns the number of peaks, or -1 if there are fewer than three pulses between tmin and tmax.
+	Allocates nothing and throws nothing, so that it can be called from several threads at once.
+*/
+double NUMshimmer_local (long numberOfPoints, const double times [], const double peaks [], double shortestPeriod, double longestPeriod, double maximumAmplitudeFactor);
+double NUMshimmer_local_dB (long numberOfPoints, const double times [], const double peaks [], double shortestPeriod, double longestPeriod, double maximumAmplitudeFactor);
+double NUMshimmer_apq3 (long numberOfPoints, const double times [], const double peaks [], double shortestPeriod, double longestPeriod, double maximumAmplitudeFactor);
+double NUMshimmer_apq5 (long numberOfPoints, const double times [], const double peaks [], double shortestPeriod, double longestPeriod, double maximumAmplitudeFactor);
+double NUMshimmer_apq11 (long numberOfPoints, const double times [], const double peaks [], double shortestPeriod, double longestPeriod, double maximumAmplitudeFactor);
+/*
+	The shimmer measures of the peaks times [1..numberOfPoints] and peaks [1..numberOfPoints];
+	the AmplitudeTier_getShimmer_xxx functions below compute these for the points of an AmplitudeTier.
+*/
 double AmplitudeTier_getShimmer_local (AmplitudeTier me, double shortestPeriod, double longestPeriod, double maximumAmplitudeFactor);
 double AmplitudeTier_getShimmer_local_dB (AmplitudeTier me, double shortestPeriod, double longestPeriod, double maximumAmplitudeFactor);
 double AmplitudeTier_getShimmer_apq3 (AmplitudeTier me, double shortestPeriod, double longestPeriod, double maximumAmplitudeFactor);
@@ -42,6 +42,7 @@
  */
 
 #include "LongSound.h"
+#include "Sound_and_Spectrum.h"
 #include "Preferences.h"
 #include "flac_FLAC_stream_decoder.h"
 #include "mp3.h"
@@ -695,4 +696,65 @@ void LongSound_concatenate (SoundAndLongSoundList me, MelderFile file, int audio
 	}
 }
 
+void LongSound_filterToAudioFile (LongSound me, Sound impulseResponse, MelderFile file, int audioFileType, int numberOfBitsPerSamplePoint) {
+	try {
+		if (impulseResponse -> ny != 1 && impulseResponse -> ny != my numberOfChannels)
+			Melder_throw (U"The impulse response should be mono or have as many channels as the LongSound.");
+		if (fabs (impulseResponse -> dx * my sampleRate - 1.0) > 1e-9)
+			Melder_throw (U"The sampling frequencies of the LongSound and the impulse response have to be equal.");
+		long numberOfSkippedSamples = Sampled_xToNearestIndex (impulseResponse, 0.0) - 1;
+		if (numberOfSkippedSamples < 0 || numberOfSkippedSamples >= impulseResponse -> nx)
+			Melder_throw (U"The impulse response should contain time 0.");
+		long blockSize = BlockConvolver_getDefaultBlockSize (impulseResponse -> nx);
+		OrderedOf <structBlockConvolver> convolvers;
+		for (int ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+			long kernelChannel = impulseResponse -> ny == 1 ? 1 : ichan;
+			convolvers. addItem_move (BlockConvolver_create (impulseResponse -> z [kernelChannel], impulseResponse -> nx, blockSize));
+		}
+		autoNUMmatrix <double> input (1, my numberOfChannels, 1, blockSize), output (1, my numberOfChannels, 1, blockSize);
+
+		autoMelderProgress progress (U"Filtering LongSound...");
+		autoMelderFile mfile = MelderFile_create (file);
+		MelderFile_writeAudioFileHeader (file, audioFileType, my sampleRate, my nx, my numberOfChannels, numberOfBitsPerSamplePoint);
+		long numberOfSamplesRead = 0, numberOfSamplesWritten = 0;
+		for (long offset = 0; numberOfSamplesWritten < my nx; offset += blockSize) {
+			long numberOfSamplesToRead = my nx - numberOfSamplesRead < blockSize ? my nx - numberOfSamplesRead : blockSize;
+			if (numberOfSamplesToRead > 0) {
+				LongSound_readAudioToFloat (me, input.peek(), numberOfSamplesRead + 1, numberOfSamplesToRead);
+				numberOfSamplesRead += numberOfSamplesToRead;
+			}
+			for (int ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+				for (long i = numberOfSamplesToRead + 1; i <= blockSize; i ++) {
+					input [ichan] [i] = 0.0;
+				}
+				BlockConvolver_process (convolvers.at [ichan], input [ichan], output [ichan]);
+			}
+			/*
+				Samples offset + 1 .. offset + blockSize of the convolution; the first numberOfSkippedSamples precede time 0.
+			*/
+			long first = numberOfSkippedSamples - offset + 1, last = numberOfSkippedSamples + my nx - offset;
+			if (first < 1) first = 1;
+			if (last > blockSize) last = blockSize;
+			if (last >= first) {
+				long numberOfSamplesToWrite = last - first + 1;
+				if (first > 1) {
+					for (int ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+						for (long i = 1; i <= numberOfSamplesToWrite; i ++) {
+							output [ichan] [i] = output [ichan] [first - 1 + i];
+						}
+					}
+				}
+				MelderFile_writeFloatToAudio (file, my numberOfChannels, Melder_defaultAudioFileEncoding (audioFileType, numberOfBitsPerSamplePoint),
+					output.peek(), numberOfSamplesToWrite, true);
+				numberOfSamplesWritten += numberOfSamplesToWrite;
+			}
+			Melder_progress ((double) numberOfSamplesWritten / my nx, U"Filtered ", numberOfSamplesWritten, U" of ", my nx, U" samples.");
+		}
+		MelderFile_writeAudioFileTrailer (file, audioFileType, my sampleRate, my nx, my numberOfChannels, numberOfBitsPerSamplePoint);
+		mfile.close ();
+	} catch (MelderError) {
+		Melder_throw (me, U": not filtered to sound file ", file, U".");
+	}
+}
+
 /* End of file LongSound.cpp */
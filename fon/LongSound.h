@@ -81,6 +81,13 @@ Collection_define (SoundAndLongSoundList, OrderedOf, Sampled) {
 
 void LongSound_concatenate (SoundAndLongSoundList collection, MelderFile file, int audioFileType, int numberOfBitsPerSamplePoint);
 
+void LongSound_filterToAudioFile (LongSound me, Sound impulseResponse, MelderFile file, int audioFileType, int numberOfBitsPerSamplePoint);
+/*
+	Stream the LongSound through the FIR filter impulseResponse (mono, or one channel per channel of me)
+	and write the part of the result that has the time domain of me, as in Sound_filter_blockwise.
+	Only a few blocks of the length of the impulse response are in memory at any time.
+*/
+
 void LongSound_preferences ();
 long LongSound_getBufferSizePref_seconds ();
 void LongSound_setBufferSizePref_seconds (long size);
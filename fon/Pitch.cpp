@@ -424,6 +424,22 @@ int Pitch_getMaxnCandidates (Pitch me) {
 	return result;
 }
 
+static void Pitch_Frame_getPathScores (Pitch_Frame frame, double silenceThreshold, double voicingThreshold,
+	double octaveCost, double ceiling, double ceiling2, double delta [], double logFrequency [], bool voiced [])
+{
+	double unvoicedStrength = silenceThreshold <= 0 ? 0 :
+		2 - frame->intensity / (silenceThreshold / (1 + voicingThreshold));
+	unvoicedStrength = voicingThreshold + (unvoicedStrength > 0 ? unvoicedStrength : 0);
+	for (long icand = 1; icand <= frame->nCandidates; icand ++) {
+		Pitch_Candidate candidate = & frame->candidate [icand];
+		int voiceless = candidate->frequency == 0 || candidate->frequency > ceiling2;
+		delta [icand] = voiceless ? unvoicedStrength :
+			candidate->strength - octaveCost * NUMlog2 (ceiling / candidate->frequency);
+		voiced [icand] = ! (candidate->frequency <= 0 || candidate->frequency >= ceiling2);   // as seen by the transitions
+		logFrequency [icand] = voiced [icand] ? NUMlog2 (candidate->frequency) : 0.0;
+	}
+}
+
 void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshold,
 	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost,
 	double ceiling, int pullFormants)
@@ -448,21 +464,21 @@ void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshol
 		voicedUnvoicedCost *= timeStepCorrection;
 
 		my ceiling = ceiling;
-		autoNUMmatrix <double> delta (1, my nx, 1, maxnCandidates);
-		autoNUMmatrix <long> psi (1, my nx, 1, maxnCandidates);
-
-		for (long iframe = 1; iframe <= my nx; iframe ++) {
-			Pitch_Frame frame = & my frame [iframe];
-			double unvoicedStrength = silenceThreshold <= 0 ? 0 :
-				2 - frame->intensity / (silenceThreshold / (1 + voicingThreshold));
-			unvoicedStrength = voicingThreshold + (unvoicedStrength > 0 ? unvoicedStrength : 0);
-			for (long icand = 1; icand <= frame->nCandidates; icand ++) {
-				Pitch_Candidate candidate = & frame->candidate [icand];
-				int voiceless = candidate->frequency == 0 || candidate->frequency > ceiling2;
-				delta [iframe] [icand] = voiceless ? unvoicedStrength :
-					candidate->strength - octaveCost * NUMlog2 (ceiling / candidate->frequency);
-			}
-		}
+		/*
+			Only two rows of scores are needed at a time; the back pointers are kept for every frame.
+			The logarithms of the candidate frequencies are computed once per candidate,
+			instead of once per pair of candidates in consecutive frames.
+			The octave-jump cost is therefore based on log2 (f1) - log2 (f2) instead of log2 (f1 / f2);
+			the two differ by rounding only (some 1e-15 octaves), which can change the path only
+			where two paths have scores that are equal to within that rounding.
+		*/
+		autoNUMvector <double> prevDelta (1, maxnCandidates), curDelta (1, maxnCandidates);
+		autoNUMvector <double> prevLogFrequency (1, maxnCandidates), curLogFrequency (1, maxnCandidates);
+		autoNUMvector <bool> prevVoiced (1, maxnCandidates), curVoiced (1, maxnCandidates);
+		autoNUMmatrix <int> psi (1, my nx, 1, maxnCandidates);
+
+		Pitch_Frame_getPathScores (& my frame [1], silenceThreshold, voicingThreshold, octaveCost, ceiling, ceiling2,
+			prevDelta.peek(), prevLogFrequency.peek(), prevVoiced.peek());
 
 		/* Look for the most probable path through the maxima. */
 		/* There is a cost for the voiced/unvoiced transition, */
@@ -470,47 +486,41 @@ void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshol
 
 		for (long iframe = 2; iframe <= my nx; iframe ++) {
 			Pitch_Frame prevFrame = & my frame [iframe - 1], curFrame = & my frame [iframe];
-			double *prevDelta = delta [iframe - 1], *curDelta = delta [iframe];
-			long *curPsi = psi [iframe];
+			Pitch_Frame_getPathScores (curFrame, silenceThreshold, voicingThreshold, octaveCost, ceiling, ceiling2,
+				curDelta.peek(), curLogFrequency.peek(), curVoiced.peek());
+			int *curPsi = psi [iframe];
+			long numberOfPreviousCandidates = prevFrame -> nCandidates;
 			for (long icand2 = 1; icand2 <= curFrame -> nCandidates; icand2 ++) {
-				double f2 = curFrame -> candidate [icand2]. frequency;
+				bool currentVoiceless = ! curVoiced [icand2];
+				double logf2 = curLogFrequency [icand2];
 				maximum = -1e30;
 				place = 0;
-				for (long icand1 = 1; icand1 <= prevFrame -> nCandidates; icand1 ++) {
-					double f1 = prevFrame -> candidate [icand1]. frequency;
+				for (long icand1 = 1; icand1 <= numberOfPreviousCandidates; icand1 ++) {
 					double transitionCost;
-					bool previousVoiceless = f1 <= 0 || f1 >= ceiling2;
-					bool currentVoiceless = f2 <= 0 || f2 >= ceiling2;
+					bool previousVoiceless = ! prevVoiced [icand1];
 					if (currentVoiceless) {
-						if (previousVoiceless) {
-							transitionCost = 0;   // both voiceless
-						} else {
-							transitionCost = voicedUnvoicedCost;   // voiced-to-unvoiced transition
-						}
+						transitionCost = previousVoiceless ? 0 : voicedUnvoicedCost;   // both voiceless, or voiced-to-unvoiced
+					} else if (! previousVoiceless) {
+						transitionCost = octaveJumpCost * fabs (prevLogFrequency [icand1] - logf2);   // both voiced
 					} else {
-						if (previousVoiceless) {
-							transitionCost = voicedUnvoicedCost;   // unvoiced-to-voiced transition
-							if (Melder_debug == 30) {
-								/*
-								 * Try to take into account a frequency jump across a voiceless stretch.
-								 */
-								long place1 = icand1;
-								for (long jframe = iframe - 2; jframe >= 1; jframe --) {
-									place1 = psi [jframe + 1] [place1];
-									f1 = my frame [jframe]. candidate [place1]. frequency;
-									if (f1 > 0 && f1 < ceiling) {
-										transitionCost += octaveJumpCost * fabs (NUMlog2 (f1 / f2)) / (iframe - jframe);
-										break;
-									}
+						transitionCost = voicedUnvoicedCost;   // unvoiced-to-voiced transition
+						if (Melder_debug == 30) {
+							/*
+							 * Try to take into account a frequency jump across a voiceless stretch.
+							 */
+							double f2 = curFrame -> candidate [icand2]. frequency;
+							long place1 = icand1;
+							for (long jframe = iframe - 2; jframe >= 1; jframe --) {
+								place1 = psi [jframe + 1] [place1];
+								double f1 = my frame [jframe]. candidate [place1]. frequency;
+								if (f1 > 0 && f1 < ceiling) {
+									transitionCost += octaveJumpCost * fabs (NUMlog2 (f1 / f2)) / (iframe - jframe);
+									break;
 								}
 							}
-						} else {
-							transitionCost = octaveJumpCost * fabs (NUMlog2 (f1 / f2));   // both voiced
 						}
 					}
 					value = prevDelta [icand1] - transitionCost + curDelta [icand2];
-					//if (Melder_debug == 33) Melder_casual ("Frame %ld, current candidate %ld (delta %g), previous candidate %ld (delta %g), "
-					//	"transition cost %g, value %g, maximum %g", iframe, icand2, curDelta [icand2], icand1, prevDelta [icand1], transitionCost, value, maximum);
 					if (value > maximum) {
 						maximum = value;
 						place = icand1;
@@ -526,16 +536,21 @@ void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshol
 				curDelta [icand2] = maximum;
 				curPsi [icand2] = place;
 			}
+			for (long icand = 1; icand <= curFrame -> nCandidates; icand ++) {
+				prevDelta [icand] = curDelta [icand];
+				prevLogFrequency [icand] = curLogFrequency [icand];
+				prevVoiced [icand] = curVoiced [icand];
+			}
 		}
 
 		/* Find the end of the most probable path. */
 
 		place = 1;
-		maximum = delta [my nx] [place];
+		maximum = prevDelta [place];
 		for (long icand = 2; icand <= my frame [my nx]. nCandidates; icand ++) {
-			if (delta [my nx] [icand] > maximum) {
+			if (prevDelta [icand] > maximum) {
 				place = icand;
-				maximum = delta [my nx] [place];
+				maximum = prevDelta [place];
 			}
 		}
 
@@ -44,11 +44,9 @@ static void infoPeriods (PointProcess me, double shortestPeriod, double longestP
 	long numberOfPeriods = PointProcess_getNumberOfPeriods (me, 0.0, 0.0, shortestPeriod, longestPeriod, maximumPeriodFactor);
 	double meanPeriod = PointProcess_getMeanPeriod (me, 0.0, 0.0, shortestPeriod, longestPeriod, maximumPeriodFactor);
 	double stdevPeriod = PointProcess_getStdevPeriod (me, 0.0, 0.0, shortestPeriod, longestPeriod, maximumPeriodFactor);
-	double jitter_local = PointProcess_getJitter_local (me, 0.0, 0.0, shortestPeriod, longestPeriod, maximumPeriodFactor);
-	double jitter_local_absolute = PointProcess_getJitter_local_absolute (me, 0.0, 0.0, shortestPeriod, longestPeriod, maximumPeriodFactor);
-	double jitter_rap = PointProcess_getJitter_rap (me, 0.0, 0.0, shortestPeriod, longestPeriod, maximumPeriodFactor);
-	double jitter_ppq5 = PointProcess_getJitter_ppq5 (me, 0.0, 0.0, shortestPeriod, longestPeriod, maximumPeriodFactor);
-	double jitter_ddp = PointProcess_getJitter_ddp (me, 0.0, 0.0, shortestPeriod, longestPeriod, maximumPeriodFactor);
+	double jitter_local, jitter_local_absolute, jitter_rap, jitter_ppq5, jitter_ddp;
+	PointProcess_getJitter_multi (me, 0.0, 0.0, shortestPeriod, longestPeriod, maximumPeriodFactor,
+		& jitter_local, & jitter_local_absolute, & jitter_rap, & jitter_ppq5, & jitter_ddp);
 	MelderInfo_writeLine (U"     Number of periods: ", numberOfPeriods);
 	MelderInfo_writeLine (U"     Mean period: ", meanPeriod, U" seconds");
 	MelderInfo_writeLine (U"     Stdev period: ", stdevPeriod, U" seconds");
@@ -24,6 +24,7 @@
 
 #include "Sound.h"
 #include "Sound_extensions.h"
+#include "Sound_and_Spectrum.h"
 #include "NUM2.h"
 
 #include "enums_getText.h"
@@ -518,30 +519,66 @@ autoSound Sounds_convolve (Sound me, Sound thee, enum kSounds_convolve_scaling s
 		long n1 = my nx, n2 = thy nx;
 		long n3 = n1 + n2 - 1, nfft = 1;
 		while (nfft < n3) nfft *= 2;
-		autoNUMvector <double> data1 (1, nfft);
-		autoNUMvector <double> data2 (1, nfft);
 		long numberOfChannels = my ny > thy ny ? my ny : thy ny;
 		autoSound him = Sound_create (numberOfChannels, my xmin + thy xmin, my xmax + thy xmax, n3, my dx, my x1 + thy x1);
-		for (long channel = 1; channel <= numberOfChannels; channel ++) {
-			double *a = my z [my ny == 1 ? 1 : channel];
-			for (long i = n1; i > 0; i --) data1 [i] = a [i];
-			for (long i = n1 + 1; i <= nfft; i ++) data1 [i] = 0.0;
-			a = thy z [thy ny == 1 ? 1 : channel];
-			for (long i = n2; i > 0; i --) data2 [i] = a [i];
-			for (long i = n2 + 1; i <= nfft; i ++) data2 [i] = 0.0;
-			NUMrealft (data1.peek(), nfft, 1);
-			NUMrealft (data2.peek(), nfft, 1);
-			data2 [1] *= data1 [1];
-			data2 [2] *= data1 [2];
-			for (long i = 3; i <= nfft; i += 2) {
-				double temp = data1 [i] * data2 [i] - data1 [i + 1] * data2 [i + 1];
-				data2 [i + 1] = data1 [i] * data2 [i + 1] + data1 [i + 1] * data2 [i];
-				data2 [i] = temp;
+		/*
+			A single transform of nfft points needs buffers of twice the length of the result
+			and has poor cache behaviour for long sounds. Beyond 2^16 points, we convolve block by block
+			(partitioned overlap-save), with the shorter sound as the kernel,
+			but only if that kernel is clearly shorter than the signal: a kernel longer than a block (at most 2^16 samples)
+			is split into partitions that all have to be multiplied with every block,
+			and if the kernel is about as long as the signal, the single transform is cheaper.
+		*/
+		long kernelLength = n1 < n2 ? n1 : n2, signalLength = n1 < n2 ? n2 : n1;
+		bool blockwise = nfft > 65536 && kernelLength <= signalLength / 2;
+		double scalingOfTransform = blockwise ? 1.0 : 1.0 / nfft;
+		if (blockwise) {
+			Sound signal = n1 >= n2 ? me : thee, kernel = n1 >= n2 ? thee : me;
+			long blockSize = BlockConvolver_getDefaultBlockSize (kernel -> nx);
+			autoNUMvector <double> input (1, blockSize), output (1, blockSize);
+			autoBlockConvolver convolver;
+			for (long channel = 1; channel <= numberOfChannels; channel ++) {
+				if (channel == 1 || kernel -> ny > 1) {
+					convolver = BlockConvolver_create (kernel -> z [kernel -> ny == 1 ? 1 : channel], kernel -> nx, blockSize);
+				} else {
+					BlockConvolver_reset (convolver.get());
+				}
+				const double *x = signal -> z [signal -> ny == 1 ? 1 : channel];
+				double *y = his z [channel];
+				for (long offset = 0; offset < n3; offset += blockSize) {
+					for (long i = 1; i <= blockSize; i ++) {
+						input [i] = offset + i <= signal -> nx ? x [offset + i] : 0.0;
+					}
+					BlockConvolver_process (convolver.get(), input.peek(), output.peek());
+					for (long i = 1; i <= blockSize && offset + i <= n3; i ++) {
+						y [offset + i] = output [i];
+					}
+				}
 			}
-			NUMrealft (data2.peek(), nfft, -1);
-			a = him -> z [channel];
-			for (long i = 1; i <= n3; i ++) {
-				a [i] = data2 [i];
+		} else {
+			autoNUMvector <double> data1 (1, nfft);
+			autoNUMvector <double> data2 (1, nfft);
+			for (long channel = 1; channel <= numberOfChannels; channel ++) {
+				double *a = my z [my ny == 1 ? 1 : channel];
+				for (long i = n1; i > 0; i --) data1 [i] = a [i];
+				for (long i = n1 + 1; i <= nfft; i ++) data1 [i] = 0.0;
+				a = thy z [thy ny == 1 ? 1 : channel];
+				for (long i = n2; i > 0; i --) data2 [i] = a [i];
+				for (long i = n2 + 1; i <= nfft; i ++) data2 [i] = 0.0;
+				NUMrealft (data1.peek(), nfft, 1);
+				NUMrealft (data2.peek(), nfft, 1);
+				data2 [1] *= data1 [1];
+				data2 [2] *= data1 [2];
+				for (long i = 3; i <= nfft; i += 2) {
+					double temp = data1 [i] * data2 [i] - data1 [i + 1] * data2 [i + 1];
+					data2 [i + 1] = data1 [i] * data2 [i + 1] + data1 [i + 1] * data2 [i];
+					data2 [i] = temp;
+				}
+				NUMrealft (data2.peek(), nfft, -1);
+				a = him -> z [channel];
+				for (long i = 1; i <= n3; i ++) {
+					a [i] = data2 [i];
+				}
 			}
 		}
 		switch (signalOutsideTimeDomain) {
@@ -566,15 +603,15 @@ autoSound Sounds_convolve (Sound me, Sound thee, enum kSounds_convolve_scaling s
 		}
 		switch (scaling) {
 			case kSounds_convolve_scaling_INTEGRAL: {
-				Vector_multiplyByScalar (him.get(), my dx / nfft);
+				Vector_multiplyByScalar (him.get(), my dx * scalingOfTransform);
 			} break;
 			case kSounds_convolve_scaling_SUM: {
-				Vector_multiplyByScalar (him.get(), 1.0 / nfft);
+				Vector_multiplyByScalar (him.get(), scalingOfTransform);
 			} break;
 			case kSounds_convolve_scaling_NORMALIZE: {
 				double normalizationFactor = Matrix_getNorm (me) * Matrix_getNorm (thee);
 				if (normalizationFactor != 0.0) {
-					Vector_multiplyByScalar (him.get(), 1.0 / nfft / normalizationFactor);
+					Vector_multiplyByScalar (him.get(), scalingOfTransform / normalizationFactor);
 				}
 			} break;
 			case kSounds_convolve_scaling_PEAK_099: {
@@ -141,6 +141,200 @@ autoSpectrum Spectrum_lpcSmoothing (Spectrum me, int numberOfPeaks, double preem
 	}
 }
 
+Thing_implement (BlockConvolver, Thing, 0);
+
+long BlockConvolver_getDefaultBlockSize (long kernelLength) {
+	/*
+		With partitions of B samples, a kernel of M samples costs two transforms of 2B points and M/B spectral products
+		per block of B output samples. Taking B near M keeps the number of products small
+		without letting the transforms (and the latency) grow beyond what a long kernel needs anyway.
+	*/
+	long blockSize = 256;
+	while (blockSize < kernelLength && blockSize < 65536) blockSize *= 2;
+	return blockSize;
+}
+
+autoBlockConvolver BlockConvolver_create (const double kernel [], long kernelLength, long blockSize) {
+	try {
+		Melder_assert (kernelLength >= 1 && blockSize >= 1);
+		autoBlockConvolver me = Thing_new (BlockConvolver);
+		my blockSize = blockSize;
+		my fftSize = 2 * blockSize;
+		my numberOfPartitions = (kernelLength - 1) / blockSize + 1;
+		NUMfft_Table_init (& my fourierTable, my fftSize);
+		my kernelSpectra.reset (1, my numberOfPartitions, 1, my fftSize);
+		my inputSpectra.reset (1, my numberOfPartitions, 1, my fftSize);
+		my inputBuffer.reset (1, my fftSize);
+		my outputBuffer.reset (1, my fftSize);
+		/*
+			The kernel spectra include the 1 / fftSize of the inverse transform.
+		*/
+		double scaling = 1.0 / my fftSize;
+		for (long ipartition = 1; ipartition <= my numberOfPartitions; ipartition ++) {
+			double *spectrum = my kernelSpectra [ipartition];
+			long offset = (ipartition - 1) * blockSize;
+			long numberOfSamples = kernelLength - offset < blockSize ? kernelLength - offset : blockSize;
+			for (long i = 1; i <= numberOfSamples; i ++) {
+				spectrum [i] = kernel [offset + i] * scaling;
+			}
+			NUMfft_forward (& my fourierTable, spectrum);
+		}
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"BlockConvolver not created.");
+	}
+}
+
+void BlockConvolver_reset (BlockConvolver me) {
+	for (long ipartition = 1; ipartition <= my numberOfPartitions; ipartition ++) {
+		for (long i = 1; i <= my fftSize; i ++) {
+			my inputSpectra [ipartition] [i] = 0.0;
+		}
+	}
+	for (long i = 1; i <= my fftSize; i ++) {
+		my inputBuffer [i] = 0.0;
+	}
+	my newestPartition = 0;
+}
+
+void BlockConvolver_process (BlockConvolver me, const double input [], double output []) {
+	long blockSize = my blockSize, fftSize = my fftSize;
+	/*
+		The input buffer holds the previous block followed by the current one.
+	*/
+	double *buffer = my inputBuffer.peek();
+	for (long i = 1; i <= blockSize; i ++) {
+		buffer [i] = buffer [blockSize + i];
+		buffer [blockSize + i] = input [i];
+	}
+	my newestPartition = my newestPartition % my numberOfPartitions + 1;
+	double *newestSpectrum = my inputSpectra [my newestPartition];
+	for (long i = 1; i <= fftSize; i ++) {
+		newestSpectrum [i] = buffer [i];
+	}
+	NUMfft_forward (& my fourierTable, newestSpectrum);
+	/*
+		Multiply the spectrum of the input block of k blocks ago with that of kernel partition k + 1, and sum.
+		Layout of the spectra: dc, (re, im) pairs, Nyquist.
+	*/
+	double *sum = my outputBuffer.peek();
+	for (long i = 1; i <= fftSize; i ++) {
+		sum [i] = 0.0;
+	}
+	for (long ipartition = 1, iinput = my newestPartition; ipartition <= my numberOfPartitions; ipartition ++) {
+		const double *x = my inputSpectra [iinput], *h = my kernelSpectra [ipartition];
+		sum [1] += x [1] * h [1];
+		sum [fftSize] += x [fftSize] * h [fftSize];
+		for (long i = 2; i < fftSize; i += 2) {
+			sum [i] += x [i] * h [i] - x [i + 1] * h [i + 1];
+			sum [i + 1] += x [i] * h [i + 1] + x [i + 1] * h [i];
+		}
+		if (-- iinput < 1) iinput = my numberOfPartitions;
+	}
+	NUMfft_backward (& my fourierTable, sum);
+	/*
+		The first half is circularly aliased; the second half is the linear convolution.
+	*/
+	for (long i = 1; i <= blockSize; i ++) {
+		output [i] = sum [blockSize + i];
+	}
+}
+
+autoSound Sound_createHannBandFilter (double samplingFrequency, double fmin, double fmax, double smooth, bool stop) {
+	try {
+		Melder_assert (smooth > 0.0);
+		/*
+			The impulse response of a Hann-shaped edge of width 2 * smooth decays as (t * smooth) ^ -3;
+			16 / smooth seconds leaves less than -90 dB outside the filter.
+		*/
+		long numberOfSamples = 256;
+		while (numberOfSamples < 16.0 * samplingFrequency / smooth && numberOfSamples < 16777216) numberOfSamples *= 2;
+		long numberOfFrequencies = numberOfSamples / 2 + 1;
+		autoSpectrum spectrum = Spectrum_create (0.5 * samplingFrequency, numberOfFrequencies);
+		for (long i = 1; i <= numberOfFrequencies; i ++) {
+			spectrum -> z [1] [i] = 1.0;
+		}
+		if (stop) {
+			Spectrum_stopHannBand (spectrum.get(), fmin, fmax, smooth);
+		} else {
+			Spectrum_passHannBand (spectrum.get(), fmin, fmax, smooth);
+		}
+		autoNUMvector <double> data (1, numberOfSamples);
+		data [1] = spectrum -> z [1] [1];
+		for (long i = 2; i < numberOfFrequencies; i ++) {
+			data [i + i - 2] = spectrum -> z [1] [i];
+			data [i + i - 1] = 0.0;
+		}
+		data [numberOfSamples] = spectrum -> z [1] [numberOfFrequencies];
+		autoNUMfft_Table fourierTable;
+		NUMfft_Table_init (& fourierTable, numberOfSamples);
+		NUMfft_backward (& fourierTable, data.peek());
+		/*
+			Rotate the circular (zero-phase) response so that time 0 is at sample numberOfSamples / 2 + 1.
+		*/
+		double dx = 1.0 / samplingFrequency, halfDuration = 0.5 * numberOfSamples * dx;
+		autoSound thee = Sound_create (1, - halfDuration - 0.5 * dx, halfDuration - 0.5 * dx, numberOfSamples, dx, - halfDuration);
+		long half = numberOfSamples / 2;
+		for (long i = 1; i <= numberOfSamples; i ++) {
+			thy z [1] [i] = data [i <= half ? i + half : i - half] / numberOfSamples;
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (U"Hann band filter not created.");
+	}
+}
+
+autoSound Sound_filter_blockwise (Sound me, Sound impulseResponse) {
+	try {
+		if (impulseResponse -> ny != 1)
+			Melder_throw (U"The impulse response should be mono.");
+		if (fabs (impulseResponse -> dx / my dx - 1.0) > 1e-9)   // equal up to rounding, e.g. after resampling back and forth
+			Melder_throw (U"The sampling frequencies of the sound and the impulse response have to be equal.");
+		long numberOfSkippedSamples = Sampled_xToNearestIndex (impulseResponse, 0.0) - 1;
+		if (numberOfSkippedSamples < 0 || numberOfSkippedSamples >= impulseResponse -> nx)
+			Melder_throw (U"The impulse response should contain time 0.");
+		long blockSize = BlockConvolver_getDefaultBlockSize (impulseResponse -> nx);
+		autoBlockConvolver convolver = BlockConvolver_create (impulseResponse -> z [1], impulseResponse -> nx, blockSize);
+		autoNUMvector <double> input (1, blockSize), output (1, blockSize);
+		autoSound thee = Sound_create (my ny, my xmin, my xmax, my nx, my dx, my x1);
+		for (long ichan = 1; ichan <= my ny; ichan ++) {
+			const double *x = my z [ichan];
+			double *y = thy z [ichan];
+			if (ichan > 1) {
+				BlockConvolver_reset (convolver.get());
+			}
+			for (long offset = 0; offset < my nx + numberOfSkippedSamples; offset += blockSize) {
+				for (long i = 1; i <= blockSize; i ++) {
+					input [i] = offset + i <= my nx ? x [offset + i] : 0.0;
+				}
+				BlockConvolver_process (convolver.get(), input.peek(), output.peek());
+				for (long i = 1; i <= blockSize; i ++) {
+					long isample = offset + i - numberOfSkippedSamples;
+					if (isample >= 1 && isample <= my nx) {
+						y [isample] = output [i];
+					}
+				}
+			}
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": not filtered block-wise.");
+	}
+}
+
+static bool Sound_filter_hannBandShouldBeBlockwise (Sound me, double smooth) {
+	/*
+		One transform of the whole sound is fine for sounds of up to a minute or so;
+		beyond that, its buffers and cache misses make block-wise filtering preferable,
+		provided that the impulse response is much shorter than the sound.
+	*/
+	if (smooth <= 0.0) return false;
+	long nfft = 2;
+	while (nfft < my nx) nfft *= 2;
+	if (nfft <= 2097152) return false;
+	return 16.0 / (my dx * smooth) * 16.0 < my nx;
+}
+
 autoSound Sound_filter_formula (Sound me, const char32 *formula, Interpreter interpreter) {
 	try {
 		autoSound thee = Data_copy (me);
@@ -166,6 +360,10 @@ autoSound Sound_filter_formula (Sound me, const char32 *formula, Interpreter int
 
 autoSound Sound_filter_passHannBand (Sound me, double fmin, double fmax, double smooth) {
 	try {
+		if (Sound_filter_hannBandShouldBeBlockwise (me, smooth)) {
+			autoSound filter = Sound_createHannBandFilter (1.0 / my dx, fmin, fmax, smooth, false);
+			return Sound_filter_blockwise (me, filter.get());
+		}
 		autoSound thee = Data_copy (me);
 		if (my ny == 1) {
 			autoSpectrum spec = Sound_to_Spectrum (me, true);
@@ -189,6 +387,10 @@ autoSound Sound_filter_passHannBand (Sound me, double fmin, double fmax, double
 
 autoSound Sound_filter_stopHannBand (Sound me, double fmin, double fmax, double smooth) {
 	try {
+		if (Sound_filter_hannBandShouldBeBlockwise (me, smooth)) {
+			autoSound filter = Sound_createHannBandFilter (1.0 / my dx, fmin, fmax, smooth, true);
+			return Sound_filter_blockwise (me, filter.get());
+		}
 		autoSound thee = Data_copy (me);
 		if (my ny == 1) {
 			autoSpectrum spec = Sound_to_Spectrum (me, true);
@@ -18,6 +18,7 @@
 
 #include "Sound.h"
 #include "Spectrum.h"
+#include "NUM2.h"
 Thing_declare (Interpreter);
 
 autoSpectrum Sound_to_Spectrum_at (Sound me, double tim, double windowDuration, int windowType);
@@ -31,4 +32,48 @@ autoSound Sound_filter_passHannBand (Sound me, double fmin, double fmax, double
 autoSound Sound_filter_stopHannBand (Sound me, double fmin, double fmax, double smooth);
 autoSound Sound_filter_formula (Sound me, const char32 *formula, Interpreter interpreter);
 
+/*
+	Uniformly partitioned overlap-save convolution.
+	The kernel is cut into partitions of blockSize samples, whose spectra (of size 2 * blockSize) are computed once.
+	Every call to BlockConvolver_process transforms one block of input, multiplies the spectra of
+	the most recent numberOfPartitions input blocks with those of the partitions, and transforms back once.
+	Memory use is of the order of kernelLength + blockSize, independent of the length of the signal,
+	so that a signal can be convolved block by block while it is being read.
+*/
+Thing_define (BlockConvolver, Thing) {
+	long blockSize, fftSize, numberOfPartitions, newestPartition;
+	autoNUMfft_Table fourierTable;
+	autoNUMmatrix <double> kernelSpectra, inputSpectra;   // [1..numberOfPartitions] [1..fftSize]
+	autoNUMvector <double> inputBuffer, outputBuffer;   // [1..fftSize]
+};
+
+long BlockConvolver_getDefaultBlockSize (long kernelLength);
+/* A power of two near kernelLength, for which the cost per sample is low; at least 256 and at most 65536. */
+
+autoBlockConvolver BlockConvolver_create (const double kernel [], long kernelLength, long blockSize);
+/* kernel [1..kernelLength]; blockSize should be a power of two. */
+
+void BlockConvolver_reset (BlockConvolver me);
+
+void BlockConvolver_process (BlockConvolver me, const double input [], double output []);
+/*
+	input [1..blockSize] are the next samples of the signal (zeroes after its end);
+	output [1..blockSize] receives the next samples of the full convolution, i.e., after n calls
+	the output contains samples 1..n*blockSize of the signal convolved with the kernel.
+*/
+
+autoSound Sound_createHannBandFilter (double samplingFrequency, double fmin, double fmax, double smooth, bool stop);
+/*
+	The zero-phase impulse response of the frequency response that Spectrum_passHannBand (or Spectrum_stopHannBand)
+	applies, sampled at a frequency resolution fine enough for the smoothing width.
+	The time domain is symmetric around 0; convolving a Sound with it (Sounds_convolve) and extracting
+	the original time domain gives the filtered Sound. Precondition: smooth > 0.
+*/
+
+autoSound Sound_filter_blockwise (Sound me, Sound impulseResponse);
+/*
+	Convolve each channel of me with the (mono) impulse response block by block, and return the part of the result
+	that has the time domain of me: an FIR filter in which the sample at time 0 of the impulse response is the centre tap.
+*/
+
 /* End of file Sound_and_Spectrum.h */
@@ -31,6 +31,105 @@
 #include "Sound_to_Cochleagram.h"
 #include "Sound_and_Spectrum.h"
 #include "Spectrum_to_Excitation.h"
+#include "NUM2.h"
+#include "MelderThread.h"
+
+Thing_define (Sound_into_Cochleagram_Args, Thing) { public:
+	Sound sound;
+	Cochleagram cochleagram;
+	long firstFrame, lastFrame, nsamp_window, halfnsamp_window, numberOfFourierSamples;
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (Sound_into_Cochleagram_Args, Thing, 0);
+
+static autoSound_into_Cochleagram_Args Sound_into_Cochleagram_Args_create (Sound sound, Cochleagram cochleagram,
+	long firstFrame, long lastFrame, long nsamp_window, long halfnsamp_window, long numberOfFourierSamples,
+	bool isMainThread, volatile int *cancelled)
+{
+	autoSound_into_Cochleagram_Args me = Thing_new (Sound_into_Cochleagram_Args);
+	my sound = sound;
+	my cochleagram = cochleagram;
+	my firstFrame = firstFrame;
+	my lastFrame = lastFrame;
+	my nsamp_window = nsamp_window;
+	my halfnsamp_window = halfnsamp_window;
+	my numberOfFourierSamples = numberOfFourierSamples;
+	my isMainThread = isMainThread;
+	my cancelled = cancelled;
+	return me;
+}
+
+MelderThread_MUTEX (mutex);
+static bool mutex_inited;
+
+static MelderThread_RETURN_TYPE Sound_into_Cochleagram (Sound_into_Cochleagram_Args me) {
+	Sound sound = my sound;
+	Cochleagram thee = my cochleagram;
+	long nsamp_window = my nsamp_window, numberOfSamples = my numberOfFourierSamples;
+	long numberOfFrequencies = numberOfSamples / 2 + 1;
+	/*
+		Everything that Sound_to_Spectrum and Spectrum_to_Excitation would create for every frame
+		is created only once per thread.
+	*/
+	autoNUMvector <double> data, work;
+	autoNUMfft_Table fourierTable;
+	autoSpectrum spec;
+	autoExcitation excitation;
+	{// scope
+		MelderThread_LOCK (mutex);
+		data.reset (1, numberOfSamples);
+		NUMfft_Table_init (& fourierTable, numberOfSamples);
+		spec = Spectrum_create (0.5 / sound -> dx, numberOfFrequencies);
+		spec -> dx = 1.0 / (sound -> dx * numberOfSamples);   // as in Sound_to_Spectrum
+		excitation = Excitation_create (thy dy, thy ny);
+		work.reset (1, 4 * thy ny);
+		MelderThread_UNLOCK (mutex);
+	}
+	double *re = spec -> z [1], *im = spec -> z [2];
+	double scaling = sound -> dx;
+	for (long iframe = my firstFrame; iframe <= my lastFrame; iframe ++) {
+		if (my isMainThread) {
+			try {
+				if ((iframe % 20) == 1)
+					Melder_progress ((double) (iframe - my firstFrame + 1) / (my lastFrame - my firstFrame + 1),
+						U"Cochleagram analysis of frame ", iframe, U" out of ", my lastFrame, U".");
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		} else if (*my cancelled) {
+			MelderThread_RETURN;
+		}
+		double t = Sampled_indexToX (thee, iframe);
+		long leftSample = Sampled_xToLowIndex (sound, t);
+		long rightSample = leftSample + 1;
+		long startSample = rightSample - my halfnsamp_window;
+		if (startSample < 1) startSample = 1;
+
+		/* Copy a window to a frame. */
+		for (long i = 1; i <= nsamp_window; i ++)
+			data [i] =
+				( sound -> ny == 1 ? sound -> z[1][i+startSample-1] : 0.5 * (sound -> z[1][i+startSample-1] + sound -> z[2][i+startSample-1]) ) *
+				(0.5 - 0.5 * cos (2.0 * NUMpi * i / (nsamp_window + 1)));
+		for (long i = nsamp_window + 1; i <= numberOfSamples; i ++)
+			data [i] = 0.0;
+		NUMfft_forward (& fourierTable, data.peek());
+		re [1] = data [1] * scaling;
+		im [1] = 0.0;
+		for (long i = 2; i < numberOfFrequencies; i ++) {
+			re [i] = data [i + i - 2] * scaling;
+			im [i] = data [i + i - 1] * scaling;
+		}
+		re [numberOfFrequencies] = data [numberOfSamples] * scaling;   // the number of samples is even
+		im [numberOfFrequencies] = 0.0;
+		Spectrum_into_Excitation (spec.get(), excitation.get(), work.peek());
+		for (long ifreq = 1; ifreq <= thy ny; ifreq ++)
+			thy z [ifreq] [iframe] = excitation -> z [1] [ifreq];
+	}
+	MelderThread_RETURN;
+}
 
 autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_window, double forwardMaskingTime) {
 	try {
@@ -45,35 +144,50 @@ autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_
 		if (nFrames < 2) return autoCochleagram ();
 		double t1 = my x1 + 0.5 * (duration - my dx - (nFrames - 1) * dt);   // centre of first frame
 		autoCochleagram thee = Cochleagram_create (my xmin, my xmax, nFrames, dt, t1, df, nf);
-		autoSound window = Sound_createSimple (1, nsamp_window * my dx, 1.0 / my dx);
+		long numberOfFourierSamples = 2;
+		while (numberOfFourierSamples < nsamp_window) numberOfFourierSamples *= 2;
 		for (long iframe = 1; iframe <= nFrames; iframe ++) {
 			double t = Sampled_indexToX (thee.get(), iframe);
-			long leftSample = Sampled_xToLowIndex (me, t);
-			long rightSample = leftSample + 1;
-			long startSample = rightSample - halfnsamp_window;
-			long endSample = rightSample + halfnsamp_window;
-			if (startSample < 1) {
+			long startSample = Sampled_xToLowIndex (me, t) + 1 - halfnsamp_window;
+			long endSample = startSample + nsamp_window;
+			if (startSample < 1)
 				Melder_casual (U"Start sample too small: ", startSample,
 					U" instead of 1.");
-				startSample = 1;
-			}
-			if (endSample > my nx) {
+			if (endSample > my nx)
 				Melder_casual (U"End sample too small: ", endSample,
 					U" instead of ", my nx,
 					U".");
-				endSample = my nx;
-			}
+		}
 
-			/* Copy a window to a frame. */
-			for (long i = 1; i <= nsamp_window; i ++)
-				window -> z [1] [i] =
-					( my ny == 1 ? my z[1][i+startSample-1] : 0.5 * (my z[1][i+startSample-1] + my z[2][i+startSample-1]) ) *
-					(0.5 - 0.5 * cos (2.0 * NUMpi * i / (nsamp_window + 1)));
-			autoSpectrum spec = Sound_to_Spectrum (window.get(), true);
-			autoExcitation excitation = Spectrum_to_Excitation (spec.get(), df);
-			for (long ifreq = 1; ifreq <= nf; ifreq ++)
-				thy z [ifreq] [iframe] = excitation -> z [1] [ifreq] + ( iframe > 1 ? dampingFactor * thy z [ifreq] [iframe - 1] : 0 );
+		/*
+			The frames are independent, so they can be analysed on separate threads;
+			forward masking connects them afterwards.
+		*/
+		autoMelderProgress progress (U"Cochleagram analysis");
+		long numberOfFramesPerThread = 20;
+		int numberOfThreads = (nFrames - 1) / numberOfFramesPerThread + 1;
+		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		numberOfFramesPerThread = (nFrames - 1) / numberOfThreads + 1;
+
+		if (! mutex_inited) { MelderThread_MUTEX_INIT (mutex); mutex_inited = true; }
+		autoSound_into_Cochleagram_Args args [16];
+		long firstFrame = 1, lastFrame = numberOfFramesPerThread;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			if (ithread == numberOfThreads) lastFrame = nFrames;
+			args [ithread - 1] = Sound_into_Cochleagram_Args_create (me, thee.get(), firstFrame, lastFrame,
+				nsamp_window, halfnsamp_window, numberOfFourierSamples, ithread == numberOfThreads, & cancelled);
+			firstFrame = lastFrame + 1;
+			lastFrame += numberOfFramesPerThread;
 		}
+		MelderThread_run (Sound_into_Cochleagram, args, numberOfThreads);
+
+		for (long ifreq = 1; ifreq <= nf; ifreq ++)
+			for (long iframe = 2; iframe <= nFrames; iframe ++)
+				thy z [ifreq] [iframe] += dampingFactor * thy z [ifreq] [iframe - 1];
 		for (long iframe = 1; iframe <= nFrames; iframe ++)
 			for (long ifreq = 1; ifreq <= nf; ifreq ++)
 				thy z [ifreq] [iframe] *= integrationCorrection;
@@ -104,6 +218,157 @@ static autoSound createGammatone (double midFrequency_Hertz, double samplingFreq
 	return gammatone;
 }
 
+Thing_define (Sound_into_Cochleagram_edb_Args, Thing) { public:
+	Sound sound;
+	Cochleagram cochleagram;
+	long firstChannel, lastChannel;
+	int hasSynapse;
+	double replenishmentRate, lossRate, returnRate, reprocessingRate;
+	const double *smoothingWeights;   // [-d..d], shared
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (Sound_into_Cochleagram_edb_Args, Thing, 0);
+
+static autoSound_into_Cochleagram_edb_Args Sound_into_Cochleagram_edb_Args_create (Sound sound, Cochleagram cochleagram,
+	long firstChannel, long lastChannel, int hasSynapse, double replenishmentRate, double lossRate, double returnRate,
+	double reprocessingRate, const double *smoothingWeights, bool isMainThread, volatile int *cancelled)
+{
+	autoSound_into_Cochleagram_edb_Args me = Thing_new (Sound_into_Cochleagram_edb_Args);
+	my sound = sound;
+	my cochleagram = cochleagram;
+	my firstChannel = firstChannel;
+	my lastChannel = lastChannel;
+	my hasSynapse = hasSynapse;
+	my replenishmentRate = replenishmentRate;
+	my lossRate = lossRate;
+	my returnRate = returnRate;
+	my reprocessingRate = reprocessingRate;
+	my smoothingWeights = smoothingWeights;
+	my isMainThread = isMainThread;
+	my cancelled = cancelled;
+	return me;
+}
+
+static MelderThread_RETURN_TYPE Sound_into_Cochleagram_edb (Sound_into_Cochleagram_edb_Args me) {
+	Sound sound = my sound;
+	Cochleagram thee = my cochleagram;
+	double dtime = thy dx;
+	long ntime = thy nx;
+	for (long ifreq = my firstChannel; ifreq <= my lastChannel; ifreq ++) {
+		if (my isMainThread) {
+			try {
+				Melder_progress ((double) (ifreq - my firstChannel) / (my lastChannel - my firstChannel + 1),
+					U"Cochleagram analysis of channel ", ifreq, U" out of ", my lastChannel, U".");
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		} else if (*my cancelled) {
+			MelderThread_RETURN;
+		}
+		double *response = thy z [ifreq];
+
+		/* Stage 3: basilar membrane filtering by gammatones. */
+		/* From oval window to basilar membrane response. */
+
+		double midFrequency_Bark = (ifreq - 0.5) * thy dy;
+		double midFrequency_Hertz = Excitation_barkToHertz (midFrequency_Bark);
+		autoSound gammatone, basil;
+		autoBlockConvolver convolver;
+		autoNUMvector <double> input, output;
+		long blockSize;
+		{// scope
+			MelderThread_LOCK (mutex);
+			gammatone = createGammatone (midFrequency_Hertz, 1.0 / sound -> dx);
+			basil = Sound_create (1, sound -> xmin + gammatone -> xmin, sound -> xmax + gammatone -> xmax,
+				sound -> nx + gammatone -> nx - 1, sound -> dx, sound -> x1 + gammatone -> x1);
+			blockSize = BlockConvolver_getDefaultBlockSize (gammatone -> nx);
+			convolver = BlockConvolver_create (gammatone -> z [1], gammatone -> nx, blockSize);
+			input.reset (1, blockSize);
+			output.reset (1, blockSize);
+			MelderThread_UNLOCK (mutex);
+		}
+		for (long offset = 0; offset < basil -> nx; offset += blockSize) {
+			for (long i = 1; i <= blockSize; i ++)
+				input [i] = offset + i <= sound -> nx ? sound -> z [1] [offset + i] : 0.0;
+			BlockConvolver_process (convolver.get(), input.peek(), output.peek());
+			for (long i = 1; i <= blockSize && offset + i <= basil -> nx; i ++)
+				basil -> z [1] [offset + i] = output [i];
+		}
+
+		/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
+		/* From basilar membrane response to firing rate. */
+
+		if (my hasSynapse) {
+			double dt = sound -> dx;
+			double M = 1.0;   // maximum free transmitter
+			double A = 5.0, B = 300.0, g = 2000.0;   // determine permeability
+			double y = my replenishmentRate;            // Meddis: 5.05
+			double l = my lossRate, r = my returnRate;     // Meddis: 2500, 6580
+			double x = my reprocessingRate;             // Meddis: 66.31
+			double h = 50000;   // convert cleft contents to firing rate
+			double gdt = 1.0 - exp (- g * dt);
+			double ydt = 1.0 - exp (- y * dt);
+			double ldt = (1.0 - exp (- (l + r) * dt)) * l / (l + r);
+			double rdt = (1.0 - exp (- (l + r) * dt)) * r / (l + r);
+			double xdt = 1.0 - exp (- x * dt);
+			double kt = g * A / (A + B);   // membrane permeability
+			double c = M * y * kt / (l * kt + y * (l + r));   // cleft contents
+			double q = c * (l + r) / kt;   // free transmitter
+			double w = c * r / x;   // reprocessing store
+			for (long itime = 1; itime <= basil -> nx; itime ++) {
+				double splusA = basil -> z [1] [itime] * 10.0 + A;
+				double replenish = ( M > q ? ydt * (M - q) : 0.0 );
+				kt = ( splusA > 0.0 ? gdt * splusA / (splusA + B) : 0.0 );
+				double eject = kt * q;
+				double loss = ldt * c;
+				double reuptake = rdt * c;
+				double reprocess = xdt * w;
+				q = q + replenish - eject + reprocess;
+				c = c + eject - loss - reuptake;
+				w = w + reuptake - reprocess;
+				basil -> z [1] [itime] = h * c;
+			}
+		}
+
+		if (dtime == sound -> dx) {
+			for (long itime = 1; itime <= ntime; itime ++)
+				response [itime] = basil -> z [1] [itime];
+		} else {
+			double d = dtime / basil -> dx / 2;
+			double area = d * sqrt (NUMpi / 6);
+			double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
+			for (long itime = 1; itime <= ntime; itime ++) {
+				double t1 = (itime - 1) * dtime;
+				double t2 = t1 + dtime;
+				double mean = 0.0;
+				long i1, i2;
+				long n = Matrix_getWindowSamplesX (basil.get(), t1, t2, & i1, & i2);
+				Melder_assert (n >= 1);
+				if (n <= 2) {
+					for (long isamp = i1; isamp <= i2; isamp ++)
+						mean += basil -> z [1] [isamp];
+					mean /= n;
+				} else {
+					double mu = floor ((i1 + i2) / 2.0);
+					long muint = (long) mu, dint = (long) d;
+					for (long isamp = muint - dint; isamp <= muint + dint; isamp ++) {
+						double y = 0;
+						if (isamp >= 1 && isamp <= basil -> nx)
+							y = basil -> z [1] [isamp];
+						mean += y * onebyoneminexpmin6 * my smoothingWeights [isamp - muint];
+					}
+					mean /= area;
+				}
+				response [itime] = mean;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
 autoCochleagram Sound_to_Cochleagram_edb
 	(Sound me, double dtime, double dfreq, int hasSynapse, double replenishmentRate,
 	 double lossRate, double returnRate, double reprocessingRate)
@@ -120,89 +385,42 @@ autoCochleagram Sound_to_Cochleagram_edb
 		/* Stages 1 and 2: outer- and middle-ear filtering. */
 		/* From acoustic sound to oval window. */
 
-		for (long ifreq = 1; ifreq <= nfreq; ifreq ++) {
-			double *response = thy z [ifreq];
-
-			/* Stage 3: basilar membrane filtering by gammatones. */
-			/* From oval window to basilar membrane response. */
-
-			double midFrequency_Bark = (ifreq - 0.5) * dfreq;
-			double midFrequency_Hertz = Excitation_barkToHertz (midFrequency_Bark);
-			autoSound gammatone = createGammatone (midFrequency_Hertz, 1.0 / my dx);
-			autoSound basil = Sounds_convolve (me, gammatone.get(), kSounds_convolve_scaling_SUM, kSounds_convolve_signalOutsideTimeDomain_ZERO);
-
-			/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
-			/* From basilar membrane response to firing rate. */
-
-			if (hasSynapse) {
-				double dt = my dx;
-				double M = 1.0;   // maximum free transmitter
-				double A = 5.0, B = 300.0, g = 2000.0;   // determine permeability
-				double y = replenishmentRate;            // Meddis: 5.05
-				double l = lossRate, r = returnRate;     // Meddis: 2500, 6580
-				double x = reprocessingRate;             // Meddis: 66.31
-				double h = 50000;   // convert cleft contents to firing rate
-				double gdt = 1.0 - exp (- g * dt);
-				double ydt = 1.0 - exp (- y * dt);
-				double ldt = (1.0 - exp (- (l + r) * dt)) * l / (l + r);
-				double rdt = (1.0 - exp (- (l + r) * dt)) * r / (l + r);
-				double xdt = 1.0 - exp (- x * dt);
-				double kt = g * A / (A + B);   // membrane permeability
-				double c = M * y * kt / (l * kt + y * (l + r));   // cleft contents
-				double q = c * (l + r) / kt;   // free transmitter
-				double w = c * r / x;   // reprocessing store
-				for (long itime = 1; itime <= basil -> nx; itime ++) {
-					double splusA = basil -> z [1] [itime] * 10.0 + A;
-					double replenish = ( M > q ? ydt * (M - q) : 0.0 );
-					kt = ( splusA > 0.0 ? gdt * splusA / (splusA + B) : 0.0 );
-					double eject = kt * q;
-					double loss = ldt * c;
-					double reuptake = rdt * c;
-					double reprocess = xdt * w;
-					q = q + replenish - eject + reprocess;
-					c = c + eject - loss - reuptake;
-					w = w + reuptake - reprocess;
-					basil -> z [1] [itime] = h * c;
-				}
-			}
-			
-			if (dtime == my dx) {
-				for (long itime = 1; itime <= ntime; itime ++)
-					response [itime] = basil -> z [1] [itime];
-			} else {
-				double d = dtime / basil -> dx / 2;
-				double factor = -6 / d / d;
-				double area = d * sqrt (NUMpi / 6);
-				double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
-				for (long itime = 1; itime <= ntime; itime ++) {
-					double t1 = (itime - 1) * dtime;
-					double t2 = t1 + dtime;
-					double mean = 0.0;
-					long i1, i2;
-					long n = Matrix_getWindowSamplesX (basil.get(), t1, t2, & i1, & i2);
-					Melder_assert (n >= 1);
-					if (n <= 2) {
-						for (long isamp = i1; isamp <= i2; isamp ++)
-							mean += basil -> z [1] [isamp];
-						mean /= n;
-					} else {
-						double mu = floor ((i1 + i2) / 2.0);
-						long muint = (long) mu, dint = (long) d;
-						for (long isamp = muint - dint; isamp <= muint + dint; isamp ++) {
-							double y = 0;
-							if (isamp < 1 || isamp > basil -> nx)
-								Melder_casual (U"isamp ", isamp);
-							else
-								y = basil -> z [1] [isamp];
-							mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) *
-								(isamp - muint)) - expmin6);
-						}
-						mean /= area;
-					}
-					response [itime] = mean;
-				}
-			}
+		/*
+			The Gaussian smoothing window (in samples) is the same for every channel.
+		*/
+		double d = dtime / my dx / 2;
+		double factor = -6 / d / d;
+		long dint = (long) d;
+		autoNUMvector <double> smoothingWeights (- dint, dint);
+		for (long k = - dint; k <= dint; k ++)
+			smoothingWeights [k] = exp (factor * k * k) - exp (-6);
+
+		/*
+			Every frequency channel is filtered independently,
+			so the channels are divided over the threads.
+		*/
+		autoMelderProgress progress (U"Cochleagram analysis");
+		long numberOfChannelsPerThread = 4;
+		int numberOfThreads = (nfreq - 1) / numberOfChannelsPerThread + 1;
+		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		numberOfChannelsPerThread = (nfreq - 1) / numberOfThreads + 1;
+
+		if (! mutex_inited) { MelderThread_MUTEX_INIT (mutex); mutex_inited = true; }
+		autoSound_into_Cochleagram_edb_Args args [16];
+		long firstChannel = 1, lastChannel = numberOfChannelsPerThread;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			if (ithread == numberOfThreads) lastChannel = nfreq;
+			args [ithread - 1] = Sound_into_Cochleagram_edb_Args_create (me, thee.get(), firstChannel, lastChannel,
+				hasSynapse, replenishmentRate, lossRate, returnRate, reprocessingRate, smoothingWeights.peek(),
+				ithread == numberOfThreads, & cancelled);
+			firstChannel = lastChannel + 1;
+			lastChannel += numberOfChannelsPerThread;
 		}
+		MelderThread_run (Sound_into_Cochleagram_edb, args, numberOfThreads);
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": not converted to Cochleagram (edb).");
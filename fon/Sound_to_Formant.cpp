@@ -31,59 +31,181 @@
 #include "Sound_to_Formant.h"
 #include "NUM2.h"
 #include "Polynomial.h"
+#include "MelderThread.h"
 
-static void burg (double sample [], long nsamp_window, double cof [], int nPoles,
-	Formant_Frame frame, double nyquistFrequency, double safetyMargin)
+static void burg (double sample [], long nsamp_window, double cof [], double work [], int nPoles,
+	PolynomialRootFinder finder, double nyquistFrequency, double safetyMargin,
+	double frequencies [], double bandwidths [], long *numberOfFormants, bool *suspect)   // put the results here
 {
 	double a0;
-	NUMburg (sample, nsamp_window, cof, nPoles, & a0);
+	NUMburg_preallocated (sample, nsamp_window, cof, nPoles, & a0, work);
 
 	/*
 	 * Convert LP coefficients to polynomial.
 	 */
-	autoPolynomial polynomial = Polynomial_create (-1, 1, nPoles);
+	Polynomial polynomial = finder -> polynomial.get();
+	polynomial -> numberOfCoefficients = nPoles + 1;
 	for (int i = 1; i <= nPoles; i ++)
 		polynomial -> coefficients [i] = - cof [nPoles - i + 1];
 	polynomial -> coefficients [nPoles + 1] = 1.0;
 
 	/*
-	 * Find the roots of the polynomial.
+	 * Find the roots of the polynomial, starting from those of the previous frame.
 	 */
-	autoRoots roots = Polynomial_to_Roots (polynomial.get());
-	Roots_fixIntoUnitCircle (roots.get());
-
-	Melder_assert (frame -> nFormants == 0 && ! frame -> formant);
+	*suspect = ! PolynomialRootFinder_findRoots (finder, true);
+	Roots roots = finder -> roots.get();
+	Roots_fixIntoUnitCircle (roots);
 
 	/*
-	 * First pass: count the formants.
-	 * The roots come in conjugate pairs, so we need only count those above the real axis.
+	 * Collect the formants.
+	 * The roots come in conjugate pairs, so we need only look at those above the real axis.
 	 */
-	for (int i = roots -> min; i <= roots -> max; i ++) if (roots -> v [i]. im >= 0) {
+	*numberOfFormants = 0;
+	for (long i = roots -> min; i <= roots -> max; i ++) if (roots -> v [i]. im >= 0.0) {
 		double f = fabs (atan2 (roots -> v [i].im, roots -> v [i].re)) * nyquistFrequency / NUMpi;
-		if (f >= safetyMargin && f <= nyquistFrequency - safetyMargin)
-			frame -> nFormants ++;
+		if (f >= safetyMargin && f <= nyquistFrequency - safetyMargin) {
+			++ *numberOfFormants;
+			frequencies [*numberOfFormants] = f;
+			bandwidths [*numberOfFormants] = -
+				log (roots -> v [i].re * roots -> v [i].re + roots -> v [i].im * roots -> v [i].im) * nyquistFrequency / NUMpi;
+		}
 	}
+}
 
-	/*
-	 * Create space for formant data.
-	 */
-	if (frame -> nFormants > 0)
-		frame -> formant = NUMvector <structFormant_Formant> (1, frame -> nFormants);
+/*
+ * The Burg analysis runs on threads, a block of frames at a time.
+ * Every thread has its own buffers and root finder, and puts the formants of its frames into scratch arrays;
+ * the main thread (which does all the allocation) then moves them into the Formant frames.
+ */
+#define Sound_to_Formant_BLOCK_SIZE  4096
 
-	/*
-	 * Second pass: fill in the formants.
-	 */
-	int iformant = 0;
-	for (int i = roots -> min; i <= roots -> max; i ++) if (roots -> v [i]. im >= 0.0) {
-		double f = fabs (atan2 (roots -> v [i].im, roots -> v [i].re)) * nyquistFrequency / NUMpi;
-		if (f >= safetyMargin && f <= nyquistFrequency - safetyMargin) {
-			Formant_Formant formant = & frame -> formant [++ iformant];
-			formant -> frequency = f;
-			formant -> bandwidth = -
-				log (roots -> v [i].re * roots -> v [i].re + roots -> v [i].im * roots -> v [i].im) * nyquistFrequency / NUMpi;
+Thing_define (Sound_to_Formant_Args, Thing) { public:
+	Sound sound;
+	Formant formant;
+	double *window;
+	long nsamp_window, halfnsamp_window;
+	int numberOfPoles;
+	double safetyMargin;
+	long firstFrame, lastFrame, blockOffset;   // frame iframe goes to scratch row iframe - blockOffset
+	autoNUMvector <double> frame, cof, work;
+	autoPolynomialRootFinder finder;
+	double **frequencies, **bandwidths;   // shared scratch [1..blockSize] [1..numberOfPoles]
+	long *numberOfFormants;
+	bool *suspect, *infinite;
+};
+
+Thing_implement (Sound_to_Formant_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE Sound_to_Formant_burg_thread (Sound_to_Formant_Args me) {
+	Sound sound = my sound;
+	Formant thee = my formant;
+	for (long iframe = my firstFrame; iframe <= my lastFrame; iframe ++) {
+		long irow = iframe - my blockOffset;
+		my numberOfFormants [irow] = 0;
+		my suspect [irow] = my infinite [irow] = false;
+		double t = Sampled_indexToX (thee, iframe);
+		long leftSample = Sampled_xToLowIndex (sound, t);
+		long rightSample = leftSample + 1;
+		long startSample = rightSample - my halfnsamp_window;
+		long endSample = leftSample + my halfnsamp_window;
+		double maximumIntensity = 0.0;
+		if (startSample < 1) startSample = 1;
+		if (endSample > sound -> nx) endSample = sound -> nx;
+		for (long i = startSample; i <= endSample; i ++) {
+			double value = Sampled_getValueAtSample (sound, i, Sound_LEVEL_MONO, 0);
+			if (value * value > maximumIntensity) {
+				maximumIntensity = value * value;
+			}
+		}
+		if (maximumIntensity == HUGE_VAL) {
+			my infinite [irow] = true;
+			continue;
 		}
+		thy d_frames [iframe]. intensity = maximumIntensity;
+		if (maximumIntensity == 0.0) continue;   // Burg cannot stand all zeroes
+
+		/* Copy a pre-emphasized window to a frame. */
+		for (long j = 1, i = startSample; j <= my nsamp_window; j ++)
+			my frame [j] = Sampled_getValueAtSample (sound, i ++, Sound_LEVEL_MONO, 0) * my window [j];
+
+		burg (my frame.peek(), endSample - startSample + 1, my cof.peek(), my work.peek(), my numberOfPoles,
+			my finder.get(), 0.5 / sound -> dx, my safetyMargin,
+			my frequencies [irow], my bandwidths [irow], & my numberOfFormants [irow], & my suspect [irow]);
 	}
-	Melder_assert (iformant == frame -> nFormants);   // may fail if some frequency is NaN
+	MelderThread_RETURN;
+}
+
+static void Sound_into_Formant_burg (Sound me, Formant thee, double window [], long nsamp_window, long halfnsamp_window,
+	int numberOfPoles, double safetyMargin)
+{
+	long blockSize = thy nx < Sound_to_Formant_BLOCK_SIZE ? thy nx : Sound_to_Formant_BLOCK_SIZE;
+	autoNUMmatrix <double> frequencies (1, blockSize, 1, numberOfPoles);
+	autoNUMmatrix <double> bandwidths (1, blockSize, 1, numberOfPoles);
+	autoNUMvector <long> numberOfFormants (1, blockSize);
+	autoNUMvector <bool> suspect (1, blockSize);
+	autoNUMvector <bool> infinite (1, blockSize);
+
+	int numberOfThreads = blockSize < 16 ? (int) blockSize : 16;
+	const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	autoSound_to_Formant_Args args [16];
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoSound_to_Formant_Args arg = Thing_new (Sound_to_Formant_Args);
+		arg -> sound = me;
+		arg -> formant = thee;
+		arg -> window = window;
+		arg -> nsamp_window = nsamp_window;
+		arg -> halfnsamp_window = halfnsamp_window;
+		arg -> numberOfPoles = numberOfPoles;
+		arg -> safetyMargin = safetyMargin;
+		arg -> frame.reset (1, nsamp_window);
+		arg -> cof.reset (1, numberOfPoles);
+		arg -> work.reset (1, nsamp_window + nsamp_window + numberOfPoles);
+		arg -> finder = PolynomialRootFinder_create (numberOfPoles);
+		arg -> frequencies = frequencies.peek();
+		arg -> bandwidths = bandwidths.peek();
+		arg -> numberOfFormants = numberOfFormants.peek();
+		arg -> suspect = suspect.peek();
+		arg -> infinite = infinite.peek();
+		args [ithread - 1] = arg.move();
+	}
+
+	long numberOfSuspectFrames = 0;
+	for (long firstFrame = 1; firstFrame <= thy nx; firstFrame += blockSize) {
+		long lastFrame = firstFrame + blockSize - 1;
+		if (lastFrame > thy nx) lastFrame = thy nx;
+		long numberOfFrames = lastFrame - firstFrame + 1;
+		int numberOfThreadsInBlock = numberOfFrames < numberOfThreads ? (int) numberOfFrames : numberOfThreads;
+		long numberOfFramesPerThread = (numberOfFrames - 1) / numberOfThreadsInBlock + 1;
+		numberOfThreadsInBlock = (int) ((numberOfFrames - 1) / numberOfFramesPerThread + 1);
+		for (int ithread = 1; ithread <= numberOfThreadsInBlock; ithread ++) {
+			Sound_to_Formant_Args arg = args [ithread - 1].get();
+			arg -> blockOffset = firstFrame - 1;
+			arg -> firstFrame = firstFrame + (ithread - 1) * numberOfFramesPerThread;
+			arg -> lastFrame = ithread == numberOfThreadsInBlock ? lastFrame : arg -> firstFrame + numberOfFramesPerThread - 1;
+		}
+		MelderThread_run (Sound_to_Formant_burg_thread, args, numberOfThreadsInBlock);
+
+		for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+			long irow = iframe - firstFrame + 1;
+			if (infinite [irow])
+				Melder_throw (U"Sound contains infinities.");
+			if (suspect [irow]) numberOfSuspectFrames ++;
+			Formant_Frame frame = & thy d_frames [iframe];
+			Melder_assert (frame -> nFormants == 0 && ! frame -> formant);
+			frame -> nFormants = numberOfFormants [irow];
+			if (frame -> nFormants > 0)
+				frame -> formant = NUMvector <structFormant_Formant> (1, frame -> nFormants);
+			for (long iformant = 1; iformant <= frame -> nFormants; iformant ++) {
+				frame -> formant [iformant]. frequency = frequencies [irow] [iformant];
+				frame -> formant [iformant]. bandwidth = bandwidths [irow] [iformant];
+			}
+		}
+		Melder_progress ((double) lastFrame / (double) thy nx, U"Formant analysis: frame ", lastFrame);
+	}
+	if (numberOfSuspectFrames > 0)
+		Melder_warning (U"Not all formants could be computed in ", numberOfSuspectFrames, U" out of ", thy nx, U" frames.");
 }
 
 static int findOneZero (int ijt, double vcx [], double a, double b, double *zero) {
@@ -285,7 +407,6 @@ static autoFormant Sound_to_Formant_any_inline (Sound me, double dt_in, int numb
 	autoFormant thee = Formant_create (my xmin, my xmax, nFrames, dt, t1, (numberOfPoles + 1) / 2);   // e.g. 11 poles -> maximally 6 formants
 	autoNUMvector <double> window (1, nsamp_window);
 	autoNUMvector <double> frame (1, nsamp_window);
-	autoNUMvector <double> cof (1, numberOfPoles);   // superfluous if which==2, but nobody uses that anyway
 
 	autoMelderProgress progress (U"Formant analysis...");
 
@@ -298,6 +419,12 @@ static autoFormant Sound_to_Formant_any_inline (Sound me, double dt_in, int numb
 		window [i] = (exp (-48.0 * (i - imid) * (i - imid) / (nsamp_window + 1) / (nsamp_window + 1)) - edge) / (1.0 - edge);
 	}
 
+	if (which == 1) {
+		Sound_into_Formant_burg (me, thee.get(), window.peek(), nsamp_window, halfnsamp_window, numberOfPoles, safetyMargin);
+		Formant_sort (thee.get());
+		return thee;
+	}
+
 	for (long iframe = 1; iframe <= nFrames; iframe ++) {
 		double t = Sampled_indexToX (thee.get(), iframe);
 		long leftSample = Sampled_xToLowIndex (me, t);
@@ -322,16 +449,12 @@ static autoFormant Sound_to_Formant_any_inline (Sound me, double dt_in, int numb
 		for (long j = 1, i = startSample; j <= nsamp_window; j ++)
 			frame [j] = Sampled_getValueAtSample (me, i ++, Sound_LEVEL_MONO, 0) * window [j];
 
-		if (which == 1) {
-			burg (frame.peek(), endSample - startSample + 1, cof.peek(), numberOfPoles, & thy d_frames [iframe], 0.5 / my dx, safetyMargin);
-		} else if (which == 2) {
-			if (! splitLevinson (frame.peek(), endSample - startSample + 1, numberOfPoles, & thy d_frames [iframe], 0.5 / my dx)) {
-				Melder_clearError ();
-				Melder_casual (U"(Sound_to_Formant:)"
-					U" Analysis results of frame ", iframe,
-					U" will be wrong."
-				);
-			}
+		if (! splitLevinson (frame.peek(), endSample - startSample + 1, numberOfPoles, & thy d_frames [iframe], 0.5 / my dx)) {
+			Melder_clearError ();
+			Melder_casual (U"(Sound_to_Formant:)"
+				U" Analysis results of frame ", iframe,
+				U" will be wrong."
+			);
 		}
 		Melder_progress ((double) iframe / (double) nFrames, U"Formant analysis: frame ", iframe);
 	}
@@ -27,22 +27,210 @@
 #include "Sound_to_Harmonicity.h"
 #include "Sound_and_LPC.h"
 #include "Sound_and_Spectrum.h"
+#include "NUM2.h"
+#include "MelderThread.h"
 
-static void bandFilter (Spectrum me, double fmid, double bandwidth) {
-	double *re = my z [1], *im = my z [2];
+/*
+ * Put the band-filtered version of a spectrum (re, im) into data [1..nfft], in the order that NUMfft_backward expects,
+ * and scaled as in Spectrum_to_Sound.
+ * Only the bins inside the band can be nonzero.
+ */
+static void bandFilter_into (Spectrum me, const double re [], const double im [], double fmid, double bandwidth, double data [], long nfft) {
 	double fmin = fmid - bandwidth / 2.0, fmax = fmid + bandwidth / 2.0;
 	double twopibybandwidth = 2.0 * NUMpi / bandwidth;
+	double scaling = my dx;
+	for (long i = 1; i <= nfft; i ++)
+		data [i] = 0.0;
 	for (long col = 1; col <= my nx; col ++) {
 		double x = my x1 + (col - 1) * my dx;
-		if (x < fmin || x > fmax) {
-			re [col] = 0.0;
-			im [col] = 0.0;
+		if (x < fmin || x > fmax) continue;
+		double factor = 0.5 + 0.5 * cos (twopibybandwidth * (x - fmid));
+		if (col == 1) {
+			data [1] = (re [col] * factor) * scaling;
+		} else if (col == my nx) {
+			data [nfft] = (re [col] * factor) * scaling;   // the Nyquist bin has no imaginary part
 		} else {
-			double factor = 0.5 + 0.5 * cos (twopibybandwidth * (x - fmid));
-			re [col] *= factor;
-			im [col] *= factor;
+			data [col + col - 2] = (re [col] * factor) * scaling;
+			data [col + col - 1] = (im [col] * factor) * scaling;
+		}
+	}
+}
+
+Thing_define (Sound_into_GNE_envelopes_Args, Thing) { public:
+	Spectrum flatSpectrum;
+	double *fmid, bandwidth;
+	long nfft, firstSample, numberOfEnvelopeSamples;
+	double **envelope;
+	long firstBand, lastBand, numberOfBands;
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (Sound_into_GNE_envelopes_Args, Thing, 0);
+
+static autoSound_into_GNE_envelopes_Args Sound_into_GNE_envelopes_Args_create (Spectrum flatSpectrum,
+	double *fmid, double bandwidth, long nfft, long firstSample, long numberOfEnvelopeSamples, double **envelope,
+	long firstBand, long lastBand, long numberOfBands, bool isMainThread, volatile int *cancelled)
+{
+	autoSound_into_GNE_envelopes_Args me = Thing_new (Sound_into_GNE_envelopes_Args);
+	my flatSpectrum = flatSpectrum;
+	my fmid = fmid;
+	my bandwidth = bandwidth;
+	my nfft = nfft;
+	my firstSample = firstSample;
+	my numberOfEnvelopeSamples = numberOfEnvelopeSamples;
+	my envelope = envelope;
+	my firstBand = firstBand;
+	my lastBand = lastBand;
+	my numberOfBands = numberOfBands;
+	my isMainThread = isMainThread;
+	my cancelled = cancelled;
+	return me;
+}
+
+MelderThread_MUTEX (mutex);
+static bool mutex_inited;
+
+static MelderThread_RETURN_TYPE Sound_into_GNE_envelopes (Sound_into_GNE_envelopes_Args me)
+{
+	autoNUMfft_Table fftTable;
+	autoNUMvector <double> band, hilbertBand, minusRe;
+	{// scope
+		MelderThread_LOCK (mutex);
+		NUMfft_Table_init (& fftTable, my nfft);
+		band.reset (1, my nfft);
+		hilbertBand.reset (1, my nfft);
+		minusRe.reset (1, my flatSpectrum -> nx);
+		MelderThread_UNLOCK (mutex);
+	}
+	/*
+	 * The spectrum of the Hilbert transform of the flat sound has (im, -re) instead of (re, im).
+	 */
+	double *re = my flatSpectrum -> z [1], *im = my flatSpectrum -> z [2];
+	for (long col = 1; col <= my flatSpectrum -> nx; col ++)
+		minusRe [col] = - re [col];
+	for (long iband = my firstBand; iband <= my lastBand; iband ++) {
+		if (my isMainThread) {
+			try {
+				Melder_monitor ((double) iband / (my numberOfBands + 1.0), U"Computing Hilbert envelope ", iband, U"...");
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		} else if (*my cancelled) {
+			MelderThread_RETURN;
+		}
+		/*
+		 * Step 3: calculate Hilbert envelopes of bands.
+		 * 3a: Filter both the spectrum of the original flat sound and its Hilbert transform.
+		 * 3b: Create both the band-filtered flat sound and its Hilbert transform.
+		 */
+		bandFilter_into (my flatSpectrum, re, im, my fmid [iband], my bandwidth, band.peek(), my nfft);
+		bandFilter_into (my flatSpectrum, im, minusRe.peek(), my fmid [iband], my bandwidth, hilbertBand.peek(), my nfft);
+		NUMfft_backward (& fftTable, band.peek());
+		NUMfft_backward (& fftTable, hilbertBand.peek());
+		/*
+		 * 3c: Compute the Hilbert envelope of the band-passed flat signal,
+		 * over the time domain of the original sound.
+		 */
+		double *envelope = my envelope [iband];
+		for (long col = 1; col <= my numberOfEnvelopeSamples; col ++) {
+			long isamp = my firstSample - 1 + col;
+			double self = isamp >= 1 && isamp <= my nfft ? band [isamp] : 0.0;
+			double other = col <= my nfft ? hilbertBand [col] : 0.0;
+			envelope [col] = sqrt (self * self + other * other);
+		}
+		double sum = 0.0;
+		for (long col = 1; col <= my numberOfEnvelopeSamples; col ++)
+			sum += envelope [col];
+		double mean = sum / my numberOfEnvelopeSamples;
+		for (long col = 1; col <= my numberOfEnvelopeSamples; col ++)
+			envelope [col] -= mean;
+	}
+	MelderThread_RETURN;
+}
+
+/*
+ * The maximum over the lags firstLag..lastLag of the normalized cross-correlation of x [1..n] and y [1..n],
+ * as Vector_getMaximum of Sounds_crossCorrelate_short would compute it.
+ * All lags are accumulated in a single pass through x, so that each x [i] is loaded only once.
+ */
+static double NUMcrossCorrelate_maximum (const double x [], double xpower, const double y [], double ypower, long n,
+	long firstLag, long lastLag, double sum [])
+{
+	for (long lag = firstLag; lag <= lastLag; lag ++)
+		sum [lag] = 0.0;
+	for (long i = 1; i <= n; i ++) {
+		long minimumLag = firstLag > 1 - i ? firstLag : 1 - i;
+		long maximumLag = lastLag < n - i ? lastLag : n - i;
+		double xi = x [i];
+		for (long lag = minimumLag; lag <= maximumLag; lag ++)
+			sum [lag] += xi * y [i + lag];
+	}
+	if (xpower != 0.0 && ypower != 0.0) {
+		double factor = 1.0 / (sqrt (xpower) * sqrt (ypower));
+		for (long lag = firstLag; lag <= lastLag; lag ++)
+			sum [lag] *= factor;
+	}
+	double maximum = sum [firstLag];
+	for (long lag = firstLag + 1; lag <= lastLag; lag ++)
+		if (sum [lag] > maximum) maximum = sum [lag];
+	return maximum;
+}
+
+Thing_define (GNE_envelopes_crossCorrelate_Args, Thing) { public:
+	double **envelope, *power;
+	long numberOfEnvelopeSamples, numberOfBands, firstLag, lastLag;
+	double minimumDistance;
+	long firstRow, rowStep;
+	Matrix cc;
+};
+
+Thing_implement (GNE_envelopes_crossCorrelate_Args, Thing, 0);
+
+static autoGNE_envelopes_crossCorrelate_Args GNE_envelopes_crossCorrelate_Args_create (double **envelope, double *power,
+	long numberOfEnvelopeSamples, long numberOfBands, long firstLag, long lastLag, double minimumDistance,
+	long firstRow, long rowStep, Matrix cc)
+{
+	autoGNE_envelopes_crossCorrelate_Args me = Thing_new (GNE_envelopes_crossCorrelate_Args);
+	my envelope = envelope;
+	my power = power;
+	my numberOfEnvelopeSamples = numberOfEnvelopeSamples;
+	my numberOfBands = numberOfBands;
+	my firstLag = firstLag;
+	my lastLag = lastLag;
+	my minimumDistance = minimumDistance;
+	my firstRow = firstRow;
+	my rowStep = rowStep;
+	my cc = cc;
+	return me;
+}
+
+static MelderThread_RETURN_TYPE GNE_envelopes_crossCorrelate (GNE_envelopes_crossCorrelate_Args me)
+{
+	autoNUMvector <double> sum;
+	{// scope
+		MelderThread_LOCK (mutex);
+		sum.reset (my firstLag, my lastLag);
+		MelderThread_UNLOCK (mutex);
+	}
+	/*
+	 * The rows are interleaved among the threads, because row r has r - 1 cells to compute.
+	 */
+	for (long row = my firstRow; row <= my numberOfBands; row += my rowStep) {
+		for (long col = 1; col <= row - 1; col ++) {
+			/*
+			 * Cells that are too close to the diagonal would be zeroed in step 6, so we do not compute them.
+			 */
+			if (labs (row - col) < my minimumDistance) continue;
+			/*
+			 * Step 5: the maximum of each correlation function
+			 */
+			my cc -> z [row] [col] = NUMcrossCorrelate_maximum (my envelope [row], my power [row],
+				my envelope [col], my power [col], my numberOfEnvelopeSamples, my firstLag, my lastLag, sum.peek());
 		}
 	}
+	MelderThread_RETURN;
 }
 
 autoMatrix Sound_to_Harmonicity_GNE (Sound me,
@@ -52,11 +240,6 @@ autoMatrix Sound_to_Harmonicity_GNE (Sound me,
 	double step)   // 80 Hz
 {
 	try {
-		autoSound envelope [1+100];
-		long nenvelopes = (long) floor ((fmax - fmin) / step);
-		for (long ienvelope = 1; ienvelope <= 100; ienvelope ++)
-			Melder_assert (! envelope [ienvelope].get());
-
 		/*
 		 * Step 1: down-sampling to 10 kHz,
 		 * in order to be able to flatten the spectrum
@@ -77,81 +260,96 @@ autoMatrix Sound_to_Harmonicity_GNE (Sound me,
 		 * otherwise, the pre-emphasis would cause an overestimation
 		 * in the LPC object of the high frequencies, so that inverse
 		 * filtering would yield weakened high frequencies.
+		 * The spectrum of the flat signal is computed only once;
+		 * every band reads from it.
 		 */
 		autoLPC lpc = Sound_to_LPC_auto (original10k.get(), 13, 30e-3, 10e-3, 1e9);
 		autoSound flat = LPC_and_Sound_filterInverse (lpc.get(), original10k.get());
 		autoSpectrum flatSpectrum = Sound_to_Spectrum (flat.get(), true);
-		autoSpectrum hilbertSpectrum = Data_copy (flatSpectrum.get());
-		for (long col = 1; col <= hilbertSpectrum -> nx; col ++) {
-			hilbertSpectrum -> z [1] [col] = flatSpectrum -> z [2] [col];
-			hilbertSpectrum -> z [2] [col] = - flatSpectrum -> z [1] [col];
-		}
-		double fmid = fmin;
-		long ienvelope = 1;
-		autoMelderMonitor monitor (U"Computing Hilbert envelopes...");
-		while (fmid <= fmax) {
-			/*
-			 * Step 3: calculate Hilbert envelopes of bands.
-			 */
-			autoSpectrum bandSpectrum = Data_copy (flatSpectrum.get());
-			autoSpectrum hilbertBandSpectrum = Data_copy (hilbertSpectrum.get());
-			/*
-			 * 3a: Filter both the spectrum of the original flat sound and its Hilbert transform.
-			 */
-			bandFilter (bandSpectrum.get(), fmid, bandwidth);
-			bandFilter (hilbertBandSpectrum.get(), fmid, bandwidth);
-			/*
-			 * 3b: Create both the band-filtered flat sound and its Hilbert transform.
-			 */
-			autoSound band = Spectrum_to_Sound (bandSpectrum.get());
-			/*if (graphics) {
-				Graphics_beginMovieFrame (graphics, & Graphics_WHITE);
-				Spectrum_draw (bandSpectrum, graphics, 0, 5000, 0, 0, true);
-				Graphics_endMovieFrame (graphics, 0.0);
-			}*/
-			Melder_monitor (ienvelope / (nenvelopes + 1.0), U"Computing Hilbert envelope ", ienvelope, U"...");
-			autoSound hilbertBand = Spectrum_to_Sound (hilbertBandSpectrum.get());
-			envelope [ienvelope] = Sound_extractPart (band.get(), 0, duration, kSound_windowShape_RECTANGULAR, 1.0, true);
-			/*
-			 * 3c: Compute the Hilbert envelope of the band-passed flat signal.
-			 */
-			for (long col = 1; col <= envelope [ienvelope] -> nx; col ++) {
-				double self = envelope [ienvelope] -> z [1] [col], other = hilbertBand -> z [1] [col];
-				envelope [ienvelope] -> z [1] [col] = sqrt (self * self + other * other);
+
+		/*
+		 * The band-filtered sounds have the time sampling that Spectrum_to_Sound would give them,
+		 * and the envelopes are cut out of them over the time domain of the original sound,
+		 * as Sound_extractPart would do.
+		 */
+		long nfft = 2 * (flatSpectrum -> nx - 1);
+		double samplingFrequency = nfft * flatSpectrum -> dx;
+		double dt = 1.0 / samplingFrequency, t1 = 0.5 / samplingFrequency;
+		long firstSample = 1 + (long) ceil ((0.0 - t1) / dt);
+		long lastSample = 1 + (long) floor ((duration - t1) / dt);
+		if (lastSample < firstSample)
+			Melder_throw (U"Sound too short.");
+		long numberOfEnvelopeSamples = lastSample - firstSample + 1;
+
+		long numberOfBands = 0;
+		for (double fmid = fmin; fmid <= fmax; fmid += step)
+			numberOfBands ++;
+		if (numberOfBands < 1)
+			Melder_throw (U"No frequency bands between ", fmin, U" and ", fmax, U" Hz.");
+		autoNUMvector <double> fmid (1, numberOfBands);
+		fmid [1] = fmin;
+		for (long iband = 2; iband <= numberOfBands; iband ++)
+			fmid [iband] = fmid [iband - 1] + step;
+		autoNUMmatrix <double> envelope (1, numberOfBands, 1, numberOfEnvelopeSamples);
+
+		if (! mutex_inited) { MelderThread_MUTEX_INIT (mutex); mutex_inited = true; }
+		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+		{// scope
+			autoMelderMonitor monitor (U"Computing Hilbert envelopes...");
+			long numberOfBandsPerThread = 4;
+			int numberOfThreads = (numberOfBands - 1) / numberOfBandsPerThread + 1;
+			if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+			if (numberOfThreads > 16) numberOfThreads = 16;
+			if (numberOfThreads < 1) numberOfThreads = 1;
+			numberOfBandsPerThread = (numberOfBands - 1) / numberOfThreads + 1;
+
+			autoSound_into_GNE_envelopes_Args args [16];
+			long firstBand = 1, lastBand = numberOfBandsPerThread;
+			volatile int cancelled = 0;
+			for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+				if (ithread == numberOfThreads) lastBand = numberOfBands;
+				args [ithread - 1] = Sound_into_GNE_envelopes_Args_create (flatSpectrum.get(),
+					fmid.peek(), bandwidth, nfft, firstSample, numberOfEnvelopeSamples, envelope.peek(),
+					firstBand, lastBand, numberOfBands, ithread == numberOfThreads, & cancelled);
+				firstBand = lastBand + 1;
+				lastBand += numberOfBandsPerThread;
 			}
-			Vector_subtractMean (envelope [ienvelope].get());
-			/*
-			 * Next band.
-			 */
-			fmid += step;
-			ienvelope += 1;
+			MelderThread_run (Sound_into_GNE_envelopes, args, numberOfThreads);
 		}
 
 		/*
-		 * Step 4: crosscorrelation
+		 * Step 4: crosscorrelation over lags of at most 0.31 ms,
+		 * with the powers of the envelopes computed only once.
 		 */
-		nenvelopes = ienvelope - 1;
-		autoMatrix cc = Matrix_createSimple (nenvelopes, nenvelopes);
-		for (long row = 2; row <= nenvelopes; row ++) {
-			for (long col = 1; col <= row - 1; col ++) {
-				autoSound crossCorrelation = Sounds_crossCorrelate_short (envelope [row].get(), envelope [col].get(), -3.1e-4, 3.1e-4, true);
-				/*
-				 * Step 5: the maximum of each correlation function
-				 */
-				double ccmax = Vector_getMaximum (crossCorrelation.get(), 0.0, 0.0, 0);
-				cc -> z [row] [col] = ccmax;
+		autoNUMvector <double> power (1, numberOfBands);
+		for (long iband = 1; iband <= numberOfBands; iband ++) {
+			double sum = 0.0;
+			for (long i = 1; i <= numberOfEnvelopeSamples; i ++) {
+				double value = envelope [iband] [i];
+				sum += value * value;
 			}
+			power [iband] = sum;
 		}
-
+		long firstLag = (long) ceil (-3.1e-4 / dt), lastLag = (long) floor (3.1e-4 / dt);
+		Melder_assert (lastLag >= firstLag);
+		autoMatrix cc = Matrix_createSimple (numberOfBands, numberOfBands);
 		/*
 		 * Step 6: maximum of the maxima, ignoring those too close to the diagonal.
-		 */	
-		for (long row = 2; row <= nenvelopes; row ++) {
-			for (long col = 1; col <= row - 1; col ++) {
-				if (labs (row - col) < bandwidth / 2.0 / step) {
-					cc -> z [row] [col] = 0.0;
-				}
+		 */
+		double minimumDistance = bandwidth / 2.0 / step;
+		{// scope
+			long numberOfRowsPerThread = 4;
+			int numberOfThreads = (numberOfBands - 1) / numberOfRowsPerThread + 1;
+			if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+			if (numberOfThreads > 16) numberOfThreads = 16;
+			if (numberOfThreads < 1) numberOfThreads = 1;
+			autoGNE_envelopes_crossCorrelate_Args args [16];
+			for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+				args [ithread - 1] = GNE_envelopes_crossCorrelate_Args_create (envelope.peek(), power.peek(),
+					numberOfEnvelopeSamples, numberOfBands, firstLag, lastLag, minimumDistance,
+					1 + ithread, numberOfThreads, cc.get());
 			}
+			MelderThread_run (GNE_envelopes_crossCorrelate, args, numberOfThreads);
 		}
 
 		return cc;
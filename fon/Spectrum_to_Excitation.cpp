@@ -18,53 +18,64 @@
 
 #include "Spectrum_to_Excitation.h"
 
-autoExcitation Spectrum_to_Excitation (Spectrum me, double dbark) {
-	try {
-		long nbark = (int) floor (25.6 / dbark + 0.5);
-		double *re = my z [1], *im = my z [2]; 
+void Spectrum_into_Excitation (Spectrum me, Excitation thee, double work []) {
+	double dbark = thy dx;
+	long nbark = thy nx;
+	double *re = my z [1], *im = my z [2];
+	double *auditoryFilter = work, *inSig = work + nbark, *outSig = work + nbark + nbark;   // base 1
+	for (long i = 1; i <= 4 * nbark; i ++)
+		work [i] = 0.0;
 
-		autoNUMvector <double> auditoryFilter (1, nbark);
-		double filterArea = 0;
-		for (long i = 1; i <= nbark; i ++) {
-			double bark = dbark * (i - nbark/2) + 0.474;
-			filterArea += auditoryFilter [i] = pow (10, (1.581 + 0.75 * bark - 1.75 * sqrt (1 + bark * bark)));
-		}
-		/*for (long i = 1; i <= nbark; i ++)
-			auditoryFilter [i] /= filterArea;*/
-		autoNUMvector <double> rFreqs (1, nbark + 1);
-		autoNUMvector <long> iFreqs (1, nbark + 1);
-		for (long i = 1; i <= nbark + 1; i ++) {
-			rFreqs [i] = Excitation_barkToHertz (dbark * (i - 1));
-			iFreqs [i] = Sampled_xToNearestIndex (me, rFreqs [i]);
-		}
-		autoNUMvector <double> inSig (1, nbark);
-		for (long i = 1; i <= nbark; i ++) {
-			long low = iFreqs [i], high = iFreqs [i + 1] - 1;
-			if (low < 1) low = 1;
-			if (high > my nx) high = my nx;
-			for (long j = low; j <= high; j ++) {
-				inSig [i] += re [j] * re [j] + im [j] * im [j];   // Pa2 s2
-			}
-
-			/* An anti-undersampling correction. */
-			if (high >= low)
-				inSig [i] *= 2.0 * (rFreqs [i + 1] - rFreqs [i]) / (high - low + 1) * my dx;   // Pa2: power density in this band
+	double filterArea = 0;
+	for (long i = 1; i <= nbark; i ++) {
+		double bark = dbark * (i - nbark/2) + 0.474;
+		filterArea += auditoryFilter [i] = pow (10, (1.581 + 0.75 * bark - 1.75 * sqrt (1 + bark * bark)));
+	}
+	/*for (long i = 1; i <= nbark; i ++)
+		auditoryFilter [i] /= filterArea;*/
+	double rFreq = Excitation_barkToHertz (0.0);
+	long iFreq = Sampled_xToNearestIndex (me, rFreq);
+	for (long i = 1; i <= nbark; i ++) {
+		double nextRFreq = Excitation_barkToHertz (dbark * i);
+		long nextIFreq = Sampled_xToNearestIndex (me, nextRFreq);
+		long low = iFreq, high = nextIFreq - 1;
+		if (low < 1) low = 1;
+		if (high > my nx) high = my nx;
+		for (long j = low; j <= high; j ++) {
+			inSig [i] += re [j] * re [j] + im [j] * im [j];   // Pa2 s2
 		}
 
-		/* Convolution with auditory (masking) filter. */
+		/* An anti-undersampling correction. */
+		if (high >= low)
+			inSig [i] *= 2.0 * (nextRFreq - rFreq) / (high - low + 1) * my dx;   // Pa2: power density in this band
+		rFreq = nextRFreq;
+		iFreq = nextIFreq;
+	}
 
-		autoNUMvector <double> outSig (1, 2 * nbark);
-		for (long i = 1; i <= nbark; i ++) {
-			for (long j = 1; j <= nbark; j ++) {
-				outSig [i + j] += inSig [i] * auditoryFilter [j];
-			}
+	/*
+		Convolution with auditory (masking) filter.
+		Only outSig [nbark/2 + 1 .. nbark/2 + nbark] is used, so we skip the other sums.
+	*/
+	for (long i = 1; i <= nbark; i ++) {
+		long jmin = nbark/2 + 1 - i, jmax = nbark/2 + nbark - i;
+		if (jmin < 1) jmin = 1;
+		if (jmax > nbark) jmax = nbark;
+		for (long j = jmin; j <= jmax; j ++) {
+			outSig [i + j] += inSig [i] * auditoryFilter [j];
 		}
+	}
 
-		autoExcitation thee = Excitation_create (dbark, nbark);
-		for (long i = 1; i <= nbark; i ++) {
-			thy z [1] [i] = Excitation_soundPressureToPhon (sqrt (outSig [i + nbark/2]), Sampled_indexToX (thee.get(), i));
-		}
+	for (long i = 1; i <= nbark; i ++) {
+		thy z [1] [i] = Excitation_soundPressureToPhon (sqrt (outSig [i + nbark/2]), Sampled_indexToX (thee, i));
+	}
+}
 
+autoExcitation Spectrum_to_Excitation (Spectrum me, double dbark) {
+	try {
+		long nbark = (int) floor (25.6 / dbark + 0.5);
+		autoExcitation thee = Excitation_create (dbark, nbark);
+		autoNUMvector <double> work (1, 4 * nbark);
+		Spectrum_into_Excitation (me, thee.get(), work.peek());
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": not converted to Excitation.");
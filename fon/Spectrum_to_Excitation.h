@@ -25,4 +25,11 @@ autoExcitation Spectrum_to_Excitation (Spectrum me, double df);
 		filtered with 10 ^ (1.581 + 0.75 * bark - 1.75 * sqrt (1 + bark * bark)))
 */
 
+void Spectrum_into_Excitation (Spectrum me, Excitation thee, double work []);
+/*
+	As Spectrum_to_Excitation, with the Bark resolution and the number of bands taken from `thee`.
+	Allocates nothing: `work [1..4 * thy nx]` is scratch space, so that many frames can be
+	analysed in a row (or on separate threads) without repeated allocation.
+*/
+
 /* End of file Spectrum_to_Excitation.h */
@@ -18,6 +18,8 @@
 
 #include "TextGrid.h"
 #include "longchar.h"
+#include <unordered_map>
+#include <vector>
 
 #include "oo_DESTROY.h"
 #include "TextGrid_def.h"
@@ -38,6 +40,43 @@
 #include "oo_DESCRIPTION.h"
 #include "TextGrid_def.h"
 
+/*
+ * A tier in a large corpus contains millions of intervals, but only a few dozen different labels.
+ * A label query therefore remembers its verdict on every label it has seen,
+ * so that an expensive criterion (a regular expression, say) is evaluated only once per label.
+ * The verdicts are kept for the duration of a single query only, so that edits to the tiers never make them stale.
+ */
+struct LabelCriterion {
+	struct LabelHash {
+		size_t operator() (const char32 *label) const {
+			size_t hash = 2166136261u;
+			for (const char32 *p = label; *p != U'\0'; p ++)
+				hash = (hash ^ (size_t) *p) * 16777619u;
+			return hash;
+		}
+	};
+	struct LabelEqual {
+		bool operator() (const char32 *label1, const char32 *label2) const {
+			return str32equ (label1, label2);
+		}
+	};
+	int which_Melder_STRING;
+	const char32 *criterion;
+	std::unordered_map <const char32 *, bool, LabelHash, LabelEqual> verdicts;   // the keys belong to the tier
+	LabelCriterion (int a_which_Melder_STRING, const char32 *a_criterion)
+		: which_Melder_STRING (a_which_Melder_STRING), criterion (a_criterion) { }
+	bool matches (const char32 *label) {
+		if (! label) label = U"";
+		if (which_Melder_STRING <= kMelder_string_NOT_EQUAL_TO)
+			return Melder_stringMatchesCriterion (label, which_Melder_STRING, criterion);   // a lookup would be no cheaper
+		auto found = verdicts.find (label);
+		if (found != verdicts.end ()) return found -> second;
+		bool verdict = Melder_stringMatchesCriterion (label, which_Melder_STRING, criterion);
+		verdicts [label] = verdict;
+		return verdict;
+	}
+};
+
 #include "TextGrid_extensions.h"
 
 Thing_implement (TextPoint, AnyPoint, 0);
@@ -469,9 +508,10 @@ long TextGrid_countIntervalsWhere (TextGrid me, long tierNumber, int which_Melde
 	try {
 		long count = 0;
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
+		LabelCriterion labelCriterion (which_Melder_STRING, criterion);
 		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion)) {
+			if (labelCriterion. matches (interval -> text)) {
 				count ++;
 			}
 		}
@@ -485,9 +525,10 @@ long TextGrid_countPointsWhere (TextGrid me, long tierNumber, int which_Melder_S
 	try {
 		long count = 0;
 		TextTier tier = TextGrid_checkSpecifiedTierIsPointTier (me, tierNumber);
+		LabelCriterion labelCriterion (which_Melder_STRING, criterion);
 		for (long ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
 			TextPoint point = tier -> points.at [ipoint];
-			if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion)) {
+			if (labelCriterion. matches (point -> mark)) {
 				count ++;
 			}
 		}
@@ -693,10 +734,11 @@ autoPointProcess IntervalTier_getCentrePoints (IntervalTier me, const char32 *te
 autoPointProcess TextGrid_getStartingPoints (TextGrid me, long tierNumber, int which_Melder_STRING, const char32 *criterion) {
 	try {
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
+		LabelCriterion labelCriterion (which_Melder_STRING, criterion);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
 		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion)) {
+			if (labelCriterion. matches (interval -> text)) {
 				PointProcess_addPoint (thee.get(), interval -> xmin);
 			}
 		}
@@ -709,10 +751,11 @@ autoPointProcess TextGrid_getStartingPoints (TextGrid me, long tierNumber, int w
 autoPointProcess TextGrid_getEndPoints (TextGrid me, long tierNumber, int which_Melder_STRING, const char32 *criterion) {
 	try {
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
+		LabelCriterion labelCriterion (which_Melder_STRING, criterion);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
 		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion)) {
+			if (labelCriterion. matches (interval -> text)) {
 				PointProcess_addPoint (thee.get(), interval -> xmax);
 			}
 		}
@@ -725,10 +768,11 @@ autoPointProcess TextGrid_getEndPoints (TextGrid me, long tierNumber, int which_
 autoPointProcess TextGrid_getCentrePoints (TextGrid me, long tierNumber, int which_Melder_STRING, const char32 *criterion) {
 	try {
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
+		LabelCriterion labelCriterion (which_Melder_STRING, criterion);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
 		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion)) {
+			if (labelCriterion. matches (interval -> text)) {
 				PointProcess_addPoint (thee.get(), 0.5 * (interval -> xmin + interval -> xmax));
 			}
 		}
@@ -741,10 +785,11 @@ autoPointProcess TextGrid_getCentrePoints (TextGrid me, long tierNumber, int whi
 autoPointProcess TextGrid_getPoints (TextGrid me, long tierNumber, int which_Melder_STRING, const char32 *criterion) {
 	try {
 		TextTier tier = TextGrid_checkSpecifiedTierIsPointTier (me, tierNumber);
+		LabelCriterion labelCriterion (which_Melder_STRING, criterion);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
 		for (long ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
 			TextPoint point = tier -> points.at [ipoint];
-			if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion)) {
+			if (labelCriterion. matches (point -> mark)) {
 				PointProcess_addPoint (thee.get(), point -> number);
 			}
 		}
@@ -760,12 +805,14 @@ autoPointProcess TextGrid_getPoints_preceded (TextGrid me, long tierNumber,
 {
 	try {
 		TextTier tier = TextGrid_checkSpecifiedTierIsPointTier (me, tierNumber);
+		LabelCriterion labelCriterion (which_Melder_STRING, criterion);
+		LabelCriterion precedingLabelCriterion (which_Melder_STRING_precededBy, criterion_precededBy);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
 		for (long ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
 			TextPoint point = tier -> points.at [ipoint];
-			if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion)) {
+			if (labelCriterion. matches (point -> mark)) {
 				TextPoint preceding = ( ipoint <= 1 ? nullptr : tier -> points.at [ipoint - 1] );
-				if (Melder_stringMatchesCriterion (preceding -> mark, which_Melder_STRING_precededBy, criterion_precededBy)) {
+				if (precedingLabelCriterion. matches (preceding ? preceding -> mark : nullptr)) {
 					PointProcess_addPoint (thee.get(), point -> number);
 				}
 			}
@@ -782,12 +829,14 @@ autoPointProcess TextGrid_getPoints_followed (TextGrid me, long tierNumber,
 {
 	try {
 		TextTier tier = TextGrid_checkSpecifiedTierIsPointTier (me, tierNumber);
+		LabelCriterion labelCriterion (which_Melder_STRING, criterion);
+		LabelCriterion followingLabelCriterion (which_Melder_STRING_followedBy, criterion_followedBy);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
 		for (long ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
 			TextPoint point = tier -> points.at [ipoint];
-			if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion)) {
+			if (labelCriterion. matches (point -> mark)) {
 				TextPoint following = ( ipoint >= tier -> points.size ? nullptr : tier -> points.at [ipoint + 1] );
-				if (Melder_stringMatchesCriterion (following -> mark, which_Melder_STRING_followedBy, criterion_followedBy)) {
+				if (followingLabelCriterion. matches (following ? following -> mark : nullptr)) {
 					PointProcess_addPoint (thee.get(), point -> number);
 				}
 			}
@@ -798,6 +847,76 @@ autoPointProcess TextGrid_getPoints_followed (TextGrid me, long tierNumber,
 	}
 }
 
+autoTable TextGrid_tabulateIntervalsWhere (TextGrid me, long tierNumber,
+	int which_Melder_STRING, const char32 *criterion,
+	int which_Melder_STRING_precededBy, const char32 *criterion_precededBy,
+	int which_Melder_STRING_followedBy, const char32 *criterion_followedBy,
+	long overlappingTierNumber, int which_Melder_STRING_overlapping, const char32 *criterion_overlapping)
+{
+	try {
+		if (tierNumber != 0)
+			(void) TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
+		IntervalTier overlappingTier = overlappingTierNumber == 0 ? nullptr :
+			TextGrid_checkSpecifiedTierIsIntervalTier (me, overlappingTierNumber);
+		LabelCriterion labelCriterion (which_Melder_STRING, criterion);
+		LabelCriterion precedingLabelCriterion (which_Melder_STRING_precededBy, criterion_precededBy);
+		LabelCriterion followingLabelCriterion (which_Melder_STRING_followedBy, criterion_followedBy);
+		LabelCriterion overlappingLabelCriterion (which_Melder_STRING_overlapping, criterion_overlapping);
+		std::vector <std::pair <long, long>> hits;   // tier number and interval number
+		for (long itier = 1; itier <= my tiers->size; itier ++) {
+			if (tierNumber != 0 && itier != tierNumber) continue;
+			Function anyTier = my tiers->at [itier];
+			if (anyTier -> classInfo != classIntervalTier) continue;
+			IntervalTier tier = static_cast <IntervalTier> (anyTier);
+			/*
+			 * The intervals of both tiers are sorted and do not overlap each other,
+			 * so the intervals of the overlapping tier can be visited in a single sweep along with ours.
+			 */
+			long firstCandidate = 1;
+			for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
+				TextInterval interval = tier -> intervals.at [iinterval];
+				if (! labelCriterion. matches (interval -> text)) continue;
+				TextInterval preceding = ( iinterval <= 1 ? nullptr : tier -> intervals.at [iinterval - 1] );
+				if (! precedingLabelCriterion. matches (preceding ? preceding -> text : nullptr)) continue;
+				TextInterval following = ( iinterval >= tier -> intervals.size ? nullptr : tier -> intervals.at [iinterval + 1] );
+				if (! followingLabelCriterion. matches (following ? following -> text : nullptr)) continue;
+				if (overlappingTier) {
+					while (firstCandidate <= overlappingTier -> intervals.size &&
+						overlappingTier -> intervals.at [firstCandidate] -> xmax <= interval -> xmin)
+					{
+						firstCandidate ++;
+					}
+					bool overlaps = false;
+					for (long icandidate = firstCandidate; icandidate <= overlappingTier -> intervals.size; icandidate ++) {
+						TextInterval candidate = overlappingTier -> intervals.at [icandidate];
+						if (candidate -> xmin >= interval -> xmax) break;
+						if (overlappingLabelCriterion. matches (candidate -> text)) {
+							overlaps = true;
+							break;
+						}
+					}
+					if (! overlaps) continue;
+				}
+				hits. push_back (std::make_pair (itier, iinterval));
+			}
+		}
+		autoTable thee = Table_createWithColumnNames ((long) hits.size(), U"tier interval tmin text tmax");
+		for (long irow = 1; irow <= (long) hits.size(); irow ++) {
+			long itier = hits [irow - 1]. first, iinterval = hits [irow - 1]. second;
+			IntervalTier tier = static_cast <IntervalTier> (my tiers->at [itier]);
+			TextInterval interval = tier -> intervals.at [iinterval];
+			Table_setNumericValue (thee.get(), irow, 1, itier);
+			Table_setNumericValue (thee.get(), irow, 2, iinterval);
+			Table_setNumericValue (thee.get(), irow, 3, interval -> xmin);
+			Table_setStringValue (thee.get(), irow, 4, interval -> text ? interval -> text : U"");
+			Table_setNumericValue (thee.get(), irow, 5, interval -> xmax);
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": intervals not tabulated.");
+	}
+}
+
 autoPointProcess IntervalTier_PointProcess_startToCentre (IntervalTier tier, PointProcess point, double phase) {
 	try {
 		autoPointProcess thee = PointProcess_create (tier -> xmin, tier -> xmax, 10);
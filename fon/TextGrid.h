@@ -77,6 +77,17 @@ autoPointProcess TextGrid_getPoints_preceded (TextGrid me, long tierNumber,
 autoPointProcess TextGrid_getPoints_followed (TextGrid me, long tierNumber,
 	int which_Melder_STRING, const char32 *criterion,
 	int which_Melder_STRING_followedBy, const char32 *criterion_followedBy);
+autoTable TextGrid_tabulateIntervalsWhere (TextGrid me, long tierNumber,
+	int which_Melder_STRING, const char32 *criterion,
+	int which_Melder_STRING_precededBy, const char32 *criterion_precededBy,
+	int which_Melder_STRING_followedBy, const char32 *criterion_followedBy,
+	long overlappingTierNumber, int which_Melder_STRING_overlapping, const char32 *criterion_overlapping);
+/*
+	Lists the intervals on tier `tierNumber` (0 = on all interval tiers) whose label matches the criterion,
+	whose neighbours match the preceding and following criteria (a missing neighbour counts as an empty label),
+	and that overlap an interval on tier `overlappingTierNumber` (0 = no such condition) whose label matches its criterion.
+	The columns of the resulting Table are "tier", "interval", "tmin", "text" and "tmax".
+*/
 
 Function TextGrid_checkSpecifiedTierNumberWithinRange (TextGrid me, long tierNumber);
 IntervalTier TextGrid_checkSpecifiedTierIsIntervalTier (TextGrid me, long tierNumber);
@@ -18,6 +18,7 @@
 
 #include "VoiceAnalysis.h"
 #include "AmplitudeTier.h"
+#include "MelderThread.h"
 
 double PointProcess_getJitter_local (PointProcess me, double tmin, double tmax,
 	double pmin, double pmax, double maximumPeriodFactor)
@@ -124,6 +125,72 @@ double PointProcess_getJitter_ddp (PointProcess me, double tmin, double tmax,
 	return NUMdefined (rap) ? 3.0 * rap : NUMundefined;
 }
 
+void PointProcess_getJitter_multi (PointProcess me, double tmin, double tmax,
+	double pmin, double pmax, double maximumPeriodFactor,
+	double *local, double *local_absolute, double *rap, double *ppq5, double *ddp)
+{
+	if (tmax <= tmin) tmin = my xmin, tmax = my xmax;   // autowindowing
+	long imin, imax;
+	long numberOfPeriods = PointProcess_getWindowPoints (me, tmin, tmax, & imin, & imax) - 1;
+	/*
+		One pass over the pulses, with the same sums and the same period conditions
+		as in the single-measure functions above.
+	*/
+	long numberOfPeriods_local = numberOfPeriods, numberOfPeriods_rap = numberOfPeriods, numberOfPeriods_ppq5 = numberOfPeriods;
+	double sum_local = 0.0, sum_rap = 0.0, sum_ppq5 = 0.0;
+	for (long i = imin + 1; i <= imax; i ++) {
+		if (i < imax) {
+			double p1 = my t [i] - my t [i - 1], p2 = my t [i + 1] - my t [i];
+			double intervalFactor = p1 > p2 ? p1 / p2 : p2 / p1;
+			if (pmin == pmax || (p1 >= pmin && p1 <= pmax && p2 >= pmin && p2 <= pmax && intervalFactor <= maximumPeriodFactor)) {
+				sum_local += fabs (p1 - p2);
+			} else {
+				numberOfPeriods_local --;
+			}
+		}
+		if (i >= imin + 2 && i < imax) {
+			double p1 = my t [i - 1] - my t [i - 2], p2 = my t [i] - my t [i - 1], p3 = my t [i + 1] - my t [i];
+			double intervalFactor1 = p1 > p2 ? p1 / p2 : p2 / p1, intervalFactor2 = p2 > p3 ? p2 / p3 : p3 / p2;
+			if (pmin == pmax || (p1 >= pmin && p1 <= pmax && p2 >= pmin && p2 <= pmax && p3 >= pmin && p3 <= pmax
+			    && intervalFactor1 <= maximumPeriodFactor && intervalFactor2 <= maximumPeriodFactor))
+			{
+				sum_rap += fabs (p2 - (p1 + p2 + p3) / 3.0);
+			} else {
+				numberOfPeriods_rap --;
+			}
+		}
+		if (i >= imin + 5) {
+			double
+				p1 = my t [i - 4] - my t [i - 5],
+				p2 = my t [i - 3] - my t [i - 4],
+				p3 = my t [i - 2] - my t [i - 3],
+				p4 = my t [i - 1] - my t [i - 2],
+				p5 = my t [i] - my t [i - 1];
+			double
+				f1 = p1 > p2 ? p1 / p2 : p2 / p1,
+				f2 = p2 > p3 ? p2 / p3 : p3 / p2,
+				f3 = p3 > p4 ? p3 / p4 : p4 / p3,
+				f4 = p4 > p5 ? p4 / p5 : p5 / p4;
+			if (pmin == pmax || (p1 >= pmin && p1 <= pmax && p2 >= pmin && p2 <= pmax && p3 >= pmin && p3 <= pmax &&
+				p4 >= pmin && p4 <= pmax && p5 >= pmin && p5 <= pmax &&
+				f1 <= maximumPeriodFactor && f2 <= maximumPeriodFactor && f3 <= maximumPeriodFactor && f4 <= maximumPeriodFactor))
+			{
+				sum_ppq5 += fabs (p3 - (p1 + p2 + p3 + p4 + p5) / 5.0);
+			} else {
+				numberOfPeriods_ppq5 --;
+			}
+		}
+	}
+	double meanPeriod = numberOfPeriods_local < 2 ? NUMundefined :
+		PointProcess_getMeanPeriod (me, tmin, tmax, pmin, pmax, maximumPeriodFactor);
+	double jitter_rap = numberOfPeriods_rap < 3 ? NUMundefined : sum_rap / (numberOfPeriods_rap - 2) / meanPeriod;
+	if (local) *local = numberOfPeriods_local < 2 ? NUMundefined : sum_local / (numberOfPeriods_local - 1) / meanPeriod;
+	if (local_absolute) *local_absolute = numberOfPeriods_local < 2 ? NUMundefined : sum_local / (numberOfPeriods_local - 1);
+	if (rap) *rap = jitter_rap;
+	if (ppq5) *ppq5 = numberOfPeriods_ppq5 < 5 ? NUMundefined : sum_ppq5 / (numberOfPeriods_ppq5 - 4) / meanPeriod;
+	if (ddp) *ddp = NUMdefined (jitter_rap) ? 3.0 * jitter_rap : NUMundefined;
+}
+
 double PointProcess_Sound_getShimmer_local (PointProcess me, Sound thee, double tmin, double tmax,
 	double pmin, double pmax, double maximumPeriodFactor, double maximumAmplitudeFactor)
 {
@@ -227,6 +294,32 @@ double PointProcess_Sound_getShimmer_dda (PointProcess me, Sound thee, double tm
 	}
 }
 
+/*
+	The shimmer measures from peaks that are computed only once, into the caller's times [] and peaks [],
+	which should have room for all the pulses between tmin and tmax.
+*/
+static void PointProcess_Sound_getShimmer_multi_ (PointProcess me, Sound thee, double tmin, double tmax,
+	double pmin, double pmax, double maximumPeriodFactor, double maximumAmplitudeFactor, double times [], double peaks [],
+	double *local, double *local_dB, double *apq3, double *apq5, double *apq11, double *dda)
+{
+	long numberOfPeaks = PointProcess_Sound_getPeriodPeaks (me, thee, tmin, tmax, pmin, pmax, maximumPeriodFactor, times, peaks);
+	if (numberOfPeaks < 0) {   // too few pulses
+		if (local)    *local    = NUMundefined;
+		if (local_dB) *local_dB = NUMundefined;
+		if (apq3)     *apq3     = NUMundefined;
+		if (apq5)     *apq5     = NUMundefined;
+		if (apq11)    *apq11    = NUMundefined;
+		if (dda)      *dda      = NUMundefined;
+		return;
+	}
+	if (local)    *local    =       NUMshimmer_local    (numberOfPeaks, times, peaks, pmin, pmax, maximumAmplitudeFactor);
+	if (local_dB) *local_dB =       NUMshimmer_local_dB (numberOfPeaks, times, peaks, pmin, pmax, maximumAmplitudeFactor);
+	if (apq3)     *apq3     =       NUMshimmer_apq3     (numberOfPeaks, times, peaks, pmin, pmax, maximumAmplitudeFactor);
+	if (apq5)     *apq5     =       NUMshimmer_apq5     (numberOfPeaks, times, peaks, pmin, pmax, maximumAmplitudeFactor);
+	if (apq11)    *apq11    =       NUMshimmer_apq11    (numberOfPeaks, times, peaks, pmin, pmax, maximumAmplitudeFactor);
+	if (dda)      *dda      = 3.0 * NUMshimmer_apq3     (numberOfPeaks, times, peaks, pmin, pmax, maximumAmplitudeFactor);
+}
+
 void PointProcess_Sound_getShimmer_multi (PointProcess me, Sound thee, double tmin, double tmax,
 	double pmin, double pmax, double maximumPeriodFactor, double maximumAmplitudeFactor,
 	double *local, double *local_dB, double *apq3, double *apq5, double *apq11, double *dda)
@@ -236,25 +329,264 @@ void PointProcess_Sound_getShimmer_multi (PointProcess me, Sound thee, double tm
 			tmin = my xmin;
 			tmax = my xmax;   // autowindowing
 		}
-		autoAmplitudeTier peaks = PointProcess_Sound_to_AmplitudeTier_period (me, thee, tmin, tmax, pmin, pmax, maximumPeriodFactor);
-		if (local)    *local    =       AmplitudeTier_getShimmer_local    (peaks.get(), pmin, pmax, maximumAmplitudeFactor);
-		if (local_dB) *local_dB =       AmplitudeTier_getShimmer_local_dB (peaks.get(), pmin, pmax, maximumAmplitudeFactor);
-		if (apq3)     *apq3     =       AmplitudeTier_getShimmer_apq3     (peaks.get(), pmin, pmax, maximumAmplitudeFactor);
-		if (apq5)     *apq5     =       AmplitudeTier_getShimmer_apq5     (peaks.get(), pmin, pmax, maximumAmplitudeFactor);
-		if (apq11)    *apq11    =       AmplitudeTier_getShimmer_apq11    (peaks.get(), pmin, pmax, maximumAmplitudeFactor);
-		if (dda)      *dda      = 3.0 * AmplitudeTier_getShimmer_apq3     (peaks.get(), pmin, pmax, maximumAmplitudeFactor);
+		long numberOfPulses = PointProcess_getWindowPoints (me, tmin, tmax, nullptr, nullptr);
+		autoNUMvector <double> times (1, numberOfPulses), peaks (1, numberOfPulses);
+		PointProcess_Sound_getShimmer_multi_ (me, thee, tmin, tmax, pmin, pmax, maximumPeriodFactor, maximumAmplitudeFactor,
+			times.peek(), peaks.peek(), local, local_dB, apq3, apq5, apq11, dda);
 	} catch (MelderError) {
-		if (Melder_hasError (U"Too few pulses between ")) {
-			Melder_clearError ();
-			if (local)    *local    = NUMundefined;
-			if (local_dB) *local_dB = NUMundefined;
-			if (apq3)     *apq3     = NUMundefined;
-			if (apq5)     *apq5     = NUMundefined;
-			if (apq11)    *apq11    = NUMundefined;
-			if (dda)      *dda      = NUMundefined;
-		} else {
-			Melder_throw (me, U" & ", thee, U": shimmer measures not computed.");
+		Melder_throw (me, U" & ", thee, U": shimmer measures not computed.");
+	}
+}
+
+/*
+	The part of a voice report that comes from the Pitch.
+	Pitch_getQuantile allocates memory, so this part is computed outside the threads.
+*/
+static void VoiceReport_computePitchStatistics (VoiceReport me, Pitch pitch, double tmin, double tmax,
+	double ceiling, double silenceThreshold, double voicingThreshold)
+{
+	my medianPitch = Pitch_getQuantile (pitch, tmin, tmax, 0.50, kPitch_unit_HERTZ);
+	my meanPitch = Pitch_getMean (pitch, tmin, tmax, kPitch_unit_HERTZ);
+	my stdevPitch = Pitch_getStandardDeviation (pitch, tmin, tmax, kPitch_unit_HERTZ);
+	my minimumPitch = Pitch_getMinimum (pitch, tmin, tmax, kPitch_unit_HERTZ, 1);
+	my maximumPitch = Pitch_getMaximum (pitch, tmin, tmax, kPitch_unit_HERTZ, 1);
+	long imin, imax, n = Sampled_getWindowSamples (pitch, tmin, tmax, & imin, & imax), nunvoiced = n;
+	for (long i = imin; i <= imax; i ++) {
+		Pitch_Frame frame = & pitch -> frame [i];
+		if (frame -> intensity >= silenceThreshold) {
+			for (long icand = 1; icand <= frame -> nCandidates; icand ++) {
+				Pitch_Candidate cand = & frame -> candidate [icand];
+				if (cand -> frequency > 0.0 && cand -> frequency < ceiling && cand -> strength >= voicingThreshold) {
+					nunvoiced --;
+					break;   // next frame
+				}
+			}
+		}
+	}
+	my numberOfFrames = n;
+	my numberOfUnvoicedFrames = nunvoiced;
+	my meanAutocorrelation = Pitch_getMeanStrength (pitch, tmin, tmax, Pitch_STRENGTH_UNIT_AUTOCORRELATION);
+	my meanNoiseToHarmonicsRatio = Pitch_getMeanStrength (pitch, tmin, tmax, Pitch_STRENGTH_UNIT_NOISE_HARMONICS_RATIO);
+	my meanHarmonicsToNoiseRatio = Pitch_getMeanStrength (pitch, tmin, tmax, Pitch_STRENGTH_UNIT_HARMONICS_NOISE_DB);
+}
+
+/*
+	The part of a voice report that comes from the pulses and the sound.
+	The peak amplitudes go into times [] and peaks [], which should have room for all the pulses between tmin and tmax;
+	nothing is allocated and nothing is thrown, so that this part can be computed on several threads at once.
+*/
+static void VoiceReport_computePulseStatistics (VoiceReport me, Sound sound, PointProcess pulses, double tmin, double tmax,
+	double pmin, double pmax, double maximumPeriodFactor, double maximumAmplitudeFactor, double times [], double peaks [])
+{
+	long imin, imax;
+	my numberOfPulses = PointProcess_getWindowPoints (pulses, tmin, tmax, & imin, & imax);
+	my numberOfPeriods = PointProcess_getNumberOfPeriods (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor);
+	my meanPeriod = PointProcess_getMeanPeriod (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor);
+	my stdevPeriod = PointProcess_getStdevPeriod (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor);
+	my numberOfVoiceBreaks = 0;
+	my durationOfVoiceBreaks = 0.0;
+	if (my numberOfPulses > 1) {
+		bool previousPeriodVoiced = true;
+		for (long i = imin + 1; i < imax; i ++) {
+			double period = pulses -> t [i] - pulses -> t [i - 1];
+			if (period > pmax) {
+				my durationOfVoiceBreaks += period;
+				if (previousPeriodVoiced) {
+					my numberOfVoiceBreaks ++;
+					previousPeriodVoiced = false;
+				}
+			} else {
+				previousPeriodVoiced = true;
+			}
+		}
+	}
+	PointProcess_getJitter_multi (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor,
+		& my jitter_local, & my jitter_local_absolute, & my jitter_rap, & my jitter_ppq5, & my jitter_ddp);
+	PointProcess_Sound_getShimmer_multi_ (pulses, sound, tmin, tmax, pmin, pmax, maximumPeriodFactor, maximumAmplitudeFactor, times, peaks,
+		& my shimmer_local, & my shimmer_local_dB, & my shimmer_apq3, & my shimmer_apq5, & my shimmer_apq11, & my shimmer_dda);
+}
+
+void Sound_Pitch_PointProcess_getVoiceReport (Sound sound, Pitch pitch, PointProcess pulses, double tmin, double tmax,
+	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor, double silenceThreshold, double voicingThreshold,
+	VoiceReport report)
+{
+	try {
+		if (tmin >= tmax) tmin = sound -> xmin, tmax = sound -> xmax;
+		double pmin = 0.8 / ceiling, pmax = 1.25 / floor;
+		VoiceReport_computePitchStatistics (report, pitch, tmin, tmax, ceiling, silenceThreshold, voicingThreshold);
+		long numberOfPulses = PointProcess_getWindowPoints (pulses, tmin, tmax, nullptr, nullptr);
+		autoNUMvector <double> times (1, numberOfPulses), peaks (1, numberOfPulses);
+		VoiceReport_computePulseStatistics (report, sound, pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor, maximumAmplitudeFactor,
+			times.peek(), peaks.peek());
+	} catch (MelderError) {
+		Melder_throw (sound, U" & ", pitch, U" & ", pulses, U": voice report not computed.");
+	}
+}
+
+Thing_define (VoiceReport_Args, Thing) { public:
+	Sound *sounds;
+	PointProcess *pulses;
+	double *tmin, *tmax;
+	VoiceReport reports;
+	long firstReport, lastReport;
+	double pmin, pmax, maximumPeriodFactor, maximumAmplitudeFactor;
+	double *times, *peaks;
+};
+
+Thing_implement (VoiceReport_Args, Thing, 0);
+
+static autoVoiceReport_Args VoiceReport_Args_create (Sound *sounds, PointProcess *pulses, double *tmin, double *tmax,
+	VoiceReport reports, long firstReport, long lastReport,
+	double pmin, double pmax, double maximumPeriodFactor, double maximumAmplitudeFactor, double *times, double *peaks)
+{
+	autoVoiceReport_Args me = Thing_new (VoiceReport_Args);
+	my sounds = sounds;
+	my pulses = pulses;
+	my tmin = tmin;
+	my tmax = tmax;
+	my reports = reports;
+	my firstReport = firstReport;
+	my lastReport = lastReport;
+	my pmin = pmin;
+	my pmax = pmax;
+	my maximumPeriodFactor = maximumPeriodFactor;
+	my maximumAmplitudeFactor = maximumAmplitudeFactor;
+	my times = times;
+	my peaks = peaks;
+	return me;
+}
+
+static MelderThread_RETURN_TYPE VoiceReport_computePulseStatistics_thread (VoiceReport_Args me) {
+	for (long ireport = my firstReport; ireport <= my lastReport; ireport ++) {
+		VoiceReport_computePulseStatistics (& my reports [ireport], my sounds [ireport], my pulses [ireport],
+			my tmin [ireport], my tmax [ireport], my pmin, my pmax, my maximumPeriodFactor, my maximumAmplitudeFactor,
+			my times, my peaks);
+	}
+	MelderThread_RETURN;
+}
+
+void Sound_Pitch_PointProcess_getVoiceReports (long numberOfReports, Sound sounds [], Pitch pitches [], PointProcess pulses [],
+	double tmin [], double tmax [], double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
+	double silenceThreshold, double voicingThreshold, VoiceReport reports)
+{
+	try {
+		if (numberOfReports < 1) return;
+		double pmin = 0.8 / ceiling, pmax = 1.25 / floor;
+		for (long ireport = 1; ireport <= numberOfReports; ireport ++) {
+			if (tmin [ireport] >= tmax [ireport]) tmin [ireport] = sounds [ireport] -> xmin, tmax [ireport] = sounds [ireport] -> xmax;
+			VoiceReport_computePitchStatistics (& reports [ireport], pitches [ireport], tmin [ireport], tmax [ireport],
+				ceiling, silenceThreshold, voicingThreshold);
 		}
+
+		/*
+			The pulses and the sound are the expensive part; the reports are divided over the threads,
+			and every thread gets its own room for the peaks of its longest stretch of pulses.
+		*/
+		long numberOfReportsPerThread = 4;
+		int numberOfThreads = (numberOfReports - 1) / numberOfReportsPerThread + 1;
+		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		numberOfReportsPerThread = (numberOfReports - 1) / numberOfThreads + 1;
+
+		autoNUMvector <double> times [16], peaks [16];
+		autoVoiceReport_Args args [16];
+		long firstReport = 1, lastReport = numberOfReportsPerThread;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			if (ithread == numberOfThreads) lastReport = numberOfReports;
+			long maximumNumberOfPulses = 0;
+			for (long ireport = firstReport; ireport <= lastReport; ireport ++) {
+				long numberOfPulses = PointProcess_getWindowPoints (pulses [ireport], tmin [ireport], tmax [ireport], nullptr, nullptr);
+				if (numberOfPulses > maximumNumberOfPulses) maximumNumberOfPulses = numberOfPulses;
+			}
+			times [ithread - 1]. reset (1, maximumNumberOfPulses);
+			peaks [ithread - 1]. reset (1, maximumNumberOfPulses);
+			args [ithread - 1] = VoiceReport_Args_create (sounds, pulses, tmin, tmax, reports, firstReport, lastReport,
+				pmin, pmax, maximumPeriodFactor, maximumAmplitudeFactor, times [ithread - 1]. peek(), peaks [ithread - 1]. peek());
+			firstReport = lastReport + 1;
+			lastReport += numberOfReportsPerThread;
+		}
+		MelderThread_run (VoiceReport_computePulseStatistics_thread, args, numberOfThreads);
+	} catch (MelderError) {
+		Melder_throw (U"Voice reports not computed.");
+	}
+}
+
+autoTable Sound_Pitch_PointProcess_TextGrid_to_Table_voiceReport (Sound sound, Pitch pitch, PointProcess pulses, TextGrid grid,
+	long tierNumber, double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
+	double silenceThreshold, double voicingThreshold)
+{
+	try {
+		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (grid, tierNumber);
+		long numberOfReports = 0;
+		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
+			TextInterval interval = tier -> intervals.at [iinterval];
+			if (interval -> text && interval -> text [0] != U'\0') numberOfReports ++;
+		}
+		autoNUMvector <Sound> sounds (1, numberOfReports);
+		autoNUMvector <Pitch> pitches (1, numberOfReports);
+		autoNUMvector <PointProcess> pulseses (1, numberOfReports);
+		autoNUMvector <double> tmin (1, numberOfReports), tmax (1, numberOfReports);
+		autoNUMvector <structVoiceReport> reports (1, numberOfReports);
+		autoTable thee = Table_createWithColumnNames (numberOfReports,
+			U"tmin text tmax medianPitch meanPitch stdevPitch minimumPitch maximumPitch "
+			"numberOfPulses numberOfPeriods meanPeriod stdevPeriod fractionOfUnvoicedFrames numberOfVoiceBreaks degreeOfVoiceBreaks "
+			"jitter_local jitter_local_absolute jitter_rap jitter_ppq5 jitter_ddp "
+			"shimmer_local shimmer_local_dB shimmer_apq3 shimmer_apq5 shimmer_apq11 shimmer_dda "
+			"meanAutocorrelation meanNoiseToHarmonicsRatio meanHarmonicsToNoiseRatio");
+		long ireport = 0;
+		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
+			TextInterval interval = tier -> intervals.at [iinterval];
+			if (interval -> text && interval -> text [0] != U'\0') {
+				ireport ++;
+				sounds [ireport] = sound;
+				pitches [ireport] = pitch;
+				pulseses [ireport] = pulses;
+				tmin [ireport] = interval -> xmin;
+				tmax [ireport] = interval -> xmax;
+				Table_setNumericValue (thee.get(), ireport, 1, interval -> xmin);
+				Table_setStringValue (thee.get(), ireport, 2, interval -> text);
+				Table_setNumericValue (thee.get(), ireport, 3, interval -> xmax);
+			}
+		}
+		Sound_Pitch_PointProcess_getVoiceReports (numberOfReports, sounds.peek(), pitches.peek(), pulseses.peek(), tmin.peek(), tmax.peek(),
+			floor, ceiling, maximumPeriodFactor, maximumAmplitudeFactor, silenceThreshold, voicingThreshold, reports.peek());
+		for (ireport = 1; ireport <= numberOfReports; ireport ++) {
+			VoiceReport report = & reports [ireport];
+			double duration = tmax [ireport] - tmin [ireport];
+			long icol = 3;
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> medianPitch);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> meanPitch);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> stdevPitch);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> minimumPitch);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> maximumPitch);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> numberOfPulses);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> numberOfPeriods);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> meanPeriod);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> stdevPeriod);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> numberOfFrames <= 0 ? NUMundefined :
+				(double) report -> numberOfUnvoicedFrames / report -> numberOfFrames);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> numberOfVoiceBreaks);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> durationOfVoiceBreaks / duration);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> jitter_local);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> jitter_local_absolute);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> jitter_rap);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> jitter_ppq5);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> jitter_ddp);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> shimmer_local);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> shimmer_local_dB);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> shimmer_apq3);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> shimmer_apq5);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> shimmer_apq11);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> shimmer_dda);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> meanAutocorrelation);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> meanNoiseToHarmonicsRatio);
+			Table_setNumericValue (thee.get(), ireport, ++ icol, report -> meanHarmonicsToNoiseRatio);
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (sound, U" & ", pitch, U" & ", pulses, U" & ", grid, U": voice reports not tabulated.");
 	}
 }
 
@@ -263,6 +595,9 @@ void Sound_Pitch_PointProcess_voiceReport (Sound sound, Pitch pitch, PointProces
 {
 	try {
 		if (tmin >= tmax) tmin = sound -> xmin, tmax = sound -> xmax;
+		structVoiceReport report;
+		Sound_Pitch_PointProcess_getVoiceReport (sound, pitch, pulses, tmin, tmax, floor, ceiling,
+			maximumPeriodFactor, maximumAmplitudeFactor, silenceThreshold, voicingThreshold, & report);
 		/*
 		 * Time domain. Should be preceded by something like "Time range of SELECTION:" or so.
 		 */
@@ -272,89 +607,55 @@ void Sound_Pitch_PointProcess_voiceReport (Sound sound, Pitch pitch, PointProces
 		 * Pitch statistics.
 		 */
 		MelderInfo_writeLine (U"Pitch:");
-		MelderInfo_writeLine (U"   Median pitch: ", Melder_fixed (Pitch_getQuantile (pitch, tmin, tmax, 0.50, kPitch_unit_HERTZ), 3), U" Hz");
-		MelderInfo_writeLine (U"   Mean pitch: ", Melder_fixed (Pitch_getMean (pitch, tmin, tmax, kPitch_unit_HERTZ), 3), U" Hz");
-		MelderInfo_writeLine (U"   Standard deviation: ", Melder_fixed (Pitch_getStandardDeviation (pitch, tmin, tmax, kPitch_unit_HERTZ), 3), U" Hz");
-		MelderInfo_writeLine (U"   Minimum pitch: ", Melder_fixed (Pitch_getMinimum (pitch, tmin, tmax, kPitch_unit_HERTZ, 1), 3), U" Hz");
-		MelderInfo_writeLine (U"   Maximum pitch: ", Melder_fixed (Pitch_getMaximum (pitch, tmin, tmax, kPitch_unit_HERTZ, 1), 3), U" Hz");
+		MelderInfo_writeLine (U"   Median pitch: ", Melder_fixed (report. medianPitch, 3), U" Hz");
+		MelderInfo_writeLine (U"   Mean pitch: ", Melder_fixed (report. meanPitch, 3), U" Hz");
+		MelderInfo_writeLine (U"   Standard deviation: ", Melder_fixed (report. stdevPitch, 3), U" Hz");
+		MelderInfo_writeLine (U"   Minimum pitch: ", Melder_fixed (report. minimumPitch, 3), U" Hz");
+		MelderInfo_writeLine (U"   Maximum pitch: ", Melder_fixed (report. maximumPitch, 3), U" Hz");
 		/*
 		 * Pulses statistics.
 		 */
-		double pmin = 0.8 / ceiling, pmax = 1.25 / floor;
 		MelderInfo_writeLine (U"Pulses:");
-		MelderInfo_writeLine (U"   Number of pulses: ", PointProcess_getWindowPoints (pulses, tmin, tmax, nullptr, nullptr));
-		MelderInfo_writeLine (U"   Number of periods: ", PointProcess_getNumberOfPeriods (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor));
-		MelderInfo_writeLine (U"   Mean period: ", Melder_fixedExponent (PointProcess_getMeanPeriod (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), -3, 6), U" seconds");
-		MelderInfo_writeLine (U"   Standard deviation of period: ", Melder_fixedExponent (PointProcess_getStdevPeriod (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), -3, 6), U" seconds");
+		MelderInfo_writeLine (U"   Number of pulses: ", report. numberOfPulses);
+		MelderInfo_writeLine (U"   Number of periods: ", report. numberOfPeriods);
+		MelderInfo_writeLine (U"   Mean period: ", Melder_fixedExponent (report. meanPeriod, -3, 6), U" seconds");
+		MelderInfo_writeLine (U"   Standard deviation of period: ", Melder_fixedExponent (report. stdevPeriod, -3, 6), U" seconds");
 		/*
 		 * Voicing.
 		 */
-		long imin, imax, n = Sampled_getWindowSamples (pitch, tmin, tmax, & imin, & imax), nunvoiced = n;
-		for (long i = imin; i <= imax; i ++) {
-			Pitch_Frame frame = & pitch -> frame [i];
-			if (frame -> intensity >= silenceThreshold) {
-				for (long icand = 1; icand <= frame -> nCandidates; icand ++) {
-					Pitch_Candidate cand = & frame -> candidate [icand];
-					if (cand -> frequency > 0.0 && cand -> frequency < ceiling && cand -> strength >= voicingThreshold) {
-						nunvoiced --;
-						break;   // next frame
-					}
-				}
-			}
-		}
 		MelderInfo_writeLine (U"Voicing:");
-		MelderInfo_write (U"   Fraction of locally unvoiced frames: ", Melder_percent (n <= 0 ? NUMundefined : (double) nunvoiced / n, 3));
-		MelderInfo_writeLine (U"   (", nunvoiced, U" / ", n, U")");
-		n = PointProcess_getWindowPoints (pulses, tmin, tmax, & imin, & imax);
-		long numberOfVoiceBreaks = 0;
-		double durationOfVoiceBreaks = 0.0;
-		if (n > 1) {
-			bool previousPeriodVoiced = true;
-			for (long i = imin + 1; i < imax; i ++) {
-				double period = pulses -> t [i] - pulses -> t [i - 1];
-				if (period > pmax) {
-					durationOfVoiceBreaks += period;
-					if (previousPeriodVoiced) {
-						numberOfVoiceBreaks ++;
-						previousPeriodVoiced = false;
-					}
-				} else {
-					previousPeriodVoiced = true;
-				}
-			}
-		}
-		MelderInfo_writeLine (U"   Number of voice breaks: ", numberOfVoiceBreaks);
-		MelderInfo_write (U"   Degree of voice breaks: ", Melder_percent (durationOfVoiceBreaks / (tmax - tmin), 3));
-		MelderInfo_writeLine (U"   (", Melder_fixed (durationOfVoiceBreaks, 6), U" seconds / ", Melder_fixed (tmax - tmin, 6), U" seconds)");
+		MelderInfo_write (U"   Fraction of locally unvoiced frames: ", Melder_percent (report. numberOfFrames <= 0 ? NUMundefined :
+			(double) report. numberOfUnvoicedFrames / report. numberOfFrames, 3));
+		MelderInfo_writeLine (U"   (", report. numberOfUnvoicedFrames, U" / ", report. numberOfFrames, U")");
+		MelderInfo_writeLine (U"   Number of voice breaks: ", report. numberOfVoiceBreaks);
+		MelderInfo_write (U"   Degree of voice breaks: ", Melder_percent (report. durationOfVoiceBreaks / (tmax - tmin), 3));
+		MelderInfo_writeLine (U"   (", Melder_fixed (report. durationOfVoiceBreaks, 6), U" seconds / ", Melder_fixed (tmax - tmin, 6), U" seconds)");
 		/*
 		 * Jitter.
 		 */
-		double shimmerLocal, shimmerLocal_dB, apq3, apq5, apq11, dda;
 		MelderInfo_writeLine (U"Jitter:");
-		MelderInfo_writeLine (U"   Jitter (local): ", Melder_percent (PointProcess_getJitter_local (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), 3));
-		MelderInfo_writeLine (U"   Jitter (local, absolute): ", Melder_fixedExponent (PointProcess_getJitter_local_absolute (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), -6, 3), U" seconds");
-		MelderInfo_writeLine (U"   Jitter (rap): ", Melder_percent (PointProcess_getJitter_rap (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), 3));
-		MelderInfo_writeLine (U"   Jitter (ppq5): ", Melder_percent (PointProcess_getJitter_ppq5 (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), 3));
-		MelderInfo_writeLine (U"   Jitter (ddp): ", Melder_percent (PointProcess_getJitter_ddp (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), 3));
+		MelderInfo_writeLine (U"   Jitter (local): ", Melder_percent (report. jitter_local, 3));
+		MelderInfo_writeLine (U"   Jitter (local, absolute): ", Melder_fixedExponent (report. jitter_local_absolute, -6, 3), U" seconds");
+		MelderInfo_writeLine (U"   Jitter (rap): ", Melder_percent (report. jitter_rap, 3));
+		MelderInfo_writeLine (U"   Jitter (ppq5): ", Melder_percent (report. jitter_ppq5, 3));
+		MelderInfo_writeLine (U"   Jitter (ddp): ", Melder_percent (report. jitter_ddp, 3));
 		/*
 		 * Shimmer.
 		 */
-		PointProcess_Sound_getShimmer_multi (pulses, sound, tmin, tmax, pmin, pmax, maximumPeriodFactor, maximumAmplitudeFactor,
-			& shimmerLocal, & shimmerLocal_dB, & apq3, & apq5, & apq11, & dda);
 		MelderInfo_writeLine (U"Shimmer:");
-		MelderInfo_writeLine (U"   Shimmer (local): ", Melder_percent (shimmerLocal, 3));
-		MelderInfo_writeLine (U"   Shimmer (local, dB): ", Melder_fixed (shimmerLocal_dB, 3), U" dB");
-		MelderInfo_writeLine (U"   Shimmer (apq3): ", Melder_percent (apq3, 3));
-		MelderInfo_writeLine (U"   Shimmer (apq5): ", Melder_percent (apq5, 3));
-		MelderInfo_writeLine (U"   Shimmer (apq11): ", Melder_percent (apq11, 3));
-		MelderInfo_writeLine (U"   Shimmer (dda): ", Melder_percent (dda, 3));
+		MelderInfo_writeLine (U"   Shimmer (local): ", Melder_percent (report. shimmer_local, 3));
+		MelderInfo_writeLine (U"   Shimmer (local, dB): ", Melder_fixed (report. shimmer_local_dB, 3), U" dB");
+		MelderInfo_writeLine (U"   Shimmer (apq3): ", Melder_percent (report. shimmer_apq3, 3));
+		MelderInfo_writeLine (U"   Shimmer (apq5): ", Melder_percent (report. shimmer_apq5, 3));
+		MelderInfo_writeLine (U"   Shimmer (apq11): ", Melder_percent (report. shimmer_apq11, 3));
+		MelderInfo_writeLine (U"   Shimmer (dda): ", Melder_percent (report. shimmer_dda, 3));
 		/*
 		 * Harmonicity.
 		 */
 		MelderInfo_writeLine (U"Harmonicity of the voiced parts only:");
-		MelderInfo_writeLine (U"   Mean autocorrelation: ", Melder_fixed (Pitch_getMeanStrength (pitch, tmin, tmax, Pitch_STRENGTH_UNIT_AUTOCORRELATION), 6));
-		MelderInfo_writeLine (U"   Mean noise-to-harmonics ratio: ", Melder_fixed (Pitch_getMeanStrength (pitch, tmin, tmax, Pitch_STRENGTH_UNIT_NOISE_HARMONICS_RATIO), 6));
-		MelderInfo_writeLine (U"   Mean harmonics-to-noise ratio: ", Melder_fixed (Pitch_getMeanStrength (pitch, tmin, tmax, Pitch_STRENGTH_UNIT_HARMONICS_NOISE_DB), 3), U" dB");
+		MelderInfo_writeLine (U"   Mean autocorrelation: ", Melder_fixed (report. meanAutocorrelation, 6));
+		MelderInfo_writeLine (U"   Mean noise-to-harmonics ratio: ", Melder_fixed (report. meanNoiseToHarmonicsRatio, 6));
+		MelderInfo_writeLine (U"   Mean harmonics-to-noise ratio: ", Melder_fixed (report. meanHarmonicsToNoiseRatio, 3), U" dB");
 	} catch (MelderError) {
 		Melder_throw (sound, U" & ", pitch, U" & ", pulses, U": voice report not computed.");
 	}
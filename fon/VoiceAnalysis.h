@@ -19,6 +19,8 @@
 #include "Sound.h"
 #include "PointProcess.h"
 #include "Pitch.h"
+#include "TextGrid.h"
+#include "Table.h"
 
 double PointProcess_getJitter_local (PointProcess me, double tmin, double tmax,
 	double minimumPeriod, double maximumPeriod, double maximumPeriodFactor);
@@ -30,6 +32,9 @@ double PointProcess_getJitter_ppq5 (PointProcess me, double tmin, double tmax,
 	double minimumPeriod, double maximumPeriod, double maximumPeriodFactor);
 double PointProcess_getJitter_ddp (PointProcess me, double tmin, double tmax,
 	double minimumPeriod, double maximumPeriod, double maximumPeriodFactor);
+void PointProcess_getJitter_multi (PointProcess me, double tmin, double tmax,
+	double minimumPeriod, double maximumPeriod, double maximumPeriodFactor,
+	double *local, double *local_absolute, double *rap, double *ppq5, double *ddp);
 
 double PointProcess_Sound_getShimmer_local (PointProcess me, Sound thee, double tmin, double tmax,
 	double minimumPeriod, double maximumPeriod, double maximumPeriodFactor, double maximumAmplitudeFactor);
@@ -47,6 +52,40 @@ void PointProcess_Sound_getShimmer_multi (PointProcess me, Sound thee, double tm
 	double minimumPeriod, double maximumPeriod, double maximumPeriodFactor, double maximumAmplitudeFactor,
 	double *local, double *local_dB, double *apq3, double *apq5, double *apq11, double *dda);
 
+typedef struct structVoiceReport *VoiceReport;
+struct structVoiceReport {
+	double medianPitch, meanPitch, stdevPitch, minimumPitch, maximumPitch;   // Hz
+	long numberOfPulses, numberOfPeriods;
+	double meanPeriod, stdevPeriod;   // seconds
+	long numberOfFrames, numberOfUnvoicedFrames;
+	long numberOfVoiceBreaks;
+	double durationOfVoiceBreaks;   // seconds
+	double jitter_local, jitter_local_absolute, jitter_rap, jitter_ppq5, jitter_ddp;
+	double shimmer_local, shimmer_local_dB, shimmer_apq3, shimmer_apq5, shimmer_apq11, shimmer_dda;
+	double meanAutocorrelation, meanNoiseToHarmonicsRatio, meanHarmonicsToNoiseRatio;
+};
+
+void Sound_Pitch_PointProcess_getVoiceReport (Sound sound, Pitch pitch, PointProcess pulses,
+	double tmin, double tmax,
+	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
+	double silenceThreshold, double voicingThreshold, VoiceReport report);
+
+void Sound_Pitch_PointProcess_getVoiceReports (long numberOfReports, Sound sounds [], Pitch pitches [], PointProcess pulses [],
+	double tmin [], double tmax [],
+	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
+	double silenceThreshold, double voicingThreshold, VoiceReport reports);
+/*
+	Computes reports [i] for sounds [i], pitches [i] and pulses [i] between tmin [i] and tmax [i],
+	for i = 1..numberOfReports, divided over several threads;
+	where tmin [i] >= tmax [i], they are replaced with the time domain of sounds [i].
+	The same objects may occur in several reports, e.g. for the intervals of a TextGrid.
+*/
+
+autoTable Sound_Pitch_PointProcess_TextGrid_to_Table_voiceReport (Sound sound, Pitch pitch, PointProcess pulses, TextGrid grid,
+	long tierNumber,
+	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
+	double silenceThreshold, double voicingThreshold);
+
 void Sound_Pitch_PointProcess_voiceReport (Sound sound, Pitch pitch, PointProcess pulses,
 	double tmin, double tmax,
 	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
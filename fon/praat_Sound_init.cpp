@@ -383,6 +383,12 @@ FORM_WRITE2 (LongSound_Sound_writeToWavFile, U"Save as WAV file", nullptr, U"wav
 	LongSound_concatenate (list.get(), file, Melder_WAV, 16);
 END2 }
 
+FORM_WRITE2 (LongSound_Sound_filterToWavFile, U"Save filtered as WAV file", nullptr, U"wav") {
+	LongSound me = FIRST (LongSound);
+	Sound impulseResponse = FIRST (Sound);
+	LongSound_filterToAudioFile (me, impulseResponse, file, Melder_WAV, 16);
+END2 }
+
 /********** SOUND **********/
 
 FORM (Sound_add, U"Sound: Add", nullptr) {
@@ -631,6 +637,22 @@ DO
 	praat_new (me.move(), GET_STRING (U"Name"));
 END2 }
 
+FORM (Sound_createAsHannBandFilter, U"Create Sound as Hann band filter", nullptr) {
+	WORD (U"Name", U"filter")
+	POSITIVE (U"Sampling frequency (Hz)", U"44100.0")
+	REAL (U"From frequency (Hz)", U"500.0")
+	REAL (U"To frequency (Hz)", U"1000.0")
+	POSITIVE (U"Smoothing (Hz)", U"100.0")
+	RADIO (U"Band", 1)
+		RADIOBUTTON (U"Pass")
+		RADIOBUTTON (U"Stop")
+	OK2
+DO
+	autoSound me = Sound_createHannBandFilter (GET_REAL (U"Sampling frequency"), GET_REAL (U"From frequency"),
+		GET_REAL (U"To frequency"), GET_REAL (U"Smoothing"), GET_INTEGER (U"Band") == 2);
+	praat_new (me.move(), GET_STRING (U"Name"));
+END2 }
+
 FORM (Sound_createFromToneComplex, U"Create Sound from tone complex", U"Create Sound from tone complex...") {
 	WORD (U"Name", U"toneComplex")
 	REAL (U"Start time (s)", U"0.0")
@@ -2456,6 +2478,7 @@ void praat_uvafon_Sound_init () {
 		praat_addMenuCommand (U"Objects", U"New", U"-- create sound advanced --", nullptr, 1, nullptr);
 		praat_addMenuCommand (U"Objects", U"New", U"Create Sound as tone complex...", nullptr, 1, DO_Sound_createFromToneComplex);
 		praat_addMenuCommand (U"Objects", U"New", U"Create Sound from tone complex...", nullptr, praat_HIDDEN + praat_DEPTH_1, DO_Sound_createFromToneComplex);
+		praat_addMenuCommand (U"Objects", U"New", U"Create Sound as Hann band filter...", nullptr, 1, DO_Sound_createAsHannBandFilter);
 
 	praat_addMenuCommand (U"Objects", U"Open", U"-- read sound --", nullptr, 0, nullptr);
 	praat_addMenuCommand (U"Objects", U"Open", U"Open long sound file...", nullptr, 'L', DO_LongSound_open);
@@ -2721,6 +2744,7 @@ void praat_uvafon_Sound_init () {
 		praat_addAction1 (classSound, 2, U"Cross-correlate...", nullptr, 1, DO_Sounds_crossCorrelate);
 		praat_addAction1 (classSound, 2, U"To ParamCurve", nullptr, 1, DO_Sounds_to_ParamCurve);
 
+	praat_addAction2 (classLongSound, 1, classSound, 1, U"Save filtered as WAV file...", nullptr, 0, DO_LongSound_Sound_filterToWavFile);
 	praat_addAction2 (classLongSound, 0, classSound, 0, U"Save as WAV file...", nullptr, 0, DO_LongSound_Sound_writeToWavFile);
 	praat_addAction2 (classLongSound, 0, classSound, 0, U"Write to WAV file...", nullptr, praat_HIDDEN, DO_LongSound_Sound_writeToWavFile);
 	praat_addAction2 (classLongSound, 0, classSound, 0, U"Save as AIFF file...", nullptr, 0, DO_LongSound_Sound_writeToAiffFile);
@@ -1425,6 +1425,32 @@ DO
 	}
 END2 }
 
+FORM (TextGrid_tabulateIntervalsWhere, U"TextGrid: Tabulate intervals where", nullptr) {
+	INTEGER (U"Tier number (0 = all)", U"1")
+	OPTIONMENU_ENUM (U"Get intervals whose label", kMelder_string, DEFAULT)
+	SENTENCE (U"...the text", U"a")
+	OPTIONMENU_ENUM (U"preceded by a label that", kMelder_string, CONTAINS)
+	SENTENCE (U"...the preceding text", U"")
+	OPTIONMENU_ENUM (U"followed by a label that", kMelder_string, CONTAINS)
+	SENTENCE (U"...the following text", U"")
+	INTEGER (U"Overlapping tier (0 = none)", U"0")
+	OPTIONMENU_ENUM (U"overlapping a label that", kMelder_string, CONTAINS)
+	SENTENCE (U"...the overlapping text", U"")
+	OK2
+DO
+	const char32 *text = GET_STRING (U"...the text");
+	LOOP {
+		iam (TextGrid);
+		autoTable thee = TextGrid_tabulateIntervalsWhere (me, GET_INTEGER (U"Tier number"),
+			GET_ENUM (kMelder_string, U"Get intervals whose label"), text,
+			GET_ENUM (kMelder_string, U"preceded by a label that"), GET_STRING (U"...the preceding text"),
+			GET_ENUM (kMelder_string, U"followed by a label that"), GET_STRING (U"...the following text"),
+			GET_INTEGER (U"Overlapping tier"),
+			GET_ENUM (kMelder_string, U"overlapping a label that"), GET_STRING (U"...the overlapping text"));
+		praat_new (thee.move(), my name, U"_", text);
+	}
+END2 }
+
 FORM (TextGrid_removeLeftBoundary, U"TextGrid: Remove left boundary", nullptr) {
 	NATURAL (STRING_TIER_NUMBER, U"1")
 	NATURAL (STRING_INTERVAL_NUMBER, U"2")
@@ -1819,6 +1845,7 @@ praat_addAction1 (classTextGrid, 0, U"Analyse", nullptr, 0, nullptr);
 		praat_addAction1 (classTextGrid, 1, U"Get starting points...", nullptr, 1, DO_TextGrid_getStartingPoints);
 		praat_addAction1 (classTextGrid, 1, U"Get end points...", nullptr, 1, DO_TextGrid_getEndPoints);
 		praat_addAction1 (classTextGrid, 1, U"Get centre points...", nullptr, 1, DO_TextGrid_getCentrePoints);
+		praat_addAction1 (classTextGrid, 1, U"Tabulate intervals where...", nullptr, 1, DO_TextGrid_tabulateIntervalsWhere);
 	praat_addAction1 (classTextGrid, 1, U"Analyse point tier -", nullptr, 0, nullptr);
 		praat_addAction1 (classTextGrid, 1, U"Get points...", nullptr, 1, DO_TextGrid_getPoints);
 		praat_addAction1 (classTextGrid, 1, U"Get points (preceded)...", nullptr, 1, DO_TextGrid_getPoints_preceded);
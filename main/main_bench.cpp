@@ -0,0 +1,380 @@
+/* main_bench.cpp
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+	A benchmark of the core analyses, to be run from the command line ("make bench"):
+
+		praat_bench [--runs N] [--sound FILE] [--baseline FILE] [--tolerance FRACTION] [--output FILE]
+
+	Every workload is run N times (default 5) on the same input; the fastest run counts.
+	The input is a synthetic vowel-like Sound of 20 seconds (the same on every computer),
+	or the recording in FILE if --sound is given.
+	The results go to stdout as a tab-separated table, with for every workload the number of samples (or rows or queries)
+	handled per second, the number of Melder allocations and bytes allocated in one run,
+	and the peak memory use of the process so far (which includes the workloads before it).
+	--output writes the same table to a file, which can serve as the --baseline of a later run
+	on the same computer ("make bench-baseline" writes bench_baseline.txt, which "make bench" then uses);
+	the ratio to the baseline throughput is then added, and the exit status is 1
+	if any workload is slower than its baseline by more than the tolerance (default 0.25).
+
+	The allocation columns are approximate. Melder_allocationCount () and Melder_allocationSize ()
+	read plain static counters (totalNumberOfAllocations and totalAllocationSize in melder_alloc.cpp),
+	which are not atomic, so allocations on the worker threads of the threaded analyses
+	(Sound_to_Pitch and Sound_to_Formant_burg) can get lost.
+*/
+
+#include "../sys/praat.h"
+#include "../fon/Sound_to_Pitch.h"
+#include "../fon/Sound_to_Formant.h"
+#include "../fon/Sound_and_Spectrogram.h"
+#include "../fon/TextGrid.h"
+#include "../dwtools/Sound_to_MFCC.h"
+#include "../stat/Table.h"
+
+#if defined (UNIX) || defined (macintosh)
+	#include <sys/resource.h>
+#endif
+
+static struct {
+	autoSound sound;
+	autoTextGrid textGrid;
+	autoTable table;
+	structMelderFile binaryFile, textFile;
+} theBench;
+
+static long bench_Sound_to_Pitch () {
+	autoPitch pitch = Sound_to_Pitch (theBench.sound.get(), 0.0, 75.0, 600.0);
+	return theBench.sound -> nx;
+}
+
+static long bench_Sound_to_Formant_burg () {
+	autoFormant formant = Sound_to_Formant_burg (theBench.sound.get(), 0.0, 5.0, 5500.0, 0.025, 50.0);
+	return theBench.sound -> nx;
+}
+
+static long bench_Sound_to_Spectrogram () {
+	autoSpectrogram spectrogram = Sound_to_Spectrogram (theBench.sound.get(), 0.005, 5000.0, 0.002, 20.0,
+		kSound_to_Spectrogram_windowShape_GAUSSIAN, 8.0, 8.0);
+	return theBench.sound -> nx;
+}
+
+static long bench_Sound_to_MFCC () {
+	autoMFCC mfcc = Sound_to_MFCC (theBench.sound.get(), 12, 0.015, 0.005, 100.0, 0.0, 100.0);
+	return theBench.sound -> nx;
+}
+
+static long bench_Sound_resample () {
+	autoSound resampled = Sound_resample (theBench.sound.get(), 16000.0, 50);
+	return theBench.sound -> nx;
+}
+
+static long bench_Sounds_convolve_shortKernel () {
+	autoSound kernel = Sound_extractPart (theBench.sound.get(), 0.0, 0.1, kSound_windowShape_HANNING, 1.0, false);
+	autoSound convolved = Sounds_convolve (theBench.sound.get(), kernel.get(),
+		kSounds_convolve_scaling_SUM, kSounds_convolve_signalOutsideTimeDomain_ZERO);
+	return theBench.sound -> nx;
+}
+
+static long bench_Sounds_convolve_longKernel () {
+	/*
+		The kernel is as long as the signal, which is the case in which a single transform beats the blocks.
+	*/
+	autoSound convolved = Sounds_convolve (theBench.sound.get(), theBench.sound.get(),
+		kSounds_convolve_scaling_SUM, kSounds_convolve_signalOutsideTimeDomain_ZERO);
+	return theBench.sound -> nx;
+}
+
+static long bench_Matrix_formula () {
+	autoSound copy = Data_copy (theBench.sound.get());
+	Matrix_formula (copy.get(), U"self * (1 + 0.5 * sin (2 * pi * 3 * x))", nullptr, nullptr);
+	return copy -> nx;
+}
+
+static long bench_Sound_writeBinary () {
+	Data_writeToBinaryFile (theBench.sound.get(), & theBench.binaryFile);
+	return theBench.sound -> nx;
+}
+
+static long bench_Sound_readBinary () {
+	autoDaata sound = Data_readFromBinaryFile (& theBench.binaryFile);
+	return static_cast <Sound> (sound.get()) -> nx;
+}
+
+static long TextGrid_numberOfElements (TextGrid me) {
+	long numberOfElements = 0;
+	for (long itier = 1; itier <= my tiers -> size; itier ++) {
+		Function anyTier = my tiers -> at [itier];
+		numberOfElements += anyTier -> classInfo == classIntervalTier ?
+			static_cast <IntervalTier> (anyTier) -> intervals.size : static_cast <TextTier> (anyTier) -> points.size;
+	}
+	return numberOfElements;
+}
+
+static long bench_TextGrid_writeText () {
+	Data_writeToTextFile (theBench.textGrid.get(), & theBench.textFile);
+	return TextGrid_numberOfElements (theBench.textGrid.get());
+}
+
+static long bench_TextGrid_readText () {
+	autoDaata textGrid = Data_readFromTextFile (& theBench.textFile);
+	return TextGrid_numberOfElements (static_cast <TextGrid> (textGrid.get()));
+}
+
+static long bench_TextGrid_queries () {
+	IntervalTier words = TextGrid_checkSpecifiedTierIsIntervalTier (theBench.textGrid.get(), 1);
+	const long numberOfQueries = 2000000;
+	const double duration = theBench.textGrid -> xmax - theBench.textGrid -> xmin;
+	long numberOfHits = 0;
+	for (long iquery = 1; iquery <= numberOfQueries; iquery ++) {
+		double time = theBench.textGrid -> xmin + duration * (iquery - 0.5) / numberOfQueries;
+		long iinterval = IntervalTier_timeToLowIndex (words, time);
+		if (iinterval > 0 && str32equ (words -> intervals.at [iinterval] -> text, U"a"))
+			numberOfHits ++;
+	}
+	for (long iquery = 1; iquery <= 100; iquery ++)
+		numberOfHits += TextGrid_countLabels (theBench.textGrid.get(), 1, U"i");
+	Melder_assert (numberOfHits > 0);
+	return numberOfQueries + 100 * TextGrid_numberOfElements (theBench.textGrid.get());
+}
+
+static long bench_Table_queries () {
+	Table table = theBench.table.get();
+	const long numberOfRounds = 20;
+	for (long iround = 1; iround <= numberOfRounds; iround ++) {
+		double mean = Table_getMean (table, 3);
+		double median = Table_getQuantile (table, 4, 0.5);
+		Melder_assert (NUMdefined (mean) && NUMdefined (median));
+		for (long ispeaker = 1; ispeaker <= 10; ispeaker ++)
+			Melder_assert (Table_searchColumn (table, 1, Melder_cat (U"s", 40 + ispeaker)) > 0);
+	}
+	return numberOfRounds * table -> rows.size;
+}
+
+static struct {
+	const char32 *name, *unit;
+	long (*run) ();
+} theWorkloads [] = {
+	{ U"Sound_to_Pitch", U"samples", bench_Sound_to_Pitch },
+	{ U"Sound_to_Formant_burg", U"samples", bench_Sound_to_Formant_burg },
+	{ U"Sound_to_Spectrogram", U"samples", bench_Sound_to_Spectrogram },
+	{ U"Sound_to_MFCC", U"samples", bench_Sound_to_MFCC },
+	{ U"Sound_resample", U"samples", bench_Sound_resample },
+	{ U"Sounds_convolve_shortKernel", U"samples", bench_Sounds_convolve_shortKernel },
+	{ U"Sounds_convolve_longKernel", U"samples", bench_Sounds_convolve_longKernel },
+	{ U"Matrix_formula", U"samples", bench_Matrix_formula },
+	{ U"Sound_writeBinary", U"samples", bench_Sound_writeBinary },
+	{ U"Sound_readBinary", U"samples", bench_Sound_readBinary },   // reads what Sound_writeBinary wrote
+	{ U"TextGrid_writeText", U"elements", bench_TextGrid_writeText },
+	{ U"TextGrid_readText", U"elements", bench_TextGrid_readText },   // reads what TextGrid_writeText wrote
+	{ U"TextGrid_queries", U"queries", bench_TextGrid_queries },
+	{ U"Table_queries", U"rows", bench_Table_queries }
+};
+
+static autoSound Sound_createBenchVowels (double duration, double samplingFrequency) {
+	/*
+		Half-second vowels with a vibrato, separated by a tenth of a second of soft noise.
+	*/
+	autoSound me = Sound_createSimple (1, duration, samplingFrequency);
+	double phase = 0.0;
+	for (long isamp = 1; isamp <= my nx; isamp ++) {
+		double time = Sampled_indexToX (me.get(), isamp);
+		double f0 = 120.0 + 20.0 * sin (2.0 * NUMpi * 5.0 * time) + 30.0 * sin (2.0 * NUMpi * 0.3 * time);
+		phase += 2.0 * NUMpi * f0 * my dx;
+		double value = 0.001 * NUMrandomGauss (0.0, 1.0);
+		if (fmod (time, 0.6) < 0.5) {
+			for (int iharmonic = 1; iharmonic <= 12; iharmonic ++)
+				value += 0.3 * sin (iharmonic * phase) / iharmonic;
+		} else {
+			value += 0.03 * NUMrandomGauss (0.0, 1.0);
+		}
+		my z [1] [isamp] = value;
+	}
+	return me;
+}
+
+static autoTextGrid TextGrid_createBenchWords (double tmin, double tmax) {
+	static const char32 *labels [] = { U"a", U"i", U"u", U"", U"pa", U"ta", U"ka" };
+	autoTextGrid me = TextGrid_create (tmin, tmax, U"words events", U"events");
+	long numberOfIntervals = (long) floor ((tmax - tmin) / 0.002);
+	for (long iinterval = 1; iinterval < numberOfIntervals; iinterval ++)
+		TextGrid_insertBoundary (me.get(), 1, tmin + iinterval * 0.002);
+	for (long iinterval = 1; iinterval <= numberOfIntervals; iinterval ++)
+		TextGrid_setIntervalText (me.get(), 1, iinterval, labels [(iinterval - 1) % 7]);
+	TextTier events = TextGrid_checkSpecifiedTierIsPointTier (me.get(), 2);
+	for (double time = tmin + 0.005; time < tmax; time += 0.01)
+		TextTier_addPoint (events, time, U"click");
+	return me;
+}
+
+static autoTable Table_createBenchFormants (long numberOfRows) {
+	static const char32 *vowels [] = { U"a", U"e", U"i", U"o", U"u" };
+	autoTable me = Table_createWithColumnNames (numberOfRows, U"speaker vowel F1 F2");
+	for (long irow = 1; irow <= numberOfRows; irow ++) {
+		Table_setStringValue (me.get(), irow, 1, Melder_cat (U"s", 1 + (irow - 1) % 50));
+		Table_setStringValue (me.get(), irow, 2, vowels [(irow - 1) % 5]);
+		Table_setNumericValue (me.get(), irow, 3, NUMrandomGauss (500.0, 150.0));
+		Table_setNumericValue (me.get(), irow, 4, NUMrandomGauss (1500.0, 400.0));
+	}
+	return me;
+}
+
+static double bench_peakMemory_kB () {
+	#if defined (UNIX) || defined (macintosh)
+		struct rusage usage;
+		if (getrusage (RUSAGE_SELF, & usage) != 0)
+			return NUMundefined;
+		#if defined (macintosh)
+			return usage. ru_maxrss / 1024.0;   // in bytes
+		#else
+			return usage. ru_maxrss;   // in kilobytes
+		#endif
+	#else
+		return NUMundefined;
+	#endif
+}
+
+int main (int argc, char *argv []) {
+	try {
+		praatlib_init ();
+		Thing_recognizeClassesByName (classSound, classTextGrid, classIntervalTier, classTextTier,
+			classTextInterval, classTextPoint, nullptr);
+		long numberOfRuns = 5;
+		double tolerance = 0.25;
+		const char *soundFileName = nullptr, *baselineFileName = nullptr, *outputFileName = nullptr;
+		for (int iarg = 1; iarg < argc; iarg ++) {
+			if (iarg + 1 < argc && strequ (argv [iarg], "--runs")) {
+				numberOfRuns = atol (argv [++ iarg]);
+			} else if (iarg + 1 < argc && strequ (argv [iarg], "--tolerance")) {
+				tolerance = atof (argv [++ iarg]);
+			} else if (iarg + 1 < argc && strequ (argv [iarg], "--sound")) {
+				soundFileName = argv [++ iarg];
+			} else if (iarg + 1 < argc && strequ (argv [iarg], "--baseline")) {
+				baselineFileName = argv [++ iarg];
+			} else if (iarg + 1 < argc && strequ (argv [iarg], "--output")) {
+				outputFileName = argv [++ iarg];
+			} else {
+				Melder_throw (U"Usage: praat_bench [--runs N] [--sound FILE] [--baseline FILE] [--tolerance FRACTION] [--output FILE]");
+			}
+		}
+		if (numberOfRuns < 1)
+			Melder_throw (U"The number of runs should be at least 1.");
+
+		/*
+			The inputs, and the files that the reading workloads read.
+		*/
+		NUMrandom_initWithSeed (2016);
+		if (soundFileName) {
+			structMelderFile soundFile { 0 };
+			Melder_pathToFile (Melder_peek8to32 (soundFileName), & soundFile);
+			autoSound recording = Sound_readFromSoundFile (& soundFile);
+			if (recording -> ny > 1)
+				recording = Sound_convertToMono (recording.get());
+			theBench.sound = recording.move();
+		} else {
+			theBench.sound = Sound_createBenchVowels (20.0, 44100.0);
+		}
+		theBench.textGrid = TextGrid_createBenchWords (theBench.sound -> xmin, theBench.sound -> xmax);
+		theBench.table = Table_createBenchFormants (50000);
+		NUMrandom_init ();
+		structMelderDir tempDir { { 0 } };
+		Melder_getTempDir (& tempDir);
+		MelderDir_getFile (& tempDir, U"praat_bench.Sound", & theBench.binaryFile);
+		MelderDir_getFile (& tempDir, U"praat_bench.TextGrid", & theBench.textFile);
+
+		autoTable baseline;
+		long baselineNameColumn = 0, baselineSpeedColumn = 0;
+		if (baselineFileName) {
+			structMelderFile baselineFile { 0 };
+			Melder_pathToFile (Melder_peek8to32 (baselineFileName), & baselineFile);
+			baseline = Table_readFromCharacterSeparatedTextFile (& baselineFile, U'\t');
+			baselineNameColumn = Table_getColumnIndexFromColumnLabel (baseline.get(), U"workload");
+			baselineSpeedColumn = Table_getColumnIndexFromColumnLabel (baseline.get(), U"samplesPerSecond");
+		}
+
+		const long numberOfWorkloads = sizeof (theWorkloads) / sizeof (*theWorkloads);
+		autoTable results = Table_createWithColumnNames (numberOfWorkloads,
+			baseline ? U"workload unit samples seconds samplesPerSecond allocations allocatedBytes peakMemory_kB baseline ratio verdict" :
+			U"workload unit samples seconds samplesPerSecond allocations allocatedBytes peakMemory_kB");
+		long numberOfSlowWorkloads = 0;
+		for (long iworkload = 1; iworkload <= numberOfWorkloads; iworkload ++) {
+			const char32 *name = theWorkloads [iworkload - 1]. name;
+			long numberOfSamples = 0;
+			double fastestDuration = NUMundefined;
+			int64 numberOfAllocations = 0, allocationSize = 0;
+			for (long irun = 1; irun <= numberOfRuns; irun ++) {
+				int64 allocationCountBefore = Melder_allocationCount (), allocationSizeBefore = Melder_allocationSize ();
+				double startingTime = Melder_clock ();
+				numberOfSamples = theWorkloads [iworkload - 1]. run ();
+				double duration = Melder_clock () - startingTime;
+				numberOfAllocations = Melder_allocationCount () - allocationCountBefore;
+				allocationSize = Melder_allocationSize () - allocationSizeBefore;
+				if (! NUMdefined (fastestDuration) || duration < fastestDuration)
+					fastestDuration = duration;
+			}
+			double samplesPerSecond = fastestDuration > 0.0 ? numberOfSamples / fastestDuration : NUMundefined;
+			Table_setStringValue (results.get(), iworkload, 1, name);
+			Table_setStringValue (results.get(), iworkload, 2, theWorkloads [iworkload - 1]. unit);
+			Table_setNumericValue (results.get(), iworkload, 3, numberOfSamples);
+			Table_setNumericValue (results.get(), iworkload, 4, fastestDuration);
+			Table_setNumericValue (results.get(), iworkload, 5, samplesPerSecond);
+			Table_setNumericValue (results.get(), iworkload, 6, numberOfAllocations);
+			Table_setNumericValue (results.get(), iworkload, 7, allocationSize);
+			Table_setNumericValue (results.get(), iworkload, 8, bench_peakMemory_kB ());
+			if (baseline) {
+				long baselineRow = Table_searchColumn (baseline.get(), baselineNameColumn, name);
+				double baselineSpeed = baselineRow ? Table_getNumericValue_Assert (baseline.get(), baselineRow, baselineSpeedColumn) : NUMundefined;
+				double ratio = NUMdefined (baselineSpeed) && NUMdefined (samplesPerSecond) && baselineSpeed > 0.0 ?
+					samplesPerSecond / baselineSpeed : NUMundefined;
+				const char32 *verdict =
+					! NUMdefined (ratio) ? U"new" :
+					ratio < 1.0 - tolerance ? U"SLOWER" :
+					ratio > 1.0 + tolerance ? U"faster" : U"ok";
+				if (str32equ (verdict, U"SLOWER"))
+					numberOfSlowWorkloads ++;
+				Table_setNumericValue (results.get(), iworkload, 9, baselineSpeed);
+				Table_setNumericValue (results.get(), iworkload, 10, ratio);
+				Table_setStringValue (results.get(), iworkload, 11, verdict);
+			}
+		}
+		MelderFile_delete (& theBench.binaryFile);
+		MelderFile_delete (& theBench.textFile);
+
+		MelderInfo_open ();
+		for (long icol = 1; icol <= results -> numberOfColumns; icol ++)
+			MelderInfo_write (icol > 1 ? U"\t" : U"", results -> columnHeaders [icol]. label);
+		for (long irow = 1; irow <= results -> rows.size; irow ++) {
+			MelderInfo_write (U"\n");
+			for (long icol = 1; icol <= results -> numberOfColumns; icol ++)
+				MelderInfo_write (icol > 1 ? U"\t" : U"", Table_getStringValue_Assert (results.get(), irow, icol));
+		}
+		MelderInfo_close ();
+		if (outputFileName) {
+			structMelderFile outputFile { 0 };
+			Melder_pathToFile (Melder_peek8to32 (outputFileName), & outputFile);
+			Table_writeToTabSeparatedFile (results.get(), & outputFile);
+		}
+		if (numberOfSlowWorkloads > 0) {
+			Melder_casual (numberOfSlowWorkloads, U" of ", numberOfWorkloads, U" workloads are slower than the baseline.");
+			return 1;
+		}
+	} catch (MelderError) {
+		Melder_flushError ();
+		return 2;
+	}
+	return 0;
+}
+
+/* End of file main_bench.cpp */
@@ -486,37 +486,43 @@ void NUM_viterbi (
 	void (*putResult) (long iframe, long place, void *closure),
 	void *closure)
 {
-	autoNUMmatrix <double> delta (1, numberOfFrames, 1, maxnCandidates);
-	autoNUMmatrix <long> psi (1, numberOfFrames, 1, maxnCandidates);
+	/*
+	 * Only two rows of scores are needed at a time; the back pointers are kept for every frame.
+	 */
+	autoNUMvector <double> prevDelta (1, maxnCandidates), curDelta (1, maxnCandidates);
+	autoNUMmatrix <int> psi (1, numberOfFrames, 1, maxnCandidates);
 	autoNUMvector <long> numberOfCandidates (1, numberOfFrames);
-	for (long iframe = 1; iframe <= numberOfFrames; iframe ++) {
+	for (long iframe = 1; iframe <= numberOfFrames; iframe ++)
 		numberOfCandidates [iframe] = getNumberOfCandidates (iframe, closure);
-		for (long icand = 1; icand <= numberOfCandidates [iframe]; icand ++)
-			delta [iframe] [icand] = - getLocalCost (iframe, icand, closure);
-	}
+	for (long icand = 1; icand <= numberOfCandidates [1]; icand ++)
+		prevDelta [icand] = - getLocalCost (1, icand, closure);
 	for (long iframe = 2; iframe <= numberOfFrames; iframe ++) {
+		for (long icand2 = 1; icand2 <= numberOfCandidates [iframe]; icand2 ++)
+			curDelta [icand2] = - getLocalCost (iframe, icand2, closure);
 		for (long icand2 = 1; icand2 <= numberOfCandidates [iframe]; icand2 ++) {
 			double maximum = -1e308;
 			long place = 0;
 			for (long icand1 = 1; icand1 <= numberOfCandidates [iframe - 1]; icand1 ++) {
-				double value = delta [iframe - 1] [icand1] + delta [iframe] [icand2]
+				double value = prevDelta [icand1] + curDelta [icand2]
 					- getTransitionCost (iframe, icand1, icand2, closure);
 				if (value > maximum) { maximum = value; place = icand1; }
 			}
 			if (place == 0)
 				Melder_throw (U"Viterbi algorithm cannot compute a track because of weird values.");
-			delta [iframe] [icand2] = maximum;
+			curDelta [icand2] = maximum;
 			psi [iframe] [icand2] = place;
 		}
+		for (long icand = 1; icand <= numberOfCandidates [iframe]; icand ++)
+			prevDelta [icand] = curDelta [icand];
 	}
 	/*
 	 * Find the end of the most probable path.
 	 */
 	long place;
-	double maximum = delta [numberOfFrames] [place = 1];
+	double maximum = prevDelta [place = 1];
 	for (long icand = 2; icand <= numberOfCandidates [numberOfFrames]; icand ++)
-		if (delta [numberOfFrames] [icand] > maximum)
-			maximum = delta [numberOfFrames] [place = icand];
+		if (prevDelta [icand] > maximum)
+			maximum = prevDelta [place = icand];
 	/*
 	 * Backtrack.
 	 */
@@ -530,8 +536,15 @@ void NUM_viterbi (
 
 struct parm2 {
 	int ntrack;
-	long ncomb;
+	long ncand, ncomb;
 	long **indices;
+	/*
+	 * The costs of the single tracks in the current frame, so that the callbacks are called
+	 * ncand * ncand * ntrack times per frame rather than ncomb * ncomb * ntrack times.
+	 */
+	long localCostFrame, transitionCostFrame;
+	double **localCosts;   // [1..ncand][1..ntrack]
+	double **transitionCosts;   // [1..ntrack * ncand][1..ncand]: row (itrack - 1) * ncand + icand1
 	double (*getLocalCost) (long iframe, long icand, int itrack, void *closure);
 	double (*getTransitionCost) (long iframe, long icand1, long icand2, int itrack, void *closure);
 	void (*putResult) (long iframe, long place, int itrack, void *closure);
@@ -545,17 +558,29 @@ static long getNumberOfCandidates_n (long iframe, void *closure) {
 }
 static double getLocalCost_n (long iframe, long jcand, void *closure) {
 	struct parm2 *me = (struct parm2 *) closure;
+	if (iframe != my localCostFrame) {
+		for (long icand = 1; icand <= my ncand; icand ++)
+			for (int itrack = 1; itrack <= my ntrack; itrack ++)
+				my localCosts [icand] [itrack] = my getLocalCost (iframe, icand, itrack, my closure);
+		my localCostFrame = iframe;
+	}
 	double localCost = 0.0;
 	for (int itrack = 1; itrack <= my ntrack; itrack ++)
-		localCost += my getLocalCost (iframe, my indices [jcand] [itrack], itrack, my closure);
+		localCost += my localCosts [my indices [jcand] [itrack]] [itrack];
 	return localCost;
 }
 static double getTransitionCost_n (long iframe, long jcand1, long jcand2, void *closure) {
 	struct parm2 *me = (struct parm2 *) closure;
+	if (iframe != my transitionCostFrame) {
+		for (int itrack = 1; itrack <= my ntrack; itrack ++)
+			for (long icand1 = 1; icand1 <= my ncand; icand1 ++)
+				for (long icand2 = 1; icand2 <= my ncand; icand2 ++)
+					my transitionCosts [(itrack - 1) * my ncand + icand1] [icand2] = my getTransitionCost (iframe, icand1, icand2, itrack, my closure);
+		my transitionCostFrame = iframe;
+	}
 	double transitionCost = 0.0;
 	for (int itrack = 1; itrack <= my ntrack; itrack ++)
-		transitionCost += my getTransitionCost (iframe,
-			my indices [jcand1] [itrack], my indices [jcand2] [itrack], itrack, my closure);
+		transitionCost += my transitionCosts [(itrack - 1) * my ncand + my indices [jcand1] [itrack]] [my indices [jcand2] [itrack]];
 	return transitionCost;
 }
 static void putResult_n (long iframe, long jplace, void *closure) {
@@ -616,6 +641,12 @@ void NUM_viterbi_multi (
 		if (itrack == 0) break;
 	}
 	Melder_assert (jcomb == ncomb);
+	parm. ncand = ncand;
+	parm. localCostFrame = parm. transitionCostFrame = 0;
+	autoNUMmatrix <double> localCosts (1, ncand, 1, ntrack);
+	parm. localCosts = localCosts.peek();
+	autoNUMmatrix <double> transitionCosts (1, ntrack * ncand, 1, ncand);
+	parm. transitionCosts = transitionCosts.peek();
 	parm. getLocalCost = getLocalCost;
 	parm. getTransitionCost = getTransitionCost;
 	parm. putResult = putResult;
@@ -339,6 +339,49 @@ double NUMrandomGauss_mt (int threadNumber, double mean, double standardDeviatio
 
 double NUMrandomPoisson (double mean);
 
+void NUMrandom_initWithSeed (uint64_t seed);
+/*
+	Makes NUMrandomFraction () and its relatives, and all the thread-numbered generators,
+	produce a sequence that is completely determined by the seed.
+	NUMrandom_init () makes them unpredictable again.
+*/
+
+/*
+	Counter-based random streams (Philox-4x32-10; Salmon, Moraes, Dror & Shaw 2011).
+	Draw number i of a stream is a pure function of (seed, stream number, i),
+	so a stream can jump ahead in constant time,
+	and parallel tasks can each draw from their own independent and reproducible stream,
+	whatever the number of threads.
+*/
+struct structNUMrandomStream {
+	uint64_t seed, streamNumber;
+	uint64_t position;   // the number of 64-bit words drawn so far; each block contains two words
+	uint64_t cachedBlockNumber;
+	uint64_t block [2];
+	bool secondAvailable;
+	double y;
+};
+typedef struct structNUMrandomStream *NUMrandomStream;
+
+void NUMrandomStream_init (NUMrandomStream me, uint64_t seed, uint64_t streamNumber);
+void NUMrandomStream_initAsSubstream (NUMrandomStream me, NUMrandomStream parent, uint64_t taskNumber);
+/*
+	A substream shares the seed of the parent, and has a stream number derived from
+	the parent's stream number and the task number, so that task i of a parallel job
+	gets the same numbers whichever thread runs it.
+*/
+void NUMrandomStream_jumpAhead (NUMrandomStream me, uint64_t numberOfFractions);
+double NUMrandomStream_fraction (NUMrandomStream me);
+double NUMrandomStream_uniform (NUMrandomStream me, double lowest, double highest);
+long NUMrandomStream_integer (NUMrandomStream me, long lowest, long highest);
+double NUMrandomStream_gauss (NUMrandomStream me, double mean, double standardDeviation);
+void NUMrandomStream_fractions (NUMrandomStream me, double x [], long n);
+void NUMrandomStream_gausses (NUMrandomStream me, double x [], long n, double mean, double standardDeviation);
+/*
+	Fill x [1..n], with the same numbers that n calls to NUMrandomStream_fraction or _gauss would give.
+	NUMrandomStream_fractions generates whole blocks in a loop without branches, which the compiler can vectorize.
+*/
+
 uint32 NUMhashString (const char32 *string);
 
 void NUMfbtoa (double formant, double bandwidth, double dt, double *a1, double *a2);
@@ -149,11 +149,11 @@ void NUMrandom_State :: init_by_array64 (uint64_t init_key [], unsigned int key_
 }
 
 static bool theInited = false;
-void NUMrandom_init () {
+static void initStates (bool predictable, uint64_t seed) {
 	for (int threadNumber = 0; threadNumber <= 16; threadNumber ++) {
 		const int numberOfKeys = 6;
 		uint64_t keys [numberOfKeys];
-		keys [0] = (uint64_t) llround (1e6 * Melder_clock ());   // unique between boots of the same computer
+		keys [0] = predictable ? seed : (uint64_t) llround (1e6 * Melder_clock ());   // unique between boots of the same computer
 		keys [1] = UINT64_C (7320321686725470078) + (uint64_t) threadNumber;   // unique between threads in the same process
 		switch (threadNumber) {
 			case  0: keys [2] = UINT64_C  (4492812493098689432), keys [3] = UINT64_C  (8902321878452586268); break;
@@ -175,15 +175,29 @@ void NUMrandom_init () {
 			case 16: keys [2] = UINT64_C  (1081237546238975884), keys [3] = UINT64_C  (2939783238574293882); break;
 			default: Melder_fatal (U"Thread number too high.");
 		}
-		keys [4] = (uint64_t) (int64) getpid ();   // unique between processes that run simultaneously on the same computer
-		#ifndef _WIN32
-		keys [5] = (uint64_t) (int64) gethostid ();   // unique between computers
-		#endif
+		if (predictable) {
+			keys [4] = keys [5] = 0;
+		} else {
+			keys [4] = (uint64_t) (int64) getpid ();   // unique between processes that run simultaneously on the same computer
+			#ifndef _WIN32
+			keys [5] = (uint64_t) (int64) gethostid ();   // unique between computers
+			#endif
+		}
 		states [threadNumber]. init_by_array64 (keys, numberOfKeys);
+		states [threadNumber]. index = NN;   // the array needs regeneration before the first draw
+		states [threadNumber]. secondAvailable = false;
 	}
 	theInited = true;
 }
 
+void NUMrandom_init () {
+	initStates (false, 0);
+}
+
+void NUMrandom_initWithSeed (uint64_t seed) {
+	initStates (true, seed);
+}
+
 /* Throughout the years, several versions for "zero or magic" have been proposed. Choose the fastest. */
 
 #define ZERO_OR_MAGIC_VERSION  3
@@ -329,6 +343,143 @@ double NUMrandomGauss_mt (int threadNumber, double mean, double standardDeviatio
 	}
 }
 
+/********** Counter-based streams **********/
+
+#define PHILOX_M0  UINT32_C (0xD2511F53)
+#define PHILOX_M1  UINT32_C (0xCD9E8D57)
+#define PHILOX_W0  UINT32_C (0x9E3779B9)
+#define PHILOX_W1  UINT32_C (0xBB67AE85)
+
+/*
+	Philox-4x32 with ten rounds: a bijection of the 128-bit counter, keyed by 64 bits.
+	Our counter is (block number, stream number) and our key is the seed.
+*/
+static inline void philox4x32_10 (uint32_t counter [4], uint32_t key0, uint32_t key1) {
+	for (int round = 1; round <= 10; round ++) {
+		uint64_t product0 = (uint64_t) PHILOX_M0 * counter [0];
+		uint64_t product1 = (uint64_t) PHILOX_M1 * counter [2];
+		uint32_t hi0 = (uint32_t) (product0 >> 32), lo0 = (uint32_t) product0;
+		uint32_t hi1 = (uint32_t) (product1 >> 32), lo1 = (uint32_t) product1;
+		counter [0] = hi1 ^ counter [1] ^ key0;
+		counter [1] = lo1;
+		counter [2] = hi0 ^ counter [3] ^ key1;
+		counter [3] = lo0;
+		key0 += PHILOX_W0;
+		key1 += PHILOX_W1;
+	}
+}
+
+static inline void NUMrandomStream_generateBlock (uint64_t seed, uint64_t streamNumber, uint64_t blockNumber, uint64_t block [2]) {
+	uint32_t counter [4] = { (uint32_t) blockNumber, (uint32_t) (blockNumber >> 32), (uint32_t) streamNumber, (uint32_t) (streamNumber >> 32) };
+	philox4x32_10 (counter, (uint32_t) seed, (uint32_t) (seed >> 32));
+	block [0] = (uint64_t) counter [0] | (uint64_t) counter [1] << 32;
+	block [1] = (uint64_t) counter [2] | (uint64_t) counter [3] << 32;
+}
+
+static inline double wordToFraction (uint64_t word) {
+	return (word >> 11) * (1.0/9007199254740992.0);
+}
+
+void NUMrandomStream_init (NUMrandomStream me, uint64_t seed, uint64_t streamNumber) {
+	my seed = seed;
+	my streamNumber = streamNumber;
+	my position = 0;
+	my cachedBlockNumber = UINT64_MAX;   // nothing cached
+	my secondAvailable = false;
+	my y = 0.0;
+}
+
+void NUMrandomStream_initAsSubstream (NUMrandomStream me, NUMrandomStream parent, uint64_t taskNumber) {
+	/*
+		SplitMix64 finalizer on a combination of the parent stream and the task number:
+		different tasks, and tasks of different parents, get unrelated stream numbers.
+	*/
+	uint64_t z = parent -> streamNumber * UINT64_C (0x9E3779B97F4A7C15) + taskNumber + 1;
+	z = (z ^ (z >> 30)) * UINT64_C (0xBF58476D1CE4E5B9);
+	z = (z ^ (z >> 27)) * UINT64_C (0x94D049BB133111EB);
+	z ^= z >> 31;
+	NUMrandomStream_init (me, parent -> seed, z);
+}
+
+void NUMrandomStream_jumpAhead (NUMrandomStream me, uint64_t numberOfFractions) {
+	my position += numberOfFractions;
+	my secondAvailable = false;
+}
+
+double NUMrandomStream_fraction (NUMrandomStream me) {
+	uint64_t blockNumber = my position >> 1;
+	if (blockNumber != my cachedBlockNumber) {
+		NUMrandomStream_generateBlock (my seed, my streamNumber, blockNumber, my block);
+		my cachedBlockNumber = blockNumber;
+	}
+	return wordToFraction (my block [my position ++ & 1]);
+}
+
+double NUMrandomStream_uniform (NUMrandomStream me, double lowest, double highest) {
+	return lowest + (highest - lowest) * NUMrandomStream_fraction (me);
+}
+
+long NUMrandomStream_integer (NUMrandomStream me, long lowest, long highest) {
+	return lowest + (long) ((highest - lowest + 1) * NUMrandomStream_fraction (me));
+}
+
+double NUMrandomStream_gauss (NUMrandomStream me, double mean, double standardDeviation) {
+	/*
+		Knuth, p. 122.
+	*/
+	if (my secondAvailable) {
+		my secondAvailable = false;
+		return mean + standardDeviation * my y;
+	} else {
+		double s, x;
+		repeat {
+			x = 2.0 * NUMrandomStream_fraction (me) - 1.0;   // inside the square [-1; 1] x [-1; 1]
+			my y = 2.0 * NUMrandomStream_fraction (me) - 1.0;
+			s = x * x + my y * my y;
+		} until (s < 1.0);   // inside the unit circle
+		if (s == 0.0) {
+			x = my y = 0.0;
+		} else {
+			double factor = sqrt (-2.0 * log (s) / s);
+			x *= factor, my y *= factor;
+		}
+		my secondAvailable = true;
+		return mean + standardDeviation * x;
+	}
+}
+
+void NUMrandomStream_fractions (NUMrandomStream me, double x [], long n) {
+	long i = 1;
+	/*
+		Finish the current block, if we are in the middle of one.
+	*/
+	while (i <= n && (my position & 1) != 0) {
+		x [i ++] = NUMrandomStream_fraction (me);
+	}
+	/*
+		Whole blocks: every iteration is independent of the others.
+	*/
+	long numberOfBlocks = (n - i + 1) / 2;
+	uint64_t firstBlockNumber = my position >> 1;
+	for (long iblock = 0; iblock < numberOfBlocks; iblock ++) {
+		uint64_t block [2];
+		NUMrandomStream_generateBlock (my seed, my streamNumber, firstBlockNumber + (uint64_t) iblock, block);
+		x [i + 2 * iblock] = wordToFraction (block [0]);
+		x [i + 2 * iblock + 1] = wordToFraction (block [1]);
+	}
+	i += 2 * numberOfBlocks;
+	my position += 2 * (uint64_t) numberOfBlocks;
+	while (i <= n) {
+		x [i ++] = NUMrandomStream_fraction (me);
+	}
+}
+
+void NUMrandomStream_gausses (NUMrandomStream me, double x [], long n, double mean, double standardDeviation) {
+	for (long i = 1; i <= n; i ++) {
+		x [i] = NUMrandomStream_gauss (me, mean, standardDeviation);
+	}
+}
+
 double NUMrandomPoisson (double mean) {
 	/*
 		The Poisson distribution is
@@ -46,7 +46,7 @@ static bool theOptimize;
 static struct Formula_NumericVector theZeroNumericVector = { 0, nullptr };
 static struct Formula_NumericMatrix theZeroNumericMatrix = { 0, 0, nullptr };
 
-typedef struct structFormulaInstruction {
+struct structFormulaInstruction {
 	int symbol;
 	int position;
 	union {
@@ -57,7 +57,7 @@ typedef struct structFormulaInstruction {
 		Daata object;
 		InterpreterVariable variable;
 	} content;
-} *FormulaInstruction;
+};
 
 static FormulaInstruction lexan, parse;
 static int ilabel, ilexan, iparse, numberOfInstructions, numberOfStringConstants;
@@ -638,19 +638,15 @@ static void Formula_lexan () {
 					U"(variables start with lower case; object names contain an underscore).");
 			} else if (str32nequ (token.string, U"Object_", 7)) {
 				long uniqueID = a32tol (token.string + 7);
-				int i = theCurrentPraatObjects -> n;
-				while (i > 0 && uniqueID != theCurrentPraatObjects -> list [i]. id)
-					i --;
+				int i = praat_positionOfId (uniqueID);
 				if (i == 0)
 					formulefout (U"No such object (note: variables start with lower case)", ikar);
 				nieuwtok (endsInDollarSign ? MATRIKSSTR_ : MATRIKS_)
 				tokmatriks ((Daata) theCurrentPraatObjects -> list [i]. object);
 			} else {
-				int i = theCurrentPraatObjects -> n;
 				*underscore = ' ';
 				if (endsInDollarSign) token.string [-- token.length] = '\0';
-				while (i > 0 && ! str32equ (token.string, theCurrentPraatObjects -> list [i]. name))
-					i --;
+				int i = praat_positionOfFullName (token.string);
 				if (i == 0)
 					formulefout (U"No such object (note: variables start with lower case)", ikar);
 				nieuwtok (endsInDollarSign ? MATRIKSSTR_ : MATRIKS_)
@@ -1885,6 +1881,79 @@ static void Formula_print (FormulaInstruction f) {
 	} while (symbol != END_);
 }
 
+/*
+ * Reusing compiled expressions.
+ */
+
+Thing_implement (FormulaProgram, Thing, 0);
+
+static inline bool FormulaInstruction_ownsString (int symbol) {
+	return symbol == STRING_ || symbol == INDEXED_NUMERIC_VARIABLE_ || symbol == INDEXED_STRING_VARIABLE_ || symbol == CALL_;
+}
+
+void structFormulaProgram :: v_destroy () noexcept {
+	if (our instructions) {
+		for (int i = 1; i <= our numberOfInstructions; i ++)
+			if (FormulaInstruction_ownsString (our instructions [i]. symbol))
+				Melder_free (our instructions [i]. content.string);
+		Melder_free (our instructions);
+	}
+	FormulaProgram_Parent :: v_destroy ();
+}
+
+#define Formula_MAXIMUM_NUMBER_OF_REMEMBERED_PROGRAMS  2000
+
+static std::u32string Formula_programKey (Interpreter interpreter, const char32 *expression, int expressionType) {
+	/*
+		Local variables (".x") are resolved relative to the current procedure,
+		so the procedure name is part of the key. It contains no spaces.
+	*/
+	std::u32string key (1, (char32) (U'0' + expressionType));
+	key += interpreter -> procedureNames [interpreter -> callDepth];
+	key += U' ';
+	key += expression;
+	return key;
+}
+
+static bool Formula_lexanRefersToObjects () {
+	/*
+		Object names and IDs are resolved to object pointers during lexical analysis,
+		and objects can be removed while the script runs.
+		Variables are safe: the interpreter removes them only together with the remembered programs.
+	*/
+	for (int i = 1; lexan [i]. symbol != END_; i ++)
+		if (lexan [i]. symbol == MATRIKS_ || lexan [i]. symbol == MATRIKSSTR_)
+			return true;
+	return false;
+}
+
+static void Formula_rememberProgram (Interpreter interpreter, const std::u32string& key) {
+	if (interpreter -> compiledExpressions. size () >= Formula_MAXIMUM_NUMBER_OF_REMEMBERED_PROGRAMS) {
+		/*
+			Probably a script that computes its expressions with string substitutions ('i'),
+			so that most of the remembered programs will not be seen again. Start afresh.
+		*/
+		for (auto it = interpreter -> compiledExpressions. begin(); it != interpreter -> compiledExpressions. end(); it ++) {
+			FormulaProgram program = it -> second;
+			forget (program);
+		}
+		interpreter -> compiledExpressions. clear ();
+	}
+	autoFormulaProgram program = Thing_new (FormulaProgram);
+	program -> instructions = Melder_calloc (struct structFormulaInstruction, numberOfInstructions + 2);
+	program -> numberOfInstructions = numberOfInstructions;
+	for (int i = 1; i <= numberOfInstructions + 1; i ++) {
+		program -> instructions [i] = parse [i];
+		if (FormulaInstruction_ownsString (parse [i]. symbol))
+			program -> instructions [i]. content.string = nullptr;   // the parse owns no strings: they are reference copies from lexan...
+	}
+	for (int i = 1; i <= numberOfInstructions; i ++)
+		if (FormulaInstruction_ownsString (parse [i]. symbol))
+			program -> instructions [i]. content.string = Melder_dup (parse [i]. content.string);   // ...but the program must survive the next lexan
+	interpreter -> compiledExpressions [key] = program.get();   // YUCK
+	program.releaseToAmbiguousOwner();
+}
+
 void Formula_compile (Interpreter interpreter, Daata data, const char32 *expression, int expressionType, bool optimize) {
 	theInterpreter = interpreter;
 	if (! theInterpreter) {
@@ -1908,6 +1977,23 @@ void Formula_compile (Interpreter interpreter, Daata data, const char32 *express
 	}
 	if (! parse) parse = Melder_calloc_f (struct structFormulaInstruction, 3000);
 
+	/*
+		Expressions in a script are typically evaluated many times (loop conditions, assignments in loops).
+		If the interpreter has compiled this expression before, reuse the result.
+	*/
+	bool reusable = interpreter && ! data && ! optimize && Melder_debug != 17;
+	std::u32string key;
+	if (reusable) {
+		key = Formula_programKey (interpreter, expression, expressionType);
+		auto it = interpreter -> compiledExpressions. find (key);
+		if (it != interpreter -> compiledExpressions. end()) {
+			FormulaProgram program = it -> second;
+			memcpy (& parse [1], & program -> instructions [1], (program -> numberOfInstructions + 1) * sizeof (struct structFormulaInstruction));
+			numberOfInstructions = program -> numberOfInstructions;
+			return;
+		}
+	}
+
 	/*
 		Clean up strings from the previous call.
 		These strings are in a union, that's why this cannot be done later, when a new string is created.
@@ -1935,6 +2021,8 @@ void Formula_compile (Interpreter interpreter, Daata data, const char32 *express
 	}
 	Formula_removeLabels ();
 	if (Melder_debug == 17) Formula_print (parse);
+	if (reusable && ! Formula_lexanRefersToObjects ())
+		Formula_rememberProgram (interpreter, key);
 }
 
 /*
@@ -2490,12 +2578,10 @@ static void do_objects_are_identical () {
 	Stackel y = pop, x = pop;
 	if (x->which == Stackel_NUMBER && y->which == Stackel_NUMBER) {
 		int id1 = lround (x->number), id2 = lround (y->number);
-		int i = theCurrentPraatObjects -> n;
-		while (i > 0 && id1 != theCurrentPraatObjects -> list [i]. id) i --;
+		int i = praat_positionOfId (id1);
 		if (i == 0) Melder_throw (U"Object #", id1, U" does not exist in function objectsAreIdentical.");
 		Daata object1 = (Daata) theCurrentPraatObjects -> list [i]. object;
-		i = theCurrentPraatObjects -> n;
-		while (i > 0 && id2 != theCurrentPraatObjects -> list [i]. id) i --;
+		i = praat_positionOfId (id2);
 		if (i == 0) Melder_throw (U"Object #", id2, U" does not exist in function objectsAreIdentical.");
 		Daata object2 = (Daata) theCurrentPraatObjects -> list [i]. object;
 		pushNumber (x->number == NUMundefined || y->number == NUMundefined ? NUMundefined : Data_equal (object1, object2));
@@ -2567,7 +2653,7 @@ static void do_do () {
 		double value = NUMundefined;
 		if (valueString.string [0] == 1) {   // nothing written with MelderInfo by praat_doAction or praat_doMenuCommand? then the return value is the ID of the selected object
 			int IOBJECT, result = 0, found = 0;
-			WHERE (SELECTED) { result = IOBJECT; found += 1; }
+			LOOP { result = IOBJECT; found += 1; }
 			if (found == 1) {
 				value = theCurrentPraatObjects -> list [result]. id;
 			}
@@ -3411,14 +3497,13 @@ static void do_index_regex (int backward) {
 	Stackel t = pop, s = pop;
 	if (s->which == Stackel_STRING && t->which == Stackel_STRING) {
 		const char32 *errorMessage;
-		regexp *compiled_regexp = CompileRE (t->string, & errorMessage, 0);
+		regexp *compiled_regexp = CompileRE_cached (t->string, & errorMessage, 0);   // owned by the cache
 		if (! compiled_regexp) {
 			Melder_throw (U"index_regex(): ", errorMessage, U".");
 		} else {
 			if (ExecRE (compiled_regexp, nullptr, s->string, nullptr, backward, '\0', '\0', nullptr, nullptr, nullptr)) {
 				char32 *place = (char32 *) compiled_regexp -> startp [0];
 				pushNumber (place - s->string + 1);
-				free (compiled_regexp);
 			} else {
 				pushNumber (false);
 			}
@@ -3442,7 +3527,7 @@ static void do_replace_regexStr () {
 	Stackel x = pop, u = pop, t = pop, s = pop;
 	if (s->which == Stackel_STRING && t->which == Stackel_STRING && u->which == Stackel_STRING && x->which == Stackel_NUMBER) {
 		const char32 *errorMessage;
-		regexp *compiled_regexp = CompileRE (t->string, & errorMessage, 0);
+		regexp *compiled_regexp = CompileRE_cached (t->string, & errorMessage, 0);   // owned by the cache
 		if (! compiled_regexp) {
 			Melder_throw (U"replace_regex$(): ", errorMessage, U".");
 		} else {
@@ -3604,8 +3689,8 @@ static void do_numberOfSelected () {
 	pushNumber (result);
 }
 static int praat_findObjectById (int id) {
-	int IOBJECT;
-	WHERE_DOWN (ID == id)
+	int IOBJECT = praat_positionOfId (id);
+	if (IOBJECT != 0)
 		return IOBJECT;
 	Melder_throw (U"No object with number ", id, U".");
 }
@@ -3622,17 +3707,13 @@ static int praat_findObjectFromString (const char32 *name) {
 			Melder_throw (U"Missing space in object name \"", name, U"\".");
 		*space = U'\0';
 		char32 *className = & buffer.string [0], *givenName = space + 1;
-		WHERE_DOWN (1) {
-			Daata object = OBJECT;
-			if (str32equ (className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
-				return IOBJECT;
-		}
+		IOBJECT = praat_positionOfName (className, givenName);
+		if (IOBJECT != 0)
+			return IOBJECT;
 		ClassInfo klas = Thing_classFromClassName (className, nullptr);
-		WHERE_DOWN (1) {
-			Daata object = OBJECT;
-			if (str32equ (klas -> className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
-				return IOBJECT;
-		}
+		IOBJECT = praat_positionOfName (klas -> className, givenName);
+		if (IOBJECT != 0)
+			return IOBJECT;
 	}
 	Melder_throw (U"No object with name \"", name, U"\".");
 }
@@ -4374,17 +4455,13 @@ static void do_selfStr0 (long irow, long icol) {
 static Daata getObjectFromUniqueID (Stackel object) {
 	Daata thee = nullptr;
 	if (object->which == Stackel_NUMBER) {
-		int i = theCurrentPraatObjects -> n;
-		while (i > 0 && object->number != theCurrentPraatObjects -> list [i]. id)
-			i --;
+		int i = object->number == floor (object->number) ? praat_positionOfId ((long) object->number) : 0;
 		if (i == 0) {
 			Melder_throw (U"No such object: ", object->number);
 		}
 		thee = (Daata) theCurrentPraatObjects -> list [i]. object;
 	} else if (object->which == Stackel_STRING) {
-		int i = theCurrentPraatObjects -> n;
-		while (i > 0 && ! Melder_equ (object->string, theCurrentPraatObjects -> list [i]. name))
-			i --;
+		int i = praat_positionOfFullName (object->string);
 		if (i == 0) {
 			Melder_throw (U"No such object: ", object->string);
 		}
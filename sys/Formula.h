@@ -73,6 +73,21 @@ struct Formula_Result {
 
 Thing_declare (Interpreter);
 
+/*
+	A FormulaProgram is the result of compiling an expression:
+	the instruction list that Formula_run executes.
+	An Interpreter keeps the programs of the expressions that it has already compiled,
+	so that a script line that is executed many times (e.g. inside a loop) is lexed and parsed only once.
+*/
+typedef struct structFormulaInstruction *FormulaInstruction;
+Thing_define (FormulaProgram, Thing) {
+	int numberOfInstructions;
+	FormulaInstruction instructions;   // [1..numberOfInstructions + 1], the last one being END_; owns its string constants
+
+	void v_destroy () noexcept
+		override;
+};
+
 void Formula_compile (Interpreter interpreter, Daata data, const char32 *expression, int expressionType, bool optimize);
 
 void Formula_run (long row, long col, struct Formula_Result *result);
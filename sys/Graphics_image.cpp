@@ -194,6 +194,8 @@ static void _GraphicsScreen_cellArrayOrImage (GraphicsScreen me, double **z_floa
 			long numberOfRows = clipy1 - clipy2;
 			Melder_assert (numberOfRows > 0);
 			unsigned char *imageData = Melder_malloc_f (unsigned char, bytesPerRow * numberOfRows);
+		#else
+			return;   // there is no bitmap to draw into
 		#endif
 		/*
 		 * Draw into the bitmap.
@@ -264,6 +266,31 @@ static void _GraphicsScreen_cellArrayOrImage (GraphicsScreen me, double **z_floa
 			#define ROW_START_ADDRESS  nullptr
 			#define PUT_PIXEL
 		#endif
+		#if win
+			#define PUT_RGBT_PIXEL \
+				*pixelAddress ++ = blue         * 255.0; \
+				*pixelAddress ++ = green        * 255.0; \
+				*pixelAddress ++ = red          * 255.0; \
+				*pixelAddress ++ = 0;
+		#elif mac
+			#define PUT_RGBT_PIXEL \
+				*pixelAddress ++ = red          * 255.0; \
+				*pixelAddress ++ = green        * 255.0; \
+				*pixelAddress ++ = blue         * 255.0; \
+				*pixelAddress ++ = transparency * 255.0;
+		#elif cairo
+			#define PUT_RGBT_PIXEL \
+				*pixelAddress ++ = blue         * 255.0; \
+				*pixelAddress ++ = green        * 255.0; \
+				*pixelAddress ++ = red          * 255.0; \
+				*pixelAddress ++ = transparency * 255.0;
+		#else
+			#define PUT_RGBT_PIXEL
+		#endif
+		/*
+		 * Every platform writes four bytes per pixel.
+		 */
+		const long bytesPerPixelRow = (clipx2 - clipx1) * 4;
 		if (interpolate) {
 			try {
 				autoNUMvector <long> ileft (clipx1, clipx2);
@@ -277,6 +304,19 @@ static void _GraphicsScreen_cellArrayOrImage (GraphicsScreen me, double **z_floa
 					if (ileft [xDC] < ix1) ileft [xDC] = ix1;
 					if (iright [xDC] > ix2) iright [xDC] = ix2;
 				}
+				/*
+				 * Unless there are many more cells than pixels in a row,
+				 * it is cheaper to blend the two rows of cells vertically once for each row of pixels
+				 * than to do it again for each pixel. The arithmetic is the same as in the per-pixel formula.
+				 */
+				autoNUMvector <double> blend;
+				long icolmin = 0, icolmax = -1;
+				if (clipx2 > clipx1 && ! z_rgbt) {
+					icolmin = ileft [clipx1];
+					icolmax = iright [clipx2 - 1];
+					if (icolmax - icolmin + 1 <= 2 * (clipx2 - clipx1))
+						blend.reset (icolmin, icolmax);
+				}
 				for (yDC = clipy2; yDC < clipy1; yDC += undersampling) {
 					double iy_real = iy2 + 0.5 - ((double) ny * (yDC - y2DC)) / (y1DC - y2DC);
 					long itop = ceil (iy_real), ibottom = itop - 1;
@@ -284,7 +324,22 @@ static void _GraphicsScreen_cellArrayOrImage (GraphicsScreen me, double **z_floa
 					unsigned char *pixelAddress = ROW_START_ADDRESS;
 					if (itop > iy2) itop = iy2;
 					if (ibottom < iy1) ibottom = iy1;
-					if (z_float) {
+					if (blend.peek ()) {
+						if (z_float) {
+							double *ztop = z_float [itop], *zbottom = z_float [ibottom];
+							for (long icol = icolmin; icol <= icolmax; icol ++)
+								blend [icol] = topWeight * ztop [icol] + bottomWeight * zbottom [icol];
+						} else {
+							unsigned char *ztop = z_byte [itop], *zbottom = z_byte [ibottom];
+							for (long icol = icolmin; icol <= icolmax; icol ++)
+								blend [icol] = topWeight * ztop [icol] + bottomWeight * zbottom [icol];
+						}
+						for (xDC = clipx1; xDC < clipx2; xDC += undersampling) {
+							double interpol = rightWeight [xDC] * blend [iright [xDC]] + leftWeight [xDC] * blend [ileft [xDC]];
+							double value = offset - scale * interpol;
+							PUT_PIXEL
+						}
+					} else if (z_float) {
 						double *ztop = z_float [itop], *zbottom = z_float [ibottom];
 						for (xDC = clipx1; xDC < clipx2; xDC += undersampling) {
 							double interpol =
@@ -314,22 +369,7 @@ static void _GraphicsScreen_cellArrayOrImage (GraphicsScreen me, double **z_floa
 							if (green        < 0.0) green        = 0.0; else if (green        > 1.0) green        = 1.0;
 							if (blue         < 0.0) blue         = 0.0; else if (blue         > 1.0) blue         = 1.0;
 							if (transparency < 0.0) transparency = 0.0; else if (transparency > 1.0) transparency = 1.0;
-							#if win
-								*pixelAddress ++ = blue         * 255.0;
-								*pixelAddress ++ = green        * 255.0;
-								*pixelAddress ++ = red          * 255.0;
-								*pixelAddress ++ = 0;
-							#elif mac
-								*pixelAddress ++ = red          * 255.0;
-								*pixelAddress ++ = green        * 255.0;
-								*pixelAddress ++ = blue         * 255.0;
-								*pixelAddress ++ = transparency * 255.0;
-							#elif cairo
-								*pixelAddress ++ = blue         * 255.0;
-								*pixelAddress ++ = green        * 255.0;
-								*pixelAddress ++ = red          * 255.0;
-								*pixelAddress ++ = transparency * 255.0;
-							#endif
+							PUT_RGBT_PIXEL
 						}
 					} else {
 						unsigned char *ztop = z_byte [itop], *zbottom = z_byte [ibottom];
@@ -350,16 +390,77 @@ static void _GraphicsScreen_cellArrayOrImage (GraphicsScreen me, double **z_floa
 				autoNUMvector <long> ix (clipx1, clipx2);
 				for (xDC = clipx1; xDC < clipx2; xDC += undersampling)
 					ix [xDC] = floor (ix1 + (nx * (xDC - x1DC)) / (x2DC - x1DC));
+				/*
+				 * Every pixel of a cell has the same colour, so we compute the four bytes of each visible cell once per row,
+				 * unless there are more visible cells than pixels in a row.
+				 * A row of pixels that shows the same row of cells as the previous one is a copy of it.
+				 */
+				autoNUMvector <uint32> cellPixel;
+				long icolmin = 0, icolmax = -1;
+				if (clipx2 > clipx1) {
+					icolmin = ix [clipx1];
+					icolmax = ix [clipx2 - 1];
+					if (icolmax - icolmin + 1 <= clipx2 - clipx1)
+						cellPixel.reset (icolmin, icolmax);
+				}
+				long previousRow = 0;
+				unsigned char *previousRowAddress = nullptr;
 				for (yDC = clipy2; yDC < clipy1; yDC += undersampling) {
 					long iy = ceil (iy2 - (ny * (yDC - y2DC)) / (y1DC - y2DC));
 					unsigned char *pixelAddress = ROW_START_ADDRESS;
 					Melder_assert (iy >= iy1 && iy <= iy2);
-					if (z_float) {
+					if (previousRowAddress && iy == previousRow) {
+						memcpy (pixelAddress, previousRowAddress, bytesPerPixelRow);
+						continue;
+					}
+					previousRow = iy;
+					previousRowAddress = pixelAddress;
+					if (cellPixel.peek ()) {
+						for (long icol = icolmin; icol <= icolmax; icol ++) {
+							unsigned char *rowStartAddress = pixelAddress;
+							pixelAddress = (unsigned char *) & cellPixel [icol];
+							if (z_float) {
+								double value = offset - scale * z_float [iy] [icol];
+								PUT_PIXEL
+							} else if (z_rgbt) {
+								double red          = z_rgbt [iy] [icol]. red;
+								double green        = z_rgbt [iy] [icol]. green;
+								double blue         = z_rgbt [iy] [icol]. blue;
+								double transparency = z_rgbt [iy] [icol]. transparency;
+								if (red          < 0.0) red          = 0.0; else if (red          > 1.0) red          = 1.0;
+								if (green        < 0.0) green        = 0.0; else if (green        > 1.0) green        = 1.0;
+								if (blue         < 0.0) blue         = 0.0; else if (blue         > 1.0) blue         = 1.0;
+								if (transparency < 0.0) transparency = 0.0; else if (transparency > 1.0) transparency = 1.0;
+								PUT_RGBT_PIXEL
+							} else {
+								double value = offset - scale * z_byte [iy] [icol];
+								PUT_PIXEL
+							}
+							pixelAddress = rowStartAddress;
+						}
+						for (xDC = clipx1; xDC < clipx2; xDC += undersampling) {
+							memcpy (pixelAddress, & cellPixel [ix [xDC]], 4);
+							pixelAddress += 4;
+						}
+					} else if (z_float) {
 						double *ziy = z_float [iy];
 						for (xDC = clipx1; xDC < clipx2; xDC += undersampling) {
 							double value = offset - scale * ziy [ix [xDC]];
 							PUT_PIXEL
 						}
+					} else if (z_rgbt) {
+						double_rgbt *ziy = z_rgbt [iy];
+						for (xDC = clipx1; xDC < clipx2; xDC += undersampling) {
+							double red          = ziy [ix [xDC]]. red;
+							double green        = ziy [ix [xDC]]. green;
+							double blue         = ziy [ix [xDC]]. blue;
+							double transparency = ziy [ix [xDC]]. transparency;
+							if (red          < 0.0) red          = 0.0; else if (red          > 1.0) red          = 1.0;
+							if (green        < 0.0) green        = 0.0; else if (green        > 1.0) green        = 1.0;
+							if (blue         < 0.0) blue         = 0.0; else if (blue         > 1.0) blue         = 1.0;
+							if (transparency < 0.0) transparency = 0.0; else if (transparency > 1.0) transparency = 1.0;
+							PUT_RGBT_PIXEL
+						}
 					} else {
 						unsigned char *ziy = z_byte [iy];
 						for (xDC = clipx1; xDC < clipx2; xDC += undersampling) {
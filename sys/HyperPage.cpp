@@ -592,10 +592,7 @@ void structHyperPage :: v_destroy () noexcept {
 	for (int i = 0; i < 20; i ++) Melder_free (our history [i]. page);
 	Melder_free (our currentPageTitle);
 	if (our praatApplication) {
-		for (int iobject = ((PraatObjects) our praatObjects) -> n; iobject >= 1; iobject --) {
-			Melder_free (((PraatObjects) our praatObjects) -> list [iobject]. name);
-			forget (((PraatObjects) our praatObjects) -> list [iobject]. object);
-		}
+		praat_freeObjects ((PraatObjects) our praatObjects);
 		Melder_free (our praatApplication);
 		Melder_free (our praatObjects);
 		Melder_free (our praatPicture);
@@ -68,10 +68,19 @@ static autoInterpreterVariable InterpreterVariable_create (const char32 *key) {
 
 Thing_implement (Interpreter, Thing, 0);
 
+static void Interpreter_forgetCompiledExpressions (Interpreter me) {
+	for (auto it = my compiledExpressions. begin(); it != my compiledExpressions. end(); it ++) {
+		FormulaProgram program = it -> second;
+		forget (program);
+	}
+	my compiledExpressions. clear ();
+}
+
 void structInterpreter :: v_destroy () noexcept {
 	Melder_free (our environmentName);
 	for (int ipar = 1; ipar <= Interpreter_MAXNUM_PARAMETERS; ipar ++)
 		Melder_free (our arguments [ipar]);
+	Interpreter_forgetCompiledExpressions (this);
 	//if (our variablesMap) {
 		for (auto it = our variablesMap. begin(); it != our variablesMap. end(); it ++) {
 			InterpreterVariable var = it -> second;
@@ -645,6 +654,10 @@ InterpreterVariable Interpreter_lookUpVariable (Interpreter me, const char32 *ke
 	return variable_ref;
 }
 
+static inline bool isElsifLine (const char32 *line) {
+	return str32nequ (line, U"elsif", 5) || str32nequ (line, U"elif", 4);
+}
+
 static long lookupLabel (Interpreter me, const char32 *labelName) {
 	for (long ilabel = 1; ilabel <= my numberOfLabels; ilabel ++)
 		if (str32equ (labelName, my labelNames [ilabel]))
@@ -753,6 +766,12 @@ void Interpreter_run (Interpreter me, char32 *text) {
 				my labelLines [my numberOfLabels] = lineNumber;
 			}
 		}
+		/*
+		 * The line that a control-flow keyword jumps to depends only on the text of the script,
+		 * so it is searched for only the first time that the keyword is executed.
+		 */
+		autoNUMvector <long> matchingLines (1, numberOfLines);   // the line found by the search of 'for', 'endfor', 'if', 'until'...
+		autoNUMvector <long> matchingEndifs (1, numberOfLines);   // the 'endif' after an 'else' or 'elsif' that ends an executed branch
 		/*
 		 * Connect continuation lines.
 		 */
@@ -770,6 +789,7 @@ void Interpreter_run (Interpreter me, char32 *text) {
 		/*
 		 * Copy the parameter names and argument values into the array of variables.
 		 */
+		Interpreter_forgetCompiledExpressions (me);
 		for (auto it = my variablesMap. begin(); it != my variablesMap. end(); it ++) {
 			InterpreterVariable var = it -> second;
 			forget (var);
@@ -1156,82 +1176,108 @@ void Interpreter_run (Interpreter me, char32 *text) {
 							if (str32nequ (command2.string, U"endif", 5) && wordEnd (command2.string [5])) {
 								/* Ignore. */
 							} else if (str32nequ (command2.string, U"endfor", 6) && wordEnd (command2.string [6])) {
-								int depth = 0;
-								long iline;
-								for (iline = lineNumber - 1; iline > 0; iline --) {
-									char32 *line = lines [iline];
-									if (line [0] == U'f' && line [1] == U'o' && line [2] == U'r' && line [3] == U' ') {
-										if (depth == 0) { lineNumber = iline - 1; fromendfor = true; break; }   // go before 'for'
-										else depth --;
-									} else if (str32nequ (lines [iline], U"endfor", 6) && wordEnd (lines [iline] [6])) {
-										depth ++;
+								long iline = matchingLines [lineNumber];
+								if (iline == 0) {
+									int depth = 0;
+									for (iline = lineNumber - 1; iline > 0; iline --) {
+										char32 *line = lines [iline];
+										if (line [0] == U'f' && line [1] == U'o' && line [2] == U'r' && line [3] == U' ') {
+											if (depth == 0) break;
+											else depth --;
+										} else if (str32nequ (lines [iline], U"endfor", 6) && wordEnd (lines [iline] [6])) {
+											depth ++;
+										}
 									}
+									if (iline <= 0) Melder_throw (U"Unmatched 'endfor'.");
+									matchingLines [lineNumber] = iline;
 								}
-								if (iline <= 0) Melder_throw (U"Unmatched 'endfor'.");
+								lineNumber = iline - 1;   // go before 'for'
+								fromendfor = true;
 							} else if (str32nequ (command2.string, U"endwhile", 8) && wordEnd (command2.string [8])) {
-								int depth = 0;
-								long iline;
-								for (iline = lineNumber - 1; iline > 0; iline --) {
-									if (str32nequ (lines [iline], U"while ", 6)) {
-										if (depth == 0) { lineNumber = iline - 1; break; }   // go before 'while'
-										else depth --;
-									} else if (str32nequ (lines [iline], U"endwhile", 8) && wordEnd (lines [iline] [8])) {
-										depth ++;
+								long iline = matchingLines [lineNumber];
+								if (iline == 0) {
+									int depth = 0;
+									for (iline = lineNumber - 1; iline > 0; iline --) {
+										if (str32nequ (lines [iline], U"while ", 6)) {
+											if (depth == 0) break;
+											else depth --;
+										} else if (str32nequ (lines [iline], U"endwhile", 8) && wordEnd (lines [iline] [8])) {
+											depth ++;
+										}
 									}
+									if (iline <= 0) Melder_throw (U"Unmatched 'endwhile'.");
+									matchingLines [lineNumber] = iline;
 								}
-								if (iline <= 0) Melder_throw (U"Unmatched 'endwhile'.");
+								lineNumber = iline - 1;   // go before 'while'
 							} else if (str32nequ (command2.string, U"endproc", 7) && wordEnd (command2.string [7])) {
 								if (callDepth == 0) Melder_throw (U"Unmatched 'endproc'.");
 								lineNumber = callStack [callDepth --];
 								-- my callDepth;
 							} else fail = true;
 						} else if (str32nequ (command2.string, U"else", 4) && wordEnd (command2.string [4])) {
-							int depth = 0;
-							long iline;
-							for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
-								if (str32nequ (lines [iline], U"endif", 5) && wordEnd (lines [iline] [5])) {
-									if (depth == 0) { lineNumber = iline; break; }   // go after 'endif'
-									else depth --;
-								} else if (str32nequ (lines [iline], U"if ", 3)) {
-									depth ++;
+							long iline = matchingEndifs [lineNumber];
+							if (iline == 0) {
+								int depth = 0;
+								for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
+									if (str32nequ (lines [iline], U"endif", 5) && wordEnd (lines [iline] [5])) {
+										if (depth == 0) break;
+										else depth --;
+									} else if (str32nequ (lines [iline], U"if ", 3)) {
+										depth ++;
+									}
 								}
+								if (iline > numberOfLines) Melder_throw (U"Unmatched 'else'.");
+								matchingEndifs [lineNumber] = iline;
 							}
-							if (iline > numberOfLines) Melder_throw (U"Unmatched 'else'.");
+							lineNumber = iline;   // go after 'endif'
 						} else if (str32nequ (command2.string, U"elsif ", 6) || str32nequ (command2.string, U"elif ", 5)) {
 							if (fromif) {
 								double value;
 								fromif = false;
 								Interpreter_numericExpression (me, command2.string + 5, & value);
 								if (value == 0.0) {
+									long iline = matchingLines [lineNumber];
+									if (iline == 0) {
+										int depth = 0;
+										for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
+											if (str32nequ (lines [iline], U"endif", 5) && wordEnd (lines [iline] [5])) {
+												if (depth == 0) break;
+												else depth --;
+											} else if (str32nequ (lines [iline], U"else", 4) && wordEnd (lines [iline] [4])) {
+												if (depth == 0) break;
+											} else if ((str32nequ (lines [iline], U"elsif", 5) && wordEnd (lines [iline] [5]))
+												|| (str32nequ (lines [iline], U"elif", 4) && wordEnd (lines [iline] [4]))) {
+												if (depth == 0) break;
+											} else if (str32nequ (lines [iline], U"if ", 3)) {
+												depth ++;
+											}
+										}
+										if (iline > numberOfLines) Melder_throw (U"Unmatched 'elsif'.");
+										matchingLines [lineNumber] = iline;
+									}
+									if (isElsifLine (lines [iline])) {
+										lineNumber = iline - 1;   // go at next 'elsif' or 'elif'
+										fromif = true;
+									} else {
+										lineNumber = iline;   // go after 'endif' or 'else'
+									}
+								}
+							} else {
+								long iline = matchingEndifs [lineNumber];
+								if (iline == 0) {
 									int depth = 0;
-									long iline;
 									for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
 										if (str32nequ (lines [iline], U"endif", 5) && wordEnd (lines [iline] [5])) {
-											if (depth == 0) { lineNumber = iline; break; }   // go after 'endif'
+											if (depth == 0) break;
 											else depth --;
-										} else if (str32nequ (lines [iline], U"else", 4) && wordEnd (lines [iline] [4])) {
-											if (depth == 0) { lineNumber = iline; break; }   // go after 'else'
-										} else if ((str32nequ (lines [iline], U"elsif", 5) && wordEnd (lines [iline] [5]))
-											|| (str32nequ (lines [iline], U"elif", 4) && wordEnd (lines [iline] [4]))) {
-											if (depth == 0) { lineNumber = iline - 1; fromif = true; break; }   // go at next 'elsif' or 'elif'
 										} else if (str32nequ (lines [iline], U"if ", 3)) {
 											depth ++;
 										}
 									}
-									if (iline > numberOfLines) Melder_throw (U"Unmatched 'elsif'.");
+									if (iline > numberOfLines) Melder_throw (U"'elsif' not matched with 'endif'.");
+									matchingEndifs [lineNumber] = iline;
 								}
-							} else {
-								int depth = 0;
-								long iline;
-								for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
-									if (str32nequ (lines [iline], U"endif", 5) && wordEnd (lines [iline] [5])) {
-										if (depth == 0) { lineNumber = iline; break; }   /* Go after 'endif'. */
-										else depth --;
-									} else if (str32nequ (lines [iline], U"if ", 3)) {
-										depth ++;
-									}
-								}
-								if (iline > numberOfLines) Melder_throw (U"'elsif' not matched with 'endif'.");
+								lineNumber = iline;   // go after 'endif'
 							}
 						} else if (str32nequ (command2.string, U"exit", 4)) {
 							if (command2.string [4] == U'\0') {
@@ -1269,17 +1315,21 @@ void Interpreter_run (Interpreter me, char32 *text) {
 							}
 							var -> numericValue = loopVariable;
 							if (loopVariable > toValue) {
-								int depth = 0;
-								long iline;
-								for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
-									if (str32nequ (lines [iline], U"endfor", 6)) {
-										if (depth == 0) { lineNumber = iline; break; }   // go after 'endfor'
-										else depth --;
-									} else if (str32nequ (lines [iline], U"for ", 4)) {
-										depth ++;
+								long iline = matchingLines [lineNumber];
+								if (iline == 0) {
+									int depth = 0;
+									for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
+										if (str32nequ (lines [iline], U"endfor", 6)) {
+											if (depth == 0) break;
+											else depth --;
+										} else if (str32nequ (lines [iline], U"for ", 4)) {
+											depth ++;
+										}
 									}
+									if (iline > numberOfLines) Melder_throw (U"Unmatched 'for'.");
+									matchingLines [lineNumber] = iline;
 								}
-								if (iline > numberOfLines) Melder_throw (U"Unmatched 'for'.");
+								lineNumber = iline;   // go after 'endfor'
 							}
 						} else if (str32nequ (command2.string, U"form ", 5)) {
 							long iline;
@@ -1317,21 +1367,30 @@ void Interpreter_run (Interpreter me, char32 *text) {
 							double value;
 							Interpreter_numericExpression (me, command2.string + 3, & value);
 							if (value == 0.0) {
-								int depth = 0;
-								long iline;
-								for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
-									if (str32nequ (lines [iline], U"endif", 5)) {
-										if (depth == 0) { lineNumber = iline; break; }   // go after 'endif'
-										else depth --;
-									} else if (str32nequ (lines [iline], U"else", 4)) {
-										if (depth == 0) { lineNumber = iline; break; }   // go after 'else'
-									} else if (str32nequ (lines [iline], U"elsif ", 6) || str32nequ (lines [iline], U"elif ", 5)) {
-										if (depth == 0) { lineNumber = iline - 1; fromif = true; break; }   // go at 'elsif'
-									} else if (str32nequ (lines [iline], U"if ", 3)) {
-										depth ++;
+								long iline = matchingLines [lineNumber];
+								if (iline == 0) {
+									int depth = 0;
+									for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
+										if (str32nequ (lines [iline], U"endif", 5)) {
+											if (depth == 0) break;
+											else depth --;
+										} else if (str32nequ (lines [iline], U"else", 4)) {
+											if (depth == 0) break;
+										} else if (str32nequ (lines [iline], U"elsif ", 6) || str32nequ (lines [iline], U"elif ", 5)) {
+											if (depth == 0) break;
+										} else if (str32nequ (lines [iline], U"if ", 3)) {
+											depth ++;
+										}
 									}
+									if (iline > numberOfLines) Melder_throw (U"Unmatched 'if'.");
+									matchingLines [lineNumber] = iline;
+								}
+								if (isElsifLine (lines [iline])) {
+									lineNumber = iline - 1;   // go at 'elsif'
+									fromif = true;
+								} else {
+									lineNumber = iline;   // go after 'endif' or 'else'
 								}
-								if (iline > numberOfLines) Melder_throw (U"Unmatched 'if'.");
 							} else if (value == NUMundefined) {
 								Melder_throw (U"The value of the 'if' condition is undefined.");
 							}
@@ -1400,17 +1459,21 @@ void Interpreter_run (Interpreter me, char32 *text) {
 							double value;
 							Interpreter_numericExpression (me, command2.string + 6, & value);
 							if (value == 0.0) {
-								int depth = 0;
-								long iline;
-								for (iline = lineNumber - 1; iline > 0; iline --) {
-									if (str32nequ (lines [iline], U"repeat", 6) && wordEnd (lines [iline] [6])) {
-										if (depth == 0) { lineNumber = iline; break; }   // go after 'repeat'
-										else depth --;
-									} else if (str32nequ (lines [iline], U"until ", 6)) {
-										depth ++;
+								long iline = matchingLines [lineNumber];
+								if (iline == 0) {
+									int depth = 0;
+									for (iline = lineNumber - 1; iline > 0; iline --) {
+										if (str32nequ (lines [iline], U"repeat", 6) && wordEnd (lines [iline] [6])) {
+											if (depth == 0) break;
+											else depth --;
+										} else if (str32nequ (lines [iline], U"until ", 6)) {
+											depth ++;
+										}
 									}
+									if (iline <= 0) Melder_throw (U"Unmatched 'until'.");
+									matchingLines [lineNumber] = iline;
 								}
-								if (iline <= 0) Melder_throw (U"Unmatched 'until'.");
+								lineNumber = iline;   // go after 'repeat'
 							}
 						} else fail = true;
 						break;
@@ -1422,17 +1485,21 @@ void Interpreter_run (Interpreter me, char32 *text) {
 							double value;
 							Interpreter_numericExpression (me, command2.string + 6, & value);
 							if (value == 0.0) {
-								int depth = 0;
-								long iline;
-								for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
-									if (str32nequ (lines [iline], U"endwhile", 8) && wordEnd (lines [iline] [8])) {
-										if (depth == 0) { lineNumber = iline; break; }   // go after 'endwhile'
-										else depth --;
-									} else if (str32nequ (lines [iline], U"while ", 6)) {
-										depth ++;
+								long iline = matchingLines [lineNumber];
+								if (iline == 0) {
+									int depth = 0;
+									for (iline = lineNumber + 1; iline <= numberOfLines; iline ++) {
+										if (str32nequ (lines [iline], U"endwhile", 8) && wordEnd (lines [iline] [8])) {
+											if (depth == 0) break;
+											else depth --;
+										} else if (str32nequ (lines [iline], U"while ", 6)) {
+											depth ++;
+										}
 									}
+									if (iline > numberOfLines) Melder_throw (U"Unmatched 'while'.");
+									matchingLines [lineNumber] = iline;
 								}
-								if (iline > numberOfLines) Melder_throw (U"Unmatched 'while'.");
+								lineNumber = iline;   // go after 'endwhile'
 							}
 						} else fail = true;
 						break;
@@ -1858,7 +1925,7 @@ void Interpreter_run (Interpreter me, char32 *text) {
 								value = NUMundefined;
 							} else if (valueString.string [0] == 1) {   // ...not overwritten by any MelderInfo function? then the return value will be the selected object
 								int IOBJECT, result = 0, found = 0;
-								WHERE (SELECTED) { result = IOBJECT; found += 1; }
+								LOOP { result = IOBJECT; found += 1; }
 								if (found > 1) {
 									Melder_throw (U"Multiple objects selected. Cannot assign ID to variable.");
 								} else if (found == 0) {
@@ -56,6 +56,7 @@ Thing_define (Interpreter, Thing) {
 	long labelLines [1+Interpreter_MAXNUM_LABELS];
 	char32 dialogTitle [1+100], procedureNames [1+Interpreter_MAX_CALL_DEPTH] [100];
 	std::unordered_map <std::u32string, InterpreterVariable> variablesMap;
+	std::unordered_map <std::u32string, FormulaProgram> compiledExpressions;   // refer to the variables, so are forgotten together with them
 	bool running, stopped;
 
 	void v_destroy () noexcept
@@ -42,17 +42,32 @@
 
 /********** text I/O **********/
 
+static inline char32 getChar (MelderReadText me) {
+	/*
+	 * ASCII is the same in every 8-bit encoding, and makes up almost all of a text file,
+	 * so we take it directly from the window without decoding.
+	 */
+	if (me -> readPointer8) {
+		char8 kar = (char8) * me -> readPointer8;
+		if (kar != '\0' && kar <= 0x7F) {
+			me -> readPointer8 ++;
+			return (char32) kar;
+		}
+	}
+	return MelderReadText_getChar (me);
+}
+
 static long getInteger (MelderReadText me) {
 	char buffer [41];
 	char32 c;
 	/*
 	 * Look for the first numeric character.
 	 */
-	for (c = MelderReadText_getChar (me); c != U'-' && ! isdigit ((int) c) && c != U'+'; c = MelderReadText_getChar (me)) {
+	for (c = getChar (me); c != U'-' && ! isdigit ((int) c) && c != U'+'; c = getChar (me)) {
 		if (c == U'\0')
 			Melder_throw (U"Early end of text detected while looking for an integer (line ", MelderReadText_getLineNumber (me), U").");
 		if (c == U'!') {   // end-of-line comment?
-			while ((c = MelderReadText_getChar (me)) != U'\n' && c != U'\r') {
+			while ((c = getChar (me)) != U'\n' && c != U'\r') {
 				if (c == 0)
 					Melder_throw (U"Early end of text detected in comment while looking for an integer (line ", MelderReadText_getLineNumber (me), U").");
 			}
@@ -64,7 +79,7 @@ static long getInteger (MelderReadText me) {
 		while (c != U' ' && c != U'\n' && c != U'\t' && c != U'\r') {
 			if (c == U'\0')
 				Melder_throw (U"Early end of text detected in comment (line ", MelderReadText_getLineNumber (me), U").");
-			c = MelderReadText_getChar (me);
+			c = getChar (me);
 		}
 	}
 	int i = 0;
@@ -72,7 +87,7 @@ static long getInteger (MelderReadText me) {
 		if (c > 127)
 			Melder_throw (U"Found strange text while looking for an integer in text (line ", MelderReadText_getLineNumber (me), U").");
 		buffer [i] = (char) (char8) c;   // guarded conversion down
-		c = MelderReadText_getChar (me);
+		c = getChar (me);
 		if (c == U'\0') { break; }   // this may well be OK here
 		if (c == U' ' || c == U'\n' || c == U'\t' || c == U'\r') break;
 	}
@@ -85,11 +100,11 @@ static long getInteger (MelderReadText me) {
 static unsigned long getUnsigned (MelderReadText me) {
 	char buffer [41];
 	char32 c;
-	for (c = MelderReadText_getChar (me); ! isdigit ((int) c) && c != U'+'; c = MelderReadText_getChar (me)) {
+	for (c = getChar (me); ! isdigit ((int) c) && c != U'+'; c = getChar (me)) {
 		if (c == U'\0')
 			Melder_throw (U"Early end of text detected while looking for an unsigned integer (line ", MelderReadText_getLineNumber (me), U").");
 		if (c == U'!') {   // end-of-line comment?
-			while ((c = MelderReadText_getChar (me)) != '\n' && c != '\r') {
+			while ((c = getChar (me)) != '\n' && c != '\r') {
 				if (c == U'\0')
 					Melder_throw (U"Early end of text detected in comment while looking for an unsigned integer (line ", MelderReadText_getLineNumber (me), U").");
 			}
@@ -103,7 +118,7 @@ static unsigned long getUnsigned (MelderReadText me) {
 		while (c != U' ' && c != U'\n' && c != U'\t' && c != U'\r') {
 			if (c == U'\0')
 				Melder_throw (U"Early end of text detected in comment (line ", MelderReadText_getLineNumber (me), U").");
-			c = MelderReadText_getChar (me);
+			c = getChar (me);
 		}
 	}
 	int i = 0;
@@ -111,7 +126,7 @@ static unsigned long getUnsigned (MelderReadText me) {
 		if (c > 127)
 			Melder_throw (U"Found strange text while looking for an unsigned integer in text (line ", MelderReadText_getLineNumber (me), U").");
 		buffer [i] = (char) (char8) c;   // guarded conversion down
-		c = MelderReadText_getChar (me);
+		c = getChar (me);
 		if (c == U'\0') { break; }   // this may well be OK here
 		if (c == U' ' || c == U'\n' || c == U'\t' || c == U'\r') break;
 	}
@@ -126,11 +141,11 @@ static double getReal (MelderReadText me) {
 	char buffer [41], *slash;
 	char32 c;
 	do {
-		for (c = MelderReadText_getChar (me); c != U'-' && ! isdigit ((int) c) && c != U'+'; c = MelderReadText_getChar (me)) {
+		for (c = getChar (me); c != U'-' && ! isdigit ((int) c) && c != U'+'; c = getChar (me)) {
 			if (c == U'\0')
 				Melder_throw (U"Early end of text detected while looking for a real number (line ", MelderReadText_getLineNumber (me), U").");
 			if (c == U'!') {   // end-of-line comment?
-				while ((c = MelderReadText_getChar (me)) != U'\n' && c != U'\r') {
+				while ((c = getChar (me)) != U'\n' && c != U'\r') {
 					if (c == U'\0')
 						Melder_throw (U"Early end of text detected in comment while looking for a real number (line ", MelderReadText_getLineNumber (me), U").");
 				}
@@ -142,14 +157,14 @@ static double getReal (MelderReadText me) {
 			while (c != U' ' && c != U'\n' && c != U'\t' && c != U'\r') {
 				if (c == U'\0')
 					Melder_throw (U"Early end of text detected in comment while looking for a real number (line ", MelderReadText_getLineNumber (me), U").");
-				c = MelderReadText_getChar (me);
+				c = getChar (me);
 			}
 		}
 		for (i = 0; i < 40; i ++) {
 			if (c > 127)
 				Melder_throw (U"Found strange text while looking for a real number in text (line ", MelderReadText_getLineNumber (me), U").");
 			buffer [i] = (char) (char8) c;   // guarded conversion down
-			c = MelderReadText_getChar (me);
+			c = getChar (me);
 			if (c == U'\0') { break; }   // this may well be OK here
 			if (c == U' ' || c == U'\n' || c == U'\t' || c == U'\r') break;
 		}
@@ -171,11 +186,11 @@ static double getReal (MelderReadText me) {
 
 static short getEnum (MelderReadText me, int (*getValue) (const char32 *)) {
 	char32 buffer [41], c;
-	for (c = MelderReadText_getChar (me); c != U'<'; c = MelderReadText_getChar (me)) {
+	for (c = getChar (me); c != U'<'; c = getChar (me)) {
 		if (c == U'\0')
 			Melder_throw (U"Early end of text detected while looking for an enumerated value (line ", MelderReadText_getLineNumber (me), U").");
 		if (c == U'!') {   /* End-of-line comment? */
-			while ((c = MelderReadText_getChar (me)) != U'\n' && c != U'\r') {
+			while ((c = getChar (me)) != U'\n' && c != U'\r') {
 				if (c == U'\0')
 					Melder_throw (U"Early end of text detected in comment while looking for an enumerated value (line ", MelderReadText_getLineNumber (me), U").");
 			}
@@ -187,12 +202,12 @@ static short getEnum (MelderReadText me, int (*getValue) (const char32 *)) {
 		while (c != U' ' && c != U'\n' && c != U'\t' && c != U'\r') {
 			if (c == U'\0')
 				Melder_throw (U"Early end of text detected in comment while looking for an enumerated value (line ", MelderReadText_getLineNumber (me), U").");
-			c = MelderReadText_getChar (me);
+			c = getChar (me);
 		}
 	}
 	int i = 0;
 	for (; i < 40; i ++) {
-		c = MelderReadText_getChar (me);   // read past first '<'
+		c = getChar (me);   // read past first '<'
 		if (c == U'\0')
 			Melder_throw (U"Early end of text detected while reading an enumerated value (line ", MelderReadText_getLineNumber (me), U").");
 		if (c == U' ' || c == U'\n' || c == U'\t' || c == U'\r')
@@ -213,11 +228,11 @@ static short getEnum (MelderReadText me, int (*getValue) (const char32 *)) {
 static char32 * getString (MelderReadText me) {
 	static MelderString buffer { 0 };
 	MelderString_empty (& buffer);
-	for (char32 c = MelderReadText_getChar (me); c != U'\"'; c = MelderReadText_getChar (me)) {
+	for (char32 c = getChar (me); c != U'\"'; c = getChar (me)) {
 		if (c == U'\0')
 			Melder_throw (U"Early end of text detected while looking for a string (line ", MelderReadText_getLineNumber (me), U").");
 		if (c == U'!') {   // end-of-line comment?
-			while ((c = MelderReadText_getChar (me)) != '\n' && c != '\r') {
+			while ((c = getChar (me)) != '\n' && c != '\r') {
 				if (c == U'\0')
 					Melder_throw (U"Early end of text detected in comment while looking for a string (line ", MelderReadText_getLineNumber (me), U").");
 			}
@@ -229,15 +244,15 @@ static char32 * getString (MelderReadText me) {
 		while (c != U' ' && c != U'\n' && c != U'\t' && c != U'\r') {
 			if (c == U'\0')
 				Melder_throw (U"Early end of text detected while looking for a string (line ", MelderReadText_getLineNumber (me), U").");
-			c = MelderReadText_getChar (me);
+			c = getChar (me);
 		}
 	}
 	for (int i = 0; 1; i ++) {
-		char32 c = MelderReadText_getChar (me);   // read past first '"'
+		char32 c = getChar (me);   // read past first '"'
 		if (c == U'\0')
 			Melder_throw (U"Early end of text detected while reading a string (line ", MelderReadText_getLineNumber (me), U").");
 		if (c == U'\"') {
-			char32 next = MelderReadText_getChar (me);
+			char32 next = getChar (me);
 			if (next == U'\0') { break; }   // closing quote is last character in file: OK
 			if (next != U'\"') {
 				if (next == U' ' || next == U'\n' || next == U'\t' || next == U'\r') {
@@ -478,12 +478,15 @@ bool Melder_stringMatchesCriterion (const char32 *value, int which_kMelder_strin
 		return (which_kMelder_string == kMelder_string_ENDS_WITH) == matchPositiveCriterion;
 	}
 	if (which_kMelder_string == kMelder_string_MATCH_REGEXP) {
-		char32 *place = nullptr;
-		regexp *compiled_regexp = CompileRE_throwable (criterion, 0);
-		if (ExecRE (compiled_regexp, nullptr, value, nullptr, 0, '\0', '\0', nullptr, nullptr, nullptr))
-			place = compiled_regexp -> startp [0];
-		free (compiled_regexp);
-		return !! place;
+		/*
+			We are typically called once for every interval or row with the same criterion,
+			so the compiled expression comes from the cache.
+		*/
+		const char32 *compileMessage;
+		regexp *compiled_regexp = CompileRE_cached (criterion, & compileMessage, 0);
+		if (! compiled_regexp)
+			Melder_throw (U"Regular expression: ", compileMessage, U".");
+		return MatchesRE (compiled_regexp, value);
 	}
 	return false;   // should not occur
 }
@@ -751,6 +751,14 @@ struct structMelderReadText {
 	char32 *string32, *readPointer32;
 	char *string8, *readPointer8;
 	unsigned long input8Encoding;
+	/*
+	 * An 8-bit text is not read into memory as a whole:
+	 * string8 is a window onto the file, which is refilled as reading proceeds.
+	 */
+	FILE *file8;
+	char *end8;   // the end of the text in the window; always points to a null byte
+	int64 windowSize8, numberOfLinesBeforeWindow8;
+	bool endOfFile8, previousByteWasReturn8;
 };
 typedef struct structMelderReadText *MelderReadText;
 
@@ -1372,6 +1380,11 @@ public:
 		if (ptr) fclose (ptr);   // BUG: not a normal closure
 		ptr = f;
 	}
+	FILE * transfer () {
+		FILE *tmp = ptr;
+		ptr = nullptr;
+		return tmp;
+	}
 	void close (MelderFile file) {
 		if (ptr) {
 			FILE *tmp = ptr;
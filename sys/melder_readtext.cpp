@@ -21,13 +21,79 @@
 #include "abcio.h"
 #define my  me ->
 
+#define WINDOW_SIZE  1000000
+
+/*
+ * Removes null bytes and changes CR-LF and bare CR to LF, in place,
+ * exactly as the whole-text repair in _MelderFile_readText does,
+ * but for a chunk of text whose predecessor may have ended in a CR.
+ * Returns the new number of bytes.
+ */
+static int64 repairChunk (char *chunk, int64 numberOfBytes, bool *previousByteWasReturn) {
+	if (numberOfBytes == 0) return 0;
+	if (! *previousByteWasReturn &&
+		! memchr (chunk, '\0', (size_t) numberOfBytes) && ! memchr (chunk, 13, (size_t) numberOfBytes))
+	{
+		return numberOfBytes;   // the usual case: nothing to repair
+	}
+	char *to = chunk;
+	for (const char *from = chunk; from < chunk + numberOfBytes; from ++) {
+		char kar = *from;
+		if (kar == '\0') continue;   // null bytes do not interrupt a CR-LF pair
+		if (kar == '\n' && *previousByteWasReturn) {
+			*previousByteWasReturn = false;   // second half of a Windows line break
+			continue;
+		}
+		*previousByteWasReturn = ( kar == 13 );
+		*to ++ = ( kar == 13 ? '\n' : kar );
+	}
+	return to - chunk;
+}
+
+/*
+ * Makes sure that at least `numberOfBytesNeeded` bytes follow the read pointer,
+ * unless the file is exhausted; returns false if no bytes follow it at all.
+ */
+static bool refillWindow (MelderReadText me, int64 numberOfBytesNeeded) {
+	int64 numberOfBytesLeft = my end8 - my readPointer8;
+	if (numberOfBytesLeft >= numberOfBytesNeeded || my endOfFile8)
+		return numberOfBytesLeft > 0;
+	/*
+	 * Forget the text that has been read, but remember how many lines it contained.
+	 */
+	for (const char *p = my string8; (p = (const char *) memchr (p, '\n', (size_t) (my readPointer8 - p))) != nullptr; p ++)
+		my numberOfLinesBeforeWindow8 ++;
+	memmove (my string8, my readPointer8, (size_t) numberOfBytesLeft);
+	my readPointer8 = my string8;
+	if (numberOfBytesNeeded > my windowSize8) {
+		int64 newWindowSize = 2 * my windowSize8 > numberOfBytesNeeded ? 2 * my windowSize8 : numberOfBytesNeeded;
+		my string8 = (char *) Melder_realloc (my string8, newWindowSize + 1);
+		my readPointer8 = my string8;
+		my windowSize8 = newWindowSize;
+	}
+	while (numberOfBytesLeft < numberOfBytesNeeded && ! my endOfFile8) {
+		size_t numberOfBytesWanted = (size_t) (my windowSize8 - numberOfBytesLeft);
+		size_t numberOfBytesRead = fread (my string8 + numberOfBytesLeft, sizeof (char), numberOfBytesWanted, my file8);
+		if (ferror (my file8))
+			Melder_throw (U"Error reading text file.");
+		if (numberOfBytesRead < numberOfBytesWanted)
+			my endOfFile8 = true;
+		numberOfBytesLeft += repairChunk (my string8 + numberOfBytesLeft, (int64) numberOfBytesRead, & my previousByteWasReturn8);
+	}
+	my end8 = my string8 + numberOfBytesLeft;
+	*my end8 = '\0';
+	return numberOfBytesLeft > 0;
+}
+
 char32 MelderReadText_getChar (MelderReadText me) {
 	if (my string32) {
 		if (* my readPointer32 == U'\0') return U'\0';
 		return * my readPointer32 ++;
 	} else {
-		if (* my readPointer8 == '\0') return U'\0';
+		if (* my readPointer8 == '\0' && ! refillWindow (me, 1)) return U'\0';
 		if (my input8Encoding == kMelder_textInputEncoding_UTF8) {
+			if ((char8) * my readPointer8 > 0x7F && my end8 - my readPointer8 < 4)
+				(void) refillWindow (me, 4);   // a character should not straddle the window boundary
 			char32 kar1 = (char32) (char8) * my readPointer8 ++;
 			if (kar1 <= 0x00007F) {
 				return kar1;
@@ -77,26 +143,32 @@ char32 * MelderReadText_readLine (MelderReadText me) {
 		Melder_assert (my string8);
 		Melder_assert (! my readPointer32);
 		Melder_assert (my readPointer8);
-		if (*my readPointer8 == '\0') {   // tried to read past end of file
+		if (*my readPointer8 == '\0' && ! refillWindow (me, 1)) {   // tried to read past end of file
 			return nullptr;
 		}
-		char *result8 = my readPointer8;
-		char *newline = strchr (result8, '\n');
-		if (newline) {
-			*newline = '\0';
-			my readPointer8 = newline + 1;
-		} else {
-			my readPointer8 += strlen (result8);
+		char *newline = (char *) memchr (my readPointer8, '\n', (size_t) (my end8 - my readPointer8));
+		while (! newline && ! my endOfFile8) {
+			/*
+			 * The line continues beyond the window.
+			 */
+			int64 numberOfBytesSearched = my end8 - my readPointer8;
+			(void) refillWindow (me, numberOfBytesSearched + 1);
+			newline = (char *) memchr (my readPointer8 + numberOfBytesSearched, '\n', (size_t) (my end8 - my readPointer8 - numberOfBytesSearched));
 		}
+		char *result8 = my readPointer8;
+		char *endOfLine = newline ? newline : my end8;
+		my readPointer8 = newline ? newline + 1 : my end8;
 		static char32 *text32 = nullptr;
 		static int64 size = 0;
-		int64 sizeNeeded = (int64) strlen (result8) + 1;
+		int64 sizeNeeded = (endOfLine - result8) + 1;
 		if (sizeNeeded > size) {
 			Melder_free (text32);
 			text32 = Melder_malloc_f (char32, sizeNeeded + 100);
 			size = sizeNeeded + 100;
 		}
+		*endOfLine = '\0';
 		Melder_8to32_inline (result8, text32, my input8Encoding);
+		if (newline) *newline = '\n';   // keep the window intact for counting lines
 		return text32;
 	}
 }
@@ -108,9 +180,28 @@ int64 MelderReadText_getNumberOfLines (MelderReadText me) {
 		for (; *p != U'\0'; p ++) if (*p == U'\n') n ++;
 		if (p - my string32 > 1 && p [-1] != U'\n') n ++;
 	} else {
-		char *p = & my string8 [0];
-		for (; *p != '\0'; p ++) if (*p == '\n') n ++;
-		if (p - my string8 > 1 && p [-1] != '\n') n ++;
+		/*
+		 * Count the lines in the whole file, not just in the window.
+		 */
+		off_t position = ftello (my file8);
+		rewind (my file8);
+		autostring8 chunk = Melder_malloc (char, WINDOW_SIZE);
+		bool previousByteWasReturn = false;
+		int64 length = 0;
+		char lastCharacter = '\0';
+		size_t numberOfBytesRead;
+		while ((numberOfBytesRead = fread (chunk.peek(), sizeof (char), WINDOW_SIZE, my file8)) > 0) {
+			int64 numberOfBytes = repairChunk (chunk.peek(), (int64) numberOfBytesRead, & previousByteWasReturn);
+			for (const char *p = chunk.peek(); (p = (const char *) memchr (p, '\n', (size_t) (chunk.peek() + numberOfBytes - p))) != nullptr; p ++)
+				n ++;
+			if (numberOfBytes > 0) lastCharacter = chunk [numberOfBytes - 1];
+			length += numberOfBytes;
+		}
+		if (ferror (my file8))
+			Melder_throw (U"Error reading text file.");
+		clearerr (my file8);
+		fseeko (my file8, position, SEEK_SET);
+		if (length > 1 && lastCharacter != '\n') n ++;
 	}
 	return n;
 }
@@ -124,12 +215,9 @@ const char32 * MelderReadText_getLineNumber (MelderReadText me) {
 			p ++;
 		}
 	} else {
-		char *p = my string8;
-		while (my readPointer8 - p > 0) {
-			if (*p == '\0' || *p == '\n') result ++;
-			p ++;
-		}
-		return Melder_integer (result);
+		result += my numberOfLinesBeforeWindow8;
+		for (const char *p = my string8; (p = (const char *) memchr (p, '\n', (size_t) (my readPointer8 - p))) != nullptr; p ++)
+			result ++;
 	}
 	return Melder_integer (result);
 }
@@ -152,7 +240,7 @@ static size_t fread_multi (char *buffer, size_t numberOfBytes, FILE *f) {
 	return numberOfBytesRead;
 }
 
-static char32 * _MelderFile_readText (MelderFile file, char **string8) {
+static char32 * _MelderFile_readText (MelderFile file) {
 	try {
 		int type = 0;   // 8-bit
 		autostring32 text;
@@ -184,29 +272,17 @@ static char32 * _MelderFile_readText (MelderFile file, char **string8) {
 			 * Count and repair null bytes.
 			 */
 			if (length > 0) {
-				int64 numberOfNullBytes = 0;
-				for (char *p = & text8bit [length - 1]; (int64) (p - text8bit.peek()) >= 0; p --) {
-					if (*p == '\0') {
-						numberOfNullBytes += 1;
-						/*
-						 * Shift.
-						 */
-						for (char *q = p; (int64) (q - text8bit.peek()) < length; q ++) {
-							*q = q [1];
-						}
-					}
+				char *to = text8bit.peek();
+				for (const char *from = text8bit.peek(); from < text8bit.peek() + length; from ++) {
+					if (*from != '\0') *to ++ = *from;
 				}
+				int64 numberOfNullBytes = length - (to - text8bit.peek());
+				*to = '\0';
 				if (numberOfNullBytes > 0) {
 					Melder_warning (U"Ignored ", numberOfNullBytes, U" null bytes in text file ", file, U".");
 				}
 			}
-			if (string8) {
-				*string8 = text8bit.transfer();
-				(void) Melder_killReturns_inline (*string8);
-				return nullptr;   // OK
-			} else {
-				text.reset (Melder_8to32 (text8bit.peek(), 0));
-			}
+			text.reset (Melder_8to32 (text8bit.peek(), 0));
 		} else {
 			length = length / 2 - 1;   // Byte Order Mark subtracted. Length = number of UTF-16 codes
 			text.reset (Melder_malloc (char32, length + 1));
@@ -266,24 +342,91 @@ static char32 * _MelderFile_readText (MelderFile file, char **string8) {
 }
 
 char32 * MelderFile_readText (MelderFile file) {
-	return _MelderFile_readText (file, nullptr);
+	return _MelderFile_readText (file);
+}
+
+/*
+ * The whole file has to be seen before we know whether it is valid UTF-8,
+ * so we check this in a separate pass, which costs no memory.
+ */
+static bool fileIsValidUtf8 (FILE *f, char *buffer, int64 *numberOfNullBytes) {
+	bool isValid = true;
+	int numberOfContinuationBytesExpected = 0;
+	*numberOfNullBytes = 0;
+	size_t numberOfBytesRead;
+	while ((numberOfBytesRead = fread (buffer, sizeof (char), WINDOW_SIZE, f)) > 0) {
+		const char8 *p = (const char8 *) buffer, *end = p + numberOfBytesRead;
+		for (const char *q = buffer; (q = (const char *) memchr (q, '\0', (size_t) ((const char *) end - q))) != nullptr; q ++)
+			(*numberOfNullBytes) ++;
+		while (isValid && p < end) {
+			if (numberOfContinuationBytesExpected == 0) {
+				/*
+				 * Skip ASCII quickly.
+				 */
+				while (end - p >= 8) {
+					uint64_t eightBytes;
+					memcpy (& eightBytes, p, 8);
+					if (eightBytes & 0x8080808080808080ULL) break;
+					p += 8;
+				}
+				if (p == end) break;
+			}
+			char8 kar = *p ++;
+			if (kar == '\0') {
+				;   // null bytes will be ignored
+			} else if (numberOfContinuationBytesExpected > 0) {
+				if ((kar & 0xC0) != 0x80) isValid = false;
+				numberOfContinuationBytesExpected --;
+			} else if (kar <= 0x7F) {
+				;
+			} else if (kar <= 0xC1) {
+				isValid = false;
+			} else if (kar <= 0xDF) {
+				numberOfContinuationBytesExpected = 1;
+			} else if (kar <= 0xEF) {
+				numberOfContinuationBytesExpected = 2;
+			} else if (kar <= 0xF4) {
+				numberOfContinuationBytesExpected = 3;
+			} else {
+				isValid = false;
+			}
+		}
+	}
+	if (ferror (f))
+		Melder_throw (U"Error reading text file.");
+	return isValid && numberOfContinuationBytesExpected == 0;
 }
 
 MelderReadText MelderReadText_createFromFile (MelderFile file) {
-	autoMelderReadText me = Melder_calloc (struct structMelderReadText, 1);
-	my string32 = _MelderFile_readText (file, & my string8);
-	if (my string32) {
-		my readPointer32 = & my string32 [0];
-	} else {
-		Melder_assert (my string8);
-		my readPointer8 = & my string8 [0];
+	try {
+		autoMelderReadText me = Melder_calloc (struct structMelderReadText, 1);
+		autofile f = Melder_fopen (file, "rb");
+		int firstByte = fgetc (f), secondByte = fgetc (f);
+		if ((firstByte == 0xFE && secondByte == 0xFF) || (firstByte == 0xFF && secondByte == 0xFE)) {
+			/*
+			 * A 16-bit text is converted as a whole.
+			 */
+			f.close (file);
+			my string32 = _MelderFile_readText (file);
+			my readPointer32 = & my string32 [0];
+			return me.transfer();
+		}
+		rewind (f);
+		my string8 = Melder_malloc (char, WINDOW_SIZE + 1);
+		my windowSize8 = WINDOW_SIZE;
 		my input8Encoding = Melder_getInputEncoding ();
-		if (my input8Encoding == kMelder_textInputEncoding_UTF8 ||
+		bool mustCheckUtf8 =
+			my input8Encoding == kMelder_textInputEncoding_UTF8 ||
 			my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_ISO_LATIN1 ||
 			my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_WINDOWS_LATIN1 ||
-			my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_MACROMAN)
-		{
-			if (Melder_str8IsValidUtf8 (my string8)) {
+			my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_MACROMAN;
+		int64 numberOfNullBytes;
+		bool isValidUtf8 = fileIsValidUtf8 (f, my string8, & numberOfNullBytes);
+		if (numberOfNullBytes > 0) {
+			Melder_warning (U"Ignored ", numberOfNullBytes, U" null bytes in text file ", file, U".");
+		}
+		if (mustCheckUtf8) {
+			if (isValidUtf8) {
 				my input8Encoding = kMelder_textInputEncoding_UTF8;
 			} else if (my input8Encoding == kMelder_textInputEncoding_UTF8) {
 				Melder_throw (U"Text is not valid UTF-8; please try a different text input encoding.");
@@ -295,8 +438,14 @@ MelderReadText MelderReadText_createFromFile (MelderFile file) {
 				my input8Encoding = kMelder_textInputEncoding_MACROMAN;
 			}
 		}
+		rewind (f);
+		my readPointer8 = my end8 = & my string8 [0];
+		*my end8 = '\0';
+		my file8 = f.transfer ();
+		return me.transfer();
+	} catch (MelderError) {
+		Melder_throw (U"Error reading file ", file, U".");
 	}
-	return me.transfer();
 }
 
 MelderReadText MelderReadText_createFromString (const char32 *string);
@@ -305,6 +454,7 @@ void MelderReadText_delete (MelderReadText me) {
 	if (! me) return;
 	Melder_free (my string32);
 	Melder_free (my string8);
+	if (my file8) fclose (my file8);
 	Melder_free (me);
 }
 
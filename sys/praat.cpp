@@ -112,12 +112,12 @@ long praat_idOfSelected (ClassInfo klas, int inplace) {
 	int place = inplace, IOBJECT;
 	if (place == 0) place = 1;
 	if (place > 0) {
-		WHERE (SELECTED && (! klas || CLASS == klas)) {
+		LOOP if (! klas || CLASS == klas) {
 			if (place == 1) return ID;
 			place --;
 		}
 	} else {
-		WHERE_DOWN (SELECTED && (! klas || CLASS == klas)) {
+		for (IOBJECT = theCurrentPraatObjects -> lastSelected; IOBJECT > 0 && IOBJECT >= theCurrentPraatObjects -> firstSelected; IOBJECT --) if (SELECTED && (! klas || CLASS == klas)) {
 			if (place == -1) return ID;
 			place ++;
 		}
@@ -134,12 +134,12 @@ char32 * praat_nameOfSelected (ClassInfo klas, int inplace) {
 	int place = inplace, IOBJECT;
 	if (place == 0) place = 1;
 	if (place > 0) {
-		WHERE (SELECTED && (! klas || CLASS == klas)) {
+		LOOP if (! klas || CLASS == klas) {
 			if (place == 1) return klas ? NAME : FULL_NAME;
 			place --;
 		}
 	} else {
-		WHERE_DOWN (SELECTED && (! klas || CLASS == klas)) {
+		for (IOBJECT = theCurrentPraatObjects -> lastSelected; IOBJECT > 0 && IOBJECT >= theCurrentPraatObjects -> firstSelected; IOBJECT --) if (SELECTED && (! klas || CLASS == klas)) {
 			if (place == -1) return klas ? NAME : FULL_NAME;
 			place ++;
 		}
@@ -163,6 +163,8 @@ void praat_deselect (int IOBJECT) {
 	if (! SELECTED) return;
 	SELECTED = false;
 	theCurrentPraatObjects -> totalSelection -= 1;
+	if (theCurrentPraatObjects -> totalSelection == 0)
+		theCurrentPraatObjects -> firstSelected = theCurrentPraatObjects -> lastSelected = 0;
 	long readableClassId = theCurrentPraatObjects -> list [IOBJECT]. object -> classInfo -> sequentialUniqueIdOfReadableClass;
 	Melder_assert (readableClassId != 0);
 	theCurrentPraatObjects -> numberOfSelected [readableClassId] -= 1;
@@ -173,11 +175,17 @@ void praat_deselect (int IOBJECT) {
 	}
 }
 
-void praat_deselectAll () { int IOBJECT; WHERE (1) praat_deselect (IOBJECT); }
+void praat_deselectAll () { int IOBJECT; LOOP praat_deselect (IOBJECT); }
 
 void praat_select (int IOBJECT) {
 	if (SELECTED) return;
 	SELECTED = true;
+	if (theCurrentPraatObjects -> totalSelection == 0) {
+		theCurrentPraatObjects -> firstSelected = theCurrentPraatObjects -> lastSelected = IOBJECT;
+	} else {
+		if (IOBJECT < theCurrentPraatObjects -> firstSelected) theCurrentPraatObjects -> firstSelected = IOBJECT;
+		if (IOBJECT > theCurrentPraatObjects -> lastSelected) theCurrentPraatObjects -> lastSelected = IOBJECT;
+	}
 	theCurrentPraatObjects -> totalSelection += 1;
 	Thing object = theCurrentPraatObjects -> list [IOBJECT]. object;
 	Melder_assert (object);
@@ -193,18 +201,18 @@ void praat_selectAll () { int IOBJECT; WHERE (1) praat_select (IOBJECT); }
 
 void praat_list_background () {
 	int IOBJECT;
-	WHERE (SELECTED) GuiList_deselectItem (praatList_objects, IOBJECT);
+	LOOP GuiList_deselectItem (praatList_objects, IOBJECT);
 }
 void praat_list_foreground () {
 	int IOBJECT;
-	WHERE (SELECTED) {
+	LOOP {
 		GuiList_selectItem (praatList_objects, IOBJECT);
 	}
 }
 
 Daata praat_onlyObject (ClassInfo klas) {
 	int IOBJECT, result = 0, found = 0;
-	WHERE (SELECTED && CLASS == klas) { result = IOBJECT; found += 1; }
+	LOOP if (CLASS == klas) { result = IOBJECT; found += 1; }
 	if (found != 1) return nullptr;
 	return theCurrentPraatObjects -> list [result]. object;
 }
@@ -219,7 +227,7 @@ Daata praat_firstObject (ClassInfo klas) {
 
 Daata praat_onlyObject_generic (ClassInfo klas) {
 	int IOBJECT, result = 0, found = 0;
-	WHERE (SELECTED && Thing_isSubclass (CLASS, klas)) { result = IOBJECT; found += 1; }
+	LOOP if (Thing_isSubclass (CLASS, klas)) { result = IOBJECT; found += 1; }
 	if (found != 1) return nullptr;
 	return theCurrentPraatObjects -> list [result]. object;
 }
@@ -234,7 +242,7 @@ Daata praat_firstObject_generic (ClassInfo klas) {
 
 praat_Object praat_onlyScreenObject () {
 	int IOBJECT, result = 0, found = 0;
-	WHERE (SELECTED) { result = IOBJECT; found += 1; }
+	LOOP { result = IOBJECT; found += 1; }
 	if (found != 1) Melder_fatal (U"praat_onlyScreenObject: found ", found, U" objects instead of 1.");
 	return & theCurrentPraatObjects -> list [result];
 }
@@ -263,7 +271,7 @@ void praat_write_do (UiForm dia, const char32 *extension) {
 	int IOBJECT, found = 0;
 	Daata data = nullptr;
 	static MelderString defaultFileName { 0 };
-	WHERE (SELECTED) { if (! data) data = (Daata) OBJECT; found += 1; }
+	LOOP { if (! data) data = (Daata) OBJECT; found += 1; }
 	if (found == 1) {
 		MelderString_copy (& defaultFileName, data -> name);
 		if (defaultFileName.length > 50) { defaultFileName.string [50] = U'\0'; defaultFileName.length = 50; }
@@ -289,6 +297,94 @@ static void removeAllReferencesToMoribundEditor (Editor editor) {
 		praatP. editor = nullptr;
 }
 
+/*
+	The name index maps each full name ("Sound hello") to the ids of the objects that carry it,
+	in increasing order, so that scripts can find "the last object with this name" without a scan.
+*/
+static void indexName (PraatObjects me, int iobject) {
+	if (! my idsByName) my idsByName = new std::unordered_map <std::u32string, std::vector <long>>;
+	(*my idsByName) [my list [iobject]. name]. push_back (my list [iobject]. id);
+}
+
+static void unindexName (PraatObjects me, int iobject) {
+	if (! my idsByName || ! my list [iobject]. name) return;
+	auto it = my idsByName -> find (my list [iobject]. name);
+	if (it == my idsByName -> end ()) return;
+	std::vector <long> & ids = it -> second;
+	for (long i = ids.size (); i > 0; i --) {
+		if (ids [i - 1] == my list [iobject]. id) {
+			ids.erase (ids.begin () + (i - 1));
+			break;
+		}
+	}
+	if (ids.empty ()) my idsByName -> erase (it);
+}
+
+int praat_positionOfId (long id) {
+	/*
+		New objects are appended with ever-increasing ids and removal preserves the order,
+		so the ids increase along the list and we can bisect.
+	*/
+	int low = 1, high = theCurrentPraatObjects -> n;
+	while (low <= high) {
+		int mid = low + (high - low) / 2;
+		long midId = theCurrentPraatObjects -> list [mid]. id;
+		if (midId == id) return mid;
+		if (midId < id) low = mid + 1; else high = mid - 1;
+	}
+	return 0;
+}
+
+int praat_positionOfFullName (const char32 *fullName) {
+	if (! theCurrentPraatObjects -> idsByName) return 0;
+	auto it = theCurrentPraatObjects -> idsByName -> find (fullName);
+	if (it == theCurrentPraatObjects -> idsByName -> end ()) return 0;
+	Melder_assert (! it -> second.empty ());
+	int position = praat_positionOfId (it -> second.back ());
+	Melder_assert (position != 0);
+	return position;
+}
+
+int praat_positionOfName (const char32 *className, const char32 *givenName) {
+	int IOBJECT;
+	/*
+		The name index normally has the answer.
+	*/
+	static MelderString fullName { 0 };
+	MelderString_copy (& fullName, className, U" ", givenName);
+	IOBJECT = praat_positionOfFullName (fullName.string);
+	if (IOBJECT != 0 && str32equ (className, Thing_className (OBJECT)) && str32equ (givenName, ((Daata) OBJECT) -> name))
+		return IOBJECT;
+	/*
+		Not found, or the object has been renamed behind the list's back.
+	*/
+	WHERE_DOWN (1) {
+		Daata object = (Daata) OBJECT;
+		if (str32equ (className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
+			return IOBJECT;
+	}
+	return 0;
+}
+
+void praat_setFullName (int IOBJECT, const char32 *fullName) {
+	unindexName (theCurrentPraatObjects, IOBJECT);
+	Melder_free (FULL_NAME), FULL_NAME = Melder_dup_f (fullName);
+	indexName (theCurrentPraatObjects, IOBJECT);
+}
+
+void praat_freeObjects (PraatObjects me) {
+	for (int iobject = my n; iobject >= 1; iobject --) {
+		Melder_free (my list [iobject]. name);
+		Melder_free (my list [iobject]. file);
+		forget (my list [iobject]. object);
+	}
+	my n = 0;
+	Melder_free (my list);
+	my capacity = 0;
+	delete my idsByName;
+	my idsByName = nullptr;
+}
+
 /**
 	Remove the "object" from the list,
 	killing everything that has to do with the selection.
@@ -319,8 +415,9 @@ static void praat_remove (int iobject, bool removeVisibly) {
 			trace (U"forgeotten editor ", ieditor);
 		}
 	}
-	MelderFile_setToNull (& theCurrentPraatObjects -> list [iobject]. file);
+	Melder_free (theCurrentPraatObjects -> list [iobject]. file);
 	trace (U"free name");
+	unindexName (theCurrentPraatObjects, iobject);
 	Melder_free (theCurrentPraatObjects -> list [iobject]. name);
 	trace (U"forget object");
 	forget (theCurrentPraatObjects -> list [iobject]. object);   // note: this might save a file-based object to file
@@ -371,15 +468,20 @@ void praat_newWithFile (autoDaata me, MelderFile file, const char32 *myName) {
 	}
 	MelderString_append (& name, Thing_className (me.get()), U" ", givenName.string);
 
-	if (theCurrentPraatObjects -> n == praat_MAXNUM_OBJECTS) {
-		//forget (me);
-		Melder_throw (U"The Object Window cannot contain more than ", praat_MAXNUM_OBJECTS, U" objects. You could remove some objects.");
+	if (theCurrentPraatObjects -> n == theCurrentPraatObjects -> capacity) {
+		int newCapacity = theCurrentPraatObjects -> capacity < 100 ? 100 : 2 * theCurrentPraatObjects -> capacity;
+		praat_Object newList = (praat_Object) Melder_realloc (theCurrentPraatObjects -> list, (1 + newCapacity) * (int64) sizeof (structPraat_Object));
+		memset (newList + 1 + theCurrentPraatObjects -> capacity, 0, (newCapacity - theCurrentPraatObjects -> capacity) * sizeof (structPraat_Object));
+		if (! theCurrentPraatObjects -> list) memset (newList, 0, sizeof (structPraat_Object));   // list [0] is never used
+		theCurrentPraatObjects -> list = newList;
+		theCurrentPraatObjects -> capacity = newCapacity;
 	}
-		
+
 	int IOBJECT = ++ theCurrentPraatObjects -> n;
 	Melder_assert (FULL_NAME == nullptr);
-	FULL_NAME = Melder_dup_f (name.string);   // all right to crash if out of memory
 	++ theCurrentPraatObjects -> uniqueId;
+	ID = theCurrentPraatObjects -> uniqueId;
+	praat_setFullName (IOBJECT, name.string);   // all right to crash if out of memory
 
 	if (! theCurrentPraatApplication -> batch) {   // put a new object on the screen, at the bottom of the list
 		GuiList_insertItem (praatList_objects,
@@ -391,12 +493,11 @@ void praat_newWithFile (autoDaata me, MelderFile file, const char32 *myName) {
 	SELECTED = false;
 	for (int ieditor = 0; ieditor < praat_MAXNUM_EDITORS; ieditor ++)
 		EDITOR [ieditor] = nullptr;
+	Melder_assert (! theCurrentPraatObjects -> list [IOBJECT]. file);
 	if (file) {
-		MelderFile_copy (file, & theCurrentPraatObjects -> list [IOBJECT]. file);
-	} else {
-		MelderFile_setToNull (& theCurrentPraatObjects -> list [IOBJECT]. file);
+		theCurrentPraatObjects -> list [IOBJECT]. file = Melder_calloc_f (structMelderFile, 1);
+		MelderFile_copy (file, theCurrentPraatObjects -> list [IOBJECT]. file);
 	}
-	ID = theCurrentPraatObjects -> uniqueId;
 	theCurrentPraatObjects -> list [IOBJECT]. isBeingCreated = true;
 	Thing_setName (OBJECT, givenName.string);
 	theCurrentPraatObjects -> totalBeingCreated ++;
@@ -446,9 +547,16 @@ void praat_updateSelection () {
 	if (theCurrentPraatObjects -> totalBeingCreated) {
 		int IOBJECT;
 		praat_deselectAll ();
-		WHERE (theCurrentPraatObjects -> list [IOBJECT]. isBeingCreated) {
-			praat_select (IOBJECT);
-			theCurrentPraatObjects -> list [IOBJECT]. isBeingCreated = false;
+		/*
+			The objects being created are the most recent ones, so they sit at the end of the list.
+		*/
+		int numberOfObjectsToFind = theCurrentPraatObjects -> totalBeingCreated;
+		for (IOBJECT = theCurrentPraatObjects -> n; IOBJECT > 0 && numberOfObjectsToFind > 0; IOBJECT --) {
+			if (theCurrentPraatObjects -> list [IOBJECT]. isBeingCreated) {
+				praat_select (IOBJECT);
+				theCurrentPraatObjects -> list [IOBJECT]. isBeingCreated = false;
+				numberOfObjectsToFind --;
+			}
 		}
 		theCurrentPraatObjects -> totalBeingCreated = 0;
 		praat_show ();
@@ -459,19 +567,24 @@ static void gui_cb_list_selectionChanged (Thing /* boss */, GuiList_SelectionCha
 	Melder_assert (event -> list == praatList_objects);
 	int IOBJECT;
 	bool first = true;
-	WHERE (SELECTED) {
+	LOOP {
 		SELECTED = false;
 		long readableClassId = theCurrentPraatObjects -> list [IOBJECT]. object -> classInfo -> sequentialUniqueIdOfReadableClass;
 		theCurrentPraatObjects -> numberOfSelected [readableClassId] --;
 		Melder_assert (theCurrentPraatObjects -> numberOfSelected [readableClassId] >= 0);
 	}
 	theCurrentPraatObjects -> totalSelection = 0;
+	theCurrentPraatObjects -> firstSelected = theCurrentPraatObjects -> lastSelected = 0;
 	long numberOfSelected;
 	long *selected = GuiList_getSelectedPositions (praatList_objects, & numberOfSelected);
 	if (selected) {
 		for (long iselected = 1; iselected <= numberOfSelected; iselected ++) {
 			IOBJECT = selected [iselected];
 			SELECTED = true;
+			if (theCurrentPraatObjects -> firstSelected == 0 || IOBJECT < theCurrentPraatObjects -> firstSelected)
+				theCurrentPraatObjects -> firstSelected = IOBJECT;
+			if (IOBJECT > theCurrentPraatObjects -> lastSelected)
+				theCurrentPraatObjects -> lastSelected = IOBJECT;
 			long readableClassId = theCurrentPraatObjects -> list [IOBJECT]. object -> classInfo -> sequentialUniqueIdOfReadableClass;
 			theCurrentPraatObjects -> numberOfSelected [readableClassId] ++;
 			Melder_assert (theCurrentPraatObjects -> numberOfSelected [readableClassId] > 0);
@@ -510,17 +623,17 @@ void praat_name2 (char32 *name, ClassInfo klas1, ClassInfo klas2) {
 }
 
 void praat_removeObject (int i) {
-	int j, ieditor;
 	praat_remove (i, true);   // dangle
-	for (j = i; j < theCurrentPraatObjects -> n; j ++)
-		theCurrentPraatObjects -> list [j] = theCurrentPraatObjects -> list [j + 1];   // undangle but create second references
-	theCurrentPraatObjects -> list [theCurrentPraatObjects -> n]. name = nullptr;   // undangle or remove second reference
-	theCurrentPraatObjects -> list [theCurrentPraatObjects -> n]. object = nullptr;   // undangle or remove second reference
-	theCurrentPraatObjects -> list [theCurrentPraatObjects -> n]. isSelected = 0;
-	for (ieditor = 0; ieditor < praat_MAXNUM_EDITORS; ieditor ++)
-		theCurrentPraatObjects -> list [theCurrentPraatObjects -> n]. editors [ieditor] = nullptr;   // undangle or remove second reference
-	MelderFile_setToNull (& theCurrentPraatObjects -> list [theCurrentPraatObjects -> n]. file);   // undangle or remove second reference
+	/*
+		Keep the order of the list, which is the order in the Objects window.
+		The slots are small, so shifting the tail down is a single cheap memmove.
+	*/
+	memmove (& theCurrentPraatObjects -> list [i], & theCurrentPraatObjects -> list [i + 1],
+		(theCurrentPraatObjects -> n - i) * sizeof (structPraat_Object));   // undangle but create second references
+	memset (& theCurrentPraatObjects -> list [theCurrentPraatObjects -> n], 0, sizeof (structPraat_Object));   // undangle or remove second references
 	-- theCurrentPraatObjects -> n;
+	if (theCurrentPraatObjects -> firstSelected > i) theCurrentPraatObjects -> firstSelected --;
+	if (theCurrentPraatObjects -> lastSelected >= i) theCurrentPraatObjects -> lastSelected --;
 	if (! theCurrentPraatApplication -> batch) {
 		GuiList_deleteItem (praatList_objects, i);
 	}
@@ -592,8 +705,8 @@ static void praat_exit (int exit_code) {
 	}
 
 	trace (U"flush the file-based objects");
-	WHERE_DOWN (! MelderFile_isNull (& theCurrentPraatObjects -> list [IOBJECT]. file)) {
-		trace (U"removing object based on file ", & theCurrentPraatObjects -> list [IOBJECT]. file);
+	WHERE_DOWN (! MelderFile_isNull (theCurrentPraatObjects -> list [IOBJECT]. file)) {
+		trace (U"removing object based on file ", theCurrentPraatObjects -> list [IOBJECT]. file);
 		praat_remove (IOBJECT, false);
 	}
 	Melder_files_cleanUp ();   // in case a URL is open
@@ -122,18 +122,20 @@ GuiMenuItem praat_addMenuCommand (const char32 *window, const char32 *menu, cons
 
 #define praat_MAXNUM_EDITORS 5
 #include "Ui.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
 typedef struct {
 	ClassInfo klas;   // the class
 	Daata object;   // the instance
 	char32 *name;   // the name of the object as it appears in the List
-	structMelderFile file;   // is this Object associated with a file?
+	MelderFile file;   // the file this Object is associated with, or null
 	long id;   // the unique number of the object
 	bool isSelected;   // is the name of the object inverted in the list?
 	Editor editors [praat_MAXNUM_EDITORS];   // are there editors open with this Object in it?
 	bool isBeingCreated;
 } structPraat_Object, *praat_Object;
 
-#define praat_MAXNUM_OBJECTS 10000   /* Maximum number of objects in the list. */
 typedef struct {   /* Readonly */
 	MelderString batchName;   /* The name of the command file when called from batch. */
 	int batch;   /* Was the program called from the command line? */
@@ -142,12 +144,16 @@ typedef struct {   /* Readonly */
 } structPraatApplication, *PraatApplication;
 typedef struct {   /* Readonly */
 	int n;	 /* The current number of objects in the list. */
-	structPraat_Object list [1 + praat_MAXNUM_OBJECTS];   /* The list of objects: list [1..n]. */
+	int capacity;   /* The number of slots allocated for list [1..capacity]; grows as needed. */
+	praat_Object list;   /* The list of objects: list [1..n]. */
 	int totalSelection;   /* The total number of selected objects, <= n. */
+	int firstSelected, lastSelected;   /* All selected objects lie in list [firstSelected..lastSelected]; 0 if none. */
+	std::unordered_map <std::u32string, std::vector <long>> *idsByName;   /* Full name -> ids, in increasing order. */
 	int numberOfSelected [1 + 1000];   /* For each (readable) class. */
 	int totalBeingCreated;
 	long uniqueId;
 } structPraatObjects, *PraatObjects;
+void praat_freeObjects (PraatObjects me);   // for private object lists, such as those of manual pages
 typedef struct {   // readonly
 	Graphics graphics;   /* The Graphics associated with the Picture window or HyperPage window or Demo window. */
 	int font, fontSize, lineType;
@@ -453,7 +459,7 @@ void praat_name2 (char32 *name, ClassInfo klas1, ClassInfo klas2);
 #define ID  (theCurrentPraatObjects -> list [IOBJECT]. id)
 #define ID_AND_FULL_NAME  Melder_cat (ID, U". ", FULL_NAME)
 #define NAME  praat_name (IOBJECT)
-#define EVERY(proc)  WHERE (SELECTED) proc;
+#define EVERY(proc)  LOOP proc;
 #define EVERY_CHECK(proc)  EVERY (if (! proc) return 0)
 #define EVERY_TO(proc)  EVERY_CHECK (praat_new1 (proc, NAME))
 #define ONLY(klas)  praat_onlyObject (klas)
@@ -467,7 +473,7 @@ Daata praat_firstObject_any ();
 #define FIRST_ANY(Klas)  (Klas) praat_firstObject_any ()
 
 #define EVERY_DRAW(proc) \
-	praat_picture_open (); WHERE (SELECTED) proc; praat_picture_close (); return 1;
+	praat_picture_open (); LOOP proc; praat_picture_close (); return 1;
 
 /* Used by praat_Sybil.cpp, if you put an Editor on the screen: */
 int praat_installEditor (Editor editor, int iobject);
@@ -536,7 +542,7 @@ void praat_addCommandsToEditor (Editor me);
 #define iam_ONLY(klas)  klas me = static_cast<klas> (ONLY (class##klas))
 #define thouart_ONLY(klas)  klas thee = static_cast<klas> (ONLY (class##klas))
 #define heis_ONLY(klas)  klas him = static_cast<klas> (ONLY (class##klas))
-#define LOOP  for (IOBJECT = 1; IOBJECT <= theCurrentPraatObjects -> n; IOBJECT ++) if (SELECTED)
+#define LOOP  for (IOBJECT = theCurrentPraatObjects -> firstSelected; IOBJECT > 0 && IOBJECT <= theCurrentPraatObjects -> lastSelected; IOBJECT ++) if (SELECTED)
 
 autoCollection praat_getSelectedObjects ();
 
@@ -89,6 +89,10 @@ Thing_define (Praat_Command, Thing) {
 int praat_numberOfSelected (ClassInfo klas);
 long praat_idOfSelected (ClassInfo klas, int inplace);
 char32 * praat_nameOfSelected (ClassInfo klas, int inplace);
+int praat_positionOfId (long id);   // 0 if there is no object with this id
+int praat_positionOfFullName (const char32 *fullName);   // the last object called e.g. "Sound hello", or 0
+int praat_positionOfName (const char32 *className, const char32 *givenName);   // the same, checked against the object's own name
+void praat_setFullName (int IOBJECT, const char32 *fullName);   // keeps the name index up to date
 
 /* Used by praat.cpp; defined in praat_picture.cpp.
 */
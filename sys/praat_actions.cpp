@@ -22,10 +22,117 @@
 #include "machine.h"
 #include "GuiP.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #define BUTTON_LEFT  -240
 #define BUTTON_RIGHT -5
 
 static OrderedOf <structPraat_Command> theActions;
+
+/*
+ * Scripts look up their action commands by title, often in tight loops,
+ * so we keep an index from each title to the positions (in increasing order) of the actions with that title.
+ *
+ * The visibility and executability of the actions depend only on how many objects of each class are selected
+ * (the "selection signature"). Scripts tend to alternate between a few selections,
+ * so praat_actions_show () remembers the states of all actions for each signature it has seen.
+ *
+ * Both caches are invalidated whenever theActions changes (insertion, removal, sorting, hiding, showing).
+ */
+static std::unordered_map <std::u32string, std::vector <long>> theActionsByTitle;
+static bool theActionsByTitleAreValid = false;
+#define ActionState_VISIBLE  1
+#define ActionState_EXECUTABLE  2
+#define MAXIMUM_NUMBER_OF_REMEMBERED_SELECTIONS  64
+static std::unordered_map <std::u32string, std::vector <unsigned char>> theActionStatesBySelection;
+static std::u32string theSelectionSignatureOfTheActionStates;
+static bool theActionStatesAreValid = false;
+
+static void invalidateActionCaches () {
+	theActionsByTitleAreValid = false;
+	theActionStatesBySelection. clear ();
+	theActionStatesAreValid = false;
+}
+
+static long lookUpExecutableAction (const char32 *title) {
+	if (! theActionsByTitleAreValid) {
+		theActionsByTitle. clear ();
+		for (long i = 1; i <= theActions.size; i ++) {
+			Praat_Command action = theActions.at [i];
+			if (action -> title && action -> callback)
+				theActionsByTitle [action -> title]. push_back (i);
+		}
+		theActionsByTitleAreValid = true;
+	}
+	auto it = theActionsByTitle. find (title);
+	if (it == theActionsByTitle. end()) return 0;   // not found
+	const std::vector <long>& positions = it -> second;
+	for (size_t ipos = 0; ipos < positions. size (); ipos ++)
+		if (theActions.at [positions [ipos]] -> executable)
+			return positions [ipos];
+	return 0;   // found, but not executable with the current selection
+}
+
+static std::u32string selectionSignature () {
+	std::u32string signature;
+	const int maximumNumberOfReadableClasses = sizeof theCurrentPraatObjects -> numberOfSelected / sizeof (int) - 1;
+	for (int iclass = 1; iclass <= maximumNumberOfReadableClasses; iclass ++) {
+		int numberOfSelected = theCurrentPraatObjects -> numberOfSelected [iclass];
+		if (numberOfSelected > 0) {
+			signature += (char32) iclass;
+			signature += (char32) numberOfSelected;
+		}
+	}
+	return signature;
+}
+
+static unsigned char computeActionState (Praat_Command action) {
+	int sel1 = 0, sel2 = 0, sel3 = 0, sel4 = 0;
+	int n1 = action -> n1, n2 = action -> n2, n3 = action -> n3, n4 = action -> n4;
+	unsigned char state = 0;
+
+	/* Match the actually selected classes with the selection required for this visibility. */
+
+	if (! action -> class1) return state;   // at least one class selected
+	sel1 = action -> class1 == classDaata ? theCurrentPraatObjects -> totalSelection : praat_numberOfSelected (action -> class1);
+	if (sel1 == 0) return state;
+	if (action -> class2 && (sel2 = praat_numberOfSelected (action -> class2)) == 0) return state;
+	if (action -> class3 && (sel3 = praat_numberOfSelected (action -> class3)) == 0) return state;
+	if (action -> class4 && (sel4 = praat_numberOfSelected (action -> class4)) == 0) return state;
+	if (sel1 + sel2 + sel3 + sel4 != theCurrentPraatObjects -> totalSelection) return state;   // other classes selected? Do not show
+	if (! action -> hidden) state |= ActionState_VISIBLE;
+
+	/* Match the actually selected objects with the selection required for this action. */
+
+	if (! action -> callback) return state;   // separators are not executable
+	if ((n1 && sel1 != n1) || (n2 && sel2 != n2) || (n3 && sel3 != n3) || (n4 && sel4 != n4)) return state;
+	return state | ActionState_EXECUTABLE;
+}
+
+static void updateActionStates () {
+	std::u32string signature = selectionSignature ();
+	if (theActionStatesAreValid && signature == theSelectionSignatureOfTheActionStates)
+		return;   // the flags in theActions are still correct
+	auto it = theActionStatesBySelection. find (signature);
+	if (it == theActionStatesBySelection. end()) {
+		if (theActionStatesBySelection. size () >= MAXIMUM_NUMBER_OF_REMEMBERED_SELECTIONS)
+			theActionStatesBySelection. clear ();
+		std::vector <unsigned char> states (theActions.size + 1);
+		for (long i = 1; i <= theActions.size; i ++)
+			states [i] = computeActionState (theActions.at [i]);
+		it = theActionStatesBySelection. insert (std::make_pair (signature, states)). first;
+	}
+	const std::vector <unsigned char>& states = it -> second;
+	for (long i = 1; i <= theActions.size; i ++) {
+		Praat_Command action = theActions.at [i];
+		action -> visible = states [i] & ActionState_VISIBLE;
+		action -> executable = states [i] & ActionState_EXECUTABLE;
+	}
+	theSelectionSignatureOfTheActionStates = signature;
+	theActionStatesAreValid = true;
+}
 static GuiMenu praat_writeMenu;
 static GuiMenuItem praat_writeMenuSeparator;
 static GuiForm praat_form;
@@ -163,6 +270,7 @@ void praat_addAction4 (ClassInfo class1, int n1, ClassInfo class2, int n2, Class
 		 * Insert new command.
 		 */
 		theActions. addItemAtPosition_move (action.move(), position);
+		invalidateActionCaches ();
 	} catch (MelderError) {
 		Melder_flushError ();
 	}
@@ -250,6 +358,7 @@ void praat_addActionScript (const char32 *className1, int n1, const char32 *clas
 		long found = lookUpMatchingAction (class1, class2, class3, nullptr, title);
 		if (found) {
 			theActions. removeItem (found);
+			invalidateActionCaches ();
 		}
 
 		/*
@@ -299,6 +408,7 @@ void praat_addActionScript (const char32 *className1, int n1, const char32 *clas
 		 * Insert new command.
 		 */
 		theActions. addItemAtPosition_move (action.move(), position);
+		invalidateActionCaches ();
 		updateDynamicMenu ();
 	} catch (MelderError) {
 		Melder_throw (U"Praat: script action not added.");
@@ -317,6 +427,7 @@ void praat_removeAction (ClassInfo class1, ClassInfo class2, ClassInfo class3, c
 				U": ", title, U"\" not found.");
 		}
 		theActions. removeItem (found);
+		invalidateActionCaches ();
 	} catch (MelderError) {
 		Melder_throw (U"Praat: action not removed.");
 	}
@@ -358,6 +469,7 @@ void praat_hideAction (ClassInfo class1, ClassInfo class2, ClassInfo class3, con
 		Praat_Command action = theActions.at [found];
 		if (! action -> hidden) {
 			action -> hidden = true;
+			invalidateActionCaches ();
 			if (praatP.phase >= praat_READING_BUTTONS) action -> toggled = ! action -> toggled;
 			updateDynamicMenu ();
 		}
@@ -401,6 +513,7 @@ void praat_showAction (ClassInfo class1, ClassInfo class2, ClassInfo class3, con
 		Praat_Command action = theActions.at [found];
 		if (action -> hidden) {
 			action -> hidden = false;
+			invalidateActionCaches ();
 			if (praatP.phase >= praat_READING_BUTTONS) action -> toggled = ! action -> toggled;
 			updateDynamicMenu ();
 		}
@@ -455,6 +568,7 @@ void praat_sortActions () {
 		action -> sortingTail = i;
 	}
 	qsort (& theActions.at [1], theActions.size, sizeof (Praat_Command), compareActions);
+	invalidateActionCaches ();
 }
 
 static const char32 *numberString (int number) {
@@ -557,33 +671,7 @@ void praat_actions_show () {
 		if (theCurrentPraatObjects -> totalSelection != 0 && ! Melder_backgrounding)
 			GuiThing_setSensitive (praat_writeMenu, true);
 	}
-	for (long i = 1; i <= theActions.size; i ++) {
-		Praat_Command action = theActions.at [i];
-		int sel1 = 0, sel2 = 0, sel3 = 0, sel4 = 0;
-		int n1 = action -> n1, n2 = action -> n2, n3 = action -> n3, n4 = action -> n4;
-
-		/* Clean up from previous selection. */
-
-		action -> visible = false;
-		action -> executable = false;
-
-		/* Match the actually selected classes with the selection required for this visibility. */
-
-		if (! action -> class1) continue;   // at least one class selected
-		sel1 = action -> class1 == classDaata ? theCurrentPraatObjects -> totalSelection : praat_numberOfSelected (action -> class1);
-		if (sel1 == 0) continue;
-		if (action -> class2 && (sel2 = praat_numberOfSelected (action -> class2)) == 0) continue;
-		if (action -> class3 && (sel3 = praat_numberOfSelected (action -> class3)) == 0) continue;
-		if (action -> class4 && (sel4 = praat_numberOfSelected (action -> class4)) == 0) continue;
-		if (sel1 + sel2 + sel3 + sel4 != theCurrentPraatObjects -> totalSelection) continue;   // other classes selected? Do not show
-		action -> visible = ! action -> hidden;
-
-		/* Match the actually selected objects with the selection required for this action. */
-
-		if (! action -> callback) continue;   // separators are not executable
-		if ((n1 && sel1 != n1) || (n2 && sel2 != n2) || (n3 && sel3 != n3) || (n4 && sel4 != n4)) continue;
-		action -> executable = true;
-	}
+	updateActionStates ();
 
 	/* Create a new column of buttons in the dynamic menu. */
 	if (! theCurrentPraatApplication -> batch && ! Melder_backgrounding) {
@@ -711,17 +799,15 @@ void praat_saveAddedActions (MelderString *buffer) {
 }
 
 int praat_doAction (const char32 *command, const char32 *arguments, Interpreter interpreter) {
-	long i = 1;
-	while (i <= theActions.size && (! theActions.at [i] -> executable || str32cmp (theActions.at [i] -> title, command))) i ++;
-	if (i > theActions.size) return 0;   // not found
+	long i = lookUpExecutableAction (command);
+	if (i == 0) return 0;   // not found
 	theActions.at [i] -> callback (nullptr, 0, nullptr, arguments, interpreter, command, false, nullptr);
 	return 1;
 }
 
 int praat_doAction (const char32 *command, int narg, Stackel args, Interpreter interpreter) {
-	long i = 1;
-	while (i <= theActions.size && (! theActions.at [i] -> executable || str32cmp (theActions.at [i] -> title, command))) i ++;
-	if (i > theActions.size) return 0;   // not found
+	long i = lookUpExecutableAction (command);
+	if (i == 0) return 0;   // not found
 	theActions.at [i] -> callback (nullptr, narg, args, nullptr, interpreter, command, false, nullptr);
 	return 1;
 }
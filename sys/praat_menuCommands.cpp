@@ -20,8 +20,33 @@
 #include "praat_script.h"
 #include "GuiP.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 static OrderedOf <structPraat_Command> theCommands;
 
+/*
+ * An index from each title to the positions (in increasing order) of the menu commands with that title,
+ * for scripts and for the fixed buttons. Rebuilt after theCommands has changed.
+ */
+static std::unordered_map <std::u32string, std::vector <long>> theCommandsByTitle;
+static bool theCommandsByTitleAreValid = false;
+
+static const std::vector <long> *lookUpMenuCommandsByTitle (const char32 *title) {
+	if (! theCommandsByTitleAreValid) {
+		theCommandsByTitle. clear ();
+		for (long i = 1; i <= theCommands.size; i ++) {
+			Praat_Command command = theCommands.at [i];
+			if (command -> title)
+				theCommandsByTitle [command -> title]. push_back (i);
+		}
+		theCommandsByTitleAreValid = true;
+	}
+	auto it = theCommandsByTitle. find (title);
+	return it == theCommandsByTitle. end() ? nullptr : & it -> second;
+}
+
 void praat_menuCommands_init () {
 }
 
@@ -47,6 +72,7 @@ void praat_sortMenuCommands () {
 		command -> sortingTail = i;
 	}
 	qsort (& theCommands.at [1], theCommands.size, sizeof (Praat_Command), compareMenuCommands);
+	theCommandsByTitleAreValid = false;
 }
 
 static long lookUpMatchingMenuCommand (const char32 *window, const char32 *menu, const char32 *title) {
@@ -216,6 +242,7 @@ GuiMenuItem praat_addMenuCommand (const char32 *window, const char32 *menu, cons
 	}
 	Thing_cast (GuiMenuItem, button_as_GuiMenuItem, command -> button);
 	theCommands. addItemAtPosition_move (command.move(), position);
+	theCommandsByTitleAreValid = false;
 	return button_as_GuiMenuItem;
 }
 
@@ -306,6 +333,7 @@ void praat_addMenuCommandScript (const char32 *window, const char32 *menu, const
 			}
 		}
 		theCommands. addItemAtPosition_move (command.move(), position);
+		theCommandsByTitleAreValid = false;
 
 		if (praatP.phase >= praat_HANDLING_EVENTS) praat_sortMenuCommands ();
 	} catch (MelderError) {
@@ -379,50 +407,38 @@ void praat_addFixedButtonCommand (GuiForm parent, const char32 *title, UiCallbac
 	}
 	my executable = false;
 	theCommands. addItemAtPosition_move (me.move(), 0);
+	theCommandsByTitleAreValid = false;
 }
 
 void praat_sensitivizeFixedButtonCommand (const char32 *title, int sensitive) {
-	Praat_Command commandFound = nullptr;
-	for (long i = 1; i <= theCommands.size; i ++) {
-		Praat_Command command = theCommands.at [i];
-		if (str32equ (command -> title, title)) {
-			commandFound = command;
-			break;
-		}
-	}
+	const std::vector <long> *positions = lookUpMenuCommandsByTitle (title);
+	Praat_Command commandFound = positions ? theCommands.at [(*positions) [0]] : nullptr;
 	if (! commandFound) Melder_fatal (U"Unkown fixed button <<", title, U">>");
 	commandFound -> executable = sensitive;
 	if (! theCurrentPraatApplication -> batch && ! Melder_backgrounding)
 		GuiThing_setSensitive (commandFound -> button, sensitive);
 }
 
-int praat_doMenuCommand (const char32 *title, const char32 *arguments, Interpreter interpreter) {
-	Praat_Command commandFound = nullptr;
-	for (long i = 1; i <= theCommands.size; i ++) {
-		Praat_Command command = theCommands.at [i];
-		if (command -> executable && str32equ (command -> title, title) &&
-			(str32equ (command -> window, U"Objects") || str32equ (command -> window, U"Picture")))
-		{
-			commandFound = command;
-			break;
-		}
+static Praat_Command findExecutableObjectsOrPictureCommand (const char32 *title) {
+	const std::vector <long> *positions = lookUpMenuCommandsByTitle (title);
+	if (! positions) return nullptr;
+	for (size_t ipos = 0; ipos < positions -> size (); ipos ++) {
+		Praat_Command command = theCommands.at [(*positions) [ipos]];
+		if (command -> executable && (str32equ (command -> window, U"Objects") || str32equ (command -> window, U"Picture")))
+			return command;
 	}
+	return nullptr;
+}
+
+int praat_doMenuCommand (const char32 *title, const char32 *arguments, Interpreter interpreter) {
+	Praat_Command commandFound = findExecutableObjectsOrPictureCommand (title);
 	if (! commandFound) return 0;
 	commandFound -> callback (nullptr, 0, nullptr, arguments, interpreter, title, false, nullptr);
 	return 1;
 }
 
 int praat_doMenuCommand (const char32 *title, int narg, Stackel args, Interpreter interpreter) {
-	Praat_Command commandFound = nullptr;
-	for (long i = 1; i <= theCommands.size; i ++) {
-		Praat_Command command = theCommands.at [i];
-		if (command -> executable && str32equ (command -> title, title) &&
-			(str32equ (command -> window, U"Objects") || str32equ (command -> window, U"Picture")))
-		{
-			commandFound = command;
-			break;
-		}
-	}
+	Praat_Command commandFound = findExecutableObjectsOrPictureCommand (title);
 	if (! commandFound) return 0;
 	commandFound -> callback (nullptr, narg, args, nullptr, interpreter, title, false, nullptr);
 	return 1;
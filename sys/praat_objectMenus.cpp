@@ -43,14 +43,14 @@ FORM (Rename, U"Rename object", U"Rename...") {
 	LABEL (U"rename object", U"New name:")
 	TEXTFIELD (U"newName", U"")
 	OK2
-int IOBJECT; WHERE (SELECTED) SET_STRING (U"newName", NAME)
+int IOBJECT; LOOP SET_STRING (U"newName", NAME)
 DO
 	char32 *string = GET_STRING (U"newName");
 	if (theCurrentPraatObjects -> totalSelection == 0)
 		Melder_throw (U"Selection changed!\nNo object selected. Cannot rename.");
 	if (theCurrentPraatObjects -> totalSelection > 1)
 		Melder_throw (U"Selection changed!\nCannot rename more than one object at a time.");
-	WHERE (SELECTED) break;
+	LOOP break;
 	praat_cleanUpName (string);   // this is allowed because "string" is local and dispensible
 	#if 0
 	std::u32string newFullName = std::u32string (Thing_className (OBJECT) + U" " + string;
@@ -65,7 +65,7 @@ DO
 	static MelderString fullName { 0 };
 	MelderString_copy (& fullName, Thing_className (OBJECT), U" ", string);
 	if (! str32equ (fullName.string, FULL_NAME)) {
-		Melder_free (FULL_NAME), FULL_NAME = Melder_dup_f (fullName.string);
+		praat_setFullName (IOBJECT, fullName.string);
 		autoMelderString listName;
 		MelderString_append (& listName, ID, U". ", fullName.string);
 		praat_list_renameAndSelect (IOBJECT, listName.string);
@@ -80,13 +80,13 @@ FORM (Copy, U"Copy object", U"Copy...") {
 	LABEL (U"copy object", U"Name of new object:")
 	TEXTFIELD (U"newName", U"")
 	OK2
-{ int IOBJECT; WHERE (SELECTED) SET_STRING (U"newName", NAME) }
+{ int IOBJECT; LOOP SET_STRING (U"newName", NAME) }
 DO
 	if (theCurrentPraatObjects -> totalSelection == 0)
 		Melder_throw (U"Selection changed!\nNo object selected. Cannot copy.");
 	if (theCurrentPraatObjects -> totalSelection > 1)
 		Melder_throw (U"Selection changed!\nCannot copy more than one object at a time.");
-	WHERE (SELECTED) {
+	LOOP {
 		char32 *name = GET_STRING (U"newName");
 		praat_new (Data_copy ((Daata) OBJECT), name);
 	}
@@ -97,7 +97,7 @@ DIRECT2 (Info) {
 		Melder_throw (U"Selection changed!\nNo object selected. Cannot query.");
 	if (theCurrentPraatObjects -> totalSelection > 1)
 		Melder_throw (U"Selection changed!\nCannot query more than one object at a time.");
-	WHERE (SELECTED) Thing_infoWithIdAndFile (OBJECT, ID, & theCurrentPraatObjects -> list [IOBJECT]. file);
+	LOOP Thing_infoWithIdAndFile (OBJECT, ID, theCurrentPraatObjects -> list [IOBJECT]. file);
 END2 }
 
 DIRECT2 (Inspect) {
@@ -106,7 +106,7 @@ DIRECT2 (Inspect) {
 	if (theCurrentPraatApplication -> batch) {
 		Melder_throw (U"Cannot inspect data from batch.");
 	} else {
-		WHERE (SELECTED) {
+		LOOP {
 			autoDataEditor editor = DataEditor_create (ID_AND_FULL_NAME, OBJECT);
 			praat_installEditor (editor.get(), IOBJECT);
 			editor.releaseToUser();
@@ -380,6 +380,36 @@ DO
 	Melder_debug = GET_INTEGER (U"Debug option");
 END2 }
 
+FORM (praat_randomSeed, U"Random seed", nullptr) {
+	LABEL (U"", U"Type a whole number to make all random numbers from now on")
+	LABEL (U"", U"the same in every run, or \"unpredictable\" to undo this.")
+	WORD (U"Seed", U"unpredictable")
+	OK2
+DO
+	const char32 *seed = GET_STRING (U"Seed");
+	if (str32equ (seed, U"unpredictable")) {
+		NUMrandom_init ();
+	} else {
+		/*
+			The seed can be any unsigned 64-bit number, which is beyond the range of Melder_atoi or Melder_atof,
+			so we read the digits ourselves.
+		*/
+		uint64_t value = 0;
+		bool isValid = seed [0] != U'\0';
+		for (const char32 *p = seed; *p != U'\0'; p ++) {
+			uint64_t digit = (uint64_t) (*p - U'0');
+			if (*p < U'0' || *p > U'9' || value > (UINT64_MAX - digit) / 10) {
+				isValid = false;
+				break;
+			}
+			value = 10 * value + digit;
+		}
+		if (! isValid)
+			Melder_throw (U"The seed should be a whole number from 0 to 18446744073709551615, or \"unpredictable\", not \"", seed, U"\".");
+		NUMrandom_initWithSeed (value);
+	}
+END2 }
+
 DIRECT2 (praat_listReadableTypesOfObjects) {
 	Thing_listReadableClasses ();
 END2 }
@@ -692,6 +722,7 @@ void praat_addMenus (GuiWindow window) {
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report text properties", nullptr, 0, DO_praat_reportTextProperties);
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report system properties", nullptr, 0, DO_praat_reportSystemProperties);
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report graphical properties", nullptr, 0, DO_praat_reportGraphicalProperties);
+	praat_addMenuCommand (U"Objects", U"Technical", U"Random seed...", nullptr, 0, DO_praat_randomSeed);
 	praat_addMenuCommand (U"Objects", U"Technical", U"Debug...", nullptr, 0, DO_praat_debug);
 
 	praat_addMenuCommand (U"Objects", U"Open", U"Read from file...", nullptr, praat_ATTRACTIVE + 'O', DO_Data_readFromFile);
@@ -39,20 +39,16 @@ static int praat_findObjectFromString (Interpreter interpreter, const char32 *st
 				Melder_throw (U"Missing space in name.");
 			*space = U'\0';
 			char32 *className = & buffer.string [0], *givenName = space + 1;
-			WHERE_DOWN (1) {
-				Daata object = (Daata) OBJECT;
-				if (str32equ (className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
-					return IOBJECT;
-			}
+			IOBJECT = praat_positionOfName (className, givenName);
+			if (IOBJECT != 0)
+				return IOBJECT;
 			/*
 			 * No object with that name. Perhaps the class name was wrong?
 			 */
 			ClassInfo klas = Thing_classFromClassName (className, NULL);
-			WHERE_DOWN (1) {
-				Daata object = (Daata) OBJECT;
-				if (str32equ (klas -> className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
-					return IOBJECT;
-			}
+			IOBJECT = praat_positionOfName (klas -> className, givenName);
+			if (IOBJECT != 0)
+				return IOBJECT;
 			Melder_throw (U"No object with that name.");
 		} else {
 			/*
@@ -61,7 +57,8 @@ static int praat_findObjectFromString (Interpreter interpreter, const char32 *st
 			double value;
 			Interpreter_numericExpression (interpreter, string, & value);
 			long id = (long) value;
-			WHERE (ID == id)
+			IOBJECT = praat_positionOfId (id);
+			if (IOBJECT != 0)
 				return IOBJECT;
 			Melder_throw (U"No object with number ", id, U".");
 		}
@@ -99,13 +96,11 @@ Editor praat_findEditorFromString (const char32 *string) {
 }
 
 Editor praat_findEditorById (long id) {
-	int IOBJECT;
-	WHERE (1) {
-		if (ID == id) {
-			for (int ieditor = 0; ieditor < praat_MAXNUM_EDITORS; ieditor ++) {
-				Editor editor = theCurrentPraatObjects -> list [IOBJECT]. editors [ieditor];
-				if (editor) return editor;
-			}
+	int IOBJECT = praat_positionOfId (id);
+	if (IOBJECT != 0) {
+		for (int ieditor = 0; ieditor < praat_MAXNUM_EDITORS; ieditor ++) {
+			Editor editor = theCurrentPraatObjects -> list [IOBJECT]. editors [ieditor];
+			if (editor) return editor;
 		}
 	}
 	Melder_throw (U"Editor ", id, U" does not exist.");